@@ -0,0 +1,78 @@
+#include "BenchReport.h"
+#include "DetourAlloc.h"
+#include "RecastAlloc.h"
+
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+
+static std::atomic<long long> allocationCount(0);
+static std::atomic<long long> allocatedBytes(0);
+
+static void* countedAlloc(size_t size) {
+    allocationCount++;
+    allocatedBytes += (long long) size;
+    return malloc(size ? size : 1);
+}
+
+AllocationCount getAllocationCount() {
+    AllocationCount count;
+    count.count = allocationCount.load();
+    count.bytes = allocatedBytes.load();
+    return count;
+}
+
+static void* rcCountedAlloc(size_t size, rcAllocHint) {
+    return countedAlloc(size);
+}
+
+static void* dtCountedAlloc(size_t size, dtAllocHint) {
+    return countedAlloc(size);
+}
+
+static void countedFree(void* ptr) {
+    free(ptr);
+}
+
+void installAllocationHooks() {
+    rcAllocSetCustom(rcCountedAlloc, countedFree);
+    dtAllocSetCustom(dtCountedAlloc, countedFree);
+}
+
+// Replacing the global operators counts every C++ allocation in the process. Where shared libraries bind to
+// the executable's operators, as on Linux and macOS, that includes the wrapper's.
+void* operator new(size_t size) {
+    void* ptr = countedAlloc(size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
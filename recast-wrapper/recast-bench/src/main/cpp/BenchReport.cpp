@@ -0,0 +1,114 @@
+#include "BenchReport.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+static std::vector<BenchResult> results;
+
+// Nearest-rank percentile of sorted samples.
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t rank = (size_t) (p * sorted.size() + 0.999999);
+    if (rank < 1) {
+        rank = 1;
+    }
+    return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+Measurement::Measurement(const char* group, const char* name) :
+    m_group(group),
+    m_name(name),
+    m_allocations(0),
+    m_allocatedBytes(0)
+{
+    m_startAllocations.count = 0;
+    m_startAllocations.bytes = 0;
+}
+
+void Measurement::begin() {
+    m_startAllocations = getAllocationCount();
+    m_start = std::chrono::steady_clock::now();
+}
+
+void Measurement::end() {
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const AllocationCount allocations = getAllocationCount();
+    add(std::chrono::duration<double, std::micro>(now - m_start).count(),
+        allocations.count - m_startAllocations.count, allocations.bytes - m_startAllocations.bytes);
+}
+
+void Measurement::add(double micros, long long allocations, long long allocatedBytes) {
+    m_micros.push_back(micros);
+    m_allocations += allocations;
+    m_allocatedBytes += allocatedBytes;
+}
+
+BenchResult Measurement::report() const {
+    std::vector<double> sorted = m_micros;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        total += sorted[i];
+    }
+
+    const int n = (int) sorted.size();
+    BenchResult result;
+    result.group = m_group;
+    result.name = m_name;
+    result.iterations = n;
+    result.p50Us = percentile(sorted, 0.50);
+    result.p99Us = percentile(sorted, 0.99);
+    result.maxUs = n > 0 ? sorted.back() : 0;
+    result.meanUs = n > 0 ? total / n : 0;
+    result.opsPerSecond = total > 0 ? n * 1000000.0 / total : 0;
+    result.allocationsPerOp = n > 0 ? (double) m_allocations / n : 0;
+    result.allocatedBytesPerOp = n > 0 ? (double) m_allocatedBytes / n : 0;
+
+    printf("%-28s n=%-7d p50 %10.2f us  p99 %10.2f us  max %10.2f us  %12.1f ops/s  %8.1f allocs/op  %10.0f B/op\n",
+           result.name.c_str(), n, result.p50Us, result.p99Us, result.maxUs, result.opsPerSecond,
+           result.allocationsPerOp, result.allocatedBytesPerOp);
+    results.push_back(result);
+    return result;
+}
+
+long long getPeakRssBytes() {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return (long long) usage.ru_maxrss;
+#else
+    return (long long) usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+bool writeJsonReport(const char* path) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) {
+        return false;
+    }
+
+    // Names are chosen by the benchmarks and never need escaping.
+    fprintf(fp, "{\n  \"peak_rss_bytes\": %lld,\n  \"results\": [", getPeakRssBytes());
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        fprintf(fp, "%s\n    {\"group\": \"%s\", \"name\": \"%s\", \"iterations\": %d, "
+                "\"p50_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f, \"mean_us\": %.3f, "
+                "\"ops_per_sec\": %.3f, \"allocs_per_op\": %.3f, \"alloc_bytes_per_op\": %.1f}",
+                i > 0 ? "," : "", r.group.c_str(), r.name.c_str(), r.iterations, r.p50Us, r.p99Us, r.maxUs,
+                r.meanUs, r.opsPerSecond, r.allocationsPerOp, r.allocatedBytesPerOp);
+    }
+    fprintf(fp, "\n  ]\n}\n");
+    return fclose(fp) == 0;
+}
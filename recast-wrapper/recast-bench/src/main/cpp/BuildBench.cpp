@@ -0,0 +1,278 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "BenchReport.h"
+#include "Benchmarks.h"
+#include "ChunkyTriMesh.h"
+#include "InputGeom.h"
+#include "MeshLoaderObj.h"
+#include "TiledNavMeshBuilder.h"
+#include "wrapper.h"
+
+// rcContext only times the build stages when a subclass keeps the timers. Times are in microseconds.
+class BenchContext : public rcContext {
+public:
+    BenchContext() : rcContext(true) {
+        resetTimers();
+    }
+
+    double getMicros(rcTimerLabel label) const {
+        return m_accumulated[label];
+    }
+
+protected:
+    void doResetTimers() override {
+        for (int i = 0; i < RC_MAX_TIMERS; ++i) {
+            m_accumulated[i] = 0;
+        }
+    }
+
+    void doStartTimer(const rcTimerLabel label) override {
+        m_start[label] = std::chrono::steady_clock::now();
+    }
+
+    void doStopTimer(const rcTimerLabel label) override {
+        m_accumulated[label] += std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - m_start[label]).count();
+    }
+
+    int doGetAccumulatedTime(const rcTimerLabel label) const override {
+        return (int) m_accumulated[label];
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start[RC_MAX_TIMERS];
+    double m_accumulated[RC_MAX_TIMERS];
+};
+
+static const struct {
+    const char* name;
+    rcTimerLabel label;
+} buildStages[] = {
+    {"rasterize", RC_TIMER_RASTERIZE_TRIANGLES},
+    {"compact heightfield", RC_TIMER_BUILD_COMPACTHEIGHTFIELD},
+    {"erode", RC_TIMER_ERODE_AREA},
+    {"distance field", RC_TIMER_BUILD_DISTANCEFIELD},
+    {"regions", RC_TIMER_BUILD_REGIONS},
+    {"contours", RC_TIMER_BUILD_CONTOURS},
+    {"polymesh", RC_TIMER_BUILD_POLYMESH},
+    {"polymesh detail", RC_TIMER_BUILD_POLYMESHDETAIL},
+};
+
+static const int buildStageCount = sizeof(buildStages) / sizeof(buildStages[0]);
+
+// Same settings as the Kotlin and C# tests, see Config.kt.
+static void initBenchConfig(rcConfig& config, const InputGeom& geom) {
+    const float cellSize = 0.3f;
+    const float cellHeight = 0.2f;
+    memset(&config, 0, sizeof(config));
+    config.cs = cellSize;
+    config.ch = cellHeight;
+    config.walkableSlopeAngle = 45.0f;
+    config.walkableHeight = (int) ceilf(2.0f / cellHeight);
+    config.walkableClimb = (int) ceilf(0.9f / cellHeight);
+    config.walkableRadius = (int) ceilf(0.6f / cellSize);
+    config.maxEdgeLen = (int) (12.0f / cellSize);
+    config.maxSimplificationError = 1.3f;
+    config.minRegionArea = 8 * 8;
+    config.mergeRegionArea = 20 * 20;
+    config.maxVertsPerPoly = 6;
+    config.detailSampleDist = cellSize * 6.0f;
+    config.detailSampleMaxError = cellHeight * 1.0f;
+    config.tileSize = 32;
+    config.borderSize = config.walkableRadius + 3;
+    rcVcopy(config.bmin, geom.getMeshBoundsMin());
+    rcVcopy(config.bmax, geom.getMeshBoundsMax());
+    rcCalcGridSize(config.bmin, config.bmax, config.cs, &config.width, &config.height);
+}
+
+static int countTiles(const dtNavMesh* navMesh) {
+    int count = 0;
+    for (int i = 0; i < navMesh->getMaxTiles(); ++i) {
+        const dtMeshTile* tile = navMesh->getTile(i);
+        if (tile && tile->header) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Needs the OBJ given by RECAST_BENCH_OBJ. The bench task points it at the test tile.
+int runBuildBenchmark() {
+    const char* objPath = getenv("RECAST_BENCH_OBJ");
+    if (!objPath) {
+        printf("build: RECAST_BENCH_OBJ is not set, skipping\n");
+        return 0;
+    }
+
+    // Parsing bypasses the geometry cache, which InputGeom would otherwise hit on every run but the first.
+    Measurement objLoad("build", "obj parse");
+    for (int i = 0; i < 5; ++i) {
+        rcMeshLoaderObj mesh;
+        objLoad.begin();
+        const bool loaded = mesh.load(objPath, true);
+        objLoad.end();
+        if (!loaded) {
+            printf("build: failed to parse %s\n", objPath);
+            return 1;
+        }
+    }
+    objLoad.report();
+
+    BenchContext ctx;
+    InputGeom geom;
+    Measurement cachedLoad("build", "geometry load (cached)");
+    cachedLoad.begin();
+    if (!geom.load(&ctx, objPath, true)) {
+        printf("build: failed to load %s\n", objPath);
+        return 1;
+    }
+    cachedLoad.end();
+    cachedLoad.report();
+
+    const rcMeshLoaderObj* mesh = geom.getMesh();
+    Measurement chunky("build", "chunky mesh");
+    for (int i = 0; i < 5; ++i) {
+        rcChunkyTriMesh cm;
+        chunky.begin();
+        rcCreateChunkyTriMesh(mesh->getVerts(), mesh->getTris(), mesh->getTriCount(), 256, &cm);
+        chunky.end();
+    }
+    chunky.report();
+
+    // Every tile of the test mesh is one sample of every stage, built on this thread so that the
+    // allocation counts belong to the tile.
+    rcConfig config;
+    initBenchConfig(config, geom);
+    TileAgentSettings agent;
+    agent.agentHeight = 2.0f;
+    agent.agentRadius = 0.6f;
+    agent.agentMaxClimb = 0.9f;
+    int tileWidth = 0;
+    int tileHeight = 0;
+    calcTileGridSize(config, &geom, &tileWidth, &tileHeight);
+
+    Measurement tileBuild("build", "tile");
+    Measurement* stages[buildStageCount];
+    for (int i = 0; i < buildStageCount; ++i) {
+        stages[i] = new Measurement("build", (std::string("tile ") + buildStages[i].name).c_str());
+    }
+    int failures = 0;
+    for (int ty = 0; ty < tileHeight; ++ty) {
+        for (int tx = 0; tx < tileWidth; ++tx) {
+            unsigned char* navData = 0;
+            int navDataSize = 0;
+            ctx.resetTimers();
+            tileBuild.begin();
+            if (!buildTileNavMeshData(&ctx, config, &geom, tx, ty, agent, &navData, &navDataSize)) {
+                failures++;
+            }
+            tileBuild.end();
+            dtFree(navData);
+            for (int i = 0; i < buildStageCount; ++i) {
+                stages[i]->add(ctx.getMicros(buildStages[i].label), 0, 0);
+            }
+        }
+    }
+    tileBuild.report();
+    for (int i = 0; i < buildStageCount; ++i) {
+        stages[i]->report();
+        delete stages[i];
+    }
+
+    // The tiles are built on the pool's workers and freed on another thread, as when a service drops a navmesh
+    // off its query thread, so the build allocator's pools see blocks come back from threads that did not
+    // allocate them. Every round has to build the same tiles out of the recycled blocks.
+    Measurement tiledBuild("build", "tiled navmesh, all cores");
+    int firstTileCount = -1;
+    for (int i = 0; i < 3; ++i) {
+        tiledBuild.begin();
+        dtNavMesh* navMesh = buildTiledNavMesh(&ctx, config, &geom, agent, 0);
+        tiledBuild.end();
+        if (!navMesh) {
+            failures++;
+            continue;
+        }
+        const int tileCount = countTiles(navMesh);
+        if (firstTileCount < 0) {
+            firstTileCount = tileCount;
+        } else if (tileCount != firstTileCount) {
+            printf("build: round %d built %d tiles, the first %d\n", i, tileCount, firstTileCount);
+            failures++;
+        }
+        std::thread deleter([navMesh]() { navmesh_delete(navMesh); });
+        deleter.join();
+    }
+    tiledBuild.report();
+
+    if (failures > 0) {
+        printf("build: %d tile builds failed\n", failures);
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Needs a tiled navmesh, given by RECAST_BENCH_NAVMESH. The bench task points it at the test navmesh.
+int runLoadBenchmark() {
+    const char* navMeshPath = getenv("RECAST_BENCH_NAVMESH");
+    if (!navMeshPath) {
+        printf("load: RECAST_BENCH_NAVMESH is not set, skipping\n");
+        return 0;
+    }
+
+    // The same navmesh in the indexed version 2 format, loaded on one thread and on every core.
+    const std::string indexedPath = std::string(navMeshPath) + ".v2";
+    dtNavMesh* source = navmesh_load_tiled_bin(navMeshPath);
+    const bool saved = navmesh_save(source, indexedPath.c_str());
+    navmesh_delete(source);
+
+    Measurement load("load", "tiled bin");
+    Measurement mapped("load", "tiled bin, mapped");
+    Measurement indexed("load", "v2, 1 thread");
+    Measurement indexedParallel("load", "v2, all threads");
+    int failures = saved ? 0 : 1;
+    for (int i = 0; i < 20; ++i) {
+        load.begin();
+        dtNavMesh* navMesh = navmesh_load_tiled_bin(navMeshPath);
+        load.end();
+        failures += navMesh ? 0 : 1;
+        navmesh_delete(navMesh);
+
+        mapped.begin();
+        navMesh = navmesh_load_tiled_bin_mapped(navMeshPath);
+        mapped.end();
+        failures += navMesh ? 0 : 1;
+        navmesh_delete(navMesh);
+
+        if (!saved) {
+            continue;
+        }
+        indexed.begin();
+        navMesh = navmesh_load(indexedPath.c_str(), 1);
+        indexed.end();
+        failures += navMesh ? 0 : 1;
+        navmesh_delete(navMesh);
+
+        indexedParallel.begin();
+        navMesh = navmesh_load(indexedPath.c_str(), 0);
+        indexedParallel.end();
+        failures += navMesh ? 0 : 1;
+        navmesh_delete(navMesh);
+    }
+    load.report();
+    mapped.report();
+    if (saved) {
+        indexed.report();
+        indexedParallel.report();
+    }
+    remove(indexedPath.c_str());
+
+    if (failures > 0) {
+        printf("load: %d loads of %s failed\n", failures, navMeshPath);
+    }
+    return failures == 0 ? 0 : 1;
+}
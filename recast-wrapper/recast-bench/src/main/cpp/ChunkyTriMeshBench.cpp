@@ -0,0 +1,172 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "ChunkyTriMesh.h"
+
+// The overlap tests and traversal as they were before the queries moved to the wide tree: one node at a
+// time through the escape indices of rcChunkyTriMesh::nodes. Kept here as the baseline.
+static bool referenceOverlapRect(const float* amin, const float* amax, const rcChunkyTriMeshNode& node) {
+    return !(amin[0] > node.bmax[0] || amax[0] < node.bmin[0] ||
+             amin[1] > node.bmax[1] || amax[1] < node.bmin[1]);
+}
+
+static bool referenceOverlapSegment(const float* p, const float* q, const rcChunkyTriMeshNode& node) {
+    float tmin = 0;
+    float tmax = 1;
+    for (int i = 0; i < 2; i++) {
+        const float d = q[i] - p[i];
+        if (fabsf(d) < 1e-6f) {
+            if (p[i] < node.bmin[i] || p[i] > node.bmax[i])
+                return false;
+        } else {
+            const float ood = 1.0f / d;
+            float t1 = (node.bmin[i] - p[i]) * ood;
+            float t2 = (node.bmax[i] - p[i]) * ood;
+            if (t1 > t2) { float tmp = t1; t1 = t2; t2 = tmp; }
+            if (t1 > tmin) tmin = t1;
+            if (t2 < tmax) tmax = t2;
+            if (tmin > tmax) return false;
+        }
+    }
+    return true;
+}
+
+template <class Overlap>
+static int referenceTraversal(const rcChunkyTriMesh& cm, const float* a, const float* b, Overlap overlaps, int* ids) {
+    int i = 0;
+    int n = 0;
+    while (i < cm.nnodes) {
+        const rcChunkyTriMeshNode& node = cm.nodes[i];
+        const bool overlap = overlaps(a, b, node);
+        const bool isLeafNode = node.i >= 0;
+
+        if (isLeafNode && overlap) {
+            ids[n++] = i;
+        }
+
+        if (overlap || isLeafNode) {
+            i++;
+        } else {
+            i += -node.i;
+        }
+    }
+    return n;
+}
+
+// Small fixed-seed LCG so every run queries the same mesh in the same places.
+static unsigned int nextRandom(unsigned int& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static float randomFloat(unsigned int& state, float range) {
+    return (float) (nextRandom(state) & 0xffff) / 65535.0f * range;
+}
+
+// Scattered small triangles over a square world, roughly what a large terrain chunked into tiles gives.
+static void makeTriangleSoup(int triCount, float worldSize, std::vector<float>& verts, std::vector<int>& tris) {
+    unsigned int state = 12345;
+    verts.resize((size_t) triCount * 9);
+    tris.resize((size_t) triCount * 3);
+    for (int i = 0; i < triCount; ++i) {
+        const float x = randomFloat(state, worldSize);
+        const float z = randomFloat(state, worldSize);
+        for (int j = 0; j < 3; ++j) {
+            float* v = &verts[((size_t) i * 3 + j) * 3];
+            v[0] = x + randomFloat(state, 2.0f);
+            v[1] = randomFloat(state, 10.0f);
+            v[2] = z + randomFloat(state, 2.0f);
+            tris[(size_t) i * 3 + j] = i * 3 + j;
+        }
+    }
+}
+
+static double millisSince(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Runs queryCount rect queries (or segment queries from one corner of the rect to the other) with sides
+// between minSize and maxSize through both traversals, and checks that they return the same chunks.
+static int compareTraversals(const rcChunkyTriMesh& cm, const char* name, bool segments, int queryCount,
+                             float minSize, float maxSize, float worldSize) {
+    std::vector<float> queries((size_t) queryCount * 4);
+    unsigned int state = 678;
+    for (int i = 0; i < queryCount; ++i) {
+        const float size = minSize + randomFloat(state, maxSize - minSize);
+        queries[i * 4 + 0] = randomFloat(state, worldSize - size);
+        queries[i * 4 + 1] = randomFloat(state, worldSize - size);
+        queries[i * 4 + 2] = queries[i * 4 + 0] + size;
+        queries[i * 4 + 3] = queries[i * 4 + 1] + size;
+    }
+
+    std::vector<int> referenceIds(cm.nnodes);
+    std::vector<int> ids;
+    long long referenceTotal = 0, total = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < queryCount; ++i) {
+        float* a = &queries[i * 4];
+        float* b = &queries[i * 4 + 2];
+        referenceTotal += segments ? referenceTraversal(cm, a, b, referenceOverlapSegment, &referenceIds[0])
+                                   : referenceTraversal(cm, a, b, referenceOverlapRect, &referenceIds[0]);
+    }
+    const double referenceMs = millisSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < queryCount; ++i) {
+        float* a = &queries[i * 4];
+        float* b = &queries[i * 4 + 2];
+        total += segments ? rcGetChunksOverlappingSegment(&cm, a, b, ids) : rcGetChunksOverlappingRect(&cm, a, b, ids);
+    }
+    const double ms = millisSince(start);
+
+    printf("%s, binary tree: %d queries in %.1f ms (%.3f us/query), %lld chunks\n",
+           name, queryCount, referenceMs, referenceMs * 1000.0 / queryCount, referenceTotal);
+    printf("%s, wide tree: %d queries in %.1f ms (%.3f us/query), %lld chunks, %.2fx\n",
+           name, queryCount, ms, ms * 1000.0 / queryCount, total, referenceMs / ms);
+
+    // The wide tree must return the same leaves in the same order.
+    for (int i = 0; i < queryCount; ++i) {
+        float* a = &queries[i * 4];
+        float* b = &queries[i * 4 + 2];
+        const int n = segments ? referenceTraversal(cm, a, b, referenceOverlapSegment, &referenceIds[0])
+                               : referenceTraversal(cm, a, b, referenceOverlapRect, &referenceIds[0]);
+        const int m = segments ? rcGetChunksOverlappingSegment(&cm, a, b, ids) : rcGetChunksOverlappingRect(&cm, a, b, ids);
+        if (n != m || (n > 0 && memcmp(&referenceIds[0], &ids[0], n * sizeof(int)) != 0)) {
+            printf("%s: results differ for query %d\n", name, i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int runChunkyTriMeshBenchmark() {
+    const int triCount = 2000000;
+    const float worldSize = 4000.0f;
+    const int trisPerChunk = 256;
+
+    std::vector<float> verts;
+    std::vector<int> tris;
+    makeTriangleSoup(triCount, worldSize, verts, tris);
+
+    rcChunkyTriMesh cm;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (!rcCreateChunkyTriMesh(&verts[0], &tris[0], triCount, trisPerChunk, &cm)) {
+        printf("chunky: failed to build the tree\n");
+        return 1;
+    }
+    printf("build: %d tris, %d nodes, %d wide nodes in %.1f ms\n",
+           triCount, cm.nnodes, cm.nwideNodes, millisSince(start));
+
+    // Tile sized areas, as when rasterizing one tile, areas covering a good part of the world, as when
+    // the whole mesh is built as one tile, and segments of tile length, as used for raycasts.
+    int failures = 0;
+    failures += compareTraversals(cm, "tile rects", false, 20000, 16.0f, 128.0f, worldSize);
+    failures += compareTraversals(cm, "area rects", false, 2000, 500.0f, 2000.0f, worldSize);
+    failures += compareTraversals(cm, "segments", true, 20000, 16.0f, 128.0f, worldSize);
+    return failures;
+}
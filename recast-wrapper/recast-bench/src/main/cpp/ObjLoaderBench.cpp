@@ -0,0 +1,148 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "BenchReport.h"
+#include "Benchmarks.h"
+#include "MeshLoaderObj.h"
+
+static const int FIXTURE_BLOCKS = 256;
+
+// Every eighth block also holds rows longer than the row buffer, which add two vertices and a triangle.
+static bool hasLongRows(int block) {
+    return block % 8 == 7;
+}
+
+// Rows that only parse right if the slices are stitched together correctly, repeated so that with small
+// slices every row starts a slice for some split. Even blocks end their rows with CRLF, odd ones with LF.
+static std::string makeSliceFixture() {
+    std::string obj;
+    char row[64];
+    for (int k = 0; k < FIXTURE_BLOCKS; ++k) {
+        const char* eol = k % 2 == 0 ? "\r\n" : "\n";
+        snprintf(row, sizeof(row), "# block %d", k);
+        obj += std::string(row) + eol;
+        for (int j = 0; j < 3; ++j) {
+            snprintf(row, sizeof(row), "v %d %d %d", k, j > 0 ? 1 : 0, j > 1 ? 1 : 0);
+            obj += std::string(row) + eol;
+        }
+        obj += std::string("f -3 -2 -1") + eol;
+        // Short rows keep the missing components of the vertex before them, which may be in another slice.
+        obj += std::string("v 5") + eol;
+        obj += std::string("v") + eol;
+        // Negative indices count back from the vertices before the row, including those of earlier slices.
+        obj += std::string("f -1 -2 -3 -4 -5") + eol;
+        // Triangles with an index out of range are dropped.
+        obj += std::string("f 1 2 100000") + eol;
+        obj += std::string("f 0 1 2") + eol;
+        if (hasLongRows(k)) {
+            // Rows are cut at 511 characters and the rest parsed as rows of their own: the trailing 4 is
+            // ignored and the vertex at the end of the long comment is kept.
+            obj += "v 1 2 3" + std::string(520, ' ') + "4" + eol;
+            obj += "# " + std::string(509, 'x') + "v 9 8 7" + eol;
+            obj += std::string("f 1/1/1 2//2 3") + eol;
+        }
+    }
+    return obj;
+}
+
+static bool checkFixtureMesh(const rcMeshLoaderObj& mesh) {
+    int vert = 0;
+    int tri = 0;
+    for (int k = 0; k < FIXTURE_BLOCKS; ++k) {
+        const float x = (float) k;
+        const float verts[] = {x, 0, 0,  x, 1, 0,  x, 1, 1,  5, 1, 1,  5, 1, 1,  1, 2, 3,  9, 8, 7};
+        const int b = vert;
+        const int tris[] = {b, b + 1, b + 2,  b + 4, b + 3, b + 2,  b + 4, b + 2, b + 1,  b + 4, b + 1, b,  0, 1, 2};
+        const int vertCount = hasLongRows(k) ? 7 : 5;
+        const int triCount = hasLongRows(k) ? 5 : 4;
+        if (vert + vertCount > mesh.getVertCount() || tri + triCount > mesh.getTriCount() ||
+            memcmp(mesh.getVerts() + vert * 3, verts, vertCount * 3 * sizeof(float)) != 0 ||
+            memcmp(mesh.getTris() + tri * 3, tris, triCount * 3 * sizeof(int)) != 0) {
+            printf("obj: block %d parsed wrong\n", k);
+            return false;
+        }
+        vert += vertCount;
+        tri += triCount;
+    }
+    if (mesh.getVertCount() != vert || mesh.getTriCount() != tri) {
+        printf("obj: parsed %d verts and %d tris, expected %d and %d\n", mesh.getVertCount(), mesh.getTriCount(),
+               vert, tri);
+        return false;
+    }
+    return true;
+}
+
+static bool sameMesh(const rcMeshLoaderObj& a, const rcMeshLoaderObj& b) {
+    return a.getVertCount() == b.getVertCount() && a.getTriCount() == b.getTriCount() &&
+           memcmp(a.getVerts(), b.getVerts(), a.getVertCount() * 3 * sizeof(float)) == 0 &&
+           memcmp(a.getTris(), b.getTris(), a.getTriCount() * 3 * sizeof(int)) == 0 &&
+           memcmp(a.getNormals(), b.getNormals(), a.getTriCount() * 3 * sizeof(float)) == 0;
+}
+
+// Needs RECAST_BENCH_OBJ, next to which the fixture is written. The bench task points it at the test tile.
+int runObjLoaderBenchmark() {
+    const char* objPath = getenv("RECAST_BENCH_OBJ");
+    if (!objPath) {
+        printf("obj: RECAST_BENCH_OBJ is not set, skipping\n");
+        return 0;
+    }
+
+    const std::string fixturePath = std::string(objPath) + ".slices.obj";
+    const std::string fixture = makeSliceFixture();
+    FILE* fp = fopen(fixturePath.c_str(), "wb");
+    bool written = fp && fwrite(fixture.data(), 1, fixture.size(), fp) == fixture.size();
+    written = fp && fclose(fp) == 0 && written;
+    if (!written) {
+        printf("obj: failed to write %s\n", fixturePath.c_str());
+        return 1;
+    }
+
+    // The fixture in one slice has to give the expected mesh, and every split of it the same mesh.
+    int failures = 0;
+    rcMeshLoaderObj reference;
+    if (!reference.load(fixturePath, false, 1, SIZE_MAX) || !checkFixtureMesh(reference)) {
+        failures++;
+    }
+    // The pool cuts four slices per thread, so the thread counts give splits into 4 to 128 slices.
+    const size_t sliceBytes[] = {1, 1000};
+    int splits = 0;
+    for (int threads = 1; threads <= 32; ++threads) {
+        for (size_t s = 0; s < sizeof(sliceBytes) / sizeof(sliceBytes[0]); ++s) {
+            rcMeshLoaderObj mesh;
+            if (!mesh.load(fixturePath, false, threads, sliceBytes[s]) || !sameMesh(mesh, reference)) {
+                printf("obj: %d threads and %d byte slices differ from one slice\n", threads, (int) sliceBytes[s]);
+                failures++;
+            }
+            splits++;
+        }
+    }
+    remove(fixturePath.c_str());
+    printf("obj: %d splits of a %d byte fixture checked against one slice, %d failures\n", splits,
+           (int) fixture.size(), failures);
+
+    // The test tile in one slice and in the default slices, to show what splitting gains.
+    Measurement oneSlice("obj", "parse, one slice");
+    Measurement sliced("obj", "parse, all cores");
+    for (int i = 0; i < 5; ++i) {
+        rcMeshLoaderObj single;
+        oneSlice.begin();
+        const bool singleLoaded = single.load(objPath, true, 1, SIZE_MAX);
+        oneSlice.end();
+
+        rcMeshLoaderObj mesh;
+        sliced.begin();
+        const bool loaded = mesh.load(objPath, true);
+        sliced.end();
+        if (!singleLoaded || !loaded || !sameMesh(single, mesh)) {
+            printf("obj: failed to parse %s the same way in one slice and in several\n", objPath);
+            failures++;
+        }
+    }
+    oneSlice.report();
+    sliced.report();
+
+    return failures == 0 ? 0 : 1;
+}
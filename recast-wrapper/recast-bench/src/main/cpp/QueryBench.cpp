@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "BenchReport.h"
+#include "Benchmarks.h"
+#include "NavMeshTesterTool_subset.h"
+#include "wrapper.h"
+
+// Small fixed-seed LCG so every run asks the same queries.
+static unsigned int randomState = 2468;
+
+static float nextRandomFloat() {
+    randomState = randomState * 1664525u + 1013904223u;
+    return (float) (randomState >> 8) / 16777216.0f;
+}
+
+// Needs a tiled navmesh, given by RECAST_BENCH_NAVMESH. The bench task points it at the test navmesh.
+int runQueryBenchmark() {
+    const char* navMeshPath = getenv("RECAST_BENCH_NAVMESH");
+    if (!navMeshPath) {
+        printf("query: RECAST_BENCH_NAVMESH is not set, skipping\n");
+        return 0;
+    }
+
+    dtNavMesh* navMesh = navmesh_load_tiled_bin(navMeshPath);
+    if (!navMesh) {
+        printf("query: failed to load %s\n", navMeshPath);
+        return 1;
+    }
+    dtNavMeshQuery* navQuery = navmesh_query_create(navMesh);
+    dtQueryFilter filter;
+
+    const int count = 10000;
+    const int maxPath = 1024;
+    const int maxSmoothPath = 4096;
+    std::vector<dtPolyRef> refs((size_t) count * 2);
+    std::vector<float> points((size_t) count * 6);
+    for (int i = 0; i < count * 2; ++i) {
+        navQuery->findRandomPoint(&filter, nextRandomFloat, &refs[i], &points[i * 3]);
+    }
+
+    // Query points a little off the mesh, so findNearestPoly has to search.
+    const float halfExtents[3] = {2.0f, 4.0f, 2.0f};
+    Measurement nearest("query", "findNearestPoly");
+    int failures = 0;
+    for (int i = 0; i < count; ++i) {
+        float point[3] = {points[i * 3] + 0.5f, points[i * 3 + 1] + 1.0f, points[i * 3 + 2] - 0.5f};
+        float nearestPoint[3];
+        dtPolyRef ref = 0;
+        nearest.begin();
+        navQuery->findNearestPoly(point, halfExtents, &filter, &ref, nearestPoint);
+        nearest.end();
+        failures += ref ? 0 : 1;
+    }
+    nearest.report();
+
+    // Each path is smoothed right after it is found, so only one corridor is kept at a time.
+    std::vector<dtPolyRef> path(maxPath);
+    std::vector<float> smoothPath((size_t) maxSmoothPath * 3);
+    Measurement findPath("query", "findPath");
+    Measurement follow("query", "smooth path, follow");
+    Measurement corners("query", "smooth path, corners");
+    for (int i = 0; i < count; ++i) {
+        const float* startPos = &points[i * 6];
+        const float* endPos = &points[i * 6 + 3];
+        dtStatus status = 0;
+        findPath.begin();
+        const int pathCount = navmesh_query_find_path_into(navQuery, refs[i * 2], refs[i * 2 + 1], startPos, endPos,
+                                                           &filter, &path[0], maxPath, &status);
+        findPath.end();
+        if (dtStatusFailed(status) || pathCount == 0) {
+            failures++;
+            continue;
+        }
+
+        int smoothCount = 0;
+        follow.begin();
+        calcSmoothPath(startPos, refs[i * 2], endPos, &path[0], pathCount, filter, navMesh, *navQuery,
+                       &smoothPath[0], smoothCount, maxSmoothPath);
+        follow.end();
+
+        corners.begin();
+        calcStraightSmoothPath(startPos, refs[i * 2], endPos, &path[0], pathCount, *navQuery, SMOOTH_PATH_CORNERS,
+                               0.0f, &smoothPath[0], smoothCount, maxSmoothPath);
+        corners.end();
+    }
+    findPath.report();
+    follow.report();
+    corners.report();
+
+    navmesh_query_delete(navQuery);
+    navmesh_delete(navMesh);
+
+    if (failures > 0) {
+        printf("query: %d queries failed\n", failures);
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "RandomPointSampler.h"
+#include "wrapper.h"
+
+// Small fixed-seed LCG for findRandomPoint, so every run draws the same points.
+static unsigned int randomState = 4321;
+
+static float nextRandomFloat() {
+    randomState = randomState * 1664525u + 1013904223u;
+    return (float) (randomState >> 8) / 16777216.0f;
+}
+
+static double millisSince(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Needs a tiled navmesh, given by RECAST_BENCH_NAVMESH. The bench task points it at the test navmesh.
+int runRandomPointBenchmark() {
+    const char* navMeshPath = getenv("RECAST_BENCH_NAVMESH");
+    if (!navMeshPath) {
+        printf("random: RECAST_BENCH_NAVMESH is not set, skipping\n");
+        return 0;
+    }
+
+    dtNavMesh* navMesh = navmesh_load_tiled_bin(navMeshPath);
+    if (!navMesh) {
+        printf("random: failed to load %s\n", navMeshPath);
+        return 1;
+    }
+    dtNavMeshQuery* navQuery = navmesh_query_create(navMesh);
+    dtQueryFilter filter;
+
+    const int count = 200000;
+    std::vector<dtPolyRef> refs(count);
+    std::vector<float> points((size_t) count * 3);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        navQuery->findRandomPoint(&filter, nextRandomFloat, &refs[i], &points[i * 3]);
+    }
+    const double scanMs = millisSince(start);
+
+    start = std::chrono::steady_clock::now();
+    RandomPointSampler sampler;
+    const bool built = sampler.init(navMesh, &filter);
+    const double buildMs = millisSince(start);
+
+    start = std::chrono::steady_clock::now();
+    const int sampled = built ? sampler.sample(1, 0, count, &refs[0], &points[0]) : 0;
+    const double sampleMs = millisSince(start);
+
+    printf("findRandomPoint: %d points in %.1f ms (%.3f us/point)\n", count, scanMs, scanMs * 1000.0 / count);
+    printf("sampler: %d polys, built in %.2f ms, %d points in %.1f ms (%.3f us/point), %.1fx\n",
+           sampler.getPolyCount(), buildMs, sampled, sampleMs, sampleMs * 1000.0 / count, scanMs / sampleMs);
+
+    int failures = 0;
+    for (int i = 0; i < sampled; ++i) {
+        if (!navMesh->isValidPolyRef(refs[i])) {
+            failures++;
+        }
+    }
+    if (sampled != count || failures > 0) {
+        printf("random: %d of %d sampled points have an invalid poly\n", failures + count - sampled, count);
+    }
+
+    navmesh_query_delete(navQuery);
+    navmesh_delete(navMesh);
+    return sampled == count && failures == 0 ? 0 : 1;
+}
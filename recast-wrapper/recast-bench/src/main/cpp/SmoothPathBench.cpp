@@ -0,0 +1,125 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "NavMeshTesterTool_subset.h"
+#include "wrapper.h"
+
+// Small fixed-seed LCG so every run asks for the same paths.
+static unsigned int randomState = 4321;
+
+static float nextRandomFloat() {
+    randomState = randomState * 1664525u + 1013904223u;
+    return (float) (randomState >> 8) / 16777216.0f;
+}
+
+static double millisSince(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct PathRequest {
+    dtPolyRef startRef;
+    float startPos[3];
+    float endPos[3];
+    std::vector<dtPolyRef> path;
+};
+
+// Follow mode is the baseline the cheaper modes are measured against.
+static const struct {
+    const char* name;
+    SmoothPathMode mode;
+    float sampleSpacing;
+} modes[] = {
+    {"follow", SMOOTH_PATH_FOLLOW, 0.0f},
+    {"sampled 2.0", SMOOTH_PATH_SAMPLED, 2.0f},
+    {"sampled 0.5", SMOOTH_PATH_SAMPLED, 0.5f},
+    {"corners", SMOOTH_PATH_CORNERS, 0.0f},
+};
+
+static const int modeCount = sizeof(modes) / sizeof(modes[0]);
+
+// Needs a tiled navmesh, given by RECAST_BENCH_NAVMESH. The bench task points it at the test navmesh.
+int runSmoothPathBenchmark() {
+    const char* navMeshPath = getenv("RECAST_BENCH_NAVMESH");
+    if (!navMeshPath) {
+        printf("smooth: RECAST_BENCH_NAVMESH is not set, skipping\n");
+        return 0;
+    }
+
+    dtNavMesh* navMesh = navmesh_load_tiled_bin(navMeshPath);
+    if (!navMesh) {
+        printf("smooth: failed to load %s\n", navMeshPath);
+        return 1;
+    }
+    dtNavMeshQuery* navQuery = navmesh_query_create(navMesh);
+    dtQueryFilter filter;
+
+    const int requestCount = 2000;
+    const int maxPath = 1024;
+    const int maxSmoothPath = 4096;
+    std::vector<PathRequest> requests(requestCount);
+    std::vector<dtPolyRef> path(maxPath);
+    long long corridorPolys = 0;
+    for (int i = 0; i < requestCount; ++i) {
+        PathRequest& request = requests[i];
+        dtPolyRef endRef = 0;
+        dtStatus status = 0;
+        navQuery->findRandomPoint(&filter, nextRandomFloat, &request.startRef, request.startPos);
+        navQuery->findRandomPoint(&filter, nextRandomFloat, &endRef, request.endPos);
+        const int pathCount = navmesh_query_find_path_into(navQuery, request.startRef, endRef, request.startPos,
+                                                           request.endPos, &filter, &path[0], maxPath, &status);
+        request.path.assign(path.begin(), path.begin() + pathCount);
+        corridorPolys += pathCount;
+    }
+    printf("%d paths, %.1f polys per corridor\n", requestCount, (double) corridorPolys / requestCount);
+
+    std::vector<float> followStarts((size_t) requestCount * 3);
+    std::vector<float> smoothPath((size_t) maxSmoothPath * 3);
+    double followMs = 0;
+    int failures = 0;
+    for (int m = 0; m < modeCount; ++m) {
+        long long points = 0;
+        int mismatches = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < requestCount; ++i) {
+            const PathRequest& request = requests[i];
+            if (request.path.empty()) {
+                continue;
+            }
+            int count = 0;
+            if (modes[m].mode == SMOOTH_PATH_FOLLOW) {
+                calcSmoothPath(request.startPos, request.startRef, request.endPos, &request.path[0],
+                               (int) request.path.size(), filter, navMesh, *navQuery, &smoothPath[0], count,
+                               maxSmoothPath);
+                dtVcopy(&followStarts[i * 3], &smoothPath[0]);
+            } else {
+                calcStraightSmoothPath(request.startPos, request.startRef, request.endPos, &request.path[0],
+                                       (int) request.path.size(), *navQuery, modes[m].mode,
+                                       modes[m].sampleSpacing, &smoothPath[0], count, maxSmoothPath);
+                // Every mode has to start where follow mode does.
+                if (count == 0 || dtVdist2D(&smoothPath[0], &followStarts[i * 3]) > 0.01f) {
+                    mismatches++;
+                }
+            }
+            points += count;
+        }
+        const double ms = millisSince(start);
+        if (m == 0) {
+            followMs = ms;
+        }
+
+        printf("%s: %.1f ms (%.2f us/path), %.1f points per path, %.2fx\n", modes[m].name, ms,
+               ms * 1000.0 / requestCount, (double) points / requestCount, followMs / ms);
+        if (mismatches > 0) {
+            printf("%s: %d paths do not start at the follow mode start\n", modes[m].name, mismatches);
+            failures++;
+        }
+    }
+
+    navmesh_query_delete(navQuery);
+    navmesh_delete(navMesh);
+    return failures;
+}
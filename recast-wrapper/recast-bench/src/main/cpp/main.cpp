@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "BenchReport.h"
+#include "Benchmarks.h"
+#include "BuildAllocator.h"
+#include "DetourAlloc.h"
+
+struct Benchmark {
+    const char* name;
+    int (*run)();
+};
+
+static const Benchmark benchmarks[] = {
+    {"chunky", runChunkyTriMeshBenchmark},
+    {"obj", runObjLoaderBenchmark},
+    {"smooth", runSmoothPathBenchmark},
+    {"random", runRandomPointBenchmark},
+    {"load", runLoadBenchmark},
+    {"build", runBuildBenchmark},
+    {"query", runQueryBenchmark},
+};
+
+static const int benchmarkCount = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+// Usage: recastbench [--build-allocator | --default-allocator] [--json path] [name...]. Runs every benchmark when
+// no names are given. --build-allocator routes rcAlloc and dtAlloc through the wrapper's build allocator instead
+// of the counters, --default-allocator leaves them on malloc. Either way allocation counts only cover operator new,
+// so the two runs do the same work and are the ones to compare.
+int main(int argc, char** argv) {
+    bool buildAllocator = false;
+    bool defaultAllocator = false;
+    const char* jsonPath = 0;
+    std::vector<const char*> names;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--build-allocator") == 0) {
+            buildAllocator = true;
+        } else if (strcmp(argv[i], "--default-allocator") == 0) {
+            defaultAllocator = true;
+        } else {
+            names.push_back(argv[i]);
+        }
+    }
+
+    // Either allocator has to be in place before anything goes through rcAlloc or dtAlloc. The build allocator
+    // installs exactly once; with the defaults kept, it must refuse as soon as they allocated.
+    if (buildAllocator) {
+        if (!installBuildAllocator() || installBuildAllocator()) {
+            printf("build allocator: installing did not succeed exactly once\n");
+            return 1;
+        }
+    } else if (defaultAllocator) {
+        dtFree(dtAlloc(16, DT_ALLOC_PERM));
+        if (installBuildAllocator()) {
+            printf("build allocator: installed after the default allocator was used\n");
+            return 1;
+        }
+    } else {
+        installAllocationHooks();
+    }
+
+    int failures = 0;
+    for (int i = 0; i < benchmarkCount; ++i) {
+        bool selected = names.empty();
+        for (size_t j = 0; j < names.size(); ++j) {
+            selected = selected || strcmp(names[j], benchmarks[i].name) == 0;
+        }
+        if (!selected) {
+            continue;
+        }
+
+        printf("== %s\n", benchmarks[i].name);
+        if (benchmarks[i].run() != 0) {
+            printf("%s: FAILED\n", benchmarks[i].name);
+            failures++;
+        }
+    }
+
+    printf("peak RSS %.1f MiB (%s allocator)\n", getPeakRssBytes() / (1024.0 * 1024.0),
+           buildAllocator ? "build" : defaultAllocator ? "default" : "counting");
+
+    if (jsonPath && !writeJsonReport(jsonPath)) {
+        printf("failed to write %s\n", jsonPath);
+        failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+//
+//  BenchReport.h
+//
+
+#ifndef BenchReport_h
+#define BenchReport_h
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Allocations made by the benchmark process through operator new, rcAlloc and dtAlloc. The counters
+// are process wide, so they are only meaningful while a single thread is being measured.
+struct AllocationCount {
+    long long count;
+    long long bytes;
+};
+
+AllocationCount getAllocationCount();
+
+// Routes rcAlloc and dtAlloc through the counters. operator new is always counted.
+void installAllocationHooks();
+
+// Peak resident set size of the process in bytes, or 0 where it is not measured.
+long long getPeakRssBytes();
+
+struct BenchResult {
+    std::string group;
+    std::string name;
+    int iterations;
+    double p50Us;
+    double p99Us;
+    double maxUs;
+    double meanUs;
+    double opsPerSecond;
+    double allocationsPerOp;
+    double allocatedBytesPerOp;
+};
+
+// Per-operation timings and allocations of one measured operation. Either bracket each operation with
+// begin() and end(), or add() timings taken elsewhere, such as Recast's build timers.
+class Measurement {
+public:
+    Measurement(const char* group, const char* name);
+
+    void begin();
+    void end();
+    void add(double micros, long long allocations, long long allocatedBytes);
+
+    // Prints the summary and keeps it for writeJsonReport.
+    BenchResult report() const;
+
+private:
+    std::string m_group;
+    std::string m_name;
+    std::vector<double> m_micros;
+    long long m_allocations;
+    long long m_allocatedBytes;
+    std::chrono::steady_clock::time_point m_start;
+    AllocationCount m_startAllocations;
+};
+
+// Writes every reported result and the peak RSS to path as JSON. Returns false if the file could not be written.
+bool writeJsonReport(const char* path);
+
+#endif /* BenchReport_h */
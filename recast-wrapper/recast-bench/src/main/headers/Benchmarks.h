@@ -0,0 +1,17 @@
+//
+//  Benchmarks.h
+//
+
+#ifndef Benchmarks_h
+#define Benchmarks_h
+
+// Each benchmark prints its own results and returns 0, or non-zero if its self checks failed.
+int runChunkyTriMeshBenchmark();
+int runObjLoaderBenchmark();
+int runSmoothPathBenchmark();
+int runRandomPointBenchmark();
+int runLoadBenchmark();
+int runBuildBenchmark();
+int runQueryBenchmark();
+
+#endif /* Benchmarks_h */
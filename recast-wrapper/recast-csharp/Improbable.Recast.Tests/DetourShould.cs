@@ -1,5 +1,9 @@
 ﻿using System;
 using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Text;
+using System.Threading;
 using Improbable.Recast.Types;
 using NUnit.Framework;
 
@@ -17,6 +21,356 @@ namespace Improbable.Recast.Tests
             }
         }
 
+        [Test]
+        public void load_nav_mesh_tiled_bin_file_mapped()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var path = TestUtils.ResolveResource("./Resources/Tile_+007_+006_L21.obj.tiled.bin64");
+                var navMesh = ctx.LoadTiledNavMeshBinFile(path);
+                var mappedNavMesh = ctx.LoadTiledNavMeshBinFileMapped(path);
+                Assert.IsFalse(mappedNavMesh.IsInvalid);
+
+                var point = new[] {-380f, 110f, -240f};
+                var halfExtents = new[] {50.0f, 50.0f, 50.0f};
+                var result = ctx.FindNearestPoly(ctx.CreateNavMeshQuery(navMesh), point, halfExtents);
+                var mappedResult = ctx.FindNearestPoly(ctx.CreateNavMeshQuery(mappedNavMesh), point, halfExtents);
+
+                Assert.IsTrue(Success(mappedResult.status));
+                Assert.AreEqual(result.polyRef, mappedResult.polyRef);
+                Assert.AreEqual(result.point, mappedResult.point);
+            }
+        }
+
+        [Test]
+        public void save_and_load_an_indexed_navmesh()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var path = Path.GetTempFileName();
+                try
+                {
+                    var navMesh = LoadNavMeshBinFile(ctx);
+                    Assert.IsTrue(ctx.SaveNavMesh(navMesh, path));
+                    var loaded = ctx.LoadNavMesh(path);
+                    Assert.IsFalse(loaded.IsInvalid);
+
+                    var point = new[] {-380f, 110f, -240f};
+                    var halfExtents = new[] {50.0f, 50.0f, 50.0f};
+                    var result = ctx.FindNearestPoly(ctx.CreateNavMeshQuery(navMesh), point, halfExtents);
+                    var loadedResult = ctx.FindNearestPoly(ctx.CreateNavMeshQuery(loaded), point, halfExtents);
+                    Assert.IsTrue(Success(loadedResult.status));
+                    Assert.AreEqual(result.polyRef, loadedResult.polyRef);
+
+                    // Single tiles are found by grid location and read without the rest.
+                    int last;
+                    using (var reader = ctx.OpenNavMeshFile(path))
+                    {
+                        Assert.IsFalse(reader.IsInvalid);
+                        last = ctx.GetTileCount(reader) - 1;
+                        Assert.GreaterOrEqual(last, 0);
+                        var location = ctx.GetTileLocation(reader, last);
+                        Assert.AreEqual(last, ctx.FindTile(reader, location[0], location[1], location[2]));
+                        Assert.AreEqual(-1, ctx.FindTile(reader, location[0], location[1], location[2] + 100));
+                        var tile = ctx.ReadTile(reader, last);
+                        // Every tile starts with DT_NAVMESH_MAGIC, 'DNAV' stored little endian.
+                        Assert.AreEqual("VAND", Encoding.ASCII.GetString(tile, 0, 4));
+                    }
+
+                    // Flipping a byte of the last tile fails its checksum.
+                    var bytes = File.ReadAllBytes(path);
+                    bytes[bytes.Length - 1] ^= 0xff;
+                    File.WriteAllBytes(path, bytes);
+                    Assert.IsTrue(ctx.LoadNavMesh(path).IsInvalid);
+                    using (var reader = ctx.OpenNavMeshFile(path))
+                    {
+                        Assert.IsNull(ctx.ReadTile(reader, last));
+                    }
+                }
+                finally
+                {
+                    File.Delete(path);
+                }
+            }
+        }
+
+        [Test]
+        public void refuse_the_build_allocator_once_the_defaults_allocated()
+        {
+            using (var ctx = new RecastContext())
+            {
+                // Whichever tests ran before, this navmesh went through the default allocators.
+                var navMesh = LoadNavMeshBinFile(ctx);
+                Assert.IsFalse(RecastContext.InstallBuildAllocator());
+                navMesh.Dispose();
+            }
+        }
+
+        [Test]
+        public void stream_compressed_tiles()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var path = TestUtils.ResolveResource("./Resources/Tile_+007_+006_L21.obj.tiled.bin64");
+                var compressedPath = Path.GetTempFileName();
+                try
+                {
+                    var navMesh = ctx.LoadTiledNavMeshBinFile(path);
+                    Assert.IsTrue(ctx.SaveCompressedNavMesh(navMesh, compressedPath));
+                    Assert.Less(new FileInfo(compressedPath).Length, new FileInfo(path).Length);
+
+                    var stream = ctx.OpenStreamingNavMesh(compressedPath, 0);
+                    Assert.IsFalse(stream.IsInvalid);
+                    Assert.AreEqual(0, ctx.GetStats(stream).residentTiles);
+                    Assert.Greater(ctx.GetStats(stream).compressedBytes, 0);
+
+                    // Only the tiles a query reaches into have to be decompressed.
+                    var point = new[] {-380f, 110f, -240f};
+                    var halfExtents = new[] {50.0f, 50.0f, 50.0f};
+                    Assert.GreaterOrEqual(ctx.TouchRegion(stream, new[] {-430f, 60f, -290f},
+                                                          new[] {-330f, 160f, -190f}), 1);
+                    var result = ctx.FindNearestPoly(ctx.CreateNavMeshQuery(navMesh), point, halfExtents);
+                    var streamResult = ctx.FindNearestPoly(ctx.CreateNavMeshQuery(ctx.GetNavMesh(stream)), point,
+                                                           halfExtents);
+                    Assert.IsTrue(Success(streamResult.status));
+                    Assert.AreEqual(result.polyRef, streamResult.polyRef);
+                    Assert.AreEqual(result.point, streamResult.point);
+                }
+                finally
+                {
+                    File.Delete(compressedPath);
+                }
+            }
+        }
+
+        [Test]
+        public void stream_tiles_under_a_budget()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var stream = ctx.OpenStreamingNavMesh(
+                    TestUtils.ResolveResource("./Resources/Tile_+007_+006_L21.obj.tiled.bin64"), 0);
+                Assert.IsFalse(stream.IsInvalid);
+                Assert.AreEqual(0, ctx.GetStats(stream).residentTiles);
+
+                var totalTiles = ctx.GetStats(stream).totalTiles;
+                Assert.AreEqual(totalTiles, ctx.TouchRegion(stream, new[] {-1.0e6f, -1.0e6f, -1.0e6f},
+                                                            new[] {1.0e6f, 1.0e6f, 1.0e6f}));
+                var allBytes = ctx.GetStats(stream).residentBytes;
+
+                ctx.SetBudget(stream, allBytes / 4);
+                var stats = ctx.GetStats(stream);
+                Assert.LessOrEqual(stats.residentBytes, allBytes / 4);
+                Assert.GreaterOrEqual(stats.evictions, 1);
+
+                var navMeshQuery = ctx.CreateNavMeshQuery(ctx.GetNavMesh(stream));
+                var path = new ulong[Constants.MaxPathLength];
+                uint status;
+                var pathCount = ctx.FindPath(stream, navMeshQuery, new[] {-373.413f, 107.4798f, -271.1656f},
+                                             new[] {-370.4435f, 100.7469f, -221.2217f}, new[] {2.0f, 4.0f, 2.0f},
+                                             path, out status);
+                Assert.IsTrue(Success(status));
+                Assert.GreaterOrEqual(pathCount, 1);
+            }
+        }
+
+        [Test]
+        public void find_paths_a_slice_at_a_time()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var navMesh = LoadNavMeshBinFile(ctx);
+                var navMeshQuery = ctx.CreateNavMeshQuery(navMesh);
+
+                var start = new float[3];
+                var end = new float[3];
+                var path = new ulong[Constants.MaxPathLength];
+                ulong startRef = 0, endRef = 0;
+                uint status = 0;
+                var pathCount = 0;
+                for (var i = 0; i < 20; i++)
+                {
+                    ctx.FindRandomPoint(navMeshQuery, out startRef, start);
+                    ctx.FindRandomPoint(navMeshQuery, out endRef, end);
+                    pathCount = ctx.FindPath(navMeshQuery, startRef, endRef, start, end, path, out status);
+                    if (Success(status) && !PartialResult(status) && pathCount > 1)
+                    {
+                        break;
+                    }
+                }
+                Assert.IsFalse(PartialResult(status));
+
+                const int maxIter = 4;
+                var sliceStatus = ctx.InitSlicedFindPath(navMeshQuery, startRef, endRef, start, end);
+                while (InProgress(sliceStatus))
+                {
+                    int doneIters;
+                    sliceStatus = ctx.UpdateSlicedFindPath(navMeshQuery, maxIter, out doneIters);
+                    Assert.LessOrEqual(doneIters, maxIter);
+                }
+                Assert.IsTrue(Success(sliceStatus));
+
+                var slicedPath = new ulong[Constants.MaxPathLength];
+                Assert.AreEqual(pathCount, ctx.FinalizeSlicedFindPath(navMeshQuery, slicedPath, out status));
+                Assert.AreEqual(endRef, slicedPath[pathCount - 1]);
+
+                // A search cut short after one slice still yields the best corridor found so far.
+                ctx.InitSlicedFindPath(navMeshQuery, startRef, endRef, start, end);
+                int iters;
+                ctx.UpdateSlicedFindPath(navMeshQuery, 1, out iters);
+                var partialCount = ctx.FinalizeSlicedFindPathPartial(navMeshQuery, new[] {startRef}, 1, slicedPath,
+                                                                     out status);
+                Assert.IsTrue(Success(status));
+                Assert.GreaterOrEqual(partialCount, 1);
+                Assert.AreEqual(startRef, slicedPath[0]);
+            }
+        }
+
+        [Test]
+        public void answer_repeated_paths_from_the_cache()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var navMesh = CreateNavMesh(ctx);
+                var navMeshQuery = ctx.CreateNavMeshQuery(navMesh);
+                var cache = ctx.CreatePathCache(navMesh, 64);
+                Assert.IsFalse(cache.IsInvalid);
+
+                // Only complete corridors are cached, so look for a pair of points that are connected.
+                var start = new float[3];
+                var end = new float[3];
+                var path = new ulong[Constants.MaxPathLength];
+                ulong startRef = 0, endRef = 0;
+                uint status = 0;
+                var pathCount = 0;
+                for (var i = 0; i < 20; i++)
+                {
+                    ctx.FindRandomPoint(navMeshQuery, out startRef, start);
+                    ctx.FindRandomPoint(navMeshQuery, out endRef, end);
+                    pathCount = ctx.FindPath(navMeshQuery, startRef, endRef, start, end, path, out status);
+                    if (Success(status) && !PartialResult(status))
+                    {
+                        break;
+                    }
+                }
+                Assert.IsFalse(PartialResult(status));
+
+                var cachedPath = new ulong[Constants.MaxPathLength];
+                for (var i = 0; i < 10; i++)
+                {
+                    Assert.AreEqual(pathCount, ctx.FindPath(cache, navMeshQuery, startRef, endRef, start, end,
+                                                            cachedPath, out status));
+                    Assert.IsTrue(Success(status));
+                    Assert.AreEqual(path[pathCount - 1], cachedPath[pathCount - 1]);
+                }
+
+                var stats = ctx.GetStats(cache);
+                Assert.AreEqual(1, stats.misses);
+                Assert.AreEqual(9, stats.hits);
+                Assert.AreEqual(1, stats.entries);
+
+                ctx.ClearPathCache(cache);
+                Assert.AreEqual(0, ctx.GetStats(cache).entries);
+            }
+        }
+
+        [Test]
+        public void find_long_paths_through_the_hierarchy()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var navMesh = LoadNavMeshBinFile(ctx);
+                var navMeshQuery = ctx.CreateNavMeshQuery(navMesh);
+                var hierarchy = ctx.CreateHierarchicalPathfinder(navMesh);
+                Assert.IsFalse(hierarchy.IsInvalid);
+                Assert.GreaterOrEqual(ctx.GetStats(hierarchy).portals, ctx.GetStats(hierarchy).clusters);
+
+                // Look for a pair of points that a plain search connects, so the hierarchy has to as well.
+                var start = new float[3];
+                var end = new float[3];
+                var path = new ulong[Constants.MaxPathLength];
+                ulong startRef = 0, endRef = 0;
+                uint status = 0;
+                for (var i = 0; i < 20; i++)
+                {
+                    ctx.FindRandomPoint(navMeshQuery, out startRef, start);
+                    ctx.FindRandomPoint(navMeshQuery, out endRef, end);
+                    ctx.FindPath(navMeshQuery, startRef, endRef, start, end, path, out status);
+                    if (Success(status) && !PartialResult(status))
+                    {
+                        break;
+                    }
+                }
+                Assert.IsFalse(PartialResult(status));
+
+                var pathCount = ctx.FindPath(hierarchy, navMeshQuery, startRef, endRef, start, end, path, out status);
+                Assert.IsTrue(Success(status));
+                Assert.IsFalse(PartialResult(status));
+                Assert.AreEqual(startRef, path[0]);
+                Assert.AreEqual(endRef, path[pathCount - 1]);
+
+                var waypoints = new ulong[256];
+                var waypointPositions = new float[256 * 3];
+                var waypointCount = ctx.FindWaypoints(hierarchy, startRef, endRef, start, end, waypoints,
+                                                      waypointPositions, out status);
+                Assert.GreaterOrEqual(waypointCount, 1);
+                Assert.AreEqual(endRef, waypoints[waypointCount - 1]);
+            }
+        }
+
+        [Test]
+        public void step_a_crowd_in_one_call()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var navMesh = LoadNavMeshBinFile(ctx);
+                var navMeshQuery = ctx.CreateNavMeshQuery(navMesh);
+                const int maxAgents = 16;
+                var crowd = ctx.CreateCrowd(navMesh, maxAgents, 0.6f);
+                Assert.IsFalse(crowd.IsInvalid);
+
+                // Send an agent between two connected points a few polygons apart.
+                var start = new float[3];
+                var end = new float[3];
+                var path = new ulong[Constants.MaxPathLength];
+                for (var i = 0; i < 20; i++)
+                {
+                    ulong startRef, endRef;
+                    uint status;
+                    ctx.FindRandomPoint(navMeshQuery, out startRef, start);
+                    ctx.FindRandomPoint(navMeshQuery, out endRef, end);
+                    var pathCount = ctx.FindPath(navMeshQuery, startRef, endRef, start, end, path, out status);
+                    if (Success(status) && !PartialResult(status) && pathCount > 2)
+                    {
+                        break;
+                    }
+                }
+
+                var config = ctx.DefaultCrowdAgentConfig();
+                var walker = ctx.AddAgent(crowd, start, config);
+                var idler = ctx.AddAgent(crowd, end, config);
+                Assert.GreaterOrEqual(walker, 0);
+                Assert.GreaterOrEqual(idler, 0);
+                Assert.AreEqual(2, ctx.GetActiveAgentCount(crowd));
+                Assert.IsTrue(ctx.SetTarget(crowd, walker, end));
+
+                var states = new float[maxAgents * 6];
+                ctx.UpdateCrowd(crowd, 0.0f, states);
+                var startX = states[walker * 6];
+                var startZ = states[walker * 6 + 2];
+                for (var i = 0; i < 20; i++)
+                {
+                    Assert.AreEqual(maxAgents, ctx.UpdateCrowd(crowd, 0.1f, states));
+                }
+                var dx = states[walker * 6] - startX;
+                var dz = states[walker * 6 + 2] - startZ;
+                Assert.GreaterOrEqual(dx * dx + dz * dz, 0.01f);
+
+                ctx.RemoveAgent(crowd, idler);
+                Assert.AreEqual(1, ctx.GetActiveAgentCount(crowd));
+            }
+        }
+
         [Test]
         public void find_random_point()
         {
@@ -103,6 +457,254 @@ namespace Improbable.Recast.Tests
             }
         }
 
+        [Test]
+        public void find_smooth_path_into_caller_owned_buffers()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var navMesh = CreateNavMesh(ctx);
+                var navMeshQuery = ctx.CreateNavMeshQuery(navMesh);
+
+                var start = new float[3];
+                var end = new float[3];
+                var path = new ulong[Constants.MaxPathLength];
+                var smoothPath = new float[3 * Constants.MaxSmoothPathLength];
+
+                for (var i = 0; i < 10; i++)
+                {
+                    ulong startRef, endRef;
+                    Assert.IsTrue(Success(ctx.FindRandomPoint(navMeshQuery, out startRef, start)));
+                    Assert.IsTrue(Success(ctx.FindRandomPoint(navMeshQuery, out endRef, end)));
+
+                    uint status;
+                    var pathCount = ctx.FindPath(navMeshQuery, startRef, endRef, start, end, path, out status);
+                    Assert.IsTrue(Success(status));
+                    Assert.GreaterOrEqual(pathCount, 1);
+                    Assert.AreEqual(startRef, path[0]);
+
+                    var smoothPathCount = ctx.FindSmoothPath(navMeshQuery, navMesh, start, startRef, end, path,
+                                                             pathCount, smoothPath);
+                    Assert.GreaterOrEqual(smoothPathCount, 1);
+                    Assert.AreEqual(start[0], smoothPath[0], 0.00001);
+                    Assert.AreEqual(start[1], smoothPath[1], 0.00001);
+                    Assert.AreEqual(start[2], smoothPath[2], 0.00001);
+                }
+
+                ulong polyRef;
+                var nearest = new float[3];
+                var nearestStatus = ctx.FindNearestPoly(navMeshQuery, new[] {-575f, -69.1874f, 54f},
+                                                        new[] {10.0f, 10.0f, 10.0f}, out polyRef, nearest);
+                Assert.IsTrue(Success(nearestStatus));
+                Assert.AreEqual(281474976711211L, polyRef);
+            }
+        }
+
+        [Test]
+        public void find_cheaper_smooth_paths_along_the_straight_path()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var navMesh = CreateNavMesh(ctx);
+                var navMeshQuery = ctx.CreateNavMeshQuery(navMesh);
+
+                var start = new float[3];
+                var end = new float[3];
+                var path = new ulong[Constants.MaxPathLength];
+                var followPath = new float[3 * Constants.MaxSmoothPathLength];
+                var sampledPath = new float[3 * Constants.MaxSmoothPathLength];
+                var cornersPath = new float[3 * Constants.MaxSmoothPathLength];
+
+                for (var i = 0; i < 10; i++)
+                {
+                    ulong startRef, endRef;
+                    Assert.IsTrue(Success(ctx.FindRandomPoint(navMeshQuery, out startRef, start)));
+                    Assert.IsTrue(Success(ctx.FindRandomPoint(navMeshQuery, out endRef, end)));
+
+                    uint status;
+                    var pathCount = ctx.FindPath(navMeshQuery, startRef, endRef, start, end, path, out status);
+                    Assert.IsTrue(Success(status));
+
+                    var followCount = ctx.FindSmoothPath(navMeshQuery, navMesh, start, startRef, end, path,
+                                                         pathCount, SmoothPathMode.Follow, 0.0f, followPath);
+                    var sampledCount = ctx.FindSmoothPath(navMeshQuery, navMesh, start, startRef, end, path,
+                                                          pathCount, SmoothPathMode.Sampled, 2.0f, sampledPath);
+                    var cornersCount = ctx.FindSmoothPath(navMeshQuery, navMesh, start, startRef, end, path,
+                                                          pathCount, SmoothPathMode.Corners, 0.0f, cornersPath);
+                    Assert.GreaterOrEqual(cornersCount, 1);
+                    Assert.GreaterOrEqual(sampledCount, cornersCount);
+                    Assert.GreaterOrEqual(followCount, cornersCount);
+
+                    // All modes start at the same point on the mesh.
+                    Assert.AreEqual(followPath[0], sampledPath[0], 0.01);
+                    Assert.AreEqual(followPath[2], cornersPath[2], 0.01);
+                }
+            }
+        }
+
+        [Test]
+        public void query_from_many_threads_with_a_query_pool()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var navMesh = CreateNavMesh(ctx);
+                var pool = ctx.CreateNavMeshQueryPool(navMesh, 42);
+                Assert.IsFalse(pool.IsInvalid);
+
+                const int threadCount = 4;
+                const int pointsPerThread = 50;
+                var points = new float[threadCount][];
+                var failures = new int[threadCount];
+                var threads = new Thread[threadCount];
+                for (var t = 0; t < threadCount; t++)
+                {
+                    var thread = t;
+                    threads[t] = new Thread(() =>
+                    {
+                        ctx.SeedThread(pool, (uint) thread);
+                        points[thread] = new float[3 * pointsPerThread];
+                        var start = new float[3];
+                        var path = new ulong[Constants.MaxPathLength];
+                        ulong startRef, endRef;
+                        ctx.FindRandomPoint(pool, out startRef, start);
+                        for (var i = 0; i < pointsPerThread; i++)
+                        {
+                            var end = new float[3];
+                            if (!Success(ctx.FindRandomPoint(pool, out endRef, end)))
+                            {
+                                failures[thread]++;
+                            }
+                            Array.Copy(end, 0, points[thread], 3 * i, 3);
+
+                            uint status;
+                            ctx.FindPath(pool, startRef, endRef, start, end, path, out status);
+                            if (!Success(status))
+                            {
+                                failures[thread]++;
+                            }
+                        }
+                    });
+                    threads[t].Start();
+                }
+                foreach (var thread in threads)
+                {
+                    thread.Join();
+                }
+
+                Assert.GreaterOrEqual(ctx.GetThreadCount(pool), threadCount);
+                for (var t = 0; t < threadCount; t++)
+                {
+                    Assert.AreEqual(0, failures[t]);
+                }
+
+                // The same seed draws the same points on any thread.
+                for (var t = 0; t < threadCount; t++)
+                {
+                    ctx.SeedThread(pool, (uint) t);
+                    var point = new float[3];
+                    ulong polyRef;
+                    ctx.FindRandomPoint(pool, out polyRef, point);
+                    for (var i = 0; i < pointsPerThread; i++)
+                    {
+                        ctx.FindRandomPoint(pool, out polyRef, point);
+                        Assert.AreEqual(points[t][3 * i], point[0]);
+                        Assert.AreEqual(points[t][3 * i + 2], point[2]);
+                    }
+                }
+            }
+        }
+
+        [Test]
+        public void sample_random_points_from_a_prebuilt_table()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var navMesh = CreateNavMesh(ctx);
+                var sampler = ctx.CreateRandomPointSampler(navMesh);
+                Assert.IsFalse(sampler.IsInvalid);
+                Assert.Greater(ctx.GetPolyCount(sampler), 0);
+                Assert.Greater(ctx.GetTotalArea(sampler), 0.0f);
+
+                const int count = 1000;
+                var refs = new ulong[count];
+                var points = new float[3 * count];
+                Assert.AreEqual(count, ctx.SampleRandomPoints(sampler, 7, 0, refs, points));
+                foreach (var polyRef in refs)
+                {
+                    Assert.AreNotEqual(0UL, polyRef);
+                }
+
+                // Points depend only on the seed and their counter, so a batch can be drawn in parts.
+                var partRefs = new ulong[100];
+                var partPoints = new float[3 * 100];
+                ctx.SampleRandomPoints(sampler, 7, 500, partRefs, partPoints);
+                for (var i = 0; i < 100; i++)
+                {
+                    Assert.AreEqual(refs[500 + i], partRefs[i]);
+                    Assert.AreEqual(points[3 * (500 + i) + 1], partPoints[3 * i + 1]);
+                }
+
+                Assert.IsFalse(ctx.Refresh(sampler));
+            }
+        }
+
+        [Test]
+        public void export_build_and_query_metrics()
+        {
+            RecastContext.ResetMetrics();
+            using (var ctx = new RecastContext())
+            {
+                var navMesh = CreateNavMesh(ctx);
+                var navMeshQuery = ctx.CreateNavMeshQuery(navMesh);
+                var pointA = FindRandomPointSafer(ctx, navMeshQuery);
+                var pointB = FindRandomPointSafer(ctx, navMeshQuery);
+                Assert.IsTrue(Success(FindPathSafer(pointA, pointB, ctx, navMeshQuery).status));
+
+                var metrics = RecastContext.GetMetrics();
+                foreach (var stage in new[] {"rasterize", "compact", "erode", "distance_field", "regions", "contours",
+                                             "polymesh", "detail", "detour_data"})
+                {
+                    Assert.GreaterOrEqual(MetricValue(metrics, "recast_build_stage_duration_seconds_count{stage=\"" + stage + "\"}"), 1);
+                }
+                Assert.GreaterOrEqual(MetricValue(metrics, "recast_query_duration_seconds_count{query=\"find_path\"}"), 1);
+                Assert.GreaterOrEqual(MetricValue(metrics, "recast_query_nodes_expanded_total{query=\"find_path\"}"), 1);
+                Assert.Greater(MetricValue(metrics, "recast_navmesh_tile_bytes"), 0);
+            }
+        }
+
+        [Test]
+        public void find_smooth_paths_in_a_batch()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var navMesh = CreateNavMesh(ctx);
+                var navMeshQuery = ctx.CreateNavMeshQuery(navMesh);
+                var batch = ctx.CreateNavMeshQueryBatch(navMesh);
+
+                const int count = 64;
+                const int maxSmoothPathLength = 256;
+                var startPositions = new float[3 * count];
+                var endPositions = new float[3 * count];
+                for (var i = 0; i < count; i++)
+                {
+                    Array.Copy(FindRandomPointSafer(ctx, navMeshQuery).point, 0, startPositions, 3 * i, 3);
+                    Array.Copy(FindRandomPointSafer(ctx, navMeshQuery).point, 0, endPositions, 3 * i, 3);
+                }
+
+                var results = new BatchPathResult[count];
+                var smoothPaths = new float[3 * maxSmoothPathLength * count];
+                var found = ctx.FindSmoothPaths(batch, startPositions, endPositions, new[] {1.0f, 1.0f, 1.0f},
+                                                results, smoothPaths, maxSmoothPathLength);
+
+                Assert.AreEqual(count, found);
+                for (var i = 0; i < count; i++)
+                {
+                    Assert.IsTrue(Success(results[i].status));
+                    Assert.GreaterOrEqual(results[i].smoothPathCount, 1);
+                    Assert.AreEqual(startPositions[3 * i], smoothPaths[3 * maxSmoothPathLength * i], 0.00001);
+                }
+            }
+        }
+
         [Test]
         public void be_fast_from_obj()
         {
@@ -155,6 +757,19 @@ namespace Improbable.Recast.Tests
             }
         }
 
+        private static double MetricValue(string metrics, string series)
+        {
+            foreach (var line in metrics.Split('\n'))
+            {
+                if (line.StartsWith(series + " "))
+                {
+                    return double.Parse(line.Substring(series.Length + 1), CultureInfo.InvariantCulture);
+                }
+            }
+            Assert.Fail("No series " + series);
+            return 0;
+        }
+
         private float be_fast_work(RecastContext ctx, NavMesh navMesh)
         {
             var navMeshQuery = ctx.CreateNavMeshQuery(navMesh);
@@ -212,6 +827,11 @@ namespace Improbable.Recast.Tests
             return (status & (1u << 6)) != 0;
         }
 
+        private bool InProgress(uint status)
+        {
+            return (status & (1u << 29)) != 0;
+        }
+
         private FindPathResult FindPathSafer(PolyPointResult pointA, PolyPointResult pointB,
                                              RecastContext ctx, NavMeshQuery navMeshQuery,
                                              Stopwatch stopwatch = null)
@@ -1,3 +1,6 @@
+using System;
+using System.IO;
+using System.Linq;
 using Improbable.Recast.Types;
 using NUnit.Framework;
 
@@ -111,6 +114,169 @@ namespace Improbable.Recast.Tests
             }
         }
 
+        [Test]
+        public void create_tiled_navmesh()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var mesh = GetInputGeom(ctx);
+                var config = _config;
+                config.tileSize = (int) BuildSettings.tileSize;
+                config.borderSize = (int) BuildSettings.walkableRadius + 3;
+
+                var navMesh = ctx.CreateTiledNavMesh(config, mesh, BuildSettings.agentHeight,
+                                                     BuildSettings.agentRadius, BuildSettings.agentMaxClimb);
+                Assert.IsFalse(navMesh.IsInvalid);
+
+                var navMeshQuery = ctx.CreateNavMeshQuery(navMesh);
+                var point = ctx.FindRandomPoint(navMeshQuery);
+                Assert.IsTrue((point.status & (1u << 30)) != 0);
+            }
+        }
+
+        [Test]
+        public void rebuild_the_tiles_under_a_convex_volume()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var mesh = GetInputGeom(ctx);
+                var config = _config;
+                config.tileSize = (int) BuildSettings.tileSize;
+                config.borderSize = (int) BuildSettings.walkableRadius + 3;
+
+                var navMesh = ctx.CreateTiledNavMesh(config, mesh, BuildSettings.agentHeight,
+                                                     BuildSettings.agentRadius, BuildSettings.agentMaxClimb);
+                var navMeshQuery = ctx.CreateNavMeshQuery(navMesh);
+                var point = new float[3];
+                ulong polyRef;
+                ctx.FindRandomPoint(navMeshQuery, out polyRef, point);
+
+                using (var rebuilder = ctx.CreateNavMeshRebuilder(navMesh, config, mesh, BuildSettings.agentHeight,
+                                                                  BuildSettings.agentRadius, BuildSettings.agentMaxClimb))
+                {
+                    // A volume with the null area cuts a hole into the navmesh.
+                    float x = point[0], y = point[1], z = point[2];
+                    var volume = new[] {x - 2, y, z - 2, x + 2, y, z - 2, x + 2, y, z + 2, x - 2, y, z + 2};
+                    Assert.Greater(ctx.AddConvexVolume(rebuilder, volume, y - 5, y + 5, 0), 0);
+                    ctx.WaitForRebuilds(rebuilder);
+
+                    var bmin = new float[3];
+                    var bmax = new float[3];
+                    var applied = ctx.ApplyRebuiltTiles(rebuilder, bmin, bmax);
+                    Assert.Greater(applied, 0);
+                    Assert.LessOrEqual(bmin[0], x - 2);
+                    Assert.GreaterOrEqual(bmax[2], z + 2);
+
+                    ctx.FindNearestPoly(navMeshQuery, point, new[] {0.5f, 2.0f, 0.5f}, out polyRef, new float[3]);
+                    Assert.AreEqual(0ul, polyRef);
+                    Assert.AreEqual(applied, ctx.GetStats(rebuilder).applied);
+                }
+            }
+        }
+
+        [Test]
+        public void carve_and_remove_a_temporary_obstacle()
+        {
+            using (var ctx = new RecastContext())
+            {
+                var mesh = GetInputGeom(ctx);
+                var config = _config;
+                config.tileSize = (int) BuildSettings.tileSize;
+                config.borderSize = (int) BuildSettings.walkableRadius + 3;
+
+                using (var cache = ctx.CreateNavMeshTileCache(config, mesh, BuildSettings.agentHeight,
+                                                              BuildSettings.agentRadius, BuildSettings.agentMaxClimb, 64))
+                {
+                    var navMeshQuery = ctx.CreateNavMeshQuery(ctx.GetNavMesh(cache));
+                    var point = new float[3];
+                    ulong polyRef;
+                    ctx.FindRandomPoint(navMeshQuery, out polyRef, point);
+                    var halfExtents = new[] {0.1f, 2.0f, 0.1f};
+
+                    var obstacle = ctx.AddCylinderObstacle(cache, point, 2.0f, 4.0f);
+                    Assert.AreNotEqual(0u, obstacle);
+                    while (!ctx.Update(cache, 1000))
+                    {
+                    }
+                    ctx.FindNearestPoly(navMeshQuery, point, halfExtents, out polyRef, new float[3]);
+                    Assert.AreEqual(0ul, polyRef);
+
+                    var stats = ctx.GetStats(cache);
+                    Assert.AreEqual(1, stats.obstacles);
+                    Assert.Less(stats.compressedBytes, stats.rawBytes);
+
+                    Assert.IsTrue(ctx.RemoveObstacle(cache, obstacle));
+                    while (!ctx.Update(cache, 1000))
+                    {
+                    }
+                    ctx.FindNearestPoly(navMeshQuery, point, halfExtents, out polyRef, new float[3]);
+                    Assert.AreNotEqual(0ul, polyRef);
+                }
+            }
+        }
+
+        [Test]
+        public void reload_geometry_from_its_cache()
+        {
+            var cachePath = TestUtils.ResolveResource("./Resources/Tile_+007_+006_L21.obj") + ".geomcache";
+            File.Delete(cachePath);
+
+            using (var ctx = new RecastContext())
+            {
+                GetInputGeom(ctx).Dispose();
+                Assert.IsTrue(File.Exists(cachePath));
+
+                var mesh = GetInputGeom(ctx);
+                var chf = ctx.CreateCompactHeightfield(_config, mesh);
+                var polyMesh = ctx.CreatePolyMesh(_config, chf);
+                var polyMeshDetail = ctx.CreatePolyMeshDetail(_config, polyMesh, chf);
+                var navMeshData = ctx.CreateNavMeshData(_config, polyMeshDetail, polyMesh, mesh, 0, 0,
+                                                        BuildSettings.agentHeight, BuildSettings.agentRadius, BuildSettings.agentMaxClimb);
+                Assert.AreEqual(114764, navMeshData.size);
+            }
+        }
+
+        [Test]
+        public void rewrite_the_geometry_cache_of_a_changed_obj()
+        {
+            var dir = Path.Combine(Path.GetTempPath(), Path.GetRandomFileName());
+            Directory.CreateDirectory(dir);
+            try
+            {
+                var objPath = Path.Combine(dir, "terrain.obj");
+                var cachePath = objPath + ".geomcache";
+                File.Copy(TestUtils.ResolveResource("./Resources/Tile_+007_+006_L21.obj"), objPath);
+
+                using (var ctx = new RecastContext())
+                {
+                    ctx.LoadInputGeom(objPath, true).Dispose();
+                    var staleCache = File.ReadAllBytes(cachePath);
+
+                    // A copy of the first vertex changes the content but neither the bounds nor the navmesh.
+                    File.AppendAllText(objPath, File.ReadLines(objPath).First(line => line.StartsWith("v ")) + "\r\n");
+                    using (var mesh = ctx.LoadInputGeom(objPath, true))
+                    {
+                        var rewritten = File.ReadAllBytes(cachePath);
+                        Assert.IsFalse(rewritten.SequenceEqual(staleCache));
+                        // The header records the size of the OBJ it was written from.
+                        Assert.AreEqual(new FileInfo(objPath).Length, BitConverter.ToInt64(rewritten, 16));
+
+                        ctx.CalcGridSize(ref _config, mesh);
+                        var chf = ctx.CreateCompactHeightfield(_config, mesh);
+                        var polyMesh = ctx.CreatePolyMesh(_config, chf);
+                        var polyMeshDetail = ctx.CreatePolyMeshDetail(_config, polyMesh, chf);
+                        var navMeshData = ctx.CreateNavMeshData(_config, polyMeshDetail, polyMesh, mesh, 0, 0,
+                                                                BuildSettings.agentHeight, BuildSettings.agentRadius, BuildSettings.agentMaxClimb);
+                        Assert.AreEqual(114764, navMeshData.size);
+                    }
+                }
+            }
+            finally
+            {
+                Directory.Delete(dir, true);
+            }
+        }
+
         [Test]
         public void disposes_work()
         {
@@ -1,6 +1,7 @@
-using System;
+﻿using System;
 using System.IO;
 using System.Runtime.InteropServices;
+using System.Text;
 using Improbable.Recast.Types;
 
 namespace Improbable.Recast
@@ -65,6 +66,23 @@ namespace Improbable.Recast
             return new NavMesh(RecastLibrary.navmesh_create(_context.DangerousGetHandle(), ref navMeshDataResult));
         }
 
+        /// <summary>
+        /// Builds a multi-tile navmesh covering the whole of geom, splitting it by config.tileSize and
+        /// building the tiles in parallel. A thread count of 0 uses every core.
+        /// </summary>
+        public NavMesh CreateTiledNavMesh(RcConfig config, InputGeom geom, float agentHeight, float agentRadius,
+            float agentMaxClimb, int threads = 0)
+        {
+            return new NavMesh(RecastLibrary.navmesh_create_tiled(
+                _context.DangerousGetHandle(),
+                ref config,
+                geom.DangerousGetHandle(),
+                agentHeight,
+                agentRadius,
+                agentMaxClimb,
+                threads));
+        }
+
         public NavMesh LoadTiledNavMeshBinFile(string path)
         {
             if (!File.Exists(path))
@@ -75,6 +93,107 @@ namespace Improbable.Recast
             return new NavMesh(RecastLibrary.navmesh_load_tiled_bin(path.ToCharArray()));
         }
 
+        /// <summary>
+        /// Loads the same file as LoadTiledNavMeshBinFile by memory mapping it instead of reading it, so
+        /// processes on one host loading the same file share its pages. The file must not be modified while
+        /// the navmesh is alive.
+        /// </summary>
+        public NavMesh LoadTiledNavMeshBinFileMapped(string path)
+        {
+            if (!File.Exists(path))
+            {
+                throw new FileNotFoundException("File not found.", path);
+            }
+
+            return new NavMesh(RecastLibrary.navmesh_load_tiled_bin_mapped(path));
+        }
+
+        /// <summary>
+        /// Writes the navmesh to path with every tile compressed on its own. LoadTiledNavMeshBinFile and
+        /// OpenStreamingNavMesh read the result; a stream keeps the tiles compressed in memory until touched.
+        /// </summary>
+        public bool SaveCompressedNavMesh(NavMesh navMesh, string path)
+        {
+            return RecastLibrary.navmesh_save_compressed(navMesh.DangerousGetHandle(), path);
+        }
+
+        /// <summary>
+        /// Writes the navmesh to path in the indexed version 2 format, with a checksum per tile.
+        /// </summary>
+        public bool SaveNavMesh(NavMesh navMesh, string path)
+        {
+            return RecastLibrary.navmesh_save(navMesh.DangerousGetHandle(), path);
+        }
+
+        /// <summary>
+        /// Loads a file written by SaveNavMesh, verifying its tiles on the given number of threads. A thread
+        /// count of 0 uses every core. The handle is invalid if any tile is damaged.
+        /// </summary>
+        public NavMesh LoadNavMesh(string path, int threads = 0)
+        {
+            if (!File.Exists(path))
+            {
+                throw new FileNotFoundException("File not found.", path);
+            }
+
+            return new NavMesh(RecastLibrary.navmesh_load(path, threads));
+        }
+
+        /// <summary>
+        /// Opens a file written by SaveNavMesh to read single tiles without loading the rest. Only the tile
+        /// table is read up front; each tile's checksum is verified when it is read.
+        /// </summary>
+        public NavMeshFileReader OpenNavMeshFile(string path)
+        {
+            if (!File.Exists(path))
+            {
+                throw new FileNotFoundException("File not found.", path);
+            }
+
+            return new NavMeshFileReader(RecastLibrary.navmesh_file_open(path));
+        }
+
+        public int GetTileCount(NavMeshFileReader reader)
+        {
+            return RecastLibrary.navmesh_file_get_tile_count(reader.DangerousGetHandle());
+        }
+
+        /// <summary>
+        /// Returns the tile's grid x, y and layer, or null if index is out of range.
+        /// </summary>
+        public int[] GetTileLocation(NavMeshFileReader reader, int index)
+        {
+            var location = new int[3];
+            return RecastLibrary.navmesh_file_get_tile_location(reader.DangerousGetHandle(), index, location)
+                ? location
+                : null;
+        }
+
+        /// <summary>
+        /// Returns the table index of the tile at the grid location, or -1 if the file has none there.
+        /// </summary>
+        public int FindTile(NavMeshFileReader reader, int x, int y, int layer)
+        {
+            return RecastLibrary.navmesh_file_find_tile(reader.DangerousGetHandle(), x, y, layer);
+        }
+
+        /// <summary>
+        /// Returns the tile's navmesh data, or null if index is out of range or the tile fails its checksum.
+        /// </summary>
+        public byte[] ReadTile(NavMeshFileReader reader, int index)
+        {
+            var size = RecastLibrary.navmesh_file_read_tile(reader.DangerousGetHandle(), index, null, 0);
+            if (size < 0)
+            {
+                return null;
+            }
+
+            var data = new byte[size];
+            return RecastLibrary.navmesh_file_read_tile(reader.DangerousGetHandle(), index, data, size) == size
+                ? data
+                : null;
+        }
+
         public NavMeshQuery CreateNavMeshQuery(NavMesh navMesh)
         {
             var handle = RecastLibrary.navmesh_query_create(navMesh.DangerousGetHandle());
@@ -140,6 +259,607 @@ namespace Improbable.Recast
             return (SmoothPathResult) smoothPathResult;
         }
 
+        // The overloads below write into caller-owned arrays, which are pinned for the duration of the call
+        // rather than copied, so reusing the same arrays makes repeated queries allocation free.
+
+        public uint FindNearestPoly(NavMeshQuery navMeshQuery, float[] point, float[] halfExtents,
+            out ulong polyRef, float[] nearestPoint)
+        {
+            return RecastLibrary.navmesh_query_find_nearest_poly_into(navMeshQuery.DangerousGetHandle(), point,
+                halfExtents, out polyRef, nearestPoint);
+        }
+
+        public uint FindRandomPoint(NavMeshQuery navMeshQuery, out ulong polyRef, float[] point)
+        {
+            return RecastLibrary.navmesh_query_find_random_point_into(navMeshQuery.DangerousGetHandle(),
+                out polyRef, point);
+        }
+
+        /// <summary>
+        /// Finds the polygon corridor from startRef to endRef into path. Returns the number of polygons written,
+        /// which is 0 if status reports a failure.
+        /// </summary>
+        public int FindPath(NavMeshQuery navMeshQuery, ulong startRef, ulong endRef, float[] startPos,
+            float[] endPos, ulong[] path, out uint status)
+        {
+            return RecastLibrary.navmesh_query_find_path_into(navMeshQuery.DangerousGetHandle(), startRef, endRef,
+                startPos, endPos, IntPtr.Zero, path, path.Length, out status);
+        }
+
+        /// <summary>
+        /// Writes the smooth path along the first pathCount polygons of path into smoothPath as packed xyz
+        /// triples. Returns the number of points written.
+        /// </summary>
+        public int FindSmoothPath(NavMeshQuery navMeshQuery, NavMesh navMesh, float[] startPos, ulong startRef,
+            float[] endPos, ulong[] path, int pathCount, float[] smoothPath)
+        {
+            if (pathCount > path.Length)
+            {
+                throw new ArgumentException("pathCount is larger than the path buffer.");
+            }
+
+            return RecastLibrary.navmesh_query_get_smooth_path_into(startPos, startRef, endPos, path, pathCount,
+                IntPtr.Zero, navMesh.DangerousGetHandle(), navMeshQuery.DangerousGetHandle(), smoothPath,
+                smoothPath.Length / 3);
+        }
+
+        /// <summary>
+        /// Like FindSmoothPath, with the way the corridor is turned into points selected by mode. Sampled and
+        /// Corners compute the straight path once instead of stepping along the surface, and are much cheaper
+        /// for long paths. Sampled writes a point every sampleSpacing units between corners.
+        /// </summary>
+        public int FindSmoothPath(NavMeshQuery navMeshQuery, NavMesh navMesh, float[] startPos, ulong startRef,
+            float[] endPos, ulong[] path, int pathCount, SmoothPathMode mode, float sampleSpacing, float[] smoothPath)
+        {
+            if (pathCount > path.Length)
+            {
+                throw new ArgumentException("pathCount is larger than the path buffer.");
+            }
+
+            return RecastLibrary.navmesh_query_get_smooth_path_mode_into(startPos, startRef, endPos, path, pathCount,
+                IntPtr.Zero, navMesh.DangerousGetHandle(), navMeshQuery.DangerousGetHandle(), mode, sampleSpacing,
+                smoothPath, smoothPath.Length / 3);
+        }
+
+        /// <summary>
+        /// Starts a time-sliced search for the polygon corridor between startRef and endRef on navMeshQuery.
+        /// Advance it with UpdateSlicedFindPath while the status has DT_IN_PROGRESS. A query runs one sliced
+        /// search at a time.
+        /// </summary>
+        public uint InitSlicedFindPath(NavMeshQuery navMeshQuery, ulong startRef, ulong endRef, float[] startPos,
+            float[] endPos)
+        {
+            return RecastLibrary.navmesh_query_init_sliced_find_path(navMeshQuery.DangerousGetHandle(), startRef,
+                endRef, startPos, endPos, IntPtr.Zero, 0);
+        }
+
+        /// <summary>
+        /// Runs at most maxIter node expansions of the sliced search and reports how many were run.
+        /// </summary>
+        public uint UpdateSlicedFindPath(NavMeshQuery navMeshQuery, int maxIter, out int doneIters)
+        {
+            return RecastLibrary.navmesh_query_update_sliced_find_path(navMeshQuery.DangerousGetHandle(), maxIter,
+                out doneIters);
+        }
+
+        /// <summary>
+        /// Writes the corridor of a finished sliced search into path, or the best partial corridor when the
+        /// search was cut short. Returns the number of polygons written.
+        /// </summary>
+        public int FinalizeSlicedFindPath(NavMeshQuery navMeshQuery, ulong[] path, out uint status)
+        {
+            return RecastLibrary.navmesh_query_finalize_sliced_find_path(navMeshQuery.DangerousGetHandle(), path,
+                path.Length, out status);
+        }
+
+        /// <summary>
+        /// Ends an unfinished sliced search with a corridor to the furthest polygon of existing[0..existingSize)
+        /// it has visited, for replanning while following a previous corridor.
+        /// </summary>
+        public int FinalizeSlicedFindPathPartial(NavMeshQuery navMeshQuery, ulong[] existing, int existingSize,
+            ulong[] path, out uint status)
+        {
+            return RecastLibrary.navmesh_query_finalize_sliced_find_path_partial(navMeshQuery.DangerousGetHandle(),
+                existing, existingSize, path, path.Length, out status);
+        }
+
+        /// <summary>
+        /// Creates a batch that runs path requests against navMesh on a native thread pool, with one query
+        /// object per thread. A thread count of 0 uses every core.
+        /// </summary>
+        public NavMeshQueryBatch CreateNavMeshQueryBatch(NavMesh navMesh, int threads = 0)
+        {
+            var handle = RecastLibrary.navmesh_query_batch_create(navMesh.DangerousGetHandle(), 0, threads);
+            return new NavMeshQueryBatch(handle);
+        }
+
+        /// <summary>
+        /// Finds the smooth paths between startPositions[i] and endPositions[i] (packed xyz triples) in a single
+        /// native call. Request i writes its summary to results[i] and up to maxSmoothPathLength points to
+        /// smoothPaths starting at index i * maxSmoothPathLength * 3. Returns the number of paths found.
+        /// </summary>
+        public int FindSmoothPaths(NavMeshQueryBatch batch, float[] startPositions, float[] endPositions,
+            float[] halfExtents, BatchPathResult[] results, float[] smoothPaths, int maxSmoothPathLength)
+        {
+            var count = results.Length;
+            if (startPositions.Length < 3 * count || endPositions.Length < 3 * count ||
+                smoothPaths.Length < 3 * maxSmoothPathLength * count)
+            {
+                throw new ArgumentException("Buffers are too small for the number of requests.");
+            }
+
+            return RecastLibrary.navmesh_query_batch_find_smooth_paths(batch.DangerousGetHandle(), startPositions,
+                endPositions, count, halfExtents, IntPtr.Zero, results, smoothPaths, maxSmoothPathLength);
+        }
+
+        /// <summary>
+        /// Creates a pool that gives every calling thread its own query object and random number generator, so
+        /// the pool can be used from any number of threads at once. The generators derive from seed until a
+        /// thread reseeds its own with SeedThread.
+        /// </summary>
+        public NavMeshQueryPool CreateNavMeshQueryPool(NavMesh navMesh, uint seed)
+        {
+            var handle = RecastLibrary.navmesh_query_pool_create(navMesh.DangerousGetHandle(), 0, seed);
+            return new NavMeshQueryPool(handle);
+        }
+
+        /// <summary>
+        /// Restarts the random number generator of the calling thread's query in pool. Random points drawn on
+        /// this thread afterwards are the same on every run.
+        /// </summary>
+        public void SeedThread(NavMeshQueryPool pool, uint seed)
+        {
+            RecastLibrary.navmesh_query_pool_seed_thread(pool.DangerousGetHandle(), seed);
+        }
+
+        /// <summary>
+        /// Finds a random point with the calling thread's query and generator in pool.
+        /// </summary>
+        public uint FindRandomPoint(NavMeshQueryPool pool, out ulong polyRef, float[] point)
+        {
+            return RecastLibrary.navmesh_query_pool_find_random_point_into(pool.DangerousGetHandle(), IntPtr.Zero,
+                out polyRef, point);
+        }
+
+        /// <summary>
+        /// Finds a random point within radius of centerPos, reachable from startRef, with the calling thread's
+        /// query and generator in pool.
+        /// </summary>
+        public uint FindRandomPointAroundCircle(NavMeshQueryPool pool, ulong startRef, float[] centerPos,
+            float radius, out ulong polyRef, float[] point)
+        {
+            return RecastLibrary.navmesh_query_pool_find_random_point_around_circle_into(pool.DangerousGetHandle(),
+                startRef, centerPos, radius, IntPtr.Zero, out polyRef, point);
+        }
+
+        /// <summary>
+        /// Same as FindPath, with the calling thread's query in pool.
+        /// </summary>
+        public int FindPath(NavMeshQueryPool pool, ulong startRef, ulong endRef, float[] startPos, float[] endPos,
+            ulong[] path, out uint status)
+        {
+            return RecastLibrary.navmesh_query_pool_find_path_into(pool.DangerousGetHandle(), startRef, endRef,
+                startPos, endPos, IntPtr.Zero, path, path.Length, out status);
+        }
+
+        /// <summary>
+        /// Number of threads that have used pool so far.
+        /// </summary>
+        public int GetThreadCount(NavMeshQueryPool pool)
+        {
+            return RecastLibrary.navmesh_query_pool_get_thread_count(pool.DangerousGetHandle());
+        }
+
+        /// <summary>
+        /// Builds an alias table over the areas of navMesh's polys whose flags pass includeFlags and
+        /// excludeFlags, from which random points are drawn in constant time.
+        /// </summary>
+        public RandomPointSampler CreateRandomPointSampler(NavMesh navMesh, int includeFlags = 0xffff,
+            int excludeFlags = 0)
+        {
+            var handle = RecastLibrary.navmesh_random_sampler_create(navMesh.DangerousGetHandle(), includeFlags,
+                excludeFlags);
+            return new RandomPointSampler(handle);
+        }
+
+        /// <summary>
+        /// Rebuilds the sampler's table if tiles of its navmesh were added, removed or replaced. Returns true
+        /// when it did. Must not overlap with sampling.
+        /// </summary>
+        public bool Refresh(RandomPointSampler sampler)
+        {
+            return RecastLibrary.navmesh_random_sampler_refresh(sampler.DangerousGetHandle());
+        }
+
+        /// <summary>
+        /// Draws refs.Length uniformly distributed points into refs and points (packed xyz triples). Point i
+        /// depends only on seed and counter + i, so consecutive batches should advance counter by the number
+        /// of points drawn. Returns the number of points written.
+        /// </summary>
+        public int SampleRandomPoints(RandomPointSampler sampler, ulong seed, ulong counter, ulong[] refs,
+            float[] points)
+        {
+            if (points.Length < 3 * refs.Length)
+            {
+                throw new ArgumentException("points is too small for the number of refs.");
+            }
+
+            return RecastLibrary.navmesh_random_sampler_sample_into(sampler.DangerousGetHandle(), seed, counter,
+                refs.Length, refs, points);
+        }
+
+        /// <summary>
+        /// Number of polys the sampler draws from.
+        /// </summary>
+        public int GetPolyCount(RandomPointSampler sampler)
+        {
+            return RecastLibrary.navmesh_random_sampler_get_poly_count(sampler.DangerousGetHandle());
+        }
+
+        /// <summary>
+        /// Total xz area of the polys the sampler draws from.
+        /// </summary>
+        public float GetTotalArea(RandomPointSampler sampler)
+        {
+            return RecastLibrary.navmesh_random_sampler_get_total_area(sampler.DangerousGetHandle());
+        }
+
+        /// <summary>
+        /// Opens a .tiled.bin64 file for streaming: tiles are only loaded once a region overlapping them is
+        /// touched, and the least recently touched unpinned tiles are evicted once budgetBytes is exceeded.
+        /// A budget of 0 means no limit.
+        /// </summary>
+        public StreamingNavMesh OpenStreamingNavMesh(string path, long budgetBytes)
+        {
+            if (!File.Exists(path))
+            {
+                throw new FileNotFoundException("File not found.", path);
+            }
+
+            return new StreamingNavMesh(RecastLibrary.navmesh_stream_open(path, budgetBytes));
+        }
+
+        /// <summary>
+        /// The navmesh is owned by the stream and is only valid while the stream is alive.
+        /// </summary>
+        public NavMesh GetNavMesh(StreamingNavMesh stream)
+        {
+            return new NavMesh(RecastLibrary.navmesh_stream_get_navmesh(stream.DangerousGetHandle()), false);
+        }
+
+        public int TouchRegion(StreamingNavMesh stream, float[] bmin, float[] bmax)
+        {
+            return RecastLibrary.navmesh_stream_touch(stream.DangerousGetHandle(), bmin, bmax);
+        }
+
+        public int PinRegion(StreamingNavMesh stream, float[] bmin, float[] bmax)
+        {
+            return RecastLibrary.navmesh_stream_pin(stream.DangerousGetHandle(), bmin, bmax);
+        }
+
+        public int UnpinRegion(StreamingNavMesh stream, float[] bmin, float[] bmax)
+        {
+            return RecastLibrary.navmesh_stream_unpin(stream.DangerousGetHandle(), bmin, bmax);
+        }
+
+        public void SetBudget(StreamingNavMesh stream, long budgetBytes)
+        {
+            RecastLibrary.navmesh_stream_set_budget(stream.DangerousGetHandle(), budgetBytes);
+        }
+
+        public TileStreamStats GetStats(StreamingNavMesh stream)
+        {
+            TileStreamStats stats;
+            RecastLibrary.navmesh_stream_get_stats(stream.DangerousGetHandle(), out stats);
+            return stats;
+        }
+
+        /// <summary>
+        /// Streams in the tiles between startPos and endPos, then finds the polygon corridor between them
+        /// into path. Returns the number of polygons written.
+        /// </summary>
+        public int FindPath(StreamingNavMesh stream, NavMeshQuery navMeshQuery, float[] startPos, float[] endPos,
+            float[] halfExtents, ulong[] path, out uint status)
+        {
+            return RecastLibrary.navmesh_stream_find_path_into(stream.DangerousGetHandle(),
+                navMeshQuery.DangerousGetHandle(), startPos, endPos, halfExtents, IntPtr.Zero, path, path.Length,
+                out status);
+        }
+
+        /// <summary>
+        /// Creates a cache of path corridors for navMesh holding at most maxEntries corridors. It can be shared
+        /// by queries on any thread and must not outlive the navmesh.
+        /// </summary>
+        public PathCache CreatePathCache(NavMesh navMesh, int maxEntries)
+        {
+            return new PathCache(RecastLibrary.navmesh_path_cache_create(navMesh.DangerousGetHandle(), maxEntries));
+        }
+
+        /// <summary>
+        /// Same as FindPath, but repeated queries for the same pair of polygons are answered from the cache.
+        /// </summary>
+        public int FindPath(PathCache cache, NavMeshQuery navMeshQuery, ulong startRef, ulong endRef,
+            float[] startPos, float[] endPos, ulong[] path, out uint status)
+        {
+            return RecastLibrary.navmesh_path_cache_find_path_into(cache.DangerousGetHandle(),
+                navMeshQuery.DangerousGetHandle(), startRef, endRef, startPos, endPos, IntPtr.Zero, path, path.Length,
+                out status);
+        }
+
+        /// <summary>
+        /// Drops the cached corridors crossing tiles in the region. Needed after changing poly flags or areas
+        /// there; removed and replaced tiles are detected by the cache itself.
+        /// </summary>
+        public int InvalidateRegion(PathCache cache, float[] bmin, float[] bmax)
+        {
+            return RecastLibrary.navmesh_path_cache_invalidate_region(cache.DangerousGetHandle(), bmin, bmax);
+        }
+
+        public void ClearPathCache(PathCache cache)
+        {
+            RecastLibrary.navmesh_path_cache_clear(cache.DangerousGetHandle());
+        }
+
+        public PathCacheStats GetStats(PathCache cache)
+        {
+            PathCacheStats stats;
+            RecastLibrary.navmesh_path_cache_get_stats(cache.DangerousGetHandle(), out stats);
+            return stats;
+        }
+
+        /// <summary>
+        /// Builds the abstract graph used to plan long paths on navMesh with the default filter. threads &lt;= 0
+        /// uses every core. Rebuild it after the navmesh's tiles change.
+        /// </summary>
+        public HierarchicalPathfinder CreateHierarchicalPathfinder(NavMesh navMesh, int threads = 0)
+        {
+            return new HierarchicalPathfinder(
+                RecastLibrary.navmesh_hierarchy_create(navMesh.DangerousGetHandle(), IntPtr.Zero, threads));
+        }
+
+        /// <summary>
+        /// Plans the route between two polygons on the abstract graph and refines it tile by tile into path.
+        /// Routes longer than path come back truncated with DT_BUFFER_TOO_SMALL.
+        /// </summary>
+        public int FindPath(HierarchicalPathfinder hierarchy, NavMeshQuery navMeshQuery, ulong startRef, ulong endRef,
+            float[] startPos, float[] endPos, ulong[] path, out uint status)
+        {
+            return RecastLibrary.navmesh_hierarchy_find_path_into(hierarchy.DangerousGetHandle(),
+                navMeshQuery.DangerousGetHandle(), startRef, endRef, startPos, endPos, path, path.Length, out status);
+        }
+
+        /// <summary>
+        /// Plans the route between two polygons on the abstract graph and writes the polygons where it enters
+        /// each tile, ending with endRef, so it can be refined one segment at a time with FindPath.
+        /// </summary>
+        public int FindWaypoints(HierarchicalPathfinder hierarchy, ulong startRef, ulong endRef, float[] startPos,
+            float[] endPos, ulong[] waypointRefs, float[] waypointPositions, out uint status)
+        {
+            return RecastLibrary.navmesh_hierarchy_find_waypoints_into(hierarchy.DangerousGetHandle(), startRef,
+                endRef, startPos, endPos, waypointRefs, waypointPositions, waypointRefs.Length, out status);
+        }
+
+        public HierarchicalGraphStats GetStats(HierarchicalPathfinder hierarchy)
+        {
+            HierarchicalGraphStats stats;
+            RecastLibrary.navmesh_hierarchy_get_stats(hierarchy.DangerousGetHandle(), out stats);
+            return stats;
+        }
+
+        /// <summary>
+        /// Creates a rebuilder that keeps navMesh, built by CreateTiledNavMesh from the same config and geom, up
+        /// to date with edits to geom by rebuilding the tiles they touch in the background. It must be disposed
+        /// before the navmesh and geometry.
+        /// </summary>
+        public NavMeshRebuilder CreateNavMeshRebuilder(NavMesh navMesh, RcConfig config, InputGeom geom,
+            float agentHeight, float agentRadius, float agentMaxClimb, int threads = 0)
+        {
+            return new NavMeshRebuilder(RecastLibrary.navmesh_rebuilder_create(_context.DangerousGetHandle(),
+                navMesh.DangerousGetHandle(), ref config, geom.DangerousGetHandle(), agentHeight, agentRadius,
+                agentMaxClimb, threads));
+        }
+
+        /// <summary>
+        /// Queues the tiles whose build reads from the region for a rebuild and returns how many there are.
+        /// </summary>
+        public int MarkDirty(NavMeshRebuilder rebuilder, float[] bmin, float[] bmax)
+        {
+            return RecastLibrary.navmesh_rebuilder_mark_dirty(rebuilder.DangerousGetHandle(), bmin, bmax);
+        }
+
+        /// <summary>
+        /// Adds a convex volume of area to the geometry and queues the tiles under it. Returns -1 when verts
+        /// has fewer than 3 or more than 12 points.
+        /// </summary>
+        public int AddConvexVolume(NavMeshRebuilder rebuilder, float[] verts, float minh, float maxh, int area)
+        {
+            return RecastLibrary.navmesh_rebuilder_add_convex_volume(rebuilder.DangerousGetHandle(), verts,
+                verts.Length / 3, minh, maxh, area);
+        }
+
+        public int AddOffMeshConnection(NavMeshRebuilder rebuilder, float[] spos, float[] epos, float radius,
+            bool bidirectional, int area, int flags)
+        {
+            return RecastLibrary.navmesh_rebuilder_add_off_mesh_connection(rebuilder.DangerousGetHandle(), spos,
+                epos, radius, bidirectional, area, flags);
+        }
+
+        /// <summary>
+        /// Swaps the rebuilt tiles into the navmesh and returns how many were swapped, with their bounds in
+        /// bmin and bmax. Must not overlap with queries on the navmesh.
+        /// </summary>
+        public int ApplyRebuiltTiles(NavMeshRebuilder rebuilder, float[] bmin, float[] bmax)
+        {
+            return RecastLibrary.navmesh_rebuilder_apply(rebuilder.DangerousGetHandle(), bmin, bmax);
+        }
+
+        /// <summary>
+        /// Blocks until no tile is waiting for or in a rebuild.
+        /// </summary>
+        public void WaitForRebuilds(NavMeshRebuilder rebuilder)
+        {
+            RecastLibrary.navmesh_rebuilder_wait(rebuilder.DangerousGetHandle());
+        }
+
+        public TileRebuildStats GetStats(NavMeshRebuilder rebuilder)
+        {
+            TileRebuildStats stats;
+            RecastLibrary.navmesh_rebuilder_get_stats(rebuilder.DangerousGetHandle(), out stats);
+            return stats;
+        }
+
+        /// <summary>
+        /// Builds a tiled navmesh whose compressed heightfield layers are kept, so obstacles can be carved in
+        /// and out without rasterizing again. The cache owns the navmesh; see GetNavMesh.
+        /// </summary>
+        public NavMeshTileCache CreateNavMeshTileCache(RcConfig config, InputGeom geom, float agentHeight,
+            float agentRadius, float agentMaxClimb, int maxObstacles, int threads = 0)
+        {
+            return new NavMeshTileCache(RecastLibrary.navmesh_tile_cache_create(_context.DangerousGetHandle(),
+                ref config, geom.DangerousGetHandle(), agentHeight, agentRadius, agentMaxClimb, maxObstacles,
+                threads));
+        }
+
+        public NavMesh GetNavMesh(NavMeshTileCache cache)
+        {
+            return new NavMesh(RecastLibrary.navmesh_tile_cache_get_navmesh(cache.DangerousGetHandle()), false);
+        }
+
+        /// <summary>
+        /// Queues a cylinder obstacle standing on pos and returns its ref, or 0 when the cache is full.
+        /// </summary>
+        public uint AddCylinderObstacle(NavMeshTileCache cache, float[] pos, float radius, float height)
+        {
+            return RecastLibrary.navmesh_tile_cache_add_cylinder_obstacle(cache.DangerousGetHandle(), pos, radius,
+                height);
+        }
+
+        public uint AddBoxObstacle(NavMeshTileCache cache, float[] bmin, float[] bmax)
+        {
+            return RecastLibrary.navmesh_tile_cache_add_box_obstacle(cache.DangerousGetHandle(), bmin, bmax);
+        }
+
+        /// <summary>
+        /// Queues a box obstacle rotated by yRadians around the y axis and returns its ref, or 0 when the cache
+        /// is full.
+        /// </summary>
+        public uint AddOrientedBoxObstacle(NavMeshTileCache cache, float[] center, float[] halfExtents,
+            float yRadians)
+        {
+            return RecastLibrary.navmesh_tile_cache_add_oriented_box_obstacle(cache.DangerousGetHandle(), center,
+                halfExtents, yRadians);
+        }
+
+        public bool RemoveObstacle(NavMeshTileCache cache, uint obstacleRef)
+        {
+            return RecastLibrary.navmesh_tile_cache_remove_obstacle(cache.DangerousGetHandle(), obstacleRef);
+        }
+
+        /// <summary>
+        /// Applies queued obstacle changes for up to budgetMicros microseconds and returns true once none are
+        /// left. Must not overlap with queries on the cache's navmesh.
+        /// </summary>
+        public bool Update(NavMeshTileCache cache, int budgetMicros)
+        {
+            return RecastLibrary.navmesh_tile_cache_update(cache.DangerousGetHandle(), budgetMicros);
+        }
+
+        public TileCacheStats GetStats(NavMeshTileCache cache)
+        {
+            TileCacheStats stats;
+            RecastLibrary.navmesh_tile_cache_get_stats(cache.DangerousGetHandle(), out stats);
+            return stats;
+        }
+
+        /// <summary>
+        /// Creates a crowd of at most maxAgents agents with radii up to maxAgentRadius on navMesh.
+        /// </summary>
+        public NavMeshCrowd CreateCrowd(NavMesh navMesh, int maxAgents, float maxAgentRadius)
+        {
+            return new NavMeshCrowd(
+                RecastLibrary.crowd_create(navMesh.DangerousGetHandle(), maxAgents, maxAgentRadius));
+        }
+
+        public CrowdAgentConfig DefaultCrowdAgentConfig()
+        {
+            CrowdAgentConfig config;
+            RecastLibrary.crowd_get_default_agent_config(out config);
+            return config;
+        }
+
+        /// <summary>
+        /// Adds an agent at the navmesh point nearest to pos and returns its index, or -1 when the crowd is
+        /// full or pos is off the mesh.
+        /// </summary>
+        public int AddAgent(NavMeshCrowd crowd, float[] pos, CrowdAgentConfig config)
+        {
+            return RecastLibrary.crowd_add_agent(crowd.DangerousGetHandle(), pos, ref config);
+        }
+
+        public void RemoveAgent(NavMeshCrowd crowd, int index)
+        {
+            RecastLibrary.crowd_remove_agent(crowd.DangerousGetHandle(), index);
+        }
+
+        public bool SetTarget(NavMeshCrowd crowd, int index, float[] pos)
+        {
+            return RecastLibrary.crowd_set_target(crowd.DangerousGetHandle(), index, pos);
+        }
+
+        public bool ResetTarget(NavMeshCrowd crowd, int index)
+        {
+            return RecastLibrary.crowd_reset_target(crowd.DangerousGetHandle(), index);
+        }
+
+        /// <summary>
+        /// Advances every agent by dt seconds and writes the position and velocity of agent i to
+        /// states[6 * i .. 6 * i + 6). Returns the number of agents written.
+        /// </summary>
+        public int UpdateCrowd(NavMeshCrowd crowd, float dt, float[] states)
+        {
+            return RecastLibrary.crowd_update(crowd.DangerousGetHandle(), dt, states, states.Length / 6);
+        }
+
+        public int GetActiveAgentCount(NavMeshCrowd crowd)
+        {
+            return RecastLibrary.crowd_get_active_agent_count(crowd.DangerousGetHandle());
+        }
+
+        /// <summary>
+        /// Returns the process wide build stage timings, query latencies and outcomes, and tile memory in the
+        /// Prometheus text format.
+        /// </summary>
+        public static string GetMetrics()
+        {
+            var length = RecastLibrary.navmesh_metrics_write_prometheus(null, 0);
+            while (true)
+            {
+                var buffer = new byte[length + 1];
+                var written = RecastLibrary.navmesh_metrics_write_prometheus(buffer, buffer.Length);
+                // Counters updated by other threads may have grown since the length was asked for.
+                if (written < buffer.Length)
+                {
+                    return Encoding.ASCII.GetString(buffer, 0, written);
+                }
+                length = written;
+            }
+        }
+
+        public static void ResetMetrics()
+        {
+            RecastLibrary.navmesh_metrics_reset();
+        }
+
+        /// <summary>
+        /// Switches Recast and Detour to allocators tuned for parallel navmesh builds, for the whole process.
+        /// Must be called before anything else in this library, and cannot be undone. Returns false and
+        /// changes nothing if called again or after anything was allocated through the default allocators.
+        /// </summary>
+        public static bool InstallBuildAllocator()
+        {
+            return RecastLibrary.build_allocator_install();
+        }
+
         public static bool IsUsing64BitPolyRefs()
         {
             return RecastLibrary.dtPolyRef_is_64bit();
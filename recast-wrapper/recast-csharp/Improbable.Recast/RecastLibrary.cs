@@ -51,9 +51,45 @@ namespace Improbable.Recast
         [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
         public static extern IntPtr navmesh_create(IntPtr context, ref NavMeshDataResult navMeshDataResult);
 
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_create_tiled(IntPtr context, ref RcConfig config, IntPtr geom, float agentHeight, float agentRadius, float agentMaxClimb, int threads);
+
         [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
         public static extern IntPtr navmesh_load_tiled_bin(char[] path);
 
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_load_tiled_bin_mapped(string path);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool navmesh_save_compressed(IntPtr navmesh, string path);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool navmesh_save(IntPtr navmesh, string path);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_load(string path, int threads);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_file_open(string path);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_file_close(IntPtr reader);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_file_get_tile_count(IntPtr reader);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool navmesh_file_get_tile_location(IntPtr reader, int index, int[] location);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_file_find_tile(IntPtr reader, int x, int y, int layer);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_file_read_tile(IntPtr reader, int index, byte[] buffer, int maxSize);
+
         [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
         public static extern void navmesh_delete(IntPtr navmesh);
 
@@ -93,6 +129,272 @@ namespace Improbable.Recast
         [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
         public static extern IntPtr smooth_path_result_delete(IntPtr smoothPathResult);
 
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint navmesh_query_find_nearest_poly_into(IntPtr navQuery, float[] point,
+            float[] halfExtents, out DtPolyRef polyRef, [Out] float[] nearestPoint);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint navmesh_query_find_random_point_into(IntPtr navQuery, out DtPolyRef polyRef,
+            [Out] float[] point);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_query_find_path_into(IntPtr navQuery, DtPolyRef startRef, DtPolyRef endRef,
+            float[] startPos, float[] endPos, IntPtr filter, [Out] DtPolyRef[] path, int maxPath, out uint status);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_query_get_smooth_path_into(float[] startPos, DtPolyRef startRef,
+            float[] endPos, DtPolyRef[] path, int pathCount, IntPtr filter, IntPtr navMesh, IntPtr navQuery,
+            [Out] float[] smoothPath, int maxSmoothPath);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_query_get_smooth_path_mode_into(float[] startPos, DtPolyRef startRef,
+            float[] endPos, DtPolyRef[] path, int pathCount, IntPtr filter, IntPtr navMesh, IntPtr navQuery,
+            SmoothPathMode mode, float sampleSpacing, [Out] float[] smoothPath, int maxSmoothPath);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint navmesh_query_init_sliced_find_path(IntPtr navQuery, DtPolyRef startRef,
+            DtPolyRef endRef, float[] startPos, float[] endPos, IntPtr filter, uint options);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint navmesh_query_update_sliced_find_path(IntPtr navQuery, int maxIter, out int doneIters);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_query_finalize_sliced_find_path(IntPtr navQuery, [Out] DtPolyRef[] path,
+            int maxPath, out uint status);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_query_finalize_sliced_find_path_partial(IntPtr navQuery,
+            DtPolyRef[] existing, int existingSize, [Out] DtPolyRef[] path, int maxPath, out uint status);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_query_batch_create(IntPtr navMesh, int maxNodes, int threads);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_query_batch_delete(IntPtr batch);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_query_batch_find_smooth_paths(IntPtr batch, float[] startPositions,
+            float[] endPositions, int count, float[] halfExtents, IntPtr filter, [Out] BatchPathResult[] results,
+            [Out] float[] smoothPaths, int maxSmoothPathLen);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_query_pool_create(IntPtr navMesh, int maxNodes, uint seed);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_query_pool_delete(IntPtr pool);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_query_pool_get_query(IntPtr pool);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_query_pool_seed_thread(IntPtr pool, uint seed);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint navmesh_query_pool_find_random_point_into(IntPtr pool, IntPtr filter,
+            out DtPolyRef polyRef, [Out] float[] point);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint navmesh_query_pool_find_random_point_around_circle_into(IntPtr pool,
+            DtPolyRef startRef, float[] centerPos, float radius, IntPtr filter, out DtPolyRef polyRef,
+            [Out] float[] point);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_query_pool_find_path_into(IntPtr pool, DtPolyRef startRef, DtPolyRef endRef,
+            float[] startPos, float[] endPos, IntPtr filter, [Out] DtPolyRef[] path, int maxPath, out uint status);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_query_pool_get_thread_count(IntPtr pool);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_random_sampler_create(IntPtr navMesh, int includeFlags, int excludeFlags);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_random_sampler_delete(IntPtr sampler);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool navmesh_random_sampler_refresh(IntPtr sampler);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_random_sampler_sample_into(IntPtr sampler, ulong seed, ulong counter,
+            int count, [Out] DtPolyRef[] refs, [Out] float[] points);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_random_sampler_get_poly_count(IntPtr sampler);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern float navmesh_random_sampler_get_total_area(IntPtr sampler);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_stream_open(string path, long budgetBytes);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_stream_delete(IntPtr stream);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_stream_get_navmesh(IntPtr stream);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_stream_touch(IntPtr stream, float[] bmin, float[] bmax);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_stream_pin(IntPtr stream, float[] bmin, float[] bmax);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_stream_unpin(IntPtr stream, float[] bmin, float[] bmax);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_stream_set_budget(IntPtr stream, long budgetBytes);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_stream_get_stats(IntPtr stream, out TileStreamStats stats);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_stream_reset_stats(IntPtr stream);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_stream_find_path_into(IntPtr stream, IntPtr navQuery, float[] startPos,
+            float[] endPos, float[] halfExtents, IntPtr filter, [Out] DtPolyRef[] path, int maxPath, out uint status);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_path_cache_create(IntPtr navmesh, int maxEntries);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_path_cache_delete(IntPtr cache);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_path_cache_find_path_into(IntPtr cache, IntPtr navQuery, DtPolyRef startRef,
+            DtPolyRef endRef, float[] startPos, float[] endPos, IntPtr filter, [Out] DtPolyRef[] path, int maxPath,
+            out uint status);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_path_cache_invalidate_region(IntPtr cache, float[] bmin, float[] bmax);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_path_cache_clear(IntPtr cache);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_path_cache_get_stats(IntPtr cache, out PathCacheStats stats);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_path_cache_reset_stats(IntPtr cache);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_hierarchy_create(IntPtr navmesh, IntPtr filter, int threads);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_hierarchy_delete(IntPtr hierarchy);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_hierarchy_find_path_into(IntPtr hierarchy, IntPtr navQuery, DtPolyRef startRef,
+            DtPolyRef endRef, float[] startPos, float[] endPos, [Out] DtPolyRef[] path, int maxPath, out uint status);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_hierarchy_find_waypoints_into(IntPtr hierarchy, DtPolyRef startRef,
+            DtPolyRef endRef, float[] startPos, float[] endPos, [Out] DtPolyRef[] waypointRefs,
+            [Out] float[] waypointPositions, int maxWaypoints, out uint status);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_hierarchy_get_stats(IntPtr hierarchy, out HierarchicalGraphStats stats);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_rebuilder_create(IntPtr context, IntPtr navmesh, ref RcConfig config,
+            IntPtr geom, float agentHeight, float agentRadius, float agentMaxClimb, int threads);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_rebuilder_delete(IntPtr rebuilder);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_rebuilder_mark_dirty(IntPtr rebuilder, float[] bmin, float[] bmax);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_rebuilder_add_convex_volume(IntPtr rebuilder, float[] verts, int nverts,
+            float minh, float maxh, int area);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_rebuilder_add_off_mesh_connection(IntPtr rebuilder, float[] spos,
+            float[] epos, float radius, bool bidirectional, int area, int flags);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_rebuilder_apply(IntPtr rebuilder, [Out] float[] bmin, [Out] float[] bmax);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_rebuilder_wait(IntPtr rebuilder);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_rebuilder_get_stats(IntPtr rebuilder, out TileRebuildStats stats);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_tile_cache_create(IntPtr context, ref RcConfig config, IntPtr geom,
+            float agentHeight, float agentRadius, float agentMaxClimb, int maxObstacles, int threads);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_tile_cache_delete(IntPtr cache);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr navmesh_tile_cache_get_navmesh(IntPtr cache);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint navmesh_tile_cache_add_cylinder_obstacle(IntPtr cache, float[] pos, float radius,
+            float height);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint navmesh_tile_cache_add_box_obstacle(IntPtr cache, float[] bmin, float[] bmax);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint navmesh_tile_cache_add_oriented_box_obstacle(IntPtr cache, float[] center,
+            float[] halfExtents, float yRadians);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool navmesh_tile_cache_remove_obstacle(IntPtr cache, uint obstacleRef);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool navmesh_tile_cache_update(IntPtr cache, int budgetMicros);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_tile_cache_get_stats(IntPtr cache, out TileCacheStats stats);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr crowd_create(IntPtr navmesh, int maxAgents, float maxAgentRadius);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void crowd_delete(IntPtr crowd);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void crowd_get_default_agent_config(out CrowdAgentConfig config);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int crowd_add_agent(IntPtr crowd, float[] pos, ref CrowdAgentConfig config);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void crowd_remove_agent(IntPtr crowd, int index);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool crowd_set_target(IntPtr crowd, int index, float[] pos);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool crowd_reset_target(IntPtr crowd, int index);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int crowd_update(IntPtr crowd, float dt, [Out] float[] states, int maxStates);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int crowd_get_active_agent_count(IntPtr crowd);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int navmesh_metrics_write_prometheus([Out] byte[] buffer, int maxLength);
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void navmesh_metrics_reset();
+
+        [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool build_allocator_install();
+
         [DllImport(Library, CallingConvention = CallingConvention.Cdecl)]
         public static extern bool dtPolyRef_is_64bit();
 
@@ -0,0 +1,21 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace Improbable.Recast.Types
+{
+    using DtPolyRef = UInt64;
+
+    [StructLayout(LayoutKind.Sequential, Pack = 0)]
+    public struct BatchPathResult
+    {
+        public uint status;
+
+        public DtPolyRef startRef;
+
+        public DtPolyRef endRef;
+
+        public int pathCount;
+
+        public int smoothPathCount;
+    }
+}
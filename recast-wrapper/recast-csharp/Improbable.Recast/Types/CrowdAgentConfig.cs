@@ -0,0 +1,22 @@
+﻿using System.Runtime.InteropServices;
+
+namespace Improbable.Recast.Types
+{
+    [StructLayout(LayoutKind.Sequential, Pack = 0)]
+    public struct CrowdAgentConfig
+    {
+        public float radius;
+
+        public float height;
+
+        public float maxAcceleration;
+
+        public float maxSpeed;
+
+        public float separationWeight;
+
+        public int updateFlags;
+
+        public int obstacleAvoidance;
+    }
+}
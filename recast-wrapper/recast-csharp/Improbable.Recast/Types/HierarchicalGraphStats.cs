@@ -0,0 +1,18 @@
+﻿using System.Runtime.InteropServices;
+
+namespace Improbable.Recast.Types
+{
+    [StructLayout(LayoutKind.Sequential, Pack = 0)]
+    public struct HierarchicalGraphStats
+    {
+        public int clusters;
+
+        public int portals;
+
+        public int intraEdges;
+
+        public int interEdges;
+
+        public long memoryBytes;
+    }
+}
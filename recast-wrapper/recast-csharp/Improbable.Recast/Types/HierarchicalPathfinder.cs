@@ -0,0 +1,19 @@
+﻿using System;
+using Microsoft.Win32.SafeHandles;
+
+namespace Improbable.Recast.Types
+{
+    public class HierarchicalPathfinder : SafeHandleZeroOrMinusOneIsInvalid
+    {
+        public HierarchicalPathfinder(IntPtr handle) : base(true)
+        {
+            SetHandle(handle);
+        }
+
+        protected override bool ReleaseHandle()
+        {
+            RecastLibrary.navmesh_hierarchy_delete(handle);
+            return true;
+        }
+    }
+}
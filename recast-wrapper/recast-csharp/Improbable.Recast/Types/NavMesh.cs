@@ -5,7 +5,7 @@ namespace Improbable.Recast.Types
 {
     public class NavMesh : SafeHandleZeroOrMinusOneIsInvalid
     {
-        public NavMesh(IntPtr handle) : base(true)
+        public NavMesh(IntPtr handle, bool ownsHandle = true) : base(ownsHandle)
         {
             SetHandle(handle);
         }
@@ -0,0 +1,19 @@
+﻿using System;
+using Microsoft.Win32.SafeHandles;
+
+namespace Improbable.Recast.Types
+{
+    public class NavMeshCrowd : SafeHandleZeroOrMinusOneIsInvalid
+    {
+        public NavMeshCrowd(IntPtr handle) : base(true)
+        {
+            SetHandle(handle);
+        }
+
+        protected override bool ReleaseHandle()
+        {
+            RecastLibrary.crowd_delete(handle);
+            return true;
+        }
+    }
+}
@@ -0,0 +1,19 @@
+﻿using System;
+using Microsoft.Win32.SafeHandles;
+
+namespace Improbable.Recast.Types
+{
+    public class NavMeshFileReader : SafeHandleZeroOrMinusOneIsInvalid
+    {
+        public NavMeshFileReader(IntPtr handle) : base(true)
+        {
+            SetHandle(handle);
+        }
+
+        protected override bool ReleaseHandle()
+        {
+            RecastLibrary.navmesh_file_close(handle);
+            return true;
+        }
+    }
+}
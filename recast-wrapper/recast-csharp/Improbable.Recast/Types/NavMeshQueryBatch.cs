@@ -0,0 +1,19 @@
+﻿using System;
+using Microsoft.Win32.SafeHandles;
+
+namespace Improbable.Recast.Types
+{
+    public class NavMeshQueryBatch : SafeHandleZeroOrMinusOneIsInvalid
+    {
+        public NavMeshQueryBatch(IntPtr handle) : base(true)
+        {
+            SetHandle(handle);
+        }
+
+        protected override bool ReleaseHandle()
+        {
+            RecastLibrary.navmesh_query_batch_delete(handle);
+            return true;
+        }
+    }
+}
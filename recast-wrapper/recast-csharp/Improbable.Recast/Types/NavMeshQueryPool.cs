@@ -0,0 +1,19 @@
+﻿using System;
+using Microsoft.Win32.SafeHandles;
+
+namespace Improbable.Recast.Types
+{
+    public class NavMeshQueryPool : SafeHandleZeroOrMinusOneIsInvalid
+    {
+        public NavMeshQueryPool(IntPtr handle) : base(true)
+        {
+            SetHandle(handle);
+        }
+
+        protected override bool ReleaseHandle()
+        {
+            RecastLibrary.navmesh_query_pool_delete(handle);
+            return true;
+        }
+    }
+}
@@ -0,0 +1,19 @@
+﻿using System;
+using Microsoft.Win32.SafeHandles;
+
+namespace Improbable.Recast.Types
+{
+    public class NavMeshTileCache : SafeHandleZeroOrMinusOneIsInvalid
+    {
+        public NavMeshTileCache(IntPtr handle) : base(true)
+        {
+            SetHandle(handle);
+        }
+
+        protected override bool ReleaseHandle()
+        {
+            RecastLibrary.navmesh_tile_cache_delete(handle);
+            return true;
+        }
+    }
+}
@@ -0,0 +1,19 @@
+﻿using System;
+using Microsoft.Win32.SafeHandles;
+
+namespace Improbable.Recast.Types
+{
+    public class PathCache : SafeHandleZeroOrMinusOneIsInvalid
+    {
+        public PathCache(IntPtr handle) : base(true)
+        {
+            SetHandle(handle);
+        }
+
+        protected override bool ReleaseHandle()
+        {
+            RecastLibrary.navmesh_path_cache_delete(handle);
+            return true;
+        }
+    }
+}
@@ -0,0 +1,22 @@
+﻿using System.Runtime.InteropServices;
+
+namespace Improbable.Recast.Types
+{
+    [StructLayout(LayoutKind.Sequential, Pack = 0)]
+    public struct PathCacheStats
+    {
+        public long hits;
+
+        public long misses;
+
+        public long insertions;
+
+        public long evictions;
+
+        public long invalidations;
+
+        public int entries;
+
+        public int maxEntries;
+    }
+}
@@ -0,0 +1,19 @@
+﻿using System;
+using Microsoft.Win32.SafeHandles;
+
+namespace Improbable.Recast.Types
+{
+    public class RandomPointSampler : SafeHandleZeroOrMinusOneIsInvalid
+    {
+        public RandomPointSampler(IntPtr handle) : base(true)
+        {
+            SetHandle(handle);
+        }
+
+        protected override bool ReleaseHandle()
+        {
+            RecastLibrary.navmesh_random_sampler_delete(handle);
+            return true;
+        }
+    }
+}
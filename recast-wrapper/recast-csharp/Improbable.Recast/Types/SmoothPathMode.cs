@@ -0,0 +1,14 @@
+﻿namespace Improbable.Recast.Types
+{
+    public enum SmoothPathMode
+    {
+        /// <summary>Small steps along the navmesh surface. The most detailed and the most expensive.</summary>
+        Follow = 0,
+
+        /// <summary>The straight path, with a point every sampleSpacing units snapped to the surface.</summary>
+        Sampled = 1,
+
+        /// <summary>The corners of the straight path only.</summary>
+        Corners = 2
+    }
+}
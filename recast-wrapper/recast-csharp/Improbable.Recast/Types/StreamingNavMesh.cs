@@ -0,0 +1,19 @@
+﻿using System;
+using Microsoft.Win32.SafeHandles;
+
+namespace Improbable.Recast.Types
+{
+    public class StreamingNavMesh : SafeHandleZeroOrMinusOneIsInvalid
+    {
+        public StreamingNavMesh(IntPtr handle) : base(true)
+        {
+            SetHandle(handle);
+        }
+
+        protected override bool ReleaseHandle()
+        {
+            RecastLibrary.navmesh_stream_delete(handle);
+            return true;
+        }
+    }
+}
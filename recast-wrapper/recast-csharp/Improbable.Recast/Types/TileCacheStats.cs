@@ -0,0 +1,20 @@
+﻿using System.Runtime.InteropServices;
+
+namespace Improbable.Recast.Types
+{
+    [StructLayout(LayoutKind.Sequential, Pack = 0)]
+    public struct TileCacheStats
+    {
+        public long compressedBytes;
+
+        public long rawBytes;
+
+        public long rebuiltTiles;
+
+        public int layers;
+
+        public int obstacles;
+
+        public int maxObstacles;
+    }
+}
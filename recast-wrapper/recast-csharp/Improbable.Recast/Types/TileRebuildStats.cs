@@ -0,0 +1,22 @@
+﻿using System.Runtime.InteropServices;
+
+namespace Improbable.Recast.Types
+{
+    [StructLayout(LayoutKind.Sequential, Pack = 0)]
+    public struct TileRebuildStats
+    {
+        public long queued;
+
+        public long built;
+
+        public long applied;
+
+        public long failures;
+
+        public long buildNanos;
+
+        public int pendingTiles;
+
+        public int readyTiles;
+    }
+}
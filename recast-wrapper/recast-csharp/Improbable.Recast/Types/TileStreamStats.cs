@@ -0,0 +1,28 @@
+﻿using System.Runtime.InteropServices;
+
+namespace Improbable.Recast.Types
+{
+    [StructLayout(LayoutKind.Sequential, Pack = 0)]
+    public struct TileStreamStats
+    {
+        public long hits;
+
+        public long misses;
+
+        public long evictions;
+
+        public long loadFailures;
+
+        public long residentBytes;
+
+        public long budgetBytes;
+
+        public long compressedBytes;
+
+        public int residentTiles;
+
+        public int pinnedTiles;
+
+        public int totalTiles;
+    }
+}
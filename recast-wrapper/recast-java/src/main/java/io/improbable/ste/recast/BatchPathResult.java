@@ -0,0 +1,20 @@
+package io.improbable.ste.recast;
+
+import com.sun.jna.Structure;
+
+import java.util.Arrays;
+import java.util.List;
+
+public class BatchPathResult extends Structure {
+    public static class ByReference extends BatchPathResult implements Structure.ByReference {}
+    public int status;
+    public long startRef;
+    public long endRef;
+    public int pathCount;
+    public int smoothPathCount;
+
+    @Override
+    protected List<String> getFieldOrder() {
+        return Arrays.asList("status", "startRef", "endRef", "pathCount", "smoothPathCount");
+    }
+}
@@ -0,0 +1,21 @@
+package io.improbable.ste.recast;
+
+import com.sun.jna.Structure;
+
+import java.util.Arrays;
+import java.util.List;
+
+public class CrowdAgentConfig extends Structure {
+    public float radius;
+    public float height;
+    public float maxAcceleration;
+    public float maxSpeed;
+    public float separationWeight;
+    public int updateFlags;
+    public int obstacleAvoidance;
+
+    @Override
+    protected List<String> getFieldOrder() {
+        return Arrays.asList("radius", "height", "maxAcceleration", "maxSpeed", "separationWeight", "updateFlags", "obstacleAvoidance");
+    }
+}
@@ -0,0 +1,19 @@
+package io.improbable.ste.recast;
+
+import com.sun.jna.Structure;
+
+import java.util.Arrays;
+import java.util.List;
+
+public class HierarchicalGraphStats extends Structure {
+    public int clusters;
+    public int portals;
+    public int intraEdges;
+    public int interEdges;
+    public long memoryBytes;
+
+    @Override
+    protected List<String> getFieldOrder() {
+        return Arrays.asList("clusters", "portals", "intraEdges", "interEdges", "memoryBytes");
+    }
+}
@@ -0,0 +1,6 @@
+package io.improbable.ste.recast;
+
+import com.sun.jna.PointerType;
+
+public class HierarchicalPathfinder extends PointerType {
+}
@@ -0,0 +1,21 @@
+package io.improbable.ste.recast;
+
+import com.sun.jna.Structure;
+
+import java.util.Arrays;
+import java.util.List;
+
+public class PathCacheStats extends Structure {
+    public long hits;
+    public long misses;
+    public long insertions;
+    public long evictions;
+    public long invalidations;
+    public int entries;
+    public int maxEntries;
+
+    @Override
+    protected List<String> getFieldOrder() {
+        return Arrays.asList("hits", "misses", "insertions", "evictions", "invalidations", "entries", "maxEntries");
+    }
+}
@@ -0,0 +1,20 @@
+package io.improbable.ste.recast;
+
+import com.sun.jna.Structure;
+
+import java.util.Arrays;
+import java.util.List;
+
+public class TileCacheStats extends Structure {
+    public long compressedBytes;
+    public long rawBytes;
+    public long rebuiltTiles;
+    public int layers;
+    public int obstacles;
+    public int maxObstacles;
+
+    @Override
+    protected List<String> getFieldOrder() {
+        return Arrays.asList("compressedBytes", "rawBytes", "rebuiltTiles", "layers", "obstacles", "maxObstacles");
+    }
+}
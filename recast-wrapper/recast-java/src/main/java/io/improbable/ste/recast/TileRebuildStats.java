@@ -0,0 +1,21 @@
+package io.improbable.ste.recast;
+
+import com.sun.jna.Structure;
+
+import java.util.Arrays;
+import java.util.List;
+
+public class TileRebuildStats extends Structure {
+    public long queued;
+    public long built;
+    public long applied;
+    public long failures;
+    public long buildNanos;
+    public int pendingTiles;
+    public int readyTiles;
+
+    @Override
+    protected List<String> getFieldOrder() {
+        return Arrays.asList("queued", "built", "applied", "failures", "buildNanos", "pendingTiles", "readyTiles");
+    }
+}
@@ -0,0 +1,25 @@
+package io.improbable.ste.recast;
+
+import com.sun.jna.Structure;
+
+import java.util.Arrays;
+import java.util.List;
+
+public class TileStreamStats extends Structure {
+    public long hits;
+    public long misses;
+    public long evictions;
+    public long loadFailures;
+    public long residentBytes;
+    public long budgetBytes;
+    public long compressedBytes;
+    public int residentTiles;
+    public int pinnedTiles;
+    public int totalTiles;
+
+    @Override
+    protected List<String> getFieldOrder() {
+        return Arrays.asList("hits", "misses", "evictions", "loadFailures", "residentBytes", "budgetBytes",
+                "compressedBytes", "residentTiles", "pinnedTiles", "totalTiles");
+    }
+}
@@ -8,13 +8,26 @@ interface RecastLibrary : Library {
     fun rcContext_create(): RcContext?
     fun rcContext_delete(context: RcContext)
     fun InputGeom_load(rcContext: RcContext, path: String, invertYZ: Boolean): InputGeom?
+    fun InputGeom_delete(geom: InputGeom)
     fun compact_heightfield_create(rcContext: RcContext, rcConfig: RcConfig.ByReference, inputGeom: InputGeom): RcCompactHeightfield?
+    fun compact_heightfield_create_threaded(rcContext: RcContext, rcConfig: RcConfig.ByReference, inputGeom: InputGeom, threads: Int): RcCompactHeightfield?
     fun polymesh_create(rcContext: RcContext, rcConfig: RcConfig.ByReference, rcCompactHeightfield: RcCompactHeightfield): RcPolyMesh.ByReference?
     fun polymesh_detail_create(rcContext: RcContext, rcConfig: RcConfig.ByReference, rcPolyMesh: RcPolyMesh, rcCompactHeightfield: RcCompactHeightfield): RcPolyMeshDetail?
     fun navmesh_data_create(rcContext: RcContext, rcConfig: RcConfig.ByReference, rcPolyMeshDetail: RcPolyMeshDetail, rcPolyMesh: RcPolyMesh, inputGeom: InputGeom, tx: Int, ty: Int, agentHeight: Float, agentRadius: Float, agentMaxClimb: Float): NavMeshDataResult.ByReference?
     fun rcConfig_calc_grid_size(config: RcConfig.ByReference, inputGeom: InputGeom)
     fun navmesh_create(rcContext: RcContext, data: NavMeshDataResult.ByReference): DtNavMesh
+    fun navmesh_create_tiled(rcContext: RcContext, rcConfig: RcConfig.ByReference, inputGeom: InputGeom, agentHeight: Float, agentRadius: Float, agentMaxClimb: Float, threads: Int): DtNavMesh?
     fun navmesh_load_tiled_bin(path: String): DtNavMesh
+    fun navmesh_load_tiled_bin_mapped(path: String): DtNavMesh?
+    fun navmesh_save_compressed(navMesh: DtNavMesh, path: String): Boolean
+    fun navmesh_save(navMesh: DtNavMesh, path: String): Boolean
+    fun navmesh_load(path: String, threads: Int): DtNavMesh?
+    fun navmesh_file_open(path: String): NavMeshFileReader?
+    fun navmesh_file_close(reader: NavMeshFileReader)
+    fun navmesh_file_get_tile_count(reader: NavMeshFileReader): Int
+    fun navmesh_file_get_tile_location(reader: NavMeshFileReader, index: Int, location: IntArray): Boolean
+    fun navmesh_file_find_tile(reader: NavMeshFileReader, x: Int, y: Int, layer: Int): Int
+    fun navmesh_file_read_tile(reader: NavMeshFileReader, index: Int, buffer: ByteArray?, maxSize: Int): Int
     fun navmesh_delete(navMesh: DtNavMesh)
     fun navmesh_query_create(navMesh: DtNavMesh): DtNavMeshQuery
     fun navmesh_query_delete(navQuery: DtNavMeshQuery)
@@ -24,6 +37,83 @@ interface RecastLibrary : Library {
     fun dtQueryFilter_create(): DtQueryFilter
     fun dtQueryFilter_delete(filter: DtQueryFilter)
     fun navmesh_query_get_smooth_path(startPos: Pointer, startRef: DtPolyRef, endPos: Pointer, path: FindPathResult, filter: DtQueryFilter, navMesh: DtNavMesh, navMeshQuery: DtNavMeshQuery): SmoothPathResult.ByReference
+    fun navmesh_query_find_nearest_poly_into(navMeshQuery: DtNavMeshQuery, point: Pointer, halfExtents: Pointer, polyRef: Pointer, nearestPoint: Pointer): DtStatus
+    fun navmesh_query_find_random_point_into(navMeshQuery: DtNavMeshQuery, polyRef: Pointer, point: Pointer): DtStatus
+    fun navmesh_query_find_path_into(navMeshQuery: DtNavMeshQuery, startRef: DtPolyRef, endRef: DtPolyRef, startPos: Pointer, endPos: Pointer, filter: DtQueryFilter?, path: Pointer, maxPath: Int, status: Pointer?): Int
+    fun navmesh_query_get_smooth_path_into(startPos: Pointer, startRef: DtPolyRef, endPos: Pointer, path: Pointer, pathCount: Int, filter: DtQueryFilter?, navMesh: DtNavMesh, navMeshQuery: DtNavMeshQuery, smoothPath: Pointer, maxSmoothPath: Int): Int
+    fun navmesh_query_get_smooth_path_mode_into(startPos: Pointer, startRef: DtPolyRef, endPos: Pointer, path: Pointer, pathCount: Int, filter: DtQueryFilter?, navMesh: DtNavMesh, navMeshQuery: DtNavMeshQuery, mode: Int, sampleSpacing: Float, smoothPath: Pointer, maxSmoothPath: Int): Int
+    fun navmesh_query_init_sliced_find_path(navMeshQuery: DtNavMeshQuery, startRef: DtPolyRef, endRef: DtPolyRef, startPos: Pointer, endPos: Pointer, filter: DtQueryFilter?, options: Int): DtStatus
+    fun navmesh_query_update_sliced_find_path(navMeshQuery: DtNavMeshQuery, maxIter: Int, doneIters: Pointer?): DtStatus
+    fun navmesh_query_finalize_sliced_find_path(navMeshQuery: DtNavMeshQuery, path: Pointer, maxPath: Int, status: Pointer?): Int
+    fun navmesh_query_finalize_sliced_find_path_partial(navMeshQuery: DtNavMeshQuery, existing: Pointer, existingSize: Int, path: Pointer, maxPath: Int, status: Pointer?): Int
+    fun navmesh_query_batch_create(navMesh: DtNavMesh, maxNodes: Int, threads: Int): NavMeshQueryBatch?
+    fun navmesh_query_batch_delete(batch: NavMeshQueryBatch)
+    fun navmesh_query_batch_find_smooth_paths(batch: NavMeshQueryBatch, startPositions: FloatArray, endPositions: FloatArray, count: Int, halfExtents: FloatArray, filter: DtQueryFilter?, results: Array<BatchPathResult>, smoothPaths: FloatArray, maxSmoothPathLen: Int): Int
+    fun navmesh_query_pool_create(navMesh: DtNavMesh, maxNodes: Int, seed: Int): NavMeshQueryPool?
+    fun navmesh_query_pool_delete(pool: NavMeshQueryPool)
+    fun navmesh_query_pool_get_query(pool: NavMeshQueryPool): DtNavMeshQuery?
+    fun navmesh_query_pool_seed_thread(pool: NavMeshQueryPool, seed: Int)
+    fun navmesh_query_pool_find_random_point_into(pool: NavMeshQueryPool, filter: DtQueryFilter?, polyRef: Pointer, point: Pointer): DtStatus
+    fun navmesh_query_pool_find_random_point_around_circle_into(pool: NavMeshQueryPool, startRef: DtPolyRef, centerPos: Pointer, radius: Float, filter: DtQueryFilter?, polyRef: Pointer, point: Pointer): DtStatus
+    fun navmesh_query_pool_find_path_into(pool: NavMeshQueryPool, startRef: DtPolyRef, endRef: DtPolyRef, startPos: Pointer, endPos: Pointer, filter: DtQueryFilter?, path: Pointer, maxPath: Int, status: Pointer?): Int
+    fun navmesh_query_pool_get_thread_count(pool: NavMeshQueryPool): Int
+    fun navmesh_random_sampler_create(navMesh: DtNavMesh, includeFlags: Int, excludeFlags: Int): RandomPointSampler?
+    fun navmesh_random_sampler_delete(sampler: RandomPointSampler)
+    fun navmesh_random_sampler_refresh(sampler: RandomPointSampler): Boolean
+    fun navmesh_random_sampler_sample_into(sampler: RandomPointSampler, seed: Long, counter: Long, count: Int, refs: LongArray, points: FloatArray): Int
+    fun navmesh_random_sampler_get_poly_count(sampler: RandomPointSampler): Int
+    fun navmesh_random_sampler_get_total_area(sampler: RandomPointSampler): Float
+    fun navmesh_stream_open(path: String, budgetBytes: Long): StreamingNavMesh?
+    fun navmesh_stream_delete(stream: StreamingNavMesh)
+    fun navmesh_stream_get_navmesh(stream: StreamingNavMesh): DtNavMesh
+    fun navmesh_stream_touch(stream: StreamingNavMesh, bmin: FloatArray, bmax: FloatArray): Int
+    fun navmesh_stream_pin(stream: StreamingNavMesh, bmin: FloatArray, bmax: FloatArray): Int
+    fun navmesh_stream_unpin(stream: StreamingNavMesh, bmin: FloatArray, bmax: FloatArray): Int
+    fun navmesh_stream_set_budget(stream: StreamingNavMesh, budgetBytes: Long)
+    fun navmesh_stream_get_stats(stream: StreamingNavMesh, stats: TileStreamStats)
+    fun navmesh_stream_reset_stats(stream: StreamingNavMesh)
+    fun navmesh_stream_find_path_into(stream: StreamingNavMesh, navMeshQuery: DtNavMeshQuery, startPos: FloatArray, endPos: FloatArray, halfExtents: FloatArray, filter: DtQueryFilter?, path: Pointer, maxPath: Int, status: Pointer?): Int
+    fun navmesh_path_cache_create(navMesh: DtNavMesh, maxEntries: Int): PathCache?
+    fun navmesh_path_cache_delete(cache: PathCache)
+    fun navmesh_path_cache_find_path_into(cache: PathCache, navMeshQuery: DtNavMeshQuery, startRef: DtPolyRef, endRef: DtPolyRef, startPos: Pointer, endPos: Pointer, filter: DtQueryFilter?, path: Pointer, maxPath: Int, status: Pointer?): Int
+    fun navmesh_path_cache_invalidate_region(cache: PathCache, bmin: FloatArray, bmax: FloatArray): Int
+    fun navmesh_path_cache_clear(cache: PathCache)
+    fun navmesh_path_cache_get_stats(cache: PathCache, stats: PathCacheStats)
+    fun navmesh_path_cache_reset_stats(cache: PathCache)
+    fun navmesh_hierarchy_create(navMesh: DtNavMesh, filter: DtQueryFilter?, threads: Int): HierarchicalPathfinder?
+    fun navmesh_hierarchy_delete(hierarchy: HierarchicalPathfinder)
+    fun navmesh_hierarchy_find_path_into(hierarchy: HierarchicalPathfinder, navMeshQuery: DtNavMeshQuery, startRef: DtPolyRef, endRef: DtPolyRef, startPos: Pointer, endPos: Pointer, path: Pointer, maxPath: Int, status: Pointer?): Int
+    fun navmesh_hierarchy_find_waypoints_into(hierarchy: HierarchicalPathfinder, startRef: DtPolyRef, endRef: DtPolyRef, startPos: Pointer, endPos: Pointer, waypointRefs: Pointer, waypointPositions: Pointer?, maxWaypoints: Int, status: Pointer?): Int
+    fun navmesh_hierarchy_get_stats(hierarchy: HierarchicalPathfinder, stats: HierarchicalGraphStats)
+    fun navmesh_rebuilder_create(rcContext: RcContext, navMesh: DtNavMesh, rcConfig: RcConfig.ByReference, inputGeom: InputGeom, agentHeight: Float, agentRadius: Float, agentMaxClimb: Float, threads: Int): NavMeshRebuilder?
+    fun navmesh_rebuilder_delete(rebuilder: NavMeshRebuilder)
+    fun navmesh_rebuilder_mark_dirty(rebuilder: NavMeshRebuilder, bmin: FloatArray, bmax: FloatArray): Int
+    fun navmesh_rebuilder_add_convex_volume(rebuilder: NavMeshRebuilder, verts: FloatArray, nverts: Int, minh: Float, maxh: Float, area: Int): Int
+    fun navmesh_rebuilder_add_off_mesh_connection(rebuilder: NavMeshRebuilder, spos: FloatArray, epos: FloatArray, radius: Float, bidirectional: Boolean, area: Int, flags: Int): Int
+    fun navmesh_rebuilder_apply(rebuilder: NavMeshRebuilder, bmin: FloatArray?, bmax: FloatArray?): Int
+    fun navmesh_rebuilder_wait(rebuilder: NavMeshRebuilder)
+    fun navmesh_rebuilder_get_stats(rebuilder: NavMeshRebuilder, stats: TileRebuildStats)
+    fun navmesh_tile_cache_create(rcContext: RcContext, rcConfig: RcConfig.ByReference, inputGeom: InputGeom, agentHeight: Float, agentRadius: Float, agentMaxClimb: Float, maxObstacles: Int, threads: Int): NavMeshTileCache?
+    fun navmesh_tile_cache_delete(cache: NavMeshTileCache)
+    fun navmesh_tile_cache_get_navmesh(cache: NavMeshTileCache): DtNavMesh
+    fun navmesh_tile_cache_add_cylinder_obstacle(cache: NavMeshTileCache, pos: Pointer, radius: Float, height: Float): Int
+    fun navmesh_tile_cache_add_box_obstacle(cache: NavMeshTileCache, bmin: FloatArray, bmax: FloatArray): Int
+    fun navmesh_tile_cache_add_oriented_box_obstacle(cache: NavMeshTileCache, center: FloatArray, halfExtents: FloatArray, yRadians: Float): Int
+    fun navmesh_tile_cache_remove_obstacle(cache: NavMeshTileCache, ref: Int): Boolean
+    fun navmesh_tile_cache_update(cache: NavMeshTileCache, budgetMicros: Int): Boolean
+    fun navmesh_tile_cache_get_stats(cache: NavMeshTileCache, stats: TileCacheStats)
+    fun crowd_create(navMesh: DtNavMesh, maxAgents: Int, maxAgentRadius: Float): NavMeshCrowd?
+    fun crowd_delete(crowd: NavMeshCrowd)
+    fun crowd_get_default_agent_config(config: CrowdAgentConfig)
+    fun crowd_add_agent(crowd: NavMeshCrowd, pos: Pointer, config: CrowdAgentConfig?): Int
+    fun crowd_remove_agent(crowd: NavMeshCrowd, index: Int)
+    fun crowd_set_target(crowd: NavMeshCrowd, index: Int, pos: Pointer): Boolean
+    fun crowd_reset_target(crowd: NavMeshCrowd, index: Int): Boolean
+    fun crowd_update(crowd: NavMeshCrowd, dt: Float, states: FloatArray?, maxStates: Int): Int
+    fun crowd_get_active_agent_count(crowd: NavMeshCrowd): Int
+    fun navmesh_metrics_write_prometheus(buffer: ByteArray?, maxLength: Int): Int
+    fun navmesh_metrics_reset()
+    fun build_allocator_install(): Boolean
     fun dtStatus_failed(dtStatus: DtStatus): Boolean
 
     companion object RecastLibrary {
@@ -44,6 +44,43 @@ class Benchmark {
         recast.rcContext_delete(ctx)
     }
 
+    @Test
+    fun ddos_mesh_batched() {
+        val ctx = recast.rcContext_create()
+        val config = createDefaultConfig()
+        val mesh = getMesh(ctx!!)
+        recast.rcConfig_calc_grid_size(config, mesh!!)
+
+        val navMesh = recast.navmesh_create(ctx, createNavMeshData(ctx, config, mesh)!!)
+        val navMeshQuery = recast.navmesh_query_create(navMesh)
+        val batch = recast.navmesh_query_batch_create(navMesh, 0, 0)
+        assertThat(batch, notNullValue())
+
+        val count = 10000
+        val maxSmoothPathLen = 256
+        val startPositions = FloatArray(3 * count)
+        val endPositions = FloatArray(3 * count)
+        for (i in 0 until count) {
+            System.arraycopy(recast.navmesh_query_find_random_point(navMeshQuery).point, 0, startPositions, 3 * i, 3)
+            System.arraycopy(recast.navmesh_query_find_random_point(navMeshQuery).point, 0, endPositions, 3 * i, 3)
+        }
+
+        @Suppress("UNCHECKED_CAST")
+        val results = BatchPathResult().toArray(count) as Array<BatchPathResult>
+        val smoothPaths = FloatArray(3 * maxSmoothPathLen * count)
+        val halfExtents = floatArrayOf(1.0f, 1.0f, 1.0f)
+
+        val time = measureTimeMillis {
+            recast.navmesh_query_batch_find_smooth_paths(batch!!, startPositions, endPositions, count, halfExtents, null, results, smoothPaths, maxSmoothPathLen)
+        }
+        println("Average time (batched): ${time.toDouble() / count}")
+
+        recast.navmesh_query_batch_delete(batch!!)
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_delete(navMesh)
+        recast.rcContext_delete(ctx)
+    }
+
     private fun createNavMeshData(ctx: RcContext, config: RcConfig.ByReference, mesh: InputGeom): NavMeshDataResult.ByReference? {
         val chf = recast.compact_heightfield_create(ctx, config, mesh)!!
         val polymesh = recast.polymesh_create(ctx, config, chf)!!
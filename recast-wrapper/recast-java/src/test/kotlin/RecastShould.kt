@@ -1,9 +1,13 @@
 import com.sun.jna.Memory
 import java.awt.image.BufferedImage
 import java.io.File
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
 import javax.imageio.ImageIO
+import com.natpryce.hamkrest.absent
 import com.natpryce.hamkrest.equalTo
 import com.natpryce.hamkrest.greaterThanOrEqualTo
+import com.natpryce.hamkrest.lessThan
 import com.natpryce.hamkrest.lessThanOrEqualTo
 import com.natpryce.hamkrest.assertion.assertThat
 import com.natpryce.hamkrest.present
@@ -53,6 +57,100 @@ class RecastShould {
         recast.rcContext_delete(ctx!!)
     }
 
+    @Test
+    fun reload_geometry_from_its_cache() {
+        val cache = File(terrainTilePath() + ".geomcache")
+        cache.delete()
+
+        val ctx = recast.rcContext_create()
+        val config = createDefaultConfig()
+        assertThat(getMesh(ctx!!), present())
+        assertThat(cache.exists(), equalTo(true))
+
+        val cachedMesh = getMesh(ctx)
+        recast.rcConfig_calc_grid_size(config, cachedMesh!!)
+        assertThat(createNavMeshData(ctx, config, cachedMesh)!!.size, equalTo(114784))
+        recast.rcContext_delete(ctx)
+    }
+
+    @Test
+    fun rewrite_the_geometry_cache_of_a_changed_obj() {
+        val dir = createTempDir("geomcache")
+        try {
+            val obj = File(terrainTilePath()).copyTo(File(dir, "terrain.obj"))
+            val cache = File(obj.absolutePath + ".geomcache")
+            val ctx = recast.rcContext_create()!!
+            recast.InputGeom_delete(recast.InputGeom_load(ctx, obj.absolutePath, true)!!)
+            val staleCache = cache.readBytes()
+
+            // A copy of the first vertex changes the content but neither the bounds nor the navmesh.
+            obj.appendText(obj.useLines { lines -> lines.first { it.startsWith("v ") } } + "\r\n")
+            val mesh = recast.InputGeom_load(ctx, obj.absolutePath, true)!!
+            val rewritten = cache.readBytes()
+            assertThat(rewritten.contentEquals(staleCache), equalTo(false))
+            // The header records the size of the OBJ it was written from.
+            assertThat(littleEndian(rewritten).getLong(16), equalTo(obj.length()))
+
+            val config = createDefaultConfig()
+            recast.rcConfig_calc_grid_size(config, mesh)
+            assertThat(createNavMeshData(ctx, config, mesh)!!.size, equalTo(114784))
+            recast.InputGeom_delete(mesh)
+            recast.rcContext_delete(ctx)
+        } finally {
+            dir.deleteRecursively()
+        }
+    }
+
+    @Test
+    fun rewrite_a_geometry_cache_with_damaged_contents() {
+        val dir = createTempDir("geomcache")
+        try {
+            val obj = File(terrainTilePath()).copyTo(File(dir, "terrain.obj"))
+            val cache = File(obj.absolutePath + ".geomcache")
+            val ctx = recast.rcContext_create()!!
+            recast.InputGeom_delete(recast.InputGeom_load(ctx, obj.absolutePath, true)!!)
+
+            // The header still matches the OBJ, but the first triangle now points past the vertices.
+            val damaged = littleEndian(cache.readBytes())
+            val trisOffset = damaged.getLong(88).toInt()
+            val firstIndex = damaged.getInt(trisOffset)
+            damaged.putInt(trisOffset, Int.MAX_VALUE)
+            cache.writeBytes(damaged.array())
+
+            val mesh = recast.InputGeom_load(ctx, obj.absolutePath, true)!!
+            assertThat(littleEndian(cache.readBytes()).getInt(trisOffset), equalTo(firstIndex))
+            val config = createDefaultConfig()
+            recast.rcConfig_calc_grid_size(config, mesh)
+            assertThat(createNavMeshData(ctx, config, mesh)!!.size, equalTo(114784))
+            recast.InputGeom_delete(mesh)
+            recast.rcContext_delete(ctx)
+        } finally {
+            dir.deleteRecursively()
+        }
+    }
+
+    @Test
+    fun create_a_tiled_navmesh() {
+        val ctx = recast.rcContext_create()
+        val config = createDefaultConfig().apply {
+            tileSize = Constants.tileSize
+            borderSize = Constants.borderSize
+        }
+        val mesh = getMesh(ctx!!)
+        recast.rcConfig_calc_grid_size(config, mesh!!)
+
+        val navMesh = recast.navmesh_create_tiled(ctx, config, mesh, Constants.agentHeight.toFloat(), Constants.agentRadius.toFloat(), Constants.agentMaxClimb.toFloat(), 0)
+        assertThat(navMesh, present())
+
+        val navMeshQuery = recast.navmesh_query_create(navMesh!!)
+        val randomPoint = recast.navmesh_query_find_random_point(navMeshQuery)
+        assertThat(dtFailed(randomPoint.status), equalTo(false))
+
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_delete(navMesh)
+        recast.rcContext_delete(ctx)
+    }
+
     @Test
     fun do_some_navmesh_queries() {
         val ctx = recast.rcContext_create()
@@ -98,6 +196,462 @@ class RecastShould {
         recast.rcContext_delete(ctx!!)
     }
 
+    @Test
+    fun do_some_navmesh_queries_into_caller_owned_buffers() {
+        val ctx = recast.rcContext_create()
+        val config = createDefaultConfig()
+        val mesh = getMesh(ctx!!)
+        recast.rcConfig_calc_grid_size(config, mesh!!)
+        val navMesh = recast.navmesh_create(ctx, createNavMeshData(ctx, config, mesh)!!)
+        val navMeshQuery = recast.navmesh_query_create(navMesh)
+
+        val maxPath = 256
+        val maxSmoothPath = 2048
+        val polyRef = Memory(8)
+        val status = Memory(4)
+        val start = Memory(3 * 4)
+        val end = Memory(3 * 4)
+        val path = Memory(8L * maxPath)
+        val smoothPath = Memory(3L * 4 * maxSmoothPath)
+
+        for (i in 1..10) {
+            assertThat(dtFailed(recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, start)), equalTo(false))
+            val startRef = polyRef.getLong(0)
+            assertThat(dtFailed(recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, end)), equalTo(false))
+            val endRef = polyRef.getLong(0)
+
+            val pathCount = recast.navmesh_query_find_path_into(navMeshQuery, startRef, endRef, start, end, null, path, maxPath, status)
+            assertThat(dtFailed(status.getInt(0)), equalTo(false))
+            assertThat(pathCount, greaterThanOrEqualTo(1))
+            assertThat(path.getLong(0), equalTo(startRef))
+
+            val smoothPathCount = recast.navmesh_query_get_smooth_path_into(start, startRef, end, path, pathCount, null, navMesh, navMeshQuery, smoothPath, maxSmoothPath)
+            assertThat(smoothPathCount, greaterThanOrEqualTo(1))
+            assertThat(smoothPath.getFloat(0), equalTo(start.getFloat(0)))
+        }
+
+        val halfExtents = Memory(3 * 4)
+        for (i in 0 until 3) halfExtents.setFloat(4L * i, 1.0f)
+        assertThat(dtFailed(recast.navmesh_query_find_nearest_poly_into(navMeshQuery, start, halfExtents, polyRef, end)), equalTo(false))
+        assertThat(polyRef.getLong(0), !equalTo(0L))
+
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_delete(navMesh)
+        recast.rcContext_delete(ctx)
+    }
+
+    @Test
+    fun find_cheaper_smooth_paths_along_the_straight_path() {
+        val navMesh = recast.navmesh_load_tiled_bin(navMeshTiledBinPath())
+        val navMeshQuery = recast.navmesh_query_create(navMesh)
+
+        val followMode = 0
+        val sampledMode = 1
+        val cornersMode = 2
+        val maxPath = 256
+        val maxSmoothPath = 2048
+        val polyRef = Memory(8)
+        val status = Memory(4)
+        val start = Memory(3 * 4)
+        val end = Memory(3 * 4)
+        val path = Memory(8L * maxPath)
+        val followPath = Memory(3L * 4 * maxSmoothPath)
+        val sampledPath = Memory(3L * 4 * maxSmoothPath)
+        val cornersPath = Memory(3L * 4 * maxSmoothPath)
+
+        for (i in 1..10) {
+            recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, start)
+            val startRef = polyRef.getLong(0)
+            recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, end)
+            val endRef = polyRef.getLong(0)
+            val pathCount = recast.navmesh_query_find_path_into(navMeshQuery, startRef, endRef, start, end, null, path, maxPath, status)
+            assertThat(dtFailed(status.getInt(0)), equalTo(false))
+
+            val followCount = recast.navmesh_query_get_smooth_path_mode_into(start, startRef, end, path, pathCount, null, navMesh, navMeshQuery, followMode, 0.0f, followPath, maxSmoothPath)
+            val sampledCount = recast.navmesh_query_get_smooth_path_mode_into(start, startRef, end, path, pathCount, null, navMesh, navMeshQuery, sampledMode, 2.0f, sampledPath, maxSmoothPath)
+            val cornersCount = recast.navmesh_query_get_smooth_path_mode_into(start, startRef, end, path, pathCount, null, navMesh, navMeshQuery, cornersMode, 0.0f, cornersPath, maxSmoothPath)
+            assertThat(cornersCount, greaterThanOrEqualTo(1))
+            assertThat(sampledCount, greaterThanOrEqualTo(cornersCount))
+            assertThat(followCount, greaterThanOrEqualTo(cornersCount))
+
+            // All modes start at the same point on the mesh.
+            assertThat(Math.abs(sampledPath.getFloat(0) - followPath.getFloat(0)), lessThanOrEqualTo(0.01f))
+            assertThat(Math.abs(cornersPath.getFloat(8) - followPath.getFloat(8)), lessThanOrEqualTo(0.01f))
+        }
+
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_delete(navMesh)
+    }
+
+    @Test
+    fun query_from_many_threads_with_a_query_pool() {
+        val navMesh = recast.navmesh_load_tiled_bin(navMeshTiledBinPath())
+        val pool = recast.navmesh_query_pool_create(navMesh, 0, 42)
+        assertThat(pool, present())
+
+        val threadCount = 4
+        val pointsPerThread = 50
+        val points = Array(threadCount) { FloatArray(3 * pointsPerThread) }
+        val failures = IntArray(threadCount)
+        val threads = (0 until threadCount).map { t ->
+            Thread {
+                recast.navmesh_query_pool_seed_thread(pool!!, t)
+                val polyRef = Memory(8)
+                val status = Memory(4)
+                val start = Memory(3 * 4)
+                val end = Memory(3 * 4)
+                val path = Memory(8L * 256)
+                recast.navmesh_query_pool_find_random_point_into(pool, null, polyRef, start)
+                val startRef = polyRef.getLong(0)
+                for (i in 0 until pointsPerThread) {
+                    if (dtFailed(recast.navmesh_query_pool_find_random_point_into(pool, null, polyRef, end))) failures[t]++
+                    end.read(0, points[t], 3 * i, 3)
+                    recast.navmesh_query_pool_find_path_into(pool, startRef, polyRef.getLong(0), start, end, null, path, 256, status)
+                    if (dtFailed(status.getInt(0))) failures[t]++
+                }
+            }
+        }
+        threads.forEach { it.start() }
+        threads.forEach { it.join() }
+
+        assertThat(recast.navmesh_query_pool_get_thread_count(pool!!), greaterThanOrEqualTo(threadCount))
+        assertThat(failures.sum(), equalTo(0))
+
+        // The same seed draws the same points on any thread.
+        val polyRef = Memory(8)
+        val point = Memory(3 * 4)
+        for (t in 0 until threadCount) {
+            recast.navmesh_query_pool_seed_thread(pool, t)
+            recast.navmesh_query_pool_find_random_point_into(pool, null, polyRef, point)
+            for (i in 0 until pointsPerThread) {
+                recast.navmesh_query_pool_find_random_point_into(pool, null, polyRef, point)
+                assertThat(point.getFloat(0), equalTo(points[t][3 * i]))
+                assertThat(point.getFloat(8), equalTo(points[t][3 * i + 2]))
+            }
+        }
+
+        recast.navmesh_query_pool_delete(pool)
+        recast.navmesh_delete(navMesh)
+    }
+
+    @Test
+    fun sample_random_points_from_a_prebuilt_table() {
+        val navMesh = recast.navmesh_load_tiled_bin(navMeshTiledBinPath())
+        val sampler = recast.navmesh_random_sampler_create(navMesh, 0xffff, 0)
+        assertThat(sampler, present())
+        assertThat(recast.navmesh_random_sampler_get_poly_count(sampler!!), greaterThanOrEqualTo(1))
+        assertThat(recast.navmesh_random_sampler_get_total_area(sampler), greaterThanOrEqualTo(1.0f))
+
+        val count = 1000
+        val refs = LongArray(count)
+        val points = FloatArray(3 * count)
+        assertThat(recast.navmesh_random_sampler_sample_into(sampler, 7, 0, count, refs, points), equalTo(count))
+        assertThat(refs.all { it != 0L }, equalTo(true))
+        assertThat(refs.distinct().size, greaterThanOrEqualTo(count / 10))
+
+        // Points depend only on the seed and their counter, so a batch can be drawn in parts.
+        val partRefs = LongArray(100)
+        val partPoints = FloatArray(3 * 100)
+        recast.navmesh_random_sampler_sample_into(sampler, 7, 500, 100, partRefs, partPoints)
+        for (i in 0 until 100) {
+            assertThat(partRefs[i], equalTo(refs[500 + i]))
+            assertThat(partPoints[3 * i + 1], equalTo(points[3 * (500 + i) + 1]))
+        }
+
+        assertThat(recast.navmesh_random_sampler_refresh(sampler), equalTo(false))
+
+        recast.navmesh_random_sampler_delete(sampler)
+        recast.navmesh_delete(navMesh)
+    }
+
+    @Test
+    fun refuse_the_build_allocator_once_the_defaults_allocated() {
+        // Whichever tests ran before, this navmesh went through the default allocators.
+        val navMesh = recast.navmesh_load_tiled_bin(navMeshTiledBinPath())
+        assertThat(recast.build_allocator_install(), equalTo(false))
+        recast.navmesh_delete(navMesh)
+    }
+
+    @Test
+    fun export_build_and_query_metrics() {
+        recast.navmesh_metrics_reset()
+
+        val ctx = recast.rcContext_create()
+        val config = createDefaultConfig()
+        val mesh = getMesh(ctx!!)
+        recast.rcConfig_calc_grid_size(config, mesh!!)
+        val navMesh = recast.navmesh_create(ctx, createNavMeshData(ctx, config, mesh)!!)
+        val navMeshQuery = recast.navmesh_query_create(navMesh)
+
+        val maxPath = 256
+        val polyRef = Memory(8)
+        val start = Memory(3 * 4)
+        val end = Memory(3 * 4)
+        val path = Memory(8L * maxPath)
+        recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, start)
+        val startRef = polyRef.getLong(0)
+        recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, end)
+        val pathCount = recast.navmesh_query_find_path_into(navMeshQuery, startRef, polyRef.getLong(0), start, end, null, path, maxPath, null)
+        assertThat(pathCount, greaterThanOrEqualTo(1))
+
+        val length = recast.navmesh_metrics_write_prometheus(null, 0)
+        val buffer = ByteArray(length + 1)
+        assertThat(recast.navmesh_metrics_write_prometheus(buffer, buffer.size), equalTo(length))
+        val metrics = String(buffer, 0, length, Charsets.UTF_8)
+
+        for (stage in listOf("rasterize", "compact", "erode", "distance_field", "regions", "contours", "polymesh", "detail", "detour_data")) {
+            assertThat(metricValue(metrics, "recast_build_stage_duration_seconds_count{stage=\"$stage\"}"), greaterThanOrEqualTo(1.0))
+        }
+        assertThat(metricValue(metrics, "recast_query_duration_seconds_count{query=\"find_random_point\"}"), greaterThanOrEqualTo(2.0))
+        assertThat(metricValue(metrics, "recast_query_duration_seconds_count{query=\"find_path\"}"), greaterThanOrEqualTo(1.0))
+        assertThat(metricValue(metrics, "recast_query_nodes_expanded_total{query=\"find_path\"}"), greaterThanOrEqualTo(1.0))
+        assertThat(metricValue(metrics, "recast_navmesh_tile_bytes"), greaterThanOrEqualTo(114784.0))
+
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_delete(navMesh)
+        recast.rcContext_delete(ctx)
+    }
+
+    @Test
+    fun rasterize_in_parallel_like_in_serial() {
+        val ctx = recast.rcContext_create()!!
+        val config = createDefaultConfig()
+        val mesh = getMesh(ctx)!!
+        recast.rcConfig_calc_grid_size(config, mesh)
+
+        val serial = createNavMeshData(ctx, config, mesh, 1)!!
+        val parallel = createNavMeshData(ctx, config, mesh, 4)!!
+
+        assertThat(parallel.size, equalTo(serial.size))
+        assertThat(parallel.data.getByteArray(0, parallel.size).contentEquals(serial.data.getByteArray(0, serial.size)), equalTo(true))
+        recast.rcContext_delete(ctx)
+    }
+
+    @Test
+    fun rebuild_the_tiles_under_a_convex_volume() {
+        val ctx = recast.rcContext_create()!!
+        val config = createDefaultConfig().apply {
+            tileSize = Constants.tileSize
+            borderSize = Constants.borderSize
+        }
+        val mesh = getMesh(ctx)!!
+        recast.rcConfig_calc_grid_size(config, mesh)
+        val navMesh = recast.navmesh_create_tiled(ctx, config, mesh, Constants.agentHeight.toFloat(), Constants.agentRadius.toFloat(), Constants.agentMaxClimb.toFloat(), 0)!!
+        val navMeshQuery = recast.navmesh_query_create(navMesh)
+        val rebuilder = recast.navmesh_rebuilder_create(ctx, navMesh, config, mesh, Constants.agentHeight.toFloat(), Constants.agentRadius.toFloat(), Constants.agentMaxClimb.toFloat(), 0)!!
+
+        val polyRef = Memory(8)
+        val point = Memory(3 * 4)
+        assertThat(dtFailed(recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, point)), equalTo(false))
+        val x = point.getFloat(0)
+        val y = point.getFloat(4)
+        val z = point.getFloat(8)
+
+        // A volume with the null area cuts a hole into the navmesh.
+        val volume = floatArrayOf(x - 2, y, z - 2, x + 2, y, z - 2, x + 2, y, z + 2, x - 2, y, z + 2)
+        assertThat(recast.navmesh_rebuilder_add_convex_volume(rebuilder, volume, 4, y - 5, y + 5, 0), greaterThanOrEqualTo(1))
+        recast.navmesh_rebuilder_wait(rebuilder)
+
+        val bmin = FloatArray(3)
+        val bmax = FloatArray(3)
+        val applied = recast.navmesh_rebuilder_apply(rebuilder, bmin, bmax)
+        assertThat(applied, greaterThanOrEqualTo(1))
+        assertThat(bmin[0], lessThanOrEqualTo(x - 2))
+        assertThat(bmax[2], greaterThanOrEqualTo(z + 2))
+
+        val halfExtents = Memory(3 * 4)
+        halfExtents.setFloat(0, 0.5f)
+        halfExtents.setFloat(4, 2.0f)
+        halfExtents.setFloat(8, 0.5f)
+        // Nothing is left under the point, so the lookup fails and leaves no poly.
+        assertThat(dtFailed(recast.navmesh_query_find_nearest_poly_into(navMeshQuery, point, halfExtents, polyRef, Memory(3 * 4))), equalTo(true))
+        assertThat(polyRef.getLong(0), equalTo(0L))
+
+        val stats = TileRebuildStats()
+        recast.navmesh_rebuilder_get_stats(rebuilder, stats)
+        assertThat(stats.applied, equalTo(applied.toLong()))
+        assertThat(stats.pendingTiles, equalTo(0))
+        assertThat(stats.readyTiles, equalTo(0))
+
+        recast.navmesh_rebuilder_delete(rebuilder)
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_delete(navMesh)
+        recast.rcContext_delete(ctx)
+    }
+
+    @Test
+    fun keep_every_convex_volume_past_256() {
+        val ctx = recast.rcContext_create()!!
+        val config = createDefaultConfig().apply {
+            tileSize = Constants.tileSize
+            borderSize = Constants.borderSize
+        }
+        val mesh = getMesh(ctx)!!
+        recast.rcConfig_calc_grid_size(config, mesh)
+        val navMesh = recast.navmesh_create_tiled(ctx, config, mesh, Constants.agentHeight.toFloat(), Constants.agentRadius.toFloat(), Constants.agentMaxClimb.toFloat(), 0)!!
+        val navMeshQuery = recast.navmesh_query_create(navMesh)
+        val rebuilder = recast.navmesh_rebuilder_create(ctx, navMesh, config, mesh, Constants.agentHeight.toFloat(), Constants.agentRadius.toFloat(), Constants.agentMaxClimb.toFloat(), 0)!!
+
+        val waterArea = 1   // SAMPLE_POLYAREA_WATER
+        val swimFlag = 0x02 // SAMPLE_POLYFLAGS_SWIM
+        val bmin = config.bmin
+        for (i in 0 until 299) {
+            val x = bmin[0] + (i % 20) * 2
+            val z = bmin[2] + (i / 20) * 2
+            val volume = floatArrayOf(x, 0f, z, x + 1, 0f, z, x + 1, 0f, z + 1, x, 0f, z + 1)
+            assertThat(recast.navmesh_rebuilder_add_convex_volume(rebuilder, volume, 4, bmin[1], config.bmax[1], waterArea), greaterThanOrEqualTo(1))
+        }
+
+        // The last volume lies on walkable ground and is big enough to keep its own region.
+        val point = Memory(3 * 4)
+        assertThat(dtFailed(recast.navmesh_query_find_random_point_into(navMeshQuery, Memory(8), point)), equalTo(false))
+        val x = point.getFloat(0)
+        val y = point.getFloat(4)
+        val z = point.getFloat(8)
+        val last = floatArrayOf(x - 4, y, z - 4, x + 4, y, z - 4, x + 4, y, z + 4, x - 4, y, z + 4)
+        assertThat(recast.navmesh_rebuilder_add_convex_volume(rebuilder, last, 4, y - 5, y + 5, waterArea), greaterThanOrEqualTo(1))
+        assertThat(recast.navmesh_rebuilder_add_convex_volume(rebuilder, FloatArray(6), 2, 0f, 1f, 0), equalTo(-1))
+        recast.navmesh_rebuilder_wait(rebuilder)
+        assertThat(recast.navmesh_rebuilder_apply(rebuilder, FloatArray(3), FloatArray(3)), greaterThanOrEqualTo(1))
+
+        // Water polys only get the swim flag, so swim-only samples land under a volume; some under the 300th.
+        val sampler = recast.navmesh_random_sampler_create(navMesh, swimFlag, 0)!!
+        val count = 1000
+        val points = FloatArray(3 * count)
+        assertThat(recast.navmesh_random_sampler_sample_into(sampler, 7, 0, count, LongArray(count), points), equalTo(count))
+        val underLast = (0 until count).count {
+            points[3 * it] in (x - 4)..(x + 4) && points[3 * it + 2] in (z - 4)..(z + 4)
+        }
+        assertThat(underLast, greaterThanOrEqualTo(1))
+
+        recast.navmesh_random_sampler_delete(sampler)
+        recast.navmesh_rebuilder_delete(rebuilder)
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_delete(navMesh)
+        recast.rcContext_delete(ctx)
+    }
+
+    @Test
+    fun keep_a_convex_volume_too_large_for_the_markup_grid() {
+        val ctx = recast.rcContext_create()!!
+        val config = createDefaultConfig().apply {
+            tileSize = Constants.tileSize
+            borderSize = Constants.borderSize
+        }
+        val mesh = getMesh(ctx)!!
+        recast.rcConfig_calc_grid_size(config, mesh)
+        val navMesh = recast.navmesh_create_tiled(ctx, config, mesh, Constants.agentHeight.toFloat(), Constants.agentRadius.toFloat(), Constants.agentMaxClimb.toFloat(), 0)!!
+        val rebuilder = recast.navmesh_rebuilder_create(ctx, navMesh, config, mesh, Constants.agentHeight.toFloat(), Constants.agentRadius.toFloat(), Constants.agentMaxClimb.toFloat(), 0)!!
+
+        // 400 km across, far more than the grid lists in cells, so every tile has to find it in the overflow.
+        val waterArea = 1   // SAMPLE_POLYAREA_WATER
+        val walkFlag = 0x01 // SAMPLE_POLYFLAGS_WALK
+        val swimFlag = 0x02 // SAMPLE_POLYFLAGS_SWIM
+        val x = config.bmin[0]
+        val z = config.bmin[2]
+        val r = 200000f
+        val volume = floatArrayOf(x - r, 0f, z - r, x + r, 0f, z - r, x + r, 0f, z + r, x - r, 0f, z + r)
+        assertThat(recast.navmesh_rebuilder_add_convex_volume(rebuilder, volume, 4, config.bmin[1] - 1, config.bmax[1] + 1, waterArea), greaterThanOrEqualTo(1))
+        recast.navmesh_rebuilder_wait(rebuilder)
+        assertThat(recast.navmesh_rebuilder_apply(rebuilder, FloatArray(3), FloatArray(3)), greaterThanOrEqualTo(1))
+
+        val walkable = recast.navmesh_random_sampler_create(navMesh, walkFlag, 0)!!
+        assertThat(recast.navmesh_random_sampler_get_poly_count(walkable), equalTo(0))
+        val swimmable = recast.navmesh_random_sampler_create(navMesh, swimFlag, 0)!!
+        assertThat(recast.navmesh_random_sampler_get_poly_count(swimmable), greaterThanOrEqualTo(1))
+
+        recast.navmesh_random_sampler_delete(swimmable)
+        recast.navmesh_random_sampler_delete(walkable)
+        recast.navmesh_rebuilder_delete(rebuilder)
+        recast.navmesh_delete(navMesh)
+        recast.rcContext_delete(ctx)
+    }
+
+    @Test
+    fun carve_and_remove_a_temporary_obstacle() {
+        val ctx = recast.rcContext_create()!!
+        val config = createDefaultConfig().apply {
+            tileSize = Constants.tileSize
+            borderSize = Constants.borderSize
+        }
+        val mesh = getMesh(ctx)!!
+        recast.rcConfig_calc_grid_size(config, mesh)
+        val cache = recast.navmesh_tile_cache_create(ctx, config, mesh, Constants.agentHeight.toFloat(), Constants.agentRadius.toFloat(), Constants.agentMaxClimb.toFloat(), 64, 0)!!
+        val navMeshQuery = recast.navmesh_query_create(recast.navmesh_tile_cache_get_navmesh(cache))
+
+        val polyRef = Memory(8)
+        val point = Memory(3 * 4)
+        assertThat(dtFailed(recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, point)), equalTo(false))
+        val halfExtents = Memory(3 * 4)
+        halfExtents.setFloat(0, 0.1f)
+        halfExtents.setFloat(4, 2.0f)
+        halfExtents.setFloat(8, 0.1f)
+
+        val obstacle = recast.navmesh_tile_cache_add_cylinder_obstacle(cache, point, 2.0f, 4.0f)
+        assertThat(obstacle, !equalTo(0))
+        while (!recast.navmesh_tile_cache_update(cache, 1000)) {
+        }
+        assertThat(dtFailed(recast.navmesh_query_find_nearest_poly_into(navMeshQuery, point, halfExtents, polyRef, Memory(3 * 4))), equalTo(true))
+        assertThat(polyRef.getLong(0), equalTo(0L))
+
+        val stats = TileCacheStats()
+        recast.navmesh_tile_cache_get_stats(cache, stats)
+        assertThat(stats.obstacles, equalTo(1))
+        assertThat(stats.rebuiltTiles, greaterThanOrEqualTo(1L))
+        assertThat(stats.compressedBytes, lessThan(stats.rawBytes))
+
+        assertThat(recast.navmesh_tile_cache_remove_obstacle(cache, obstacle), equalTo(true))
+        while (!recast.navmesh_tile_cache_update(cache, 1000)) {
+        }
+        assertThat(dtFailed(recast.navmesh_query_find_nearest_poly_into(navMeshQuery, point, halfExtents, polyRef, Memory(3 * 4))), equalTo(false))
+        assertThat(polyRef.getLong(0), !equalTo(0L))
+
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_tile_cache_delete(cache)
+        recast.rcContext_delete(ctx)
+    }
+
+    @Test
+    fun find_paths_in_a_batch() {
+        val ctx = recast.rcContext_create()
+        val config = createDefaultConfig()
+        val mesh = getMesh(ctx!!)
+        recast.rcConfig_calc_grid_size(config, mesh!!)
+        val navMesh = recast.navmesh_create(ctx, createNavMeshData(ctx, config, mesh)!!)
+        val navMeshQuery = recast.navmesh_query_create(navMesh)
+
+        val count = 64
+        val maxSmoothPathLen = 256
+        val startPositions = FloatArray(3 * count)
+        val endPositions = FloatArray(3 * count)
+        for (i in 0 until count) {
+            val start = recast.navmesh_query_find_random_point(navMeshQuery)
+            val end = recast.navmesh_query_find_random_point(navMeshQuery)
+            System.arraycopy(start.point, 0, startPositions, 3 * i, 3)
+            System.arraycopy(end.point, 0, endPositions, 3 * i, 3)
+        }
+
+        val batch = recast.navmesh_query_batch_create(navMesh, 0, 0)
+        assertThat(batch, present())
+
+        @Suppress("UNCHECKED_CAST")
+        val results = BatchPathResult().toArray(count) as Array<BatchPathResult>
+        val smoothPaths = FloatArray(3 * maxSmoothPathLen * count)
+        val found = recast.navmesh_query_batch_find_smooth_paths(batch!!, startPositions, endPositions, count, floatArrayOf(1.0f, 1.0f, 1.0f), null, results, smoothPaths, maxSmoothPathLen)
+
+        assertThat(found, equalTo(count))
+        for (i in 0 until count) {
+            assertThat(dtFailed(results[i].status), equalTo(false))
+            assertThat(results[i].smoothPathCount, greaterThanOrEqualTo(1))
+            assertThat(smoothPaths[3 * maxSmoothPathLen * i], equalTo(startPositions[3 * i]))
+        }
+
+        recast.navmesh_query_batch_delete(batch)
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_delete(navMesh)
+        recast.rcContext_delete(ctx)
+    }
+
     @Test
     fun load_tiled_mesh() {
         val navMesh = recast.navmesh_load_tiled_bin(navMeshTiledBinPath())
@@ -133,6 +687,438 @@ class RecastShould {
         recast.navmesh_delete(navMesh)
     }
 
+    @Test
+    fun load_tiled_mesh_mapped() {
+        val navMesh = recast.navmesh_load_tiled_bin(navMeshTiledBinPath())
+        val mappedNavMesh = recast.navmesh_load_tiled_bin_mapped(navMeshTiledBinPath())
+        assertThat(mappedNavMesh, present())
+
+        val navMeshQuery = recast.navmesh_query_create(navMesh)
+        val mappedNavMeshQuery = recast.navmesh_query_create(mappedNavMesh!!)
+
+        val point = Memory(3 * 4)
+        point.setFloat(0, -380f)
+        point.setFloat(4, 110f)
+        point.setFloat(8, -240f)
+        val halfExtents = Memory(3 * 4)
+        for (i in 0 until 3) halfExtents.setFloat(4L * i, 50.0f)
+
+        val result = recast.navmesh_query_find_nearest_poly(navMeshQuery, point, halfExtents)
+        val mappedResult = recast.navmesh_query_find_nearest_poly(mappedNavMeshQuery, point, halfExtents)
+        assertThat(dtSuccess(mappedResult.status), equalTo(true))
+        assertThat(mappedResult.polyRef, equalTo(result.polyRef))
+        assertWithinLimits(mappedResult)
+
+        recast.navmesh_query_delete(mappedNavMeshQuery)
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_delete(mappedNavMesh)
+        recast.navmesh_delete(navMesh)
+    }
+
+    @Test
+    fun save_and_load_an_indexed_navmesh() {
+        val navMesh = recast.navmesh_load_tiled_bin(navMeshTiledBinPath())
+        val file = File.createTempFile("navmesh", ".tiled.bin64")
+        file.deleteOnExit()
+        assertThat(recast.navmesh_save(navMesh, file.absolutePath), equalTo(true))
+
+        val loaded = recast.navmesh_load(file.absolutePath, 0)
+        assertThat(loaded, present())
+        val mapped = recast.navmesh_load_tiled_bin_mapped(file.absolutePath)
+        assertThat(mapped, present())
+
+        val point = Memory(3 * 4)
+        point.setFloat(0, -380f)
+        point.setFloat(4, 110f)
+        point.setFloat(8, -240f)
+        val halfExtents = Memory(3 * 4)
+        for (i in 0 until 3) halfExtents.setFloat(4L * i, 50.0f)
+
+        val queries = listOf(navMesh, loaded!!, mapped!!).map { recast.navmesh_query_create(it) }
+        val results = queries.map { recast.navmesh_query_find_nearest_poly(it, point, halfExtents) }
+        assertThat(dtSuccess(results[1].status), equalTo(true))
+        assertThat(results[1].polyRef, equalTo(results[0].polyRef))
+        assertThat(results[2].polyRef, equalTo(results[0].polyRef))
+        queries.forEach { recast.navmesh_query_delete(it) }
+        recast.navmesh_delete(mapped)
+        recast.navmesh_delete(loaded)
+
+        // Single tiles are found by grid location and read without the rest.
+        val reader = recast.navmesh_file_open(file.absolutePath)!!
+        val last = recast.navmesh_file_get_tile_count(reader) - 1
+        assertThat(last, greaterThanOrEqualTo(0))
+        val location = IntArray(3)
+        assertThat(recast.navmesh_file_get_tile_location(reader, last, location), equalTo(true))
+        assertThat(recast.navmesh_file_find_tile(reader, location[0], location[1], location[2]), equalTo(last))
+        assertThat(recast.navmesh_file_find_tile(reader, location[0], location[1], location[2] + 100), equalTo(-1))
+        val size = recast.navmesh_file_read_tile(reader, last, null, 0)
+        val tile = ByteArray(size)
+        assertThat(recast.navmesh_file_read_tile(reader, last, tile, size), equalTo(size))
+        // Every tile starts with DT_NAVMESH_MAGIC, 'DNAV' stored little endian.
+        assertThat(String(tile, 0, 4, Charsets.US_ASCII), equalTo("VAND"))
+        recast.navmesh_file_close(reader)
+
+        // Flipping a byte of the last tile fails its checksum.
+        val bytes = file.readBytes()
+        bytes[bytes.size - 1] = (bytes[bytes.size - 1].toInt() xor 0xff).toByte()
+        file.writeBytes(bytes)
+        assertThat(recast.navmesh_load(file.absolutePath, 0), absent())
+        val damaged = recast.navmesh_file_open(file.absolutePath)!!
+        assertThat(recast.navmesh_file_read_tile(damaged, last, tile, size), equalTo(-1))
+        recast.navmesh_file_close(damaged)
+
+        recast.navmesh_delete(navMesh)
+    }
+
+    @Test
+    fun stream_compressed_tiles() {
+        val navMesh = recast.navmesh_load_tiled_bin(navMeshTiledBinPath())
+        val compressedFile = File.createTempFile("navmesh", ".tiled.bin64")
+        compressedFile.deleteOnExit()
+        assertThat(recast.navmesh_save_compressed(navMesh, compressedFile.absolutePath), equalTo(true))
+        assertThat(compressedFile.length(), lessThan(File(navMeshTiledBinPath()).length()))
+
+        val stream = recast.navmesh_stream_open(compressedFile.absolutePath, 0)!!
+        val stats = TileStreamStats()
+        recast.navmesh_stream_get_stats(stream, stats)
+        assertThat(stats.residentTiles, equalTo(0))
+        assertThat(stats.compressedBytes, greaterThanOrEqualTo(1L))
+
+        // Only the tiles a query reaches into have to be decompressed.
+        val point = floatArrayOf(-380f, 110f, -240f)
+        val bmin = FloatArray(3) { point[it] - 50.0f }
+        val bmax = FloatArray(3) { point[it] + 50.0f }
+        assertThat(recast.navmesh_stream_touch(stream, bmin, bmax), greaterThanOrEqualTo(1))
+
+        val pointMemory = Memory(3 * 4)
+        val halfExtents = Memory(3 * 4)
+        for (i in 0 until 3) {
+            pointMemory.setFloat(4L * i, point[i])
+            halfExtents.setFloat(4L * i, 50.0f)
+        }
+        val navMeshQuery = recast.navmesh_query_create(navMesh)
+        val streamQuery = recast.navmesh_query_create(recast.navmesh_stream_get_navmesh(stream))
+        val result = recast.navmesh_query_find_nearest_poly(navMeshQuery, pointMemory, halfExtents)
+        val streamResult = recast.navmesh_query_find_nearest_poly(streamQuery, pointMemory, halfExtents)
+        assertThat(dtSuccess(streamResult.status), equalTo(true))
+        assertThat(streamResult.polyRef, equalTo(result.polyRef))
+        assertWithinLimits(streamResult)
+
+        recast.navmesh_query_delete(streamQuery)
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_stream_delete(stream)
+        recast.navmesh_delete(navMesh)
+    }
+
+    @Test
+    fun stream_tiles_under_a_budget() {
+        val stream = recast.navmesh_stream_open(navMeshTiledBinPath(), 0)
+        assertThat(stream, present())
+
+        val stats = TileStreamStats()
+        recast.navmesh_stream_get_stats(stream!!, stats)
+        assertThat(stats.residentTiles, equalTo(0))
+        val totalTiles = stats.totalTiles
+
+        val everywhere = floatArrayOf(-1.0e6f, -1.0e6f, -1.0e6f) to floatArrayOf(1.0e6f, 1.0e6f, 1.0e6f)
+        assertThat(recast.navmesh_stream_touch(stream, everywhere.first, everywhere.second), equalTo(totalTiles))
+        recast.navmesh_stream_get_stats(stream, stats)
+        assertThat(stats.misses, equalTo(totalTiles.toLong()))
+        val allBytes = stats.residentBytes
+
+        val navMeshQuery = recast.navmesh_query_create(recast.navmesh_stream_get_navmesh(stream))
+        val path = Memory(8L * 256)
+        val status = Memory(4)
+        val start = floatArrayOf(-373.413f, 107.4798f, -271.1656f)
+        val end = floatArrayOf(-370.4435f, 100.7469f, -221.2217f)
+        val halfExtents = floatArrayOf(2.0f, 4.0f, 2.0f)
+
+        // Shrink the budget so only the tiles a query touches stay resident.
+        recast.navmesh_stream_set_budget(stream, allBytes / 4)
+        recast.navmesh_stream_get_stats(stream, stats)
+        assertThat(stats.residentBytes, lessThanOrEqualTo(allBytes / 4))
+        assertThat(stats.evictions, greaterThanOrEqualTo(1L))
+
+        val pathCount = recast.navmesh_stream_find_path_into(stream, navMeshQuery, start, end, halfExtents, null, path, 256, status)
+        assertThat(dtFailed(status.getInt(0)), equalTo(false))
+        assertThat(pathCount, greaterThanOrEqualTo(1))
+
+        recast.navmesh_stream_pin(stream, start, start)
+        recast.navmesh_stream_get_stats(stream, stats)
+        assertThat(stats.pinnedTiles, greaterThanOrEqualTo(1))
+        assertThat(stats.hits, greaterThanOrEqualTo(1L))
+
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_stream_delete(stream)
+    }
+
+    @Test
+    fun find_paths_a_slice_at_a_time() {
+        val navMesh = recast.navmesh_load_tiled_bin(navMeshTiledBinPath())
+        val navMeshQuery = recast.navmesh_query_create(navMesh)
+
+        val maxPath = 256
+        val polyRef = Memory(8)
+        val status = Memory(4)
+        val doneIters = Memory(4)
+        val start = Memory(3 * 4)
+        val end = Memory(3 * 4)
+        val path = Memory(8L * maxPath)
+        val slicedPath = Memory(8L * maxPath)
+
+        val partialResult = 1.shl(6)
+        val inProgress = 1.shl(29)
+        var startRef = 0L
+        var endRef = 0L
+        var pathCount = 0
+        for (i in 1..20) {
+            recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, start)
+            startRef = polyRef.getLong(0)
+            recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, end)
+            endRef = polyRef.getLong(0)
+            pathCount = recast.navmesh_query_find_path_into(navMeshQuery, startRef, endRef, start, end, null, path, maxPath, status)
+            if (!dtFailed(status.getInt(0)) && status.getInt(0).and(partialResult) == 0 && pathCount > 1) break
+        }
+        assertThat(status.getInt(0).and(partialResult), equalTo(0))
+
+        val maxIter = 4
+        var sliceStatus = recast.navmesh_query_init_sliced_find_path(navMeshQuery, startRef, endRef, start, end, null, 0)
+        while (sliceStatus.and(inProgress) != 0) {
+            sliceStatus = recast.navmesh_query_update_sliced_find_path(navMeshQuery, maxIter, doneIters)
+            assertThat(doneIters.getInt(0), lessThanOrEqualTo(maxIter))
+        }
+        assertThat(dtFailed(sliceStatus), equalTo(false))
+
+        val slicedCount = recast.navmesh_query_finalize_sliced_find_path(navMeshQuery, slicedPath, maxPath, status)
+        assertThat(slicedCount, equalTo(pathCount))
+        assertThat(slicedPath.getLong(8L * (slicedCount - 1)), equalTo(endRef))
+
+        // A search cut short after one slice still yields the best corridor found so far.
+        recast.navmesh_query_init_sliced_find_path(navMeshQuery, startRef, endRef, start, end, null, 0)
+        recast.navmesh_query_update_sliced_find_path(navMeshQuery, 1, doneIters)
+        val existing = Memory(8)
+        existing.setLong(0, startRef)
+        val partialCount = recast.navmesh_query_finalize_sliced_find_path_partial(navMeshQuery, existing, 1, slicedPath, maxPath, status)
+        assertThat(dtFailed(status.getInt(0)), equalTo(false))
+        assertThat(partialCount, greaterThanOrEqualTo(1))
+        assertThat(slicedPath.getLong(0), equalTo(startRef))
+
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_delete(navMesh)
+    }
+
+    @Test
+    fun answer_repeated_paths_from_the_cache() {
+        val navMesh = recast.navmesh_load_tiled_bin(navMeshTiledBinPath())
+        val navMeshQuery = recast.navmesh_query_create(navMesh)
+        val cache = recast.navmesh_path_cache_create(navMesh, 64)
+        assertThat(cache, present())
+
+        val maxPath = 256
+        val polyRef = Memory(8)
+        val status = Memory(4)
+        val start = Memory(3 * 4)
+        val end = Memory(3 * 4)
+        val path = Memory(8L * maxPath)
+        val cachedPath = Memory(8L * maxPath)
+
+        // Only complete corridors are cached, so look for a pair of points that are connected.
+        val partialResult = 1.shl(6)
+        var startRef = 0L
+        var endRef = 0L
+        var pathCount = 0
+        for (i in 1..20) {
+            recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, start)
+            startRef = polyRef.getLong(0)
+            recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, end)
+            endRef = polyRef.getLong(0)
+            pathCount = recast.navmesh_query_find_path_into(navMeshQuery, startRef, endRef, start, end, null, path, maxPath, status)
+            if (!dtFailed(status.getInt(0)) && status.getInt(0).and(partialResult) == 0 && pathCount < maxPath) break
+        }
+        assertThat(status.getInt(0).and(partialResult), equalTo(0))
+
+        assertThat(recast.navmesh_path_cache_find_path_into(cache!!, navMeshQuery, startRef, endRef, start, end, null, cachedPath, maxPath, status), equalTo(pathCount))
+
+        val stats = PathCacheStats()
+        for (i in 1..10) {
+            val cachedCount = recast.navmesh_path_cache_find_path_into(cache, navMeshQuery, startRef, endRef, start, end, null, cachedPath, maxPath, status)
+            assertThat(cachedCount, equalTo(pathCount))
+            assertThat(cachedPath.getLong(8L * (cachedCount - 1)), equalTo(path.getLong(8L * (pathCount - 1))))
+        }
+        recast.navmesh_path_cache_get_stats(cache, stats)
+        assertThat(stats.misses, equalTo(1L))
+        assertThat(stats.hits, equalTo(10L))
+        assertThat(stats.entries, equalTo(1))
+
+        recast.navmesh_path_cache_clear(cache)
+        recast.navmesh_path_cache_find_path_into(cache, navMeshQuery, startRef, endRef, start, end, null, cachedPath, maxPath, status)
+        recast.navmesh_path_cache_get_stats(cache, stats)
+        assertThat(stats.misses, equalTo(2L))
+
+        recast.navmesh_path_cache_delete(cache)
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_delete(navMesh)
+    }
+
+    @Test
+    fun miss_cached_paths_through_replaced_tiles() {
+        val ctx = recast.rcContext_create()!!
+        val config = createDefaultConfig().apply {
+            tileSize = Constants.tileSize
+            borderSize = Constants.borderSize
+        }
+        val mesh = getMesh(ctx)!!
+        recast.rcConfig_calc_grid_size(config, mesh)
+        val navMesh = recast.navmesh_create_tiled(ctx, config, mesh, Constants.agentHeight.toFloat(), Constants.agentRadius.toFloat(), Constants.agentMaxClimb.toFloat(), 0)!!
+        val navMeshQuery = recast.navmesh_query_create(navMesh)
+        val cache = recast.navmesh_path_cache_create(navMesh, 64)!!
+        val rebuilder = recast.navmesh_rebuilder_create(ctx, navMesh, config, mesh, Constants.agentHeight.toFloat(), Constants.agentRadius.toFloat(), Constants.agentMaxClimb.toFloat(), 0)!!
+
+        val maxPath = 256
+        val polyRef = Memory(8)
+        val status = Memory(4)
+        val start = Memory(3 * 4)
+        val end = Memory(3 * 4)
+        val path = Memory(8L * maxPath)
+        val partialResult = 1.shl(6)
+        var startRef = 0L
+        var endRef = 0L
+        for (i in 1..20) {
+            recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, start)
+            startRef = polyRef.getLong(0)
+            recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, end)
+            endRef = polyRef.getLong(0)
+            recast.navmesh_path_cache_find_path_into(cache, navMeshQuery, startRef, endRef, start, end, null, path, maxPath, status)
+            if (!dtFailed(status.getInt(0)) && status.getInt(0).and(partialResult) == 0) break
+        }
+        assertThat(status.getInt(0).and(partialResult), equalTo(0))
+        recast.navmesh_path_cache_find_path_into(cache, navMeshQuery, startRef, endRef, start, end, null, path, maxPath, status)
+        val stats = PathCacheStats()
+        recast.navmesh_path_cache_get_stats(cache, stats)
+        assertThat(stats.hits, equalTo(1L))
+
+        // Rebuilding every tile replaces them, which changes their salt and so every ref in the corridor.
+        assertThat(recast.navmesh_rebuilder_mark_dirty(rebuilder, config.bmin, config.bmax), greaterThanOrEqualTo(1))
+        recast.navmesh_rebuilder_wait(rebuilder)
+        assertThat(recast.navmesh_rebuilder_apply(rebuilder, null, null), greaterThanOrEqualTo(1))
+
+        val misses = stats.misses
+        recast.navmesh_path_cache_find_path_into(cache, navMeshQuery, startRef, endRef, start, end, null, path, maxPath, status)
+        recast.navmesh_path_cache_get_stats(cache, stats)
+        assertThat(stats.hits, equalTo(1L))
+        assertThat(stats.misses, equalTo(misses + 1))
+        assertThat(stats.invalidations, greaterThanOrEqualTo(1L))
+
+        recast.navmesh_rebuilder_delete(rebuilder)
+        recast.navmesh_path_cache_delete(cache)
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_delete(navMesh)
+        recast.rcContext_delete(ctx)
+    }
+
+    @Test
+    fun find_long_paths_through_the_hierarchy() {
+        val navMesh = recast.navmesh_load_tiled_bin(navMeshTiledBinPath())
+        val navMeshQuery = recast.navmesh_query_create(navMesh)
+        val hierarchy = recast.navmesh_hierarchy_create(navMesh, null, 0)
+        assertThat(hierarchy, present())
+
+        val stats = HierarchicalGraphStats()
+        recast.navmesh_hierarchy_get_stats(hierarchy!!, stats)
+        assertThat(stats.portals, greaterThanOrEqualTo(stats.clusters))
+
+        val maxPath = 4096
+        val polyRef = Memory(8)
+        val status = Memory(4)
+        val start = Memory(3 * 4)
+        val end = Memory(3 * 4)
+        val path = Memory(8L * maxPath)
+
+        // Look for a pair of points that a plain search connects, so the hierarchy has to as well.
+        val partialResult = 1.shl(6)
+        var startRef = 0L
+        var endRef = 0L
+        for (i in 1..20) {
+            recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, start)
+            startRef = polyRef.getLong(0)
+            recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, end)
+            endRef = polyRef.getLong(0)
+            recast.navmesh_query_find_path_into(navMeshQuery, startRef, endRef, start, end, null, path, maxPath, status)
+            if (!dtFailed(status.getInt(0)) && status.getInt(0).and(partialResult) == 0) break
+        }
+        assertThat(status.getInt(0).and(partialResult), equalTo(0))
+
+        val pathCount = recast.navmesh_hierarchy_find_path_into(hierarchy, navMeshQuery, startRef, endRef, start, end, path, maxPath, status)
+        assertThat(dtFailed(status.getInt(0)), equalTo(false))
+        assertThat(status.getInt(0).and(partialResult), equalTo(0))
+        assertThat(path.getLong(0), equalTo(startRef))
+        assertThat(path.getLong(8L * (pathCount - 1)), equalTo(endRef))
+
+        val maxWaypoints = 256
+        val waypoints = Memory(8L * maxWaypoints)
+        val waypointCount = recast.navmesh_hierarchy_find_waypoints_into(hierarchy, startRef, endRef, start, end, waypoints, null, maxWaypoints, status)
+        assertThat(waypointCount, greaterThanOrEqualTo(1))
+        assertThat(waypoints.getLong(8L * (waypointCount - 1)), equalTo(endRef))
+
+        recast.navmesh_hierarchy_delete(hierarchy)
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_delete(navMesh)
+    }
+
+    @Test
+    fun step_a_crowd_in_one_call() {
+        val navMesh = recast.navmesh_load_tiled_bin(navMeshTiledBinPath())
+        val navMeshQuery = recast.navmesh_query_create(navMesh)
+        val maxAgents = 16
+        val crowd = recast.crowd_create(navMesh, maxAgents, 0.6f)
+        assertThat(crowd, present())
+
+        val maxPath = 256
+        val polyRef = Memory(8)
+        val status = Memory(4)
+        val start = Memory(3 * 4)
+        val end = Memory(3 * 4)
+        val path = Memory(8L * maxPath)
+
+        // Send an agent between two connected points a few polys apart.
+        val partialResult = 1.shl(6)
+        for (i in 1..20) {
+            recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, start)
+            val startRef = polyRef.getLong(0)
+            recast.navmesh_query_find_random_point_into(navMeshQuery, polyRef, end)
+            val endRef = polyRef.getLong(0)
+            val pathCount = recast.navmesh_query_find_path_into(navMeshQuery, startRef, endRef, start, end, null, path, maxPath, status)
+            if (!dtFailed(status.getInt(0)) && status.getInt(0).and(partialResult) == 0 && pathCount > 2) break
+        }
+
+        val config = CrowdAgentConfig()
+        recast.crowd_get_default_agent_config(config)
+        val walker = recast.crowd_add_agent(crowd!!, start, config)
+        val idler = recast.crowd_add_agent(crowd, end, null)
+        assertThat(walker, greaterThanOrEqualTo(0))
+        assertThat(idler, greaterThanOrEqualTo(0))
+        assertThat(recast.crowd_get_active_agent_count(crowd), equalTo(2))
+        assertThat(recast.crowd_set_target(crowd, walker, end), equalTo(true))
+
+        val states = FloatArray(maxAgents * 6)
+        recast.crowd_update(crowd, 0.0f, states, maxAgents)
+        val startX = states[walker * 6]
+        val startZ = states[walker * 6 + 2]
+        for (i in 1..20) {
+            assertThat(recast.crowd_update(crowd, 0.1f, states, maxAgents), equalTo(maxAgents))
+        }
+        val dx = states[walker * 6] - startX
+        val dz = states[walker * 6 + 2] - startZ
+        assertThat(dx * dx + dz * dz, greaterThanOrEqualTo(0.01f))
+
+        recast.crowd_remove_agent(crowd, idler)
+        assertThat(recast.crowd_get_active_agent_count(crowd), equalTo(1))
+
+        recast.crowd_delete(crowd)
+        recast.navmesh_query_delete(navMeshQuery)
+        recast.navmesh_delete(navMesh)
+    }
+
     @Test
     fun draw_a_polymesh() {
         val ctx = recast.rcContext_create()
@@ -153,8 +1139,8 @@ class RecastShould {
         ImageIO.write(bImg, "png", outputfile)
     }
 
-    private fun createNavMeshData(ctx: RcContext, config: RcConfig.ByReference, mesh: InputGeom): NavMeshDataResult.ByReference? {
-        val chf = recast.compact_heightfield_create(ctx, config, mesh)!!
+    private fun createNavMeshData(ctx: RcContext, config: RcConfig.ByReference, mesh: InputGeom, threads: Int = 0): NavMeshDataResult.ByReference? {
+        val chf = recast.compact_heightfield_create_threaded(ctx, config, mesh, threads)!!
         val polymesh = recast.polymesh_create(ctx, config, chf)!!
         val polyMeshDetail = recast.polymesh_detail_create(ctx, config, polymesh, chf)!!
         return recast.navmesh_data_create(ctx, config, polyMeshDetail, polymesh, mesh, 0, 0, Constants.agentHeight.toFloat(), Constants.agentRadius.toFloat(), Constants.agentMaxClimb.toFloat())
@@ -162,6 +1148,11 @@ class RecastShould {
 
     private fun getMesh(ctx: RcContext) = recast.InputGeom_load(ctx, terrainTilePath(), true)
 
+    private fun littleEndian(bytes: ByteArray) = ByteBuffer.wrap(bytes).order(ByteOrder.LITTLE_ENDIAN)
+
+    private fun metricValue(metrics: String, series: String) =
+        metrics.lines().first { it.startsWith("$series ") }.substringAfter(' ').toDouble()
+
     private val recast = RecastLibrary.load()
 
     private fun terrainTilePath() = File(this.javaClass.getResource("Tile_+007_+006_L21.obj").toURI()).absolutePath
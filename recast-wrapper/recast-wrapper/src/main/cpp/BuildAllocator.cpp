@@ -0,0 +1,309 @@
+#include "BuildAllocator.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "DetourAlloc.h"
+#include "RecastAlloc.h"
+
+struct BuildArena;
+
+// Every block starts with a header that tells buildFree where it came from. Its size keeps the 16 byte
+// alignment of malloc.
+struct BlockHeader {
+    BuildArena* arena;  // Null for heap blocks.
+    int sizeClass;      // -1 for heap blocks too large to pool.
+};
+
+static const size_t HEADER_SIZE = 16;
+static_assert(sizeof(BlockHeader) <= HEADER_SIZE, "BlockHeader must fit its slot");
+
+// Size class c holds blocks of 2^(c + MIN_CLASS_SHIFT) bytes including the header, 32 bytes to 64 KiB.
+static const int MIN_CLASS_SHIFT = 5;
+static const int SIZE_CLASSES = 12;
+// Free blocks kept per size class, by each thread and in the shared pool.
+static const size_t THREAD_CACHE_BYTES = 256 * 1024;
+static const size_t SHARED_POOL_BYTES = 4 * 1024 * 1024;
+
+static const size_t ARENA_INITIAL_BYTES = 1024 * 1024;
+static const size_t ARENA_MAX_BYTES = 64 * 1024 * 1024;
+static const size_t MAX_IDLE_ARENAS = 64;
+
+static size_t classSize(int sizeClass) {
+    return (size_t) 1 << (sizeClass + MIN_CLASS_SHIFT);
+}
+
+static int sizeClassOf(size_t total) {
+    for (int sizeClass = 0; sizeClass < SIZE_CLASSES; ++sizeClass) {
+        if (classSize(sizeClass) >= total) {
+            return sizeClass;
+        }
+    }
+    return -1;
+}
+
+static int maxCachedBlocks(int sizeClass) {
+    const size_t count = THREAD_CACHE_BYTES / classSize(sizeClass);
+    return count > 2 ? (int) count : 2;
+}
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+struct SharedPool {
+    std::mutex mutex;
+    FreeBlock* blocks[SIZE_CLASSES];
+    size_t bytes[SIZE_CLASSES];
+};
+
+static SharedPool sharedPool;
+
+struct ThreadCache {
+    FreeBlock* blocks[SIZE_CLASSES];
+    int counts[SIZE_CLASSES];
+
+    ThreadCache() {
+        memset(blocks, 0, sizeof(blocks));
+        memset(counts, 0, sizeof(counts));
+    }
+
+    ~ThreadCache() {
+        for (int sizeClass = 0; sizeClass < SIZE_CLASSES; ++sizeClass) {
+            spill(sizeClass, counts[sizeClass]);
+        }
+    }
+
+    // Moves count blocks of the class to the shared pool, or back to malloc once the pool is full.
+    void spill(int sizeClass, int count) {
+        std::lock_guard<std::mutex> lock(sharedPool.mutex);
+        for (int i = 0; i < count && blocks[sizeClass]; ++i) {
+            FreeBlock* block = blocks[sizeClass];
+            blocks[sizeClass] = block->next;
+            counts[sizeClass]--;
+            if (sharedPool.bytes[sizeClass] < SHARED_POOL_BYTES) {
+                block->next = sharedPool.blocks[sizeClass];
+                sharedPool.blocks[sizeClass] = block;
+                sharedPool.bytes[sizeClass] += classSize(sizeClass);
+            } else {
+                free(block);
+            }
+        }
+    }
+
+    // Refills the class from the shared pool, up to half of what the thread may keep.
+    void refill(int sizeClass) {
+        std::lock_guard<std::mutex> lock(sharedPool.mutex);
+        const int count = maxCachedBlocks(sizeClass) / 2;
+        for (int i = 0; i < count && sharedPool.blocks[sizeClass]; ++i) {
+            FreeBlock* block = sharedPool.blocks[sizeClass];
+            sharedPool.blocks[sizeClass] = block->next;
+            sharedPool.bytes[sizeClass] -= classSize(sizeClass);
+            block->next = blocks[sizeClass];
+            blocks[sizeClass] = block;
+            counts[sizeClass]++;
+        }
+    }
+
+    void* take(int sizeClass) {
+        if (!blocks[sizeClass]) {
+            refill(sizeClass);
+        }
+        FreeBlock* block = blocks[sizeClass];
+        if (!block) {
+            return malloc(classSize(sizeClass));
+        }
+        blocks[sizeClass] = block->next;
+        counts[sizeClass]--;
+        return block;
+    }
+
+    void give(int sizeClass, void* ptr) {
+        FreeBlock* block = (FreeBlock*) ptr;
+        block->next = blocks[sizeClass];
+        blocks[sizeClass] = block;
+        if (++counts[sizeClass] > maxCachedBlocks(sizeClass)) {
+            spill(sizeClass, counts[sizeClass] / 2);
+        }
+    }
+};
+
+static thread_local ThreadCache threadCache;
+
+static void* heapAlloc(size_t size) {
+    const size_t total = size + HEADER_SIZE;
+    const int sizeClass = sizeClassOf(total);
+    BlockHeader* header = (BlockHeader*) (sizeClass < 0 ? malloc(total) : threadCache.take(sizeClass));
+    if (!header) {
+        return 0;
+    }
+    header->arena = 0;
+    header->sizeClass = sizeClass;
+    return (unsigned char*) header + HEADER_SIZE;
+}
+
+struct BuildArena {
+    unsigned char* buffer;
+    size_t capacity;
+    size_t offset;
+    // Bytes asked for since the last rewind, including those that overflowed to the heap.
+    size_t highWater;
+    // Live blocks, plus one for the thread or idle list that owns the arena.
+    std::atomic<int> references;
+};
+
+static void destroyArena(BuildArena* arena) {
+    free(arena->buffer);
+    delete arena;
+}
+
+static void releaseArena(BuildArena* arena) {
+    if (arena->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        destroyArena(arena);
+    }
+}
+
+static std::mutex idleArenasMutex;
+static std::vector<BuildArena*> idleArenas;
+
+struct ArenaOwner {
+    BuildArena* arena;
+
+    ArenaOwner() : arena(0) {}
+
+    // With nothing live the arena can serve the next thread, otherwise the last free destroys it.
+    ~ArenaOwner() {
+        if (!arena) {
+            return;
+        }
+        if (arena->references.load(std::memory_order_acquire) == 1) {
+            std::lock_guard<std::mutex> lock(idleArenasMutex);
+            if (idleArenas.size() < MAX_IDLE_ARENAS) {
+                idleArenas.push_back(arena);
+                return;
+            }
+        }
+        releaseArena(arena);
+    }
+
+    BuildArena* get() {
+        if (arena) {
+            return arena;
+        }
+        {
+            std::lock_guard<std::mutex> lock(idleArenasMutex);
+            if (!idleArenas.empty()) {
+                arena = idleArenas.back();
+                idleArenas.pop_back();
+                return arena;
+            }
+        }
+        arena = new BuildArena();
+        arena->buffer = (unsigned char*) malloc(ARENA_INITIAL_BYTES);
+        arena->capacity = arena->buffer ? ARENA_INITIAL_BYTES : 0;
+        arena->offset = 0;
+        arena->highWater = 0;
+        arena->references.store(1);
+        return arena;
+    }
+};
+
+static thread_local ArenaOwner arenaOwner;
+
+// Only called by the owning thread while no block of the arena is live.
+static void rewindArena(BuildArena* arena) {
+    if (arena->highWater > arena->capacity && arena->capacity < ARENA_MAX_BYTES) {
+        const size_t capacity = arena->highWater < ARENA_MAX_BYTES ? arena->highWater : ARENA_MAX_BYTES;
+        unsigned char* buffer = (unsigned char*) malloc(capacity);
+        if (buffer) {
+            free(arena->buffer);
+            arena->buffer = buffer;
+            arena->capacity = capacity;
+        }
+    }
+    arena->offset = 0;
+    arena->highWater = 0;
+}
+
+static void* arenaAlloc(size_t size) {
+    BuildArena* arena = arenaOwner.get();
+    if (arena->references.load(std::memory_order_acquire) == 1) {
+        rewindArena(arena);
+    }
+
+    const size_t total = (size + HEADER_SIZE + HEADER_SIZE - 1) & ~(HEADER_SIZE - 1);
+    arena->highWater += total;
+    if (total > arena->capacity - arena->offset) {
+        return heapAlloc(size);
+    }
+
+    BlockHeader* header = (BlockHeader*) (arena->buffer + arena->offset);
+    arena->offset += total;
+    arena->references.fetch_add(1, std::memory_order_relaxed);
+    header->arena = arena;
+    header->sizeClass = -1;
+    return (unsigned char*) header + HEADER_SIZE;
+}
+
+static void buildFree(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    BlockHeader* header = (BlockHeader*) ((unsigned char*) ptr - HEADER_SIZE);
+    if (header->arena) {
+        releaseArena(header->arena);
+    } else if (header->sizeClass < 0) {
+        free(header);
+    } else {
+        threadCache.give(header->sizeClass, header);
+    }
+}
+
+static void* rcBuildAlloc(size_t size, rcAllocHint hint) {
+    return hint == RC_ALLOC_TEMP ? arenaAlloc(size) : heapAlloc(size);
+}
+
+static void* dtBuildAlloc(size_t size, dtAllocHint hint) {
+    return hint == DT_ALLOC_TEMP ? arenaAlloc(size) : heapAlloc(size);
+}
+
+// Until the build allocator is installed, rcAlloc and dtAlloc go to malloc as by default but leave a mark, so
+// that installing refuses once there are blocks it could not free.
+static std::atomic<bool> defaultAllocated(false);
+static std::atomic<bool> installed(false);
+
+static void* trackedAlloc(size_t size) {
+    if (!defaultAllocated.load(std::memory_order_relaxed)) {
+        defaultAllocated.store(true, std::memory_order_relaxed);
+    }
+    return malloc(size);
+}
+
+static void* rcTrackedAlloc(size_t size, rcAllocHint) {
+    return trackedAlloc(size);
+}
+
+static void* dtTrackedAlloc(size_t size, dtAllocHint) {
+    return trackedAlloc(size);
+}
+
+struct DefaultAllocationTracker {
+    DefaultAllocationTracker() {
+        rcAllocSetCustom(rcTrackedAlloc, free);
+        dtAllocSetCustom(dtTrackedAlloc, free);
+    }
+};
+
+static DefaultAllocationTracker defaultAllocationTracker;
+
+bool installBuildAllocator() {
+    if (installed.exchange(true) || defaultAllocated.load()) {
+        return false;
+    }
+    rcAllocSetCustom(rcBuildAlloc, buildFree);
+    dtAllocSetCustom(dtBuildAlloc, buildFree);
+    return true;
+}
@@ -17,9 +17,17 @@
 //
 
 #include "ChunkyTriMesh.h"
+#include "ThreadPool.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <algorithm>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CHUNKY_USE_SSE2 1
+#endif
 
 struct BoundsItem
 {
@@ -28,27 +36,15 @@ struct BoundsItem
 	int i;
 };
 
-static int compareItemX(const void* va, const void* vb)
+struct CompareItemX
 {
-	const BoundsItem* a = (const BoundsItem*)va;
-	const BoundsItem* b = (const BoundsItem*)vb;
-	if (a->bmin[0] < b->bmin[0])
-		return -1;
-	if (a->bmin[0] > b->bmin[0])
-		return 1;
-	return 0;
-}
+	bool operator()(const BoundsItem& a, const BoundsItem& b) const { return a.bmin[0] < b.bmin[0]; }
+};
 
-static int compareItemY(const void* va, const void* vb)
+struct CompareItemY
 {
-	const BoundsItem* a = (const BoundsItem*)va;
-	const BoundsItem* b = (const BoundsItem*)vb;
-	if (a->bmin[1] < b->bmin[1])
-		return -1;
-	if (a->bmin[1] > b->bmin[1])
-		return 1;
-	return 0;
-}
+	bool operator()(const BoundsItem& a, const BoundsItem& b) const { return a.bmin[1] < b.bmin[1]; }
+};
 
 static void calcExtends(const BoundsItem* items, const int /*nitems*/,
 						const int imin, const int imax,
@@ -76,75 +72,83 @@ inline int longestAxis(float x, float y)
 	return y > x ? 1 : 0;
 }
 
-static void subdivide(BoundsItem* items, int nitems, int imin, int imax, int trisPerChunk,
-					  int& curNode, rcChunkyTriMeshNode* nodes, const int maxNodes,
-					  int& curTri, int* outTris, const int* inTris)
+// Number of nodes subdivide emits for a range of n triangles. Depends only on n, which is what lets
+// sibling subtrees be written to their final place in the node array independently.
+static int calcNodeCount(int n, int trisPerChunk)
 {
-	int inum = imax - imin;
-	int icur = curNode;
-	
-	if (curNode > maxNodes)
-		return;
+	if (n <= trisPerChunk)
+		return 1;
+	return 1 + calcNodeCount(n/2, trisPerChunk) + calcNodeCount(n - n/2, trisPerChunk);
+}
+
+// Fills in the bounds of node for [imin, imax) and, unless it becomes a leaf, partitions the items
+// around the median of the longest axis. Returns the split index, or -1 for a leaf. The escape index
+// of an internal node is left to the caller.
+static int splitNode(BoundsItem* items, int imin, int imax, int trisPerChunk,
+					 rcChunkyTriMeshNode& node, int* outTris, const int* inTris)
+{
+	const int inum = imax - imin;
+
+	calcExtends(items, 0, imin, imax, node.bmin, node.bmax);
 
-	rcChunkyTriMeshNode& node = nodes[curNode++];
-	
 	if (inum <= trisPerChunk)
 	{
-		// Leaf
-		calcExtends(items, nitems, imin, imax, node.bmin, node.bmax);
-		
-		// Copy triangles.
-		node.i = curTri;
+		// Leaf. Leaves are laid out in item order, so their triangles start at imin.
+		node.i = imin;
 		node.n = inum;
-		
+
 		for (int i = imin; i < imax; ++i)
 		{
 			const int* src = &inTris[items[i].i*3];
-			int* dst = &outTris[curTri*3];
-			curTri++;
+			int* dst = &outTris[i*3];
 			dst[0] = src[0];
 			dst[1] = src[1];
 			dst[2] = src[2];
 		}
+		return -1;
 	}
+
+	// Split
+	const int axis = longestAxis(node.bmax[0] - node.bmin[0],
+								 node.bmax[1] - node.bmin[1]);
+	const int isplit = imin+inum/2;
+
+	// Only the median needs to be in place, with smaller items to its left and larger ones to its
+	// right, so a selection replaces the full sort.
+	if (axis == 0)
+		std::nth_element(items+imin, items+isplit, items+imax, CompareItemX());
 	else
-	{
-		// Split
-		calcExtends(items, nitems, imin, imax, node.bmin, node.bmax);
-		
-		int	axis = longestAxis(node.bmax[0] - node.bmin[0],
-							   node.bmax[1] - node.bmin[1]);
-		
-		if (axis == 0)
-		{
-			// Sort along x-axis
-			qsort(items+imin, static_cast<size_t>(inum), sizeof(BoundsItem), compareItemX);
-		}
-		else if (axis == 1)
-		{
-			// Sort along y-axis
-			qsort(items+imin, static_cast<size_t>(inum), sizeof(BoundsItem), compareItemY);
-		}
-		
-		int isplit = imin+inum/2;
-		
-		// Left
-		subdivide(items, nitems, imin, isplit, trisPerChunk, curNode, nodes, maxNodes, curTri, outTris, inTris);
-		// Right
-		subdivide(items, nitems, isplit, imax, trisPerChunk, curNode, nodes, maxNodes, curTri, outTris, inTris);
-		
-		int iescape = curNode - icur;
-		// Negative index means escape.
-		node.i = -iescape;
-	}
+		std::nth_element(items+imin, items+isplit, items+imax, CompareItemY());
+
+	node.n = inum;
+	return isplit;
+}
+
+// Builds the subtree for [imin, imax) rooted at nodes[curNode] and returns its node count.
+static int subdivide(BoundsItem* items, int imin, int imax, int trisPerChunk,
+					 int curNode, rcChunkyTriMeshNode* nodes, int* outTris, const int* inTris)
+{
+	rcChunkyTriMeshNode& node = nodes[curNode];
+	const int isplit = splitNode(items, imin, imax, trisPerChunk, node, outTris, inTris);
+	if (isplit < 0)
+		return 1;
+
+	// Left
+	const int nleft = subdivide(items, imin, isplit, trisPerChunk, curNode+1, nodes, outTris, inTris);
+	// Right
+	const int nright = subdivide(items, isplit, imax, trisPerChunk, curNode+1+nleft, nodes, outTris, inTris);
+
+	// Negative index means escape.
+	node.i = -(1 + nleft + nright);
+	return 1 + nleft + nright;
 }
 
 bool rcCreateChunkyTriMesh(const float* verts, const int* tris, int ntris,
-						   int trisPerChunk, rcChunkyTriMesh* cm)
+						   int trisPerChunk, rcChunkyTriMesh* cm, int threadCount)
 {
-	int nchunks = (ntris + trisPerChunk-1) / trisPerChunk;
+	const int nnodes = calcNodeCount(ntris, trisPerChunk);
 
-	cm->nodes = new rcChunkyTriMeshNode[nchunks*4];
+	cm->nodes = new rcChunkyTriMeshNode[nnodes];
 	if (!cm->nodes)
 		return false;
 		
@@ -153,39 +157,90 @@ bool rcCreateChunkyTriMesh(const float* verts, const int* tris, int ntris,
 		return false;
 		
 	cm->ntris = ntris;
+	cm->nnodes = nnodes;
 
 	// Build tree
-	BoundsItem* items = new BoundsItem[ntris];
+	BoundsItem* items = new BoundsItem[ntris ? ntris : 1];
 	if (!items)
 		return false;
 
-	for (int i = 0; i < ntris; i++)
+	ThreadPool pool(threadCount);
+	const int itemBlock = 1 << 16;
+	pool.parallelFor((ntris + itemBlock-1) / itemBlock, [&](int block, int) {
+		const int end = (block+1)*itemBlock < ntris ? (block+1)*itemBlock : ntris;
+		for (int i = block*itemBlock; i < end; i++)
+		{
+			const int* t = &tris[i*3];
+			BoundsItem& it = items[i];
+			it.i = i;
+			// Calc triangle XZ bounds.
+			it.bmin[0] = it.bmax[0] = verts[t[0]*3+0];
+			it.bmin[1] = it.bmax[1] = verts[t[0]*3+2];
+			for (int j = 1; j < 3; ++j)
+			{
+				const float* v = &verts[t[j]*3];
+				if (v[0] < it.bmin[0]) it.bmin[0] = v[0];
+				if (v[2] < it.bmin[1]) it.bmin[1] = v[2];
+
+				if (v[0] > it.bmax[0]) it.bmax[0] = v[0];
+				if (v[2] > it.bmax[1]) it.bmax[1] = v[2];
+			}
+		}
+	});
+
+	if (!ntris)
 	{
-		const int* t = &tris[i*3];
-		BoundsItem& it = items[i];
-		it.i = i;
-		// Calc triangle XZ bounds.
-		it.bmin[0] = it.bmax[0] = verts[t[0]*3+0];
-		it.bmin[1] = it.bmax[1] = verts[t[0]*3+2];
-		for (int j = 1; j < 3; ++j)
+		// Single empty leaf, as the recursive build always produced.
+		cm->nodes[0].bmin[0] = cm->nodes[0].bmin[1] = 0.0f;
+		cm->nodes[0].bmax[0] = cm->nodes[0].bmax[1] = 0.0f;
+		cm->nodes[0].i = 0;
+		cm->nodes[0].n = 0;
+	}
+	else
+	{
+		// Split the top of the tree breadth first until there are enough independent subtrees to keep
+		// every thread busy, then finish the subtrees in parallel. The result does not depend on the
+		// thread count.
+		struct Subtree { int imin, imax, node; };
+		std::vector<Subtree> subtrees;
+		std::vector<Subtree> pending(1);
+		pending[0].imin = 0;
+		pending[0].imax = ntris;
+		pending[0].node = 0;
+		const size_t targetSubtrees = pool.getThreadCount() > 1 ? (size_t)pool.getThreadCount() * 8 : 1;
+
+		for (size_t head = 0; head < pending.size(); ++head)
 		{
-			const float* v = &verts[t[j]*3];
-			if (v[0] < it.bmin[0]) it.bmin[0] = v[0]; 
-			if (v[2] < it.bmin[1]) it.bmin[1] = v[2]; 
+			const Subtree t = pending[head];
+			if (pending.size() - head + subtrees.size() >= targetSubtrees)
+			{
+				subtrees.push_back(t);
+				continue;
+			}
+
+			rcChunkyTriMeshNode& node = cm->nodes[t.node];
+			const int isplit = splitNode(items, t.imin, t.imax, trisPerChunk, node, cm->tris, tris);
+			if (isplit < 0)
+				continue;
+			node.i = -calcNodeCount(t.imax - t.imin, trisPerChunk);
 
-			if (v[0] > it.bmax[0]) it.bmax[0] = v[0]; 
-			if (v[2] > it.bmax[1]) it.bmax[1] = v[2]; 
+			Subtree left = { t.imin, isplit, t.node+1 };
+			Subtree right = { isplit, t.imax, t.node+1+calcNodeCount(isplit-t.imin, trisPerChunk) };
+			pending.push_back(left);
+			pending.push_back(right);
 		}
+
+		pool.parallelFor((int)subtrees.size(), [&](int i, int) {
+			subdivide(items, subtrees[i].imin, subtrees[i].imax, trisPerChunk, subtrees[i].node,
+					  cm->nodes, cm->tris, tris);
+		});
 	}
 
-	int curTri = 0;
-	int curNode = 0;
-	subdivide(items, ntris, 0, ntris, trisPerChunk, curNode, cm->nodes, nchunks*4, curTri, cm->tris, tris);
-	
 	delete [] items;
-	
-	cm->nnodes = curNode;
-	
+
+	if (!rcBuildChunkyTriMeshWideNodes(cm))
+		return false;
+
 	// Calc max tris per node.
 	cm->maxTrisPerChunk = 0;
 	for (int i = 0; i < cm->nnodes; ++i)
@@ -201,6 +256,79 @@ bool rcCreateChunkyTriMesh(const float* verts, const int* tris, int ntris,
 }
 
 
+// Adds the children of the binary node b to the wide node, looking through internal children so a wide
+// node gets up to four grandchildren in pre-order.
+static void collectWideChildren(const rcChunkyTriMesh* cm, int b, int depth, int* children, int& count)
+{
+	const rcChunkyTriMeshNode* nodes = cm->nodes;
+	const int left = b+1;
+	const int right = left + (nodes[left].i >= 0 ? 1 : -nodes[left].i);
+	const int halves[2] = { left, right };
+	for (int k = 0; k < 2; ++k)
+	{
+		if (depth == 0 && nodes[halves[k]].i < 0)
+			collectWideChildren(cm, halves[k], 1, children, count);
+		else
+			children[count++] = halves[k];
+	}
+}
+
+static int buildWideNode(rcChunkyTriMesh* cm, int b, int& nextWide)
+{
+	const int w = nextWide++;
+	int children[4];
+	int count = 0;
+	if (cm->nodes[b].i >= 0)
+		children[count++] = b;
+	else
+		collectWideChildren(cm, b, 0, children, count);
+
+	cm->wideNodes[w].count = count;
+	for (int j = 0; j < 4; ++j)
+	{
+		rcChunkyTriMeshWideNode& wide = cm->wideNodes[w];
+		if (j >= count)
+		{
+			wide.minX[j] = wide.minY[j] = 0.0f;
+			wide.maxX[j] = wide.maxY[j] = 0.0f;
+			wide.child[j] = 0;
+			continue;
+		}
+		const rcChunkyTriMeshNode& node = cm->nodes[children[j]];
+		wide.minX[j] = node.bmin[0];
+		wide.minY[j] = node.bmin[1];
+		wide.maxX[j] = node.bmax[0];
+		wide.maxY[j] = node.bmax[1];
+		// Leaves are stored complemented, internal children get a wide node of their own. The array is
+		// not reallocated during the build, so the reference is taken again after the recursion.
+		if (node.i >= 0)
+			wide.child[j] = ~children[j];
+		else
+		{
+			const int child = buildWideNode(cm, children[j], nextWide);
+			cm->wideNodes[w].child[j] = child;
+		}
+	}
+	return w;
+}
+
+bool rcBuildChunkyTriMeshWideNodes(rcChunkyTriMesh* cm)
+{
+	delete [] cm->wideNodes;
+	cm->wideNodes = 0;
+	cm->nwideNodes = 0;
+	if (!cm->nnodes)
+		return true;
+
+	// Every wide node but the root replaces at least one internal binary node.
+	cm->wideNodes = new rcChunkyTriMeshWideNode[cm->nnodes];
+	if (!cm->wideNodes)
+		return false;
+
+	buildWideNode(cm, 0, cm->nwideNodes);
+	return true;
+}
+
 inline bool checkOverlapRect(const float amin[2], const float amax[2],
 							 const float bmin[2], const float bmax[2])
 {
@@ -210,47 +338,60 @@ inline bool checkOverlapRect(const float amin[2], const float amax[2],
 	return overlap;
 }
 
-int rcGetChunksOverlappingRect(const rcChunkyTriMesh* cm,
-							   float bmin[2], float bmax[2],
-							   int* ids, const int maxIds)
+// Overlap tests return a bit mask of the children of a wide node that overlap the query. Bits of
+// unused slots are masked off by the traversal.
+struct RectOverlap
 {
-	// Traverse tree
-	int i = 0;
-	int n = 0;
-	while (i < cm->nnodes)
+#ifdef CHUNKY_USE_SSE2
+	__m128 bmin[2], bmax[2];
+
+	RectOverlap(const float qmin[2], const float qmax[2])
 	{
-		const rcChunkyTriMeshNode* node = &cm->nodes[i];
-		const bool overlap = checkOverlapRect(bmin, bmax, node->bmin, node->bmax);
-		const bool isLeafNode = node->i >= 0;
-		
-		if (isLeafNode && overlap)
-		{
-			if (n < maxIds)
-			{
-				ids[n] = i;
-				n++;
-			}
-		}
-		
-		if (overlap || isLeafNode)
-			i++;
-		else
+		bmin[0] = _mm_set1_ps(qmin[0]);
+		bmin[1] = _mm_set1_ps(qmin[1]);
+		bmax[0] = _mm_set1_ps(qmax[0]);
+		bmax[1] = _mm_set1_ps(qmax[1]);
+	}
+
+	unsigned int operator()(const rcChunkyTriMeshWideNode& node) const
+	{
+		const __m128 x = _mm_and_ps(_mm_cmple_ps(bmin[0], _mm_loadu_ps(node.maxX)),
+									_mm_cmpge_ps(bmax[0], _mm_loadu_ps(node.minX)));
+		const __m128 y = _mm_and_ps(_mm_cmple_ps(bmin[1], _mm_loadu_ps(node.maxY)),
+									_mm_cmpge_ps(bmax[1], _mm_loadu_ps(node.minY)));
+		return (unsigned int)_mm_movemask_ps(_mm_and_ps(x, y));
+	}
+#else
+	float bmin[2], bmax[2];
+
+	RectOverlap(const float qmin[2], const float qmax[2])
+	{
+		bmin[0] = qmin[0];
+		bmin[1] = qmin[1];
+		bmax[0] = qmax[0];
+		bmax[1] = qmax[1];
+	}
+
+	unsigned int operator()(const rcChunkyTriMeshWideNode& node) const
+	{
+		unsigned int mask = 0;
+		for (int j = 0; j < 4; ++j)
 		{
-			const int escapeIndex = -node->i;
-			i += escapeIndex;
+			const float nmin[2] = { node.minX[j], node.minY[j] };
+			const float nmax[2] = { node.maxX[j], node.maxY[j] };
+			if (checkOverlapRect(bmin, bmax, nmin, nmax))
+				mask |= 1u << j;
 		}
+		return mask;
 	}
-	
-	return n;
-}
-
+#endif
+};
 
+static const float SEGMENT_EPSILON = 1e-6f;
 
-static bool checkOverlapSegment(const float p[2], const float q[2],
+inline bool checkOverlapSegment(const float p[2], const float q[2],
 								const float bmin[2], const float bmax[2])
 {
-	static const float EPSILON = 1e-6f;
-
 	float tmin = 0;
 	float tmax = 1;
 	float d[2];
@@ -259,7 +400,7 @@ static bool checkOverlapSegment(const float p[2], const float q[2],
 	
 	for (int i = 0; i < 2; i++)
 	{
-		if (fabsf(d[i]) < EPSILON)
+		if (fabsf(d[i]) < SEGMENT_EPSILON)
 		{
 			// Ray is parallel to slab. No hit if origin not within slab
 			if (p[i] < bmin[i] || p[i] > bmax[i])
@@ -280,36 +421,160 @@ static bool checkOverlapSegment(const float p[2], const float q[2],
 	return true;
 }
 
-int rcGetChunksOverlappingSegment(const rcChunkyTriMesh* cm,
-								  float p[2], float q[2],
-								  int* ids, const int maxIds)
+struct SegmentOverlap
 {
-	// Traverse tree
-	int i = 0;
-	int n = 0;
-	while (i < cm->nnodes)
+	float p[2], q[2];
+
+	SegmentOverlap(const float sp[2], const float sq[2])
 	{
-		const rcChunkyTriMeshNode* node = &cm->nodes[i];
-		const bool overlap = checkOverlapSegment(p, q, node->bmin, node->bmax);
-		const bool isLeafNode = node->i >= 0;
-		
-		if (isLeafNode && overlap)
+		p[0] = sp[0];
+		p[1] = sp[1];
+		q[0] = sq[0];
+		q[1] = sq[1];
+	}
+
+	unsigned int operator()(const rcChunkyTriMeshWideNode& node) const
+	{
+#ifdef CHUNKY_USE_SSE2
+		// Same slab test as checkOverlapSegment, for four nodes at a time. Whether an axis is parallel
+		// only depends on the segment, so the branches are shared by all lanes.
+		const float* nmin[2] = { node.minX, node.minY };
+		const float* nmax[2] = { node.maxX, node.maxY };
+		__m128 tmin = _mm_setzero_ps();
+		__m128 tmax = _mm_set1_ps(1.0f);
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int i = 0; i < 2; i++)
 		{
-			if (n < maxIds)
+			const float d = q[i] - p[i];
+			const __m128 pi = _mm_set1_ps(p[i]);
+			const __m128 bmin = _mm_loadu_ps(nmin[i]);
+			const __m128 bmax = _mm_loadu_ps(nmax[i]);
+			if (fabsf(d) < SEGMENT_EPSILON)
 			{
-				ids[n] = i;
-				n++;
+				inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(pi, bmin), _mm_cmple_ps(pi, bmax)));
+			}
+			else
+			{
+				const __m128 ood = _mm_set1_ps(1.0f / d);
+				const __m128 t1 = _mm_mul_ps(_mm_sub_ps(bmin, pi), ood);
+				const __m128 t2 = _mm_mul_ps(_mm_sub_ps(bmax, pi), ood);
+				tmin = _mm_max_ps(tmin, _mm_min_ps(t1, t2));
+				tmax = _mm_min_ps(tmax, _mm_max_ps(t1, t2));
 			}
 		}
-		
-		if (overlap || isLeafNode)
-			i++;
-		else
+		return (unsigned int)_mm_movemask_ps(_mm_and_ps(inside, _mm_cmple_ps(tmin, tmax)));
+#else
+		unsigned int mask = 0;
+		for (int j = 0; j < 4; ++j)
 		{
-			const int escapeIndex = -node->i;
-			i += escapeIndex;
+			const float nmin[2] = { node.minX[j], node.minY[j] };
+			const float nmax[2] = { node.maxX[j], node.maxY[j] };
+			if (checkOverlapSegment(p, q, nmin, nmax))
+				mask |= 1u << j;
 		}
+		return mask;
+#endif
 	}
-	
-	return n;
+};
+
+struct ArraySink
+{
+	int* ids;
+	int maxIds;
+	int n;
+
+	// Returns false once full, which ends the traversal.
+	bool add(int id)
+	{
+		ids[n++] = id;
+		return n < maxIds;
+	}
+};
+
+struct VectorSink
+{
+	std::vector<int>* ids;
+
+	bool add(int id)
+	{
+		ids->push_back(id);
+		return true;
+	}
+};
+
+// Depth of the wide tree is half that of the binary tree, which is at most 32 levels for any int
+// triangle count, and each level leaves at most three siblings on the stack.
+static const int WIDE_STACK_SIZE = 64;
+
+// Walks the wide tree depth first. Children are pushed in reverse, so leaves come out in the same
+// order as the escape index traversal of the binary tree would return them.
+template <class Overlap, class Sink>
+static void traverseChunks(const rcChunkyTriMesh* cm, const Overlap& overlaps, Sink& sink)
+{
+	if (!cm->nwideNodes)
+		return;
+
+	int stack[WIDE_STACK_SIZE];
+	int sp = 0;
+	stack[sp++] = 0;
+	while (sp > 0)
+	{
+		const int item = stack[--sp];
+		if (item < 0)
+		{
+			if (!sink.add(~item))
+				return;
+			continue;
+		}
+
+		const rcChunkyTriMeshWideNode& node = cm->wideNodes[item];
+		const unsigned int mask = overlaps(node) & ((1u << node.count) - 1);
+		for (int j = node.count-1; j >= 0; --j)
+		{
+			if (mask & (1u << j))
+				stack[sp++] = node.child[j];
+		}
+	}
+}
+
+int rcGetChunksOverlappingRect(const rcChunkyTriMesh* cm,
+							   float bmin[2], float bmax[2],
+							   int* ids, const int maxIds)
+{
+	if (maxIds <= 0)
+		return 0;
+	ArraySink sink = { ids, maxIds, 0 };
+	traverseChunks(cm, RectOverlap(bmin, bmax), sink);
+	return sink.n;
+}
+
+int rcGetChunksOverlappingSegment(const rcChunkyTriMesh* cm,
+								  float p[2], float q[2],
+								  int* ids, const int maxIds)
+{
+	if (maxIds <= 0)
+		return 0;
+	ArraySink sink = { ids, maxIds, 0 };
+	traverseChunks(cm, SegmentOverlap(p, q), sink);
+	return sink.n;
+}
+
+int rcGetChunksOverlappingRect(const rcChunkyTriMesh* cm,
+							   float bmin[2], float bmax[2],
+							   std::vector<int>& ids)
+{
+	ids.clear();
+	VectorSink sink = { &ids };
+	traverseChunks(cm, RectOverlap(bmin, bmax), sink);
+	return (int)ids.size();
+}
+
+int rcGetChunksOverlappingSegment(const rcChunkyTriMesh* cm,
+								  float p[2], float q[2],
+								  std::vector<int>& ids)
+{
+	ids.clear();
+	VectorSink sink = { &ids };
+	traverseChunks(cm, SegmentOverlap(p, q), sink);
+	return (int)ids.size();
 }
@@ -0,0 +1,219 @@
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "GeomCache.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+static const size_t HASH_BLOCK_SIZE = 1 << 20;
+static const unsigned long long HASH_PRIME = 0x100000001b3ull;
+
+static inline unsigned long long mix(unsigned long long h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static unsigned long long hashBlock(const unsigned char* data, size_t size) {
+    unsigned long long h = 0xcbf29ce484222325ull;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        unsigned long long word;
+        memcpy(&word, data + i, sizeof(word));
+        h = (h ^ word) * HASH_PRIME;
+    }
+    for (; i < size; ++i) {
+        h = (h ^ data[i]) * HASH_PRIME;
+    }
+    return mix(h);
+}
+
+unsigned long long hashGeomSource(const unsigned char* data, size_t size, int threadCount) {
+    const int blockCount = (int) ((size + HASH_BLOCK_SIZE - 1) / HASH_BLOCK_SIZE);
+    std::vector<unsigned long long> blockHashes(blockCount);
+
+    ThreadPool pool(threadCount);
+    pool.parallelFor(blockCount, [&](int i, int) {
+        const size_t offset = (size_t) i * HASH_BLOCK_SIZE;
+        const size_t length = size - offset < HASH_BLOCK_SIZE ? size - offset : HASH_BLOCK_SIZE;
+        blockHashes[i] = hashBlock(data + offset, length);
+    });
+
+    unsigned long long h = mix(size);
+    for (int i = 0; i < blockCount; ++i) {
+        h = mix((h ^ blockHashes[i]) * HASH_PRIME);
+    }
+    return h;
+}
+
+std::string getGeomCachePath(const std::string& objPath) {
+    return objPath + ".geomcache";
+}
+
+static unsigned long long align16(unsigned long long offset) {
+    return (offset + 15) & ~15ull;
+}
+
+static bool sectionFits(unsigned long long offset, unsigned long long bytes, size_t fileSize) {
+    return (offset & 15) == 0 && offset <= fileSize && bytes <= fileSize - offset;
+}
+
+static bool indicesInRange(const int* indices, long long count, int limit) {
+    for (long long i = 0; i < count; ++i) {
+        if (indices[i] < 0 || indices[i] >= limit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Nodes covered by the subtree at index, or 0 if its escape index is malformed.
+static int subtreeSize(const rcChunkyTriMeshNode* nodes, int index) {
+    return nodes[index].i >= 0 ? 1 : (nodes[index].i == INT_MIN ? 0 : -nodes[index].i);
+}
+
+// One pass over the sections that index into each other: triangles into vertices, leaves into the chunk
+// triangles and internal nodes into the rest of the tree, whose children have to tile its subtree exactly
+// for the traversals that follow escape indices.
+static bool contentsValid(const GeomCacheHeader& header, const GeomCacheData& data) {
+    if (!indicesInRange(data.tris, (long long) header.triCount * 3, header.vertCount) ||
+        !indicesInRange(data.chunkTris, (long long) header.chunkTriCount * 3, header.vertCount) ||
+        header.maxTrisPerChunk < 0) {
+        return false;
+    }
+    if (header.nodeCount > 0 && subtreeSize(data.nodes, 0) != header.nodeCount) {
+        return false;
+    }
+    for (int i = 0; i < header.nodeCount; ++i) {
+        const rcChunkyTriMeshNode& node = data.nodes[i];
+        if (node.i >= 0) {
+            if (node.n < 0 || node.n > header.maxTrisPerChunk || node.i > header.chunkTriCount - node.n) {
+                return false;
+            }
+            continue;
+        }
+        const int size = subtreeSize(data.nodes, i);
+        if (size < 3 || size > header.nodeCount - i) {
+            return false;
+        }
+        const int left = i + 1;
+        const int right = left + subtreeSize(data.nodes, left);
+        if (right <= left || right >= i + size || right + subtreeSize(data.nodes, right) != i + size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readGeomCache(const std::string& path, unsigned long long sourceHash, unsigned long long sourceSize,
+                   bool invertYZ, int trisPerChunk, MappedFile& file, GeomCacheData& data) {
+    if (!file.open(path.c_str())) {
+        return false;
+    }
+
+    const size_t size = file.getSize();
+    const GeomCacheHeader* header = (const GeomCacheHeader*) file.getData();
+    if (size < sizeof(GeomCacheHeader) ||
+        header->magic != GEOMCACHE_MAGIC ||
+        header->version != GEOMCACHE_VERSION ||
+        header->sourceHash != sourceHash ||
+        header->sourceSize != sourceSize ||
+        header->invertYZ != (invertYZ ? 1 : 0) ||
+        header->trisPerChunk != trisPerChunk ||
+        header->vertCount < 0 || header->triCount < 0 || header->nodeCount < 0 || header->chunkTriCount < 0 ||
+        !sectionFits(header->vertsOffset, (unsigned long long) header->vertCount * 3 * sizeof(float), size) ||
+        !sectionFits(header->trisOffset, (unsigned long long) header->triCount * 3 * sizeof(int), size) ||
+        !sectionFits(header->normalsOffset, (unsigned long long) header->triCount * 3 * sizeof(float), size) ||
+        !sectionFits(header->nodesOffset, (unsigned long long) header->nodeCount * sizeof(rcChunkyTriMeshNode), size) ||
+        !sectionFits(header->chunkTrisOffset, (unsigned long long) header->chunkTriCount * 3 * sizeof(int), size)) {
+        file.close();
+        return false;
+    }
+
+    unsigned char* base = file.getData();
+    data.header = header;
+    data.verts = (float*) (base + header->vertsOffset);
+    data.tris = (int*) (base + header->trisOffset);
+    data.normals = (float*) (base + header->normalsOffset);
+    data.nodes = (rcChunkyTriMeshNode*) (base + header->nodesOffset);
+    data.chunkTris = (int*) (base + header->chunkTrisOffset);
+    if (!contentsValid(*header, data)) {
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+static bool writeSection(FILE* fp, unsigned long long& position, unsigned long long offset, const void* data,
+                         size_t bytes) {
+    // Sections are written in order, so padding up to offset is all that is needed.
+    static const unsigned char zeros[16] = { 0 };
+    if (position > offset) {
+        return false;
+    }
+    const size_t padding = (size_t) (offset - position);
+    if (padding && fwrite(zeros, 1, padding, fp) != padding) {
+        return false;
+    }
+    if (bytes && fwrite(data, 1, bytes, fp) != bytes) {
+        return false;
+    }
+    position = offset + bytes;
+    return true;
+}
+
+bool writeGeomCache(const std::string& path, const GeomCacheHeader& source, const float* verts,
+                    const int* tris, const float* normals, const rcChunkyTriMeshNode* nodes,
+                    const int* chunkTris) {
+    GeomCacheHeader header = source;
+    header.magic = GEOMCACHE_MAGIC;
+    header.version = GEOMCACHE_VERSION;
+    header.reserved = 0;
+    header.vertsOffset = align16(sizeof(GeomCacheHeader));
+    header.trisOffset = align16(header.vertsOffset + (unsigned long long) header.vertCount * 3 * sizeof(float));
+    header.normalsOffset = align16(header.trisOffset + (unsigned long long) header.triCount * 3 * sizeof(int));
+    header.nodesOffset = align16(header.normalsOffset + (unsigned long long) header.triCount * 3 * sizeof(float));
+    header.chunkTrisOffset = align16(header.nodesOffset + (unsigned long long) header.nodeCount * sizeof(rcChunkyTriMeshNode));
+
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%d.tmp", (int) getpid());
+    const std::string tmpPath = path + suffix;
+
+    FILE* fp = fopen(tmpPath.c_str(), "wb");
+    if (!fp) {
+        return false;
+    }
+
+    unsigned long long position = sizeof(header);
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+        writeSection(fp, position, header.vertsOffset, verts, (size_t) header.vertCount * 3 * sizeof(float)) &&
+        writeSection(fp, position, header.trisOffset, tris, (size_t) header.triCount * 3 * sizeof(int)) &&
+        writeSection(fp, position, header.normalsOffset, normals, (size_t) header.triCount * 3 * sizeof(float)) &&
+        writeSection(fp, position, header.nodesOffset, nodes, (size_t) header.nodeCount * sizeof(rcChunkyTriMeshNode)) &&
+        writeSection(fp, position, header.chunkTrisOffset, chunkTris, (size_t) header.chunkTriCount * 3 * sizeof(int));
+    ok = fclose(fp) == 0 && ok;
+
+#ifdef _WIN32
+    // rename does not replace an existing file on Windows.
+    if (ok) {
+        remove(path.c_str());
+    }
+#endif
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,136 @@
+#include "HeightfieldRasterizer.h"
+#include "ChunkyTriMesh.h"
+#include "ThreadPool.h"
+
+#include <string.h>
+#include <vector>
+
+// Strips thinner than this spend more time on the chunks they share with their neighbours than they save.
+static const int MIN_STRIP_ROWS = 32;
+// Every strip has a span column array reaching from row 0 to its last row; beyond this many bytes of
+// them, fewer strips are used.
+static const long long MAX_STRIP_COLUMN_BYTES = 256LL * 1024 * 1024;
+
+static bool rasterizeSerial(rcContext* ctx, const rcConfig& config, const rcMeshLoaderObj* mesh,
+                            const rcChunkyTriMesh* chunkyMesh, const int* chunkIds, int chunkCount,
+                            rcHeightfield& heightfield) {
+    std::vector<unsigned char> triareas(chunkyMesh->maxTrisPerChunk);
+    for (int i = 0; i < chunkCount; ++i) {
+        const rcChunkyTriMeshNode& node = chunkyMesh->nodes[chunkIds[i]];
+        const int* ctris = &chunkyMesh->tris[node.i * 3];
+        const int nctris = node.n;
+
+        memset(&triareas[0], 0, nctris * sizeof(unsigned char));
+        rcMarkWalkableTriangles(ctx, config.walkableSlopeAngle, mesh->getVerts(), mesh->getVertCount(), ctris,
+                                nctris, &triareas[0]);
+        if (!rcRasterizeTriangles(ctx, mesh->getVerts(), mesh->getVertCount(), ctris, &triareas[0], nctris,
+                                  heightfield, config.walkableClimb)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int chooseStripCount(const rcHeightfield& heightfield, int threadCount) {
+    int strips = rcMin(ThreadPool::resolveThreadCount(threadCount), heightfield.height / MIN_STRIP_ROWS);
+    // Strip i of n needs (i + 1) / n of the rows, (n + 1) / 2 full column arrays in total.
+    const long long columnBytes = (long long) heightfield.width * heightfield.height * sizeof(rcSpan*);
+    while (strips > 1 && columnBytes * (strips + 1) / 2 > MAX_STRIP_COLUMN_BYTES) {
+        strips--;
+    }
+    return strips;
+}
+
+struct Strip {
+    int firstRow;
+    int endRow;
+    std::vector<int> chunkIds;
+    rcHeightfield* heightfield;
+    bool ok;
+};
+
+bool rasterizeChunks(rcContext* ctx, const rcConfig& config, const InputGeom* geom, const int* chunkIds,
+                     int chunkCount, rcHeightfield& heightfield, int threadCount) {
+    const rcMeshLoaderObj* mesh = geom->getMesh();
+    const rcChunkyTriMesh* chunkyMesh = geom->getChunkyMesh();
+
+    const int stripCount = chooseStripCount(heightfield, threadCount);
+    if (stripCount < 2) {
+        return rasterizeSerial(ctx, config, mesh, chunkyMesh, chunkIds, chunkCount, heightfield);
+    }
+
+    ctx->startTimer(RC_TIMER_RASTERIZE_TRIANGLES);
+
+    // A chunk may touch a strip when its bounds overlap the strip's rows, widened by a cell on each side
+    // so that rounding in the rasterizer cannot leave a triangle out. The filter keeps the serial order.
+    std::vector<Strip> strips(stripCount);
+    for (int s = 0; s < stripCount; ++s) {
+        Strip& strip = strips[s];
+        strip.firstRow = (int) ((long long) heightfield.height * s / stripCount);
+        strip.endRow = (int) ((long long) heightfield.height * (s + 1) / stripCount);
+        strip.heightfield = 0;
+        strip.ok = false;
+
+        const float zmin = heightfield.bmin[2] + (strip.firstRow - 1) * heightfield.cs;
+        const float zmax = heightfield.bmin[2] + (strip.endRow + 1) * heightfield.cs;
+        for (int i = 0; i < chunkCount; ++i) {
+            const rcChunkyTriMeshNode& node = chunkyMesh->nodes[chunkIds[i]];
+            if (node.bmax[1] >= zmin && node.bmin[1] <= zmax) {
+                strip.chunkIds.push_back(chunkIds[i]);
+            }
+        }
+    }
+
+    ThreadPool pool(stripCount);
+    pool.parallelFor(stripCount, [&](int s, int) {
+        Strip& strip = strips[s];
+        // Workers must not share the caller's context, and their timers would double count anyway.
+        rcContext workerCtx(false);
+        strip.heightfield = rcAllocHeightfield();
+        // Same bounds as the full heightfield, so the rasterizer does exactly the same arithmetic, but
+        // only the rows up to the end of the strip. The rasterizer clamps triangles that start beyond the
+        // last row into it, so one more row is kept to take them, except where the full heightfield ends.
+        const int rows = rcMin(strip.endRow + 1, heightfield.height);
+        if (!strip.heightfield ||
+            !rcCreateHeightfield(&workerCtx, *strip.heightfield, heightfield.width, rows,
+                                 heightfield.bmin, heightfield.bmax, heightfield.cs, heightfield.ch)) {
+            return;
+        }
+        strip.ok = rasterizeSerial(&workerCtx, config, mesh, chunkyMesh,
+                                   strip.chunkIds.empty() ? 0 : &strip.chunkIds[0], (int) strip.chunkIds.size(),
+                                   *strip.heightfield);
+    });
+
+    bool ok = true;
+    for (int s = 0; s < stripCount; ++s) {
+        Strip& strip = strips[s];
+        if (!strip.ok) {
+            ok = false;
+        } else {
+            // Move the strip's columns over, along with the pools their spans live in. Spans the worker
+            // made outside its strip stay unreferenced in those pools until the heightfield is freed.
+            const int first = strip.firstRow * heightfield.width;
+            const int end = strip.endRow * heightfield.width;
+            memcpy(&heightfield.spans[first], &strip.heightfield->spans[first], (end - first) * sizeof(rcSpan*));
+
+            rcSpanPool* pools = strip.heightfield->pools;
+            if (pools) {
+                rcSpanPool* last = pools;
+                while (last->next) {
+                    last = last->next;
+                }
+                last->next = heightfield.pools;
+                heightfield.pools = pools;
+                strip.heightfield->pools = 0;
+            }
+        }
+        rcFreeHeightField(strip.heightfield);
+    }
+
+    ctx->stopTimer(RC_TIMER_RASTERIZE_TRIANGLES);
+
+    if (!ok) {
+        ctx->log(RC_LOG_ERROR, "rasterizeChunks: Out of memory rasterizing %d strips.", stripCount);
+    }
+    return ok;
+}
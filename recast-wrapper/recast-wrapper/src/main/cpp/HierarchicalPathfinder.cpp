@@ -0,0 +1,425 @@
+#include "HierarchicalPathfinder.h"
+#include "DetourCommon.h"
+#include "ThreadPool.h"
+
+#include <float.h>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+// Same heuristic scale as dtNavMeshQuery::findPath.
+static const float H_SCALE = 0.999f;
+
+typedef std::pair<float, int> QueueItem;
+typedef std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem> > OpenQueue;
+
+static void calcPolyCenters(const dtMeshTile* tile, std::vector<float>& centers) {
+    centers.resize((size_t) tile->header->polyCount * 3);
+    for (int i = 0; i < tile->header->polyCount; ++i) {
+        const dtPoly* poly = &tile->polys[i];
+        dtCalcPolyCenter(&centers[i * 3], poly->verts, poly->vertCount, tile->verts);
+    }
+}
+
+HierarchicalPathfinder::HierarchicalPathfinder() :
+    m_navMesh(0),
+    m_clusterCount(0),
+    m_intraEdgeCount(0)
+{
+}
+
+bool HierarchicalPathfinder::init(const dtNavMesh* navMesh, const dtQueryFilter* filter, int threadCount) {
+    if (!navMesh) {
+        return false;
+    }
+
+    m_navMesh = navMesh;
+    m_filter = filter ? *filter : dtQueryFilter();
+    m_portals.clear();
+    m_portalEdges.clear();
+    m_edges.clear();
+    m_clusterCount = 0;
+    m_intraEdgeCount = 0;
+
+    // Gathering the portals tile by tile and poly by poly leaves them sorted by cluster, then ref.
+    const int maxTiles = navMesh->getMaxTiles();
+    m_clusterPortals.assign(maxTiles + 1, 0);
+    for (int i = 0; i < maxTiles; ++i) {
+        m_clusterPortals[i] = (int) m_portals.size();
+
+        const dtMeshTile* tile = navMesh->getTile(i);
+        if (!tile->header) {
+            continue;
+        }
+
+        const dtPolyRef base = navMesh->getPolyRefBase(tile);
+        for (int j = 0; j < tile->header->polyCount; ++j) {
+            const dtPoly* poly = &tile->polys[j];
+            const dtPolyRef ref = base | (dtPolyRef) j;
+            if (!m_filter.passFilter(ref, tile, poly)) {
+                continue;
+            }
+
+            bool isPortal = false;
+            for (unsigned int k = poly->firstLink; k != DT_NULL_LINK && !isPortal; k = tile->links[k].next) {
+                const dtPolyRef neighbourRef = tile->links[k].ref;
+                if (!neighbourRef || navMesh->decodePolyIdTile(neighbourRef) == (unsigned int) i) {
+                    continue;
+                }
+                const dtMeshTile* neighbourTile = 0;
+                const dtPoly* neighbourPoly = 0;
+                navMesh->getTileAndPolyByRefUnsafe(neighbourRef, &neighbourTile, &neighbourPoly);
+                isPortal = m_filter.passFilter(neighbourRef, neighbourTile, neighbourPoly);
+            }
+            if (!isPortal) {
+                continue;
+            }
+
+            Portal portal;
+            portal.ref = ref;
+            portal.cluster = i;
+            dtCalcPolyCenter(portal.pos, poly->verts, poly->vertCount, tile->verts);
+            m_portals.push_back(portal);
+        }
+
+        if ((int) m_portals.size() > m_clusterPortals[i]) {
+            m_clusterCount++;
+        }
+    }
+    m_clusterPortals[maxTiles] = (int) m_portals.size();
+
+    // Clusters only write the edges of their own portals, so they can be searched in parallel.
+    std::vector<std::vector<Edge> > portalEdges(m_portals.size());
+    ThreadPool pool(threadCount);
+    pool.parallelFor(maxTiles, [&](int cluster, int) {
+        const int first = m_clusterPortals[cluster];
+        const int last = m_clusterPortals[cluster + 1];
+        if (first == last) {
+            return;
+        }
+
+        const dtMeshTile* tile = navMesh->getTile(cluster);
+        std::vector<float> centers;
+        std::vector<float> costs;
+        calcPolyCenters(tile, centers);
+
+        for (int p = first; p < last; ++p) {
+            const Portal& portal = m_portals[p];
+            const int polyIndex = (int) navMesh->decodePolyIdPoly(portal.ref);
+            std::vector<Edge>& edges = portalEdges[p];
+
+            findClusterCosts(tile, polyIndex, portal.pos, centers, costs);
+            for (int q = first; q < last; ++q) {
+                const float cost = costs[navMesh->decodePolyIdPoly(m_portals[q].ref)];
+                if (q != p && cost < FLT_MAX) {
+                    Edge edge = { q, cost };
+                    edges.push_back(edge);
+                }
+            }
+
+            const dtPoly* poly = &tile->polys[polyIndex];
+            const float areaCost = m_filter.getAreaCost(poly->getArea());
+            for (unsigned int k = poly->firstLink; k != DT_NULL_LINK; k = tile->links[k].next) {
+                const dtPolyRef neighbourRef = tile->links[k].ref;
+                if (!neighbourRef || navMesh->decodePolyIdTile(neighbourRef) == (unsigned int) cluster) {
+                    continue;
+                }
+                const int target = findPortal((int) navMesh->decodePolyIdTile(neighbourRef), neighbourRef);
+                if (target < 0) {
+                    continue;
+                }
+                bool duplicate = false;
+                for (size_t e = 0; e < edges.size() && !duplicate; ++e) {
+                    duplicate = edges[e].to == target;
+                }
+                if (!duplicate) {
+                    Edge edge = { target, dtVdist(portal.pos, m_portals[target].pos) * areaCost };
+                    edges.push_back(edge);
+                }
+            }
+        }
+    });
+
+    m_portalEdges.resize(m_portals.size() + 1);
+    for (size_t i = 0; i < m_portals.size(); ++i) {
+        m_portalEdges[i] = (int) m_edges.size();
+        for (size_t e = 0; e < portalEdges[i].size(); ++e) {
+            const Edge& edge = portalEdges[i][e];
+            if (m_portals[edge.to].cluster == m_portals[i].cluster) {
+                m_intraEdgeCount++;
+            }
+            m_edges.push_back(edge);
+        }
+    }
+    m_portalEdges[m_portals.size()] = (int) m_edges.size();
+
+    return true;
+}
+
+void HierarchicalPathfinder::findClusterCosts(const dtMeshTile* tile, int sourcePoly, const float* sourcePos,
+                                              const std::vector<float>& centers, std::vector<float>& costs) const {
+    // Dijkstra from sourcePoly over the polys of one tile. Steps are costed between poly centers like
+    // dtQueryFilter::getCost, using the area of the poly being left.
+    const unsigned int tileIndex = m_navMesh->decodePolyIdTile(m_navMesh->getPolyRefBase(tile));
+    costs.assign(tile->header->polyCount, FLT_MAX);
+    costs[sourcePoly] = 0.0f;
+
+    OpenQueue open;
+    open.push(QueueItem(0.0f, sourcePoly));
+    while (!open.empty()) {
+        const QueueItem top = open.top();
+        open.pop();
+        const int current = top.second;
+        if (top.first > costs[current]) {
+            continue;
+        }
+
+        const dtPoly* poly = &tile->polys[current];
+        const float* pos = current == sourcePoly ? sourcePos : &centers[current * 3];
+        const float areaCost = m_filter.getAreaCost(poly->getArea());
+        for (unsigned int i = poly->firstLink; i != DT_NULL_LINK; i = tile->links[i].next) {
+            const dtPolyRef neighbourRef = tile->links[i].ref;
+            if (!neighbourRef || m_navMesh->decodePolyIdTile(neighbourRef) != tileIndex) {
+                continue;
+            }
+            const int neighbour = (int) m_navMesh->decodePolyIdPoly(neighbourRef);
+            if (!m_filter.passFilter(neighbourRef, tile, &tile->polys[neighbour])) {
+                continue;
+            }
+            const float cost = top.first + dtVdist(pos, &centers[neighbour * 3]) * areaCost;
+            if (cost < costs[neighbour]) {
+                costs[neighbour] = cost;
+                open.push(QueueItem(cost, neighbour));
+            }
+        }
+    }
+}
+
+void HierarchicalPathfinder::findPortalCosts(dtPolyRef ref, const float* pos, std::vector<float>& portalCosts) const {
+    const dtMeshTile* tile = 0;
+    const dtPoly* poly = 0;
+    m_navMesh->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+    const int cluster = (int) m_navMesh->decodePolyIdTile(ref);
+
+    std::vector<float> centers;
+    std::vector<float> costs;
+    calcPolyCenters(tile, centers);
+    findClusterCosts(tile, (int) m_navMesh->decodePolyIdPoly(ref), pos, centers, costs);
+
+    portalCosts.clear();
+    for (int p = m_clusterPortals[cluster]; p < m_clusterPortals[cluster + 1]; ++p) {
+        portalCosts.push_back(costs[m_navMesh->decodePolyIdPoly(m_portals[p].ref)]);
+    }
+}
+
+int HierarchicalPathfinder::findPortal(int cluster, dtPolyRef ref) const {
+    const Portal* first = &m_portals[0] + m_clusterPortals[cluster];
+    const Portal* last = &m_portals[0] + m_clusterPortals[cluster + 1];
+    const Portal* portal = std::lower_bound(first, last, ref, [](const Portal& p, dtPolyRef r) { return p.ref < r; });
+    return portal != last && portal->ref == ref ? (int) (portal - &m_portals[0]) : -1;
+}
+
+dtStatus HierarchicalPathfinder::planRoute(dtPolyRef startRef, dtPolyRef endRef, const float* startPos,
+                                           const float* endPos, std::vector<Waypoint>& waypoints) const {
+    waypoints.clear();
+    if (!m_navMesh || !startPos || !endPos ||
+        !m_navMesh->isValidPolyRef(startRef) || !m_navMesh->isValidPolyRef(endRef)) {
+        return DT_FAILURE | DT_INVALID_PARAM;
+    }
+
+    Waypoint end;
+    end.ref = endRef;
+    dtVcopy(end.pos, endPos);
+
+    const int startCluster = (int) m_navMesh->decodePolyIdTile(startRef);
+    const int endCluster = (int) m_navMesh->decodePolyIdTile(endRef);
+    if (startCluster == endCluster || startCluster >= (int) m_clusterPortals.size() - 1 ||
+        endCluster >= (int) m_clusterPortals.size() - 1) {
+        waypoints.push_back(end);
+        return DT_SUCCESS;
+    }
+
+    std::vector<float> startCosts;
+    std::vector<float> endCosts;
+    findPortalCosts(startRef, startPos, startCosts);
+    findPortalCosts(endRef, endPos, endCosts);
+
+    // A* over the portals, with the end poly as an extra goal node. Node state lives in a hash map, so
+    // memory grows with the part of the graph the search visits rather than with the whole graph.
+    struct SearchNode {
+        float cost;
+        int parent;
+        bool closed;
+    };
+    const int goal = (int) m_portals.size();
+    std::unordered_map<int, SearchNode> nodes;
+    OpenQueue open;
+
+    auto relax = [&](int node, float cost, int parent) {
+        std::unordered_map<int, SearchNode>::iterator it = nodes.find(node);
+        if (it != nodes.end() && (it->second.closed || it->second.cost <= cost)) {
+            return;
+        }
+        SearchNode& searchNode = nodes[node];
+        searchNode.cost = cost;
+        searchNode.parent = parent;
+        searchNode.closed = false;
+        const float heuristic = node == goal ? 0.0f : dtVdist(m_portals[node].pos, endPos) * H_SCALE;
+        open.push(QueueItem(cost + heuristic, node));
+    };
+
+    const int startFirst = m_clusterPortals[startCluster];
+    for (size_t i = 0; i < startCosts.size(); ++i) {
+        if (startCosts[i] < FLT_MAX) {
+            relax(startFirst + (int) i, startCosts[i], -1);
+        }
+    }
+
+    const int endFirst = m_clusterPortals[endCluster];
+    int closest = -1;
+    float closestDist = FLT_MAX;
+    bool reachedGoal = false;
+    while (!open.empty()) {
+        const int node = open.top().second;
+        open.pop();
+
+        SearchNode& searchNode = nodes[node];
+        if (searchNode.closed) {
+            continue;
+        }
+        searchNode.closed = true;
+        if (node == goal) {
+            reachedGoal = true;
+            break;
+        }
+
+        const Portal& portal = m_portals[node];
+        const float dist = dtVdist(portal.pos, endPos);
+        if (dist < closestDist) {
+            closest = node;
+            closestDist = dist;
+        }
+
+        const float cost = searchNode.cost;
+        if (portal.cluster == endCluster && endCosts[node - endFirst] < FLT_MAX) {
+            relax(goal, cost + endCosts[node - endFirst], node);
+        }
+        for (int e = m_portalEdges[node]; e < m_portalEdges[node + 1]; ++e) {
+            relax(m_edges[e].to, cost + m_edges[e].cost, node);
+        }
+    }
+
+    const int last = reachedGoal ? goal : closest;
+    if (last < 0) {
+        // No portal can be reached from the start poly.
+        return DT_SUCCESS | DT_PARTIAL_RESULT;
+    }
+
+    std::vector<int> route;
+    for (int node = last; node != -1; node = nodes[node].parent) {
+        route.push_back(node);
+    }
+    std::reverse(route.begin(), route.end());
+
+    // The route starts on a portal of the start tile. Keep the portals where it enters the next tile.
+    for (size_t i = 1; i < route.size(); ++i) {
+        if (route[i] == goal) {
+            waypoints.push_back(end);
+        } else if (m_portals[route[i]].cluster != m_portals[route[i - 1]].cluster) {
+            Waypoint waypoint;
+            waypoint.ref = m_portals[route[i]].ref;
+            dtVcopy(waypoint.pos, m_portals[route[i]].pos);
+            waypoints.push_back(waypoint);
+        }
+    }
+    if (!reachedGoal && (waypoints.empty() || waypoints.back().ref != m_portals[last].ref)) {
+        Waypoint waypoint;
+        waypoint.ref = m_portals[last].ref;
+        dtVcopy(waypoint.pos, m_portals[last].pos);
+        waypoints.push_back(waypoint);
+    }
+
+    return reachedGoal ? DT_SUCCESS : DT_SUCCESS | DT_PARTIAL_RESULT;
+}
+
+int HierarchicalPathfinder::findWaypoints(dtPolyRef startRef, dtPolyRef endRef, const float* startPos,
+                                          const float* endPos, dtPolyRef* waypointRefs, float* waypointPositions,
+                                          int maxWaypoints, dtStatus* status) const {
+    std::vector<Waypoint> waypoints;
+    dtStatus result = planRoute(startRef, endRef, startPos, endPos, waypoints);
+
+    int count = 0;
+    if (dtStatusSucceed(result)) {
+        count = dtMin((int) waypoints.size(), dtMax(maxWaypoints, 0));
+        if (count < (int) waypoints.size()) {
+            result |= DT_BUFFER_TOO_SMALL;
+        }
+        for (int i = 0; i < count; ++i) {
+            waypointRefs[i] = waypoints[i].ref;
+            if (waypointPositions) {
+                dtVcopy(&waypointPositions[i * 3], waypoints[i].pos);
+            }
+        }
+    }
+
+    if (status) {
+        *status = result;
+    }
+    return count;
+}
+
+int HierarchicalPathfinder::findPath(dtNavMeshQuery* navQuery, dtPolyRef startRef, dtPolyRef endRef,
+                                     const float* startPos, const float* endPos, dtPolyRef* path, int maxPath,
+                                     dtStatus* status) const {
+    std::vector<Waypoint> waypoints;
+    dtStatus result = planRoute(startRef, endRef, startPos, endPos, waypoints);
+
+    int count = 0;
+    if (dtStatusSucceed(result) && waypoints.empty()) {
+        // Nothing outside the start tile is reachable, which a plain search handles within its node pool.
+        result = navQuery->findPath(startRef, endRef, startPos, endPos, &m_filter, path, &count, maxPath);
+    } else if (dtStatusSucceed(result)) {
+        dtPolyRef current = startRef;
+        const float* currentPos = startPos;
+        for (size_t i = 0; i < waypoints.size(); ++i) {
+            // Each segment starts on the poly the previous one ended on, which is already in the path.
+            const int offset = count > 0 ? count - 1 : 0;
+            int segmentCount = 0;
+            const dtStatus segment = navQuery->findPath(current, waypoints[i].ref, currentPos, waypoints[i].pos,
+                                                        &m_filter, path + offset, &segmentCount, maxPath - offset);
+            if (dtStatusFailed(segment)) {
+                result = count > 0 ? (DT_SUCCESS | DT_PARTIAL_RESULT) : segment;
+                break;
+            }
+            count = offset + segmentCount;
+
+            if (dtStatusDetail(segment, DT_BUFFER_TOO_SMALL)) {
+                result |= DT_BUFFER_TOO_SMALL;
+                break;
+            }
+            if (path[count - 1] != waypoints[i].ref) {
+                result |= DT_PARTIAL_RESULT;
+                break;
+            }
+            current = waypoints[i].ref;
+            currentPos = waypoints[i].pos;
+        }
+    }
+
+    if (status) {
+        *status = result;
+    }
+    return dtStatusFailed(result) ? 0 : count;
+}
+
+void HierarchicalPathfinder::getStats(HierarchicalGraphStats* stats) const {
+    stats->clusters = m_clusterCount;
+    stats->portals = (int) m_portals.size();
+    stats->intraEdges = m_intraEdgeCount;
+    stats->interEdges = (int) m_edges.size() - m_intraEdgeCount;
+    stats->memoryBytes = (long long) (m_portals.capacity() * sizeof(Portal) +
+                                      m_clusterPortals.capacity() * sizeof(int) +
+                                      m_portalEdges.capacity() * sizeof(int) +
+                                      m_edges.capacity() * sizeof(Edge));
+}
@@ -23,9 +23,12 @@
 #include <string.h>
 #include <algorithm>
 #include "Recast.h"
+#include "DetourNavMeshBuilder.h"
 #include "InputGeom.h"
 #include "ChunkyTriMesh.h"
 #include "MeshLoaderObj.h"
+#include "GeomCache.h"
+#include "MappedFile.h"
 
 static bool intersectSegmentTriangle(const float* sp, const float* sq,
 									 const float* a, const float* b, const float* c,
@@ -101,12 +104,17 @@ static char* parseRow(char* buf, char* bufEnd, char* row, int len)
 	return buf;
 }
 
+// World units per cell of the convex volume and off-mesh connection grids, about a typical tile.
+static const float MARKUP_GRID_CELL_SIZE = 32.0f;
+
 InputGeom::InputGeom() :
 	m_chunkyMesh(0),
 	m_mesh(0),
+	m_geomCache(0),
 	m_hasBuildSettings(false),
-	m_offMeshConCount(0),
-	m_volumeCount(0)
+	m_offMeshConNextId(1000),
+	m_offMeshConGrid(MARKUP_GRID_CELL_SIZE),
+	m_volumeGrid(MARKUP_GRID_CELL_SIZE)
 {
 }
 
@@ -114,20 +122,86 @@ InputGeom::~InputGeom()
 {
 	delete m_chunkyMesh;
 	delete m_mesh;
+	// The mesh and chunky mesh may point into the cache mapping, so it goes last.
+	delete m_geomCache;
 }
-		
-bool InputGeom::loadMesh(rcContext* ctx, const std::string& filepath, bool invertYZ)
+
+static const int CHUNKY_TRIS_PER_CHUNK = 256;
+
+bool InputGeom::loadCachedMesh(const std::string& filepath, unsigned long long sourceHash,
+							   unsigned long long sourceSize, bool invertYZ)
 {
-	if (m_mesh)
+	m_geomCache = new MappedFile;
+	GeomCacheData data;
+	if (!readGeomCache(getGeomCachePath(filepath), sourceHash, sourceSize, invertYZ, CHUNKY_TRIS_PER_CHUNK,
+					   *m_geomCache, data))
+	{
+		delete m_geomCache;
+		m_geomCache = 0;
+		return false;
+	}
+
+	m_mesh = new rcMeshLoaderObj;
+	m_mesh->setExternalData(filepath, data.verts, data.header->vertCount, data.tris, data.normals,
+							data.header->triCount);
+	rcVcopy(m_meshBMin, data.header->bmin);
+	rcVcopy(m_meshBMax, data.header->bmax);
+
+	m_chunkyMesh = new rcChunkyTriMesh;
+	m_chunkyMesh->nodes = data.nodes;
+	m_chunkyMesh->nnodes = data.header->nodeCount;
+	m_chunkyMesh->tris = data.chunkTris;
+	m_chunkyMesh->ntris = data.header->chunkTriCount;
+	m_chunkyMesh->maxTrisPerChunk = data.header->maxTrisPerChunk;
+	m_chunkyMesh->ownsData = false;
+	if (!rcBuildChunkyTriMeshWideNodes(m_chunkyMesh))
 	{
 		delete m_chunkyMesh;
 		m_chunkyMesh = 0;
 		delete m_mesh;
 		m_mesh = 0;
+		delete m_geomCache;
+		m_geomCache = 0;
+		return false;
 	}
-	m_offMeshConCount = 0;
-	m_volumeCount = 0;
-	
+	return true;
+}
+
+bool InputGeom::loadMesh(rcContext* ctx, const std::string& filepath, bool invertYZ)
+{
+	delete m_chunkyMesh;
+	m_chunkyMesh = 0;
+	delete m_mesh;
+	m_mesh = 0;
+	delete m_geomCache;
+	m_geomCache = 0;
+	m_offMeshConVerts.clear();
+	m_offMeshConRads.clear();
+	m_offMeshConDirs.clear();
+	m_offMeshConAreas.clear();
+	m_offMeshConFlags.clear();
+	m_offMeshConId.clear();
+	m_offMeshConNextId = 1000;
+	m_offMeshConGrid.clear();
+	m_volumes.clear();
+	m_volumeBounds.clear();
+	m_volumeGrid.clear();
+
+	// The geometry cache next to the OBJ is keyed by a hash of its content, so an edited OBJ is
+	// re-parsed and the cache rewritten.
+	MappedFile source;
+	if (!source.open(filepath.c_str()))
+	{
+		ctx->log(RC_LOG_ERROR, "buildTiledNavigation: Could not load '%s'", filepath.c_str());
+		return false;
+	}
+	const unsigned long long sourceSize = source.getSize();
+	const unsigned long long sourceHash = hashGeomSource(source.getData(), source.getSize(), 0);
+	source.close();
+
+	if (loadCachedMesh(filepath, sourceHash, sourceSize, invertYZ))
+		return true;
+
 	m_mesh = new rcMeshLoaderObj;
 	if (!m_mesh)
 	{
@@ -148,11 +222,30 @@ bool InputGeom::loadMesh(rcContext* ctx, const std::string& filepath, bool inver
 		ctx->log(RC_LOG_ERROR, "buildTiledNavigation: Out of memory 'm_chunkyMesh'.");
 		return false;
 	}
-	if (!rcCreateChunkyTriMesh(m_mesh->getVerts(), m_mesh->getTris(), m_mesh->getTriCount(), 256, m_chunkyMesh))
+	if (!rcCreateChunkyTriMesh(m_mesh->getVerts(), m_mesh->getTris(), m_mesh->getTriCount(), CHUNKY_TRIS_PER_CHUNK, m_chunkyMesh))
 	{
 		ctx->log(RC_LOG_ERROR, "buildTiledNavigation: Failed to build chunky mesh.");
 		return false;
-	}		
+	}
+
+	GeomCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	header.sourceHash = sourceHash;
+	header.sourceSize = sourceSize;
+	header.invertYZ = invertYZ ? 1 : 0;
+	header.trisPerChunk = CHUNKY_TRIS_PER_CHUNK;
+	header.vertCount = m_mesh->getVertCount();
+	header.triCount = m_mesh->getTriCount();
+	header.nodeCount = m_chunkyMesh->nnodes;
+	header.chunkTriCount = m_chunkyMesh->ntris;
+	header.maxTrisPerChunk = m_chunkyMesh->maxTrisPerChunk;
+	rcVcopy(header.bmin, m_meshBMin);
+	rcVcopy(header.bmax, m_meshBMax);
+	if (!writeGeomCache(getGeomCachePath(filepath), header, m_mesh->getVerts(), m_mesh->getTris(),
+						m_mesh->getNormals(), m_chunkyMesh->nodes, m_chunkyMesh->tris))
+	{
+		ctx->log(RC_LOG_WARNING, "loadMesh: Could not write geometry cache for '%s'.", filepath.c_str());
+	}
 
 	return true;
 }
@@ -210,46 +303,127 @@ static bool isectSegAABB(const float* sp, const float* sq,
 void InputGeom::addOffMeshConnection(const float* spos, const float* epos, const float rad,
 									 unsigned char bidir, unsigned char area, unsigned short flags)
 {
-	if (m_offMeshConCount >= MAX_OFFMESH_CONNECTIONS) return;
-	float* v = &m_offMeshConVerts[m_offMeshConCount*3*2];
-	m_offMeshConRads[m_offMeshConCount] = rad;
-	m_offMeshConDirs[m_offMeshConCount] = bidir;
-	m_offMeshConAreas[m_offMeshConCount] = area;
-	m_offMeshConFlags[m_offMeshConCount] = flags;
-	m_offMeshConId[m_offMeshConCount] = 1000 + m_offMeshConCount;
-	rcVcopy(&v[0], spos);
-	rcVcopy(&v[3], epos);
-	m_offMeshConCount++;
+	const int i = getOffMeshConnectionCount();
+	m_offMeshConVerts.insert(m_offMeshConVerts.end(), spos, spos+3);
+	m_offMeshConVerts.insert(m_offMeshConVerts.end(), epos, epos+3);
+	m_offMeshConRads.push_back(rad);
+	m_offMeshConDirs.push_back(bidir);
+	m_offMeshConAreas.push_back(area);
+	m_offMeshConFlags.push_back(flags);
+	m_offMeshConId.push_back(m_offMeshConNextId++);
+	m_offMeshConGrid.insert(i, spos, spos);
 }
 
 void InputGeom::deleteOffMeshConnection(int i)
 {
-	m_offMeshConCount--;
-	float* src = &m_offMeshConVerts[m_offMeshConCount*3*2];
-	float* dst = &m_offMeshConVerts[i*3*2];
-	rcVcopy(&dst[0], &src[0]);
-	rcVcopy(&dst[3], &src[3]);
-	m_offMeshConRads[i] = m_offMeshConRads[m_offMeshConCount];
-	m_offMeshConDirs[i] = m_offMeshConDirs[m_offMeshConCount];
-	m_offMeshConAreas[i] = m_offMeshConAreas[m_offMeshConCount];
-	m_offMeshConFlags[i] = m_offMeshConFlags[m_offMeshConCount];
+	const int last = getOffMeshConnectionCount()-1;
+	if (i < 0 || i > last) return;
+	m_offMeshConGrid.remove(i, &m_offMeshConVerts[i*3*2], &m_offMeshConVerts[i*3*2]);
+	if (i != last)
+	{
+		m_offMeshConGrid.renumber(last, i, &m_offMeshConVerts[last*3*2], &m_offMeshConVerts[last*3*2]);
+		std::copy(&m_offMeshConVerts[last*3*2], &m_offMeshConVerts[last*3*2]+6, &m_offMeshConVerts[i*3*2]);
+		m_offMeshConRads[i] = m_offMeshConRads[last];
+		m_offMeshConDirs[i] = m_offMeshConDirs[last];
+		m_offMeshConAreas[i] = m_offMeshConAreas[last];
+		m_offMeshConFlags[i] = m_offMeshConFlags[last];
+		m_offMeshConId[i] = m_offMeshConId[last];
+	}
+	m_offMeshConVerts.resize(last*3*2);
+	m_offMeshConRads.pop_back();
+	m_offMeshConDirs.pop_back();
+	m_offMeshConAreas.pop_back();
+	m_offMeshConFlags.pop_back();
+	m_offMeshConId.pop_back();
+}
+
+void InputGeom::gatherOffMeshConnections(const float* bmin, const float* bmax, OffMeshConnectionSet& storage,
+										 dtNavMeshCreateParams& params) const
+{
+	storage.verts.clear();
+	storage.rads.clear();
+	storage.dirs.clear();
+	storage.areas.clear();
+	storage.flags.clear();
+	storage.ids.clear();
+
+	m_offMeshConGrid.query(bmin, bmax, storage.indices);
+	for (size_t n = 0; n < storage.indices.size(); ++n)
+	{
+		const int i = storage.indices[n];
+		const float* v = &m_offMeshConVerts[i*3*2];
+		if (v[0] < bmin[0] || v[0] > bmax[0] || v[2] < bmin[2] || v[2] > bmax[2])
+			continue;
+		storage.verts.insert(storage.verts.end(), v, v+6);
+		storage.rads.push_back(m_offMeshConRads[i]);
+		storage.dirs.push_back(m_offMeshConDirs[i]);
+		storage.areas.push_back(m_offMeshConAreas[i]);
+		storage.flags.push_back(m_offMeshConFlags[i]);
+		storage.ids.push_back(m_offMeshConId[i]);
+	}
+
+	params.offMeshConCount = (int)storage.rads.size();
+	params.offMeshConVerts = storage.rads.empty() ? 0 : &storage.verts[0];
+	params.offMeshConRad = storage.rads.empty() ? 0 : &storage.rads[0];
+	params.offMeshConDir = storage.rads.empty() ? 0 : &storage.dirs[0];
+	params.offMeshConAreas = storage.rads.empty() ? 0 : &storage.areas[0];
+	params.offMeshConFlags = storage.rads.empty() ? 0 : &storage.flags[0];
+	params.offMeshConUserID = storage.rads.empty() ? 0 : &storage.ids[0];
 }
 
 void InputGeom::addConvexVolume(const float* verts, const int nverts,
 								const float minh, const float maxh, unsigned char area)
 {
-	if (m_volumeCount >= MAX_VOLUMES) return;
-	ConvexVolume* vol = &m_volumes[m_volumeCount++];
-	memset(vol, 0, sizeof(ConvexVolume));
-	memcpy(vol->verts, verts, sizeof(float)*3*nverts);
-	vol->hmin = minh;
-	vol->hmax = maxh;
-	vol->nverts = nverts;
-	vol->area = area;
+	if (nverts < 3 || nverts > MAX_CONVEXVOL_PTS) return;
+	ConvexVolume vol;
+	memset(&vol, 0, sizeof(ConvexVolume));
+	memcpy(vol.verts, verts, sizeof(float)*3*nverts);
+	vol.hmin = minh;
+	vol.hmax = maxh;
+	vol.nverts = nverts;
+	vol.area = area;
+
+	float bounds[6];
+	rcVcopy(&bounds[0], verts);
+	rcVcopy(&bounds[3], verts);
+	for (int j = 1; j < nverts; ++j)
+	{
+		rcVmin(&bounds[0], &verts[j*3]);
+		rcVmax(&bounds[3], &verts[j*3]);
+	}
+	bounds[1] = minh;
+	bounds[4] = maxh;
+
+	const int i = getConvexVolumeCount();
+	m_volumes.push_back(vol);
+	m_volumeBounds.insert(m_volumeBounds.end(), bounds, bounds+6);
+	m_volumeGrid.insert(i, &bounds[0], &bounds[3]);
 }
 
 void InputGeom::deleteConvexVolume(int i)
 {
-	m_volumeCount--;
-	m_volumes[i] = m_volumes[m_volumeCount];
+	const int last = getConvexVolumeCount()-1;
+	if (i < 0 || i > last) return;
+	m_volumeGrid.remove(i, &m_volumeBounds[i*6], &m_volumeBounds[i*6+3]);
+	if (i != last)
+	{
+		m_volumeGrid.renumber(last, i, &m_volumeBounds[last*6], &m_volumeBounds[last*6+3]);
+		m_volumes[i] = m_volumes[last];
+		std::copy(&m_volumeBounds[last*6], &m_volumeBounds[last*6]+6, &m_volumeBounds[i*6]);
+	}
+	m_volumes.pop_back();
+	m_volumeBounds.resize(last*6);
+}
+
+void InputGeom::queryConvexVolumes(const float* bmin, const float* bmax, std::vector<int>& volumes) const
+{
+	m_volumeGrid.query(bmin, bmax, volumes);
+	size_t n = 0;
+	for (size_t j = 0; j < volumes.size(); ++j)
+	{
+		const float* b = &m_volumeBounds[volumes[j]*6];
+		if (b[0] <= bmax[0] && b[3] >= bmin[0] && b[2] <= bmax[2] && b[5] >= bmin[2])
+			volumes[n++] = volumes[j];
+	}
+	volumes.resize(n);
 }
@@ -0,0 +1,115 @@
+#include "MarkupGrid.h"
+
+#include <math.h>
+#include <algorithm>
+
+// Items spanning more cells than this on an axis are kept in the overflow list that every query scans,
+// and queries spanning more collect every item, rather than walking billions of mostly empty cells.
+static const double MAX_CELL_SPAN = 4096;
+// Keeps cell coordinates, and the loops over them, well inside the range of int.
+static const double MAX_CELL_COORD = 1 << 30;
+
+MarkupGrid::MarkupGrid(float cellSize) :
+    m_invCellSize(1.0f / cellSize)
+{
+}
+
+bool MarkupGrid::cellRange(const float* bmin, const float* bmax, int* x0, int* z0, int* x1, int* z1) const {
+    const double fx0 = floor((double) bmin[0] * m_invCellSize);
+    const double fz0 = floor((double) bmin[2] * m_invCellSize);
+    const double fx1 = floor((double) bmax[0] * m_invCellSize);
+    const double fz1 = floor((double) bmax[2] * m_invCellSize);
+    // Written so that NaN bounds fail too.
+    if (!(fx0 <= fx1 && fz0 <= fz1 && fx1 - fx0 <= MAX_CELL_SPAN && fz1 - fz0 <= MAX_CELL_SPAN &&
+          fabs(fx0) < MAX_CELL_COORD && fabs(fz0) < MAX_CELL_COORD &&
+          fabs(fx1) < MAX_CELL_COORD && fabs(fz1) < MAX_CELL_COORD)) {
+        return false;
+    }
+    *x0 = (int) fx0;
+    *z0 = (int) fz0;
+    *x1 = (int) fx1;
+    *z1 = (int) fz1;
+    return true;
+}
+
+void MarkupGrid::clear() {
+    m_cells.clear();
+    m_overflow.clear();
+}
+
+void MarkupGrid::insert(int item, const float* bmin, const float* bmax) {
+    int x0, z0, x1, z1;
+    if (!cellRange(bmin, bmax, &x0, &z0, &x1, &z1)) {
+        m_overflow.push_back(item);
+        return;
+    }
+    for (int z = z0; z <= z1; ++z) {
+        for (int x = x0; x <= x1; ++x) {
+            m_cells[cellKey(x, z)].push_back(item);
+        }
+    }
+}
+
+void MarkupGrid::remove(int item, const float* bmin, const float* bmax) {
+    int x0, z0, x1, z1;
+    if (!cellRange(bmin, bmax, &x0, &z0, &x1, &z1)) {
+        m_overflow.erase(std::remove(m_overflow.begin(), m_overflow.end(), item), m_overflow.end());
+        return;
+    }
+    for (int z = z0; z <= z1; ++z) {
+        for (int x = x0; x <= x1; ++x) {
+            std::unordered_map<long long, std::vector<int> >::iterator cell = m_cells.find(cellKey(x, z));
+            if (cell == m_cells.end()) {
+                continue;
+            }
+            std::vector<int>& items = cell->second;
+            items.erase(std::remove(items.begin(), items.end(), item), items.end());
+            if (items.empty()) {
+                m_cells.erase(cell);
+            }
+        }
+    }
+}
+
+void MarkupGrid::renumber(int from, int to, const float* bmin, const float* bmax) {
+    int x0, z0, x1, z1;
+    if (!cellRange(bmin, bmax, &x0, &z0, &x1, &z1)) {
+        std::replace(m_overflow.begin(), m_overflow.end(), from, to);
+        return;
+    }
+    for (int z = z0; z <= z1; ++z) {
+        for (int x = x0; x <= x1; ++x) {
+            std::unordered_map<long long, std::vector<int> >::iterator cell = m_cells.find(cellKey(x, z));
+            if (cell != m_cells.end()) {
+                std::replace(cell->second.begin(), cell->second.end(), from, to);
+            }
+        }
+    }
+}
+
+void MarkupGrid::query(const float* bmin, const float* bmax, std::vector<int>& items) const {
+    items.assign(m_overflow.begin(), m_overflow.end());
+    if (m_cells.empty()) {
+        return;
+    }
+
+    int x0, z0, x1, z1;
+    if (!cellRange(bmin, bmax, &x0, &z0, &x1, &z1)) {
+        for (std::unordered_map<long long, std::vector<int> >::const_iterator cell = m_cells.begin();
+             cell != m_cells.end(); ++cell) {
+            items.insert(items.end(), cell->second.begin(), cell->second.end());
+        }
+    } else {
+        for (int z = z0; z <= z1; ++z) {
+            for (int x = x0; x <= x1; ++x) {
+                std::unordered_map<long long, std::vector<int> >::const_iterator cell = m_cells.find(cellKey(x, z));
+                if (cell != m_cells.end()) {
+                    items.insert(items.end(), cell->second.begin(), cell->second.end());
+                }
+            }
+        }
+    }
+
+    std::sort(items.begin(), items.end());
+    items.erase(std::unique(items.begin(), items.end()), items.end());
+}
@@ -17,9 +17,13 @@
 //
 
 #include "MeshLoaderObj.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <cstring>
+#include <locale.h>
+#include <vector>
 #define _USE_MATH_DEFINES
 #include <math.h>
 
@@ -29,54 +33,40 @@ rcMeshLoaderObj::rcMeshLoaderObj() :
 	m_tris(0),
 	m_normals(0),
 	m_vertCount(0),
-	m_triCount(0)
+	m_triCount(0),
+	m_ownsData(true)
 {
 }
 
 rcMeshLoaderObj::~rcMeshLoaderObj()
 {
-	delete [] m_verts;
-	delete [] m_normals;
-	delete [] m_tris;
-}
-		
-void rcMeshLoaderObj::addVertex(float x, float y, float z, int& cap)
-{
-	if (m_vertCount+1 > cap)
+	if (m_ownsData)
 	{
-		cap = !cap ? 8 : cap*2;
-		float* nv = new float[cap*3];
-		if (m_vertCount)
-			memcpy(nv, m_verts, m_vertCount*3*sizeof(float));
 		delete [] m_verts;
-		m_verts = nv;
+		delete [] m_normals;
+		delete [] m_tris;
 	}
-	float* dst = &m_verts[m_vertCount*3];
-	*dst++ = x*m_scale;
-	*dst++ = y*m_scale;
-	*dst++ = z*m_scale;
-	m_vertCount++;
 }
 
-void rcMeshLoaderObj::addTriangle(int a, int b, int c, int& cap)
+void rcMeshLoaderObj::setExternalData(const std::string& fileName, float* verts, int vertCount,
+									  int* tris, float* normals, int triCount)
 {
-	if (m_triCount+1 > cap)
+	if (m_ownsData)
 	{
-		cap = !cap ? 8 : cap*2;
-		int* nv = new int[cap*3];
-		if (m_triCount)
-			memcpy(nv, m_tris, m_triCount*3*sizeof(int));
+		delete [] m_verts;
+		delete [] m_normals;
 		delete [] m_tris;
-		m_tris = nv;
 	}
-	int* dst = &m_tris[m_triCount*3];
-	*dst++ = a;
-	*dst++ = b;
-	*dst++ = c;
-	m_triCount++;
+	m_verts = verts;
+	m_tris = tris;
+	m_normals = normals;
+	m_vertCount = vertCount;
+	m_triCount = triCount;
+	m_ownsData = false;
+	m_filename = fileName;
 }
 
-static char* parseRow(char* buf, char* bufEnd, char* row, int len)
+static const char* parseRow(const char* buf, const char* bufEnd, char* row, int len)
 {
 	bool start = true;
 	bool done = false;
@@ -112,7 +102,163 @@ static char* parseRow(char* buf, char* bufEnd, char* row, int len)
 	return buf;
 }
 
-static int parseFace(char* row, int* data, int n, int vcnt)
+static inline bool isSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static inline bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+// Same result as atoi for the index tokens found in face rows.
+static int parseInt(const char* s)
+{
+	while (isSpace(*s)) s++;
+	bool negative = false;
+	if (*s == '-' || *s == '+')
+		negative = *s++ == '-';
+	unsigned int v = 0;
+	while (isDigit(*s))
+		v = v*10 + (unsigned int)(*s++ - '0');
+	return negative ? -(int)v : (int)v;
+}
+
+// strtof with the C locale's '.' decimal point regardless of the process locale. Used for the inputs
+// parseFloat cannot convert exactly; the token is copied and its '.' swapped for the locale's separator.
+static float parseFloatSlow(const char* s, const char* tokenEnd, const char** end)
+{
+	char buf[512];
+	const int len = (int)(tokenEnd - s) < (int)sizeof(buf)-1 ? (int)(tokenEnd - s) : (int)sizeof(buf)-1;
+	const char decimalPoint = localeconv()->decimal_point[0];
+	for (int i = 0; i < len; ++i)
+		buf[i] = s[i] == '.' ? decimalPoint : s[i];
+	buf[len] = '\0';
+	char* bufEnd = 0;
+	const float v = strtof(buf, &bufEnd);
+	*end = s + (bufEnd - buf);
+	return v;
+}
+
+// Locale independent replacement for the "%f" conversion sscanf used to do. Decimal numbers with up to
+// 19 significant digits and a small exponent take the exact fast path (Clinger): the mantissa and power
+// of ten are both exact doubles, so one multiply or divide gives the correctly rounded double, and
+// rounding that to float is only ambiguous when it lands exactly between two floats. Everything else
+// (long mantissas, large exponents, hex, inf/nan, that tie case) goes through strtof, so the results
+// match sscanf in the C locale bit for bit. Returns false if no number could be converted.
+static bool parseFloat(const char* s, const char** end, float* out)
+{
+	static const double pow10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	while (isSpace(*s)) s++;
+	const char* tokenStart = s;
+
+	bool negative = false;
+	if (*s == '-' || *s == '+')
+		negative = *s++ == '-';
+
+	// Hex floats, "inf" and "nan" are rare enough to leave to strtof.
+	if ((s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) || *s == 'i' || *s == 'I' || *s == 'n' || *s == 'N')
+	{
+		const char* tokenEnd = s;
+		while (*tokenEnd && !isSpace(*tokenEnd)) tokenEnd++;
+		*out = parseFloatSlow(tokenStart, tokenEnd, end);
+		return *end != tokenStart;
+	}
+
+	unsigned long long mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool any = false;
+	bool exact = true;
+
+	// Leading zeros do not count towards the significant digits.
+	while (*s == '0') { s++; any = true; }
+	while (isDigit(*s))
+	{
+		if (digits < 19) mantissa = mantissa*10 + (unsigned long long)(*s - '0');
+		else { exponent++; exact = exact && *s == '0'; }
+		if (mantissa) digits++;
+		s++;
+		any = true;
+	}
+	if (*s == '.')
+	{
+		s++;
+		if (!mantissa)
+		{
+			while (*s == '0') { s++; exponent--; any = true; }
+		}
+		while (isDigit(*s))
+		{
+			if (digits < 19) { mantissa = mantissa*10 + (unsigned long long)(*s - '0'); exponent--; }
+			else exact = exact && *s == '0';
+			if (mantissa) digits++;
+			s++;
+			any = true;
+		}
+	}
+
+	const char* tokenEnd = s;
+	if (!any)
+		return false;
+
+	if (*s == 'e' || *s == 'E')
+	{
+		const char* e = s + 1;
+		bool negativeExponent = false;
+		if (*e == '-' || *e == '+')
+			negativeExponent = *e++ == '-';
+		if (isDigit(*e))
+		{
+			int value = 0;
+			while (isDigit(*e))
+			{
+				if (value < 100000) value = value*10 + (*e - '0');
+				e++;
+			}
+			exponent += negativeExponent ? -value : value;
+			s = e;
+			tokenEnd = e;
+		}
+	}
+
+	*end = s;
+
+	if (!mantissa)
+	{
+		*out = negative ? -0.0f : 0.0f;
+		return true;
+	}
+
+	if (exact && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22)
+	{
+		const double d = exponent < 0 ? (double)mantissa / pow10[-exponent] : (double)mantissa * pow10[exponent];
+		if (d >= 1.1754943508222875e-38 && d <= 3.4028234663852886e+38)
+		{
+			unsigned long long bits;
+			memcpy(&bits, &d, sizeof(bits));
+			// The 29 mantissa bits a float drops being exactly 100...0 means d is a float midpoint.
+			if ((bits & 0x1fffffffull) != 0x10000000ull)
+			{
+				const float f = (float)d;
+				*out = negative ? -f : f;
+				return true;
+			}
+		}
+	}
+
+	*out = parseFloatSlow(tokenStart, tokenEnd, end);
+	return true;
+}
+
+// Collects the raw indices of a face row; parseFace used to resolve them against the running vertex
+// count, which is only known once the preceding chunks have been counted.
+static int parseFaceIndices(char* row, int* data, int n)
 {
 	int j = 0;
 	while (*row != '\0')
@@ -129,59 +275,31 @@ static int parseFace(char* row, int* data, int n, int vcnt)
 		}
 		if (*s == '\0')
 			continue;
-		int vi = atoi(s);
-		data[j++] = vi < 0 ? vi+vcnt : vi-1;
+		data[j++] = parseInt(s);
 		if (j >= n) return j;
 	}
 	return j;
 }
 
-bool rcMeshLoaderObj::load(const std::string& filename, bool invertYZ)
+namespace
 {
-	char* buf = 0;
-	FILE* fp = fopen(filename.c_str(), "rb");
-	if (!fp)
-		return false;
-	if (fseek(fp, 0, SEEK_END) != 0)
+	// Output of parsing one line-aligned slice of the file.
+	struct ObjChunk
 	{
-		fclose(fp);
-		return false;
-	}
-	long bufSize = ftell(fp);
-	if (bufSize < 0)
-	{
-		fclose(fp);
-		return false;
-	}
-	if (fseek(fp, 0, SEEK_SET) != 0)
-	{
-		fclose(fp);
-		return false;
-	}
-	buf = new char[bufSize];
-	if (!buf)
-	{
-		fclose(fp);
-		return false;
-	}
-	size_t readLen = fread(buf, bufSize, 1, fp);
-	fclose(fp);
-
-	if (readLen != 1)
-	{
-		delete[] buf;
-		return false;
-	}
+		std::vector<float> verts;	// x, y, z as written in the file.
+		std::vector<int> partial;	// (vertex, components parsed) for vertex rows with fewer than 3 numbers.
+		std::vector<int> faces;		// Per face row: index count, vertices seen so far, raw indices.
+		std::vector<int> tris;
+		int vertBase;
+		int triBase;
+	};
+}
 
-	char* src = buf;
-	char* srcEnd = buf + bufSize;
+static void parseChunk(const char* src, const char* srcEnd, ObjChunk& chunk)
+{
 	char row[512];
 	int face[32];
-	float x,y,z;
-	int nv;
-	int vcap = 0;
-	int tcap = 0;
-	
+
 	while (src < srcEnd)
 	{
 		// Parse one row
@@ -192,56 +310,198 @@ bool rcMeshLoaderObj::load(const std::string& filename, bool invertYZ)
 		if (row[0] == 'v' && row[1] != 'n' && row[1] != 't')
 		{
 			// Vertex pos
-			sscanf(row+1, "%f %f %f", &x, &y, &z);
-
-			if (invertYZ) addVertex(x, z, -y, vcap);
-			else addVertex(x, y, z, vcap);
+			float v[3] = { 0.0f, 0.0f, 0.0f };
+			const char* p = row+1;
+			int parsed = 0;
+			while (parsed < 3 && parseFloat(p, &p, &v[parsed]))
+				parsed++;
+			if (parsed < 3)
+			{
+				chunk.partial.push_back((int)chunk.verts.size()/3);
+				chunk.partial.push_back(parsed);
+			}
+			chunk.verts.push_back(v[0]);
+			chunk.verts.push_back(v[1]);
+			chunk.verts.push_back(v[2]);
 		}
 		if (row[0] == 'f')
 		{
 			// Faces
-			nv = parseFace(row+1, face, 32, m_vertCount);
-			for (int i = 2; i < nv; ++i)
-			{
-				const int a = face[0];
-				const int b = face[i-1];
-				const int c = face[i];
-				if (a < 0 || a >= m_vertCount || b < 0 || b >= m_vertCount || c < 0 || c >= m_vertCount)
-					continue;
-				addTriangle(a, b, c, tcap);
-			}
+			const int nv = parseFaceIndices(row+1, face, 32);
+			chunk.faces.push_back(nv);
+			chunk.faces.push_back((int)chunk.verts.size()/3);
+			chunk.faces.insert(chunk.faces.end(), face, face + nv);
 		}
 	}
+}
 
-	delete [] buf;
-
-	// Calculate normals.
-	m_normals = new float[m_triCount*3];
-	for (int i = 0; i < m_triCount*3; i += 3)
-	{
-		const float* v0 = &m_verts[m_tris[i]*3];
-		const float* v1 = &m_verts[m_tris[i+1]*3];
-		const float* v2 = &m_verts[m_tris[i+2]*3];
-		float e0[3], e1[3];
-		for (int j = 0; j < 3; ++j)
+static void triangulateChunk(ObjChunk& chunk)
+{
+	const std::vector<int>& faces = chunk.faces;
+	for (size_t f = 0; f < faces.size(); f += 2 + faces[f])
+	{
+		const int nv = faces[f];
+		const int vcnt = chunk.vertBase + faces[f+1];
+		const int* face = &faces[f+2];
+		for (int i = 2; i < nv; ++i)
 		{
-			e0[j] = v1[j] - v0[j];
-			e1[j] = v2[j] - v0[j];
+			const int a = face[0] < 0 ? face[0]+vcnt : face[0]-1;
+			const int b = face[i-1] < 0 ? face[i-1]+vcnt : face[i-1]-1;
+			const int c = face[i] < 0 ? face[i]+vcnt : face[i]-1;
+			if (a < 0 || a >= vcnt || b < 0 || b >= vcnt || c < 0 || c >= vcnt)
+				continue;
+			chunk.tris.push_back(a);
+			chunk.tris.push_back(b);
+			chunk.tris.push_back(c);
 		}
-		float* n = &m_normals[i];
-		n[0] = e0[1]*e1[2] - e0[2]*e1[1];
-		n[1] = e0[2]*e1[0] - e0[0]*e1[2];
-		n[2] = e0[0]*e1[1] - e0[1]*e1[0];
-		float d = sqrtf(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
-		if (d > 0)
+	}
+	std::vector<int>().swap(chunk.faces);
+}
+
+bool rcMeshLoaderObj::load(const std::string& filename, bool invertYZ, int threadCount)
+{
+	return load(filename, invertYZ, threadCount, 1 << 20);
+}
+
+bool rcMeshLoaderObj::load(const std::string& filename, bool invertYZ, int threadCount, size_t minSliceBytes)
+{
+	MappedFile file;
+	if (!file.open(filename.c_str()))
+		return false;
+
+	const char* buf = (const char*)file.getData();
+	const size_t bufSize = file.getSize();
+
+	// Split the file into slices that each start right after a newline. parseRow is in its start state
+	// at every line start, so parsing the slices independently yields exactly the rows of a serial pass.
+	ThreadPool pool(threadCount);
+	size_t chunkCount = (size_t)pool.getThreadCount() * 4;
+	if (minSliceBytes > 0 && chunkCount > bufSize / minSliceBytes)
+		chunkCount = bufSize / minSliceBytes;
+	if (chunkCount < 1)
+		chunkCount = 1;
+
+	std::vector<size_t> bounds(chunkCount + 1);
+	bounds[0] = 0;
+	bounds[chunkCount] = bufSize;
+	for (size_t i = 1; i < chunkCount; ++i)
+	{
+		size_t pos = bufSize / chunkCount * i;
+		if (pos < bounds[i-1]) pos = bounds[i-1];
+		const void* nl = pos < bufSize ? memchr(buf + pos, '\n', bufSize - pos) : 0;
+		bounds[i] = nl ? (size_t)((const char*)nl - buf) + 1 : bufSize;
+	}
+
+	std::vector<ObjChunk> chunks(chunkCount);
+	pool.parallelFor((int)chunkCount, [&](int i, int) {
+		parseChunk(buf + bounds[i], buf + bounds[i+1], chunks[i]);
+	});
+
+	size_t vertCount = 0;
+	for (size_t i = 0; i < chunkCount; ++i)
+	{
+		chunks[i].vertBase = (int)vertCount;
+		vertCount += chunks[i].verts.size()/3;
+	}
+
+	pool.parallelFor((int)chunkCount, [&](int i, int) {
+		triangulateChunk(chunks[i]);
+	});
+
+	size_t triCount = 0;
+	for (size_t i = 0; i < chunkCount; ++i)
+	{
+		chunks[i].triBase = (int)triCount;
+		triCount += chunks[i].tris.size()/3;
+	}
+
+	// sscanf left the components it could not convert at their values from the previous vertex row.
+	// That makes short rows depend on the row before them, so they are patched up serially.
+	const float* prev = 0;
+	for (size_t i = 0; i < chunkCount; ++i)
+	{
+		ObjChunk& chunk = chunks[i];
+		for (size_t j = 0; j < chunk.partial.size(); j += 2)
 		{
-			d = 1.0f/d;
-			n[0] *= d;
-			n[1] *= d;
-			n[2] *= d;
+			const int v = chunk.partial[j];
+			float* dst = &chunk.verts[v*3];
+			const float* src = v > 0 ? &chunk.verts[(v-1)*3] : prev;
+			for (int k = chunk.partial[j+1]; k < 3 && src; ++k)
+				dst[k] = src[k];
 		}
+		if (!chunk.verts.empty())
+			prev = &chunk.verts[chunk.verts.size()-3];
+	}
+
+	if (m_ownsData)
+	{
+		delete [] m_verts;
+		delete [] m_tris;
+		delete [] m_normals;
 	}
-	
+	m_ownsData = true;
+	m_verts = new float[vertCount*3];
+	m_tris = new int[triCount*3];
+	m_normals = new float[triCount*3];
+	m_vertCount = (int)vertCount;
+	m_triCount = (int)triCount;
+
+	pool.parallelFor((int)chunkCount, [&](int i, int) {
+		ObjChunk& chunk = chunks[i];
+		const int nverts = (int)chunk.verts.size()/3;
+		float* dst = &m_verts[chunk.vertBase*3];
+		for (int v = 0; v < nverts; ++v)
+		{
+			const float* src = &chunk.verts[v*3];
+			if (invertYZ)
+			{
+				*dst++ = src[0]*m_scale;
+				*dst++ = src[2]*m_scale;
+				*dst++ = -src[1]*m_scale;
+			}
+			else
+			{
+				*dst++ = src[0]*m_scale;
+				*dst++ = src[1]*m_scale;
+				*dst++ = src[2]*m_scale;
+			}
+		}
+		if (!chunk.tris.empty())
+			memcpy(&m_tris[chunk.triBase*3], &chunk.tris[0], chunk.tris.size()*sizeof(int));
+		std::vector<float>().swap(chunk.verts);
+		std::vector<int>().swap(chunk.tris);
+	});
+
+	// Calculate normals.
+	const int normalBlock = 1 << 16;
+	pool.parallelFor((m_triCount + normalBlock-1) / normalBlock, [&](int block, int) {
+		const int end = (block+1)*normalBlock < m_triCount ? (block+1)*normalBlock : m_triCount;
+		for (int i = block*normalBlock*3; i < end*3; i += 3)
+		{
+			const float* v0 = &m_verts[m_tris[i]*3];
+			const float* v1 = &m_verts[m_tris[i+1]*3];
+			const float* v2 = &m_verts[m_tris[i+2]*3];
+			float e0[3], e1[3];
+			for (int j = 0; j < 3; ++j)
+			{
+				e0[j] = v1[j] - v0[j];
+				e1[j] = v2[j] - v0[j];
+			}
+			float* n = &m_normals[i];
+			n[0] = e0[1]*e1[2] - e0[2]*e1[1];
+			n[1] = e0[2]*e1[0] - e0[0]*e1[2];
+			n[2] = e0[0]*e1[1] - e0[1]*e1[0];
+			float d = sqrtf(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+			if (d > 0)
+			{
+				d = 1.0f/d;
+				n[0] *= d;
+				n[1] *= d;
+				n[2] *= d;
+			}
+		}
+	});
+
 	m_filename = filename;
 	return true;
 }
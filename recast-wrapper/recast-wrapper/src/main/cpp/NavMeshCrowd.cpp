@@ -0,0 +1,147 @@
+#include "NavMeshCrowd.h"
+#include "DetourCommon.h"
+
+#include <string.h>
+
+// Adaptive sampling settings of the four avoidance qualities, as in the Recast demo's crowd tool.
+static const unsigned char AVOIDANCE_DIVS[4] = { 5, 5, 7, 7 };
+static const unsigned char AVOIDANCE_RINGS[4] = { 2, 2, 2, 3 };
+static const unsigned char AVOIDANCE_DEPTH[4] = { 1, 2, 3, 3 };
+
+NavMeshCrowd::NavMeshCrowd() :
+    m_crowd(0),
+    m_activeAgents(0)
+{
+}
+
+NavMeshCrowd::~NavMeshCrowd() {
+    dtFreeCrowd(m_crowd);
+}
+
+bool NavMeshCrowd::init(dtNavMesh* navMesh, int maxAgents, float maxAgentRadius) {
+    if (!navMesh || maxAgents <= 0) {
+        return false;
+    }
+
+    m_crowd = dtAllocCrowd();
+    if (!m_crowd || !m_crowd->init(maxAgents, maxAgentRadius, navMesh)) {
+        return false;
+    }
+
+    dtObstacleAvoidanceParams params;
+    memcpy(&params, m_crowd->getObstacleAvoidanceParams(0), sizeof(dtObstacleAvoidanceParams));
+    for (int i = 0; i < 4; ++i) {
+        params.velBias = 0.5f;
+        params.adaptiveDivs = AVOIDANCE_DIVS[i];
+        params.adaptiveRings = AVOIDANCE_RINGS[i];
+        params.adaptiveDepth = AVOIDANCE_DEPTH[i];
+        m_crowd->setObstacleAvoidanceParams(i, &params);
+    }
+
+    return true;
+}
+
+void NavMeshCrowd::getDefaultAgentConfig(CrowdAgentConfig* config) {
+    config->radius = 0.6f;
+    config->height = 2.0f;
+    config->maxAcceleration = 8.0f;
+    config->maxSpeed = 3.5f;
+    config->separationWeight = 2.0f;
+    config->updateFlags = DT_CROWD_ANTICIPATE_TURNS | DT_CROWD_OBSTACLE_AVOIDANCE | DT_CROWD_SEPARATION |
+                          DT_CROWD_OPTIMIZE_VIS | DT_CROWD_OPTIMIZE_TOPO;
+    config->obstacleAvoidance = 3;
+}
+
+int NavMeshCrowd::addAgent(const float* pos, const CrowdAgentConfig* config) {
+    CrowdAgentConfig defaultConfig;
+    if (!config) {
+        getDefaultAgentConfig(&defaultConfig);
+        config = &defaultConfig;
+    }
+
+    dtCrowdAgentParams params;
+    memset(&params, 0, sizeof(params));
+    params.radius = config->radius;
+    params.height = config->height;
+    params.maxAcceleration = config->maxAcceleration;
+    params.maxSpeed = config->maxSpeed;
+    params.collisionQueryRange = config->radius * 12.0f;
+    params.pathOptimizationRange = config->radius * 30.0f;
+    params.separationWeight = config->separationWeight;
+    params.updateFlags = (unsigned char) config->updateFlags;
+    params.obstacleAvoidanceType = (unsigned char) dtClamp(config->obstacleAvoidance, 0, 3);
+    params.queryFilterType = 0;
+
+    const int index = m_crowd->addAgent(pos, &params);
+    if (index < 0) {
+        return -1;
+    }
+    // dtCrowd keeps agents that start off the mesh, but they cannot move.
+    if (m_crowd->getAgent(index)->state == DT_CROWDAGENT_STATE_INVALID) {
+        m_crowd->removeAgent(index);
+        return -1;
+    }
+
+    m_activeAgents++;
+    return index;
+}
+
+void NavMeshCrowd::removeAgent(int index) {
+    const dtCrowdAgent* agent = m_crowd->getAgent(index);
+    if (agent && agent->active) {
+        m_crowd->removeAgent(index);
+        m_activeAgents--;
+    }
+}
+
+bool NavMeshCrowd::setTarget(int index, const float* pos) {
+    const dtCrowdAgent* agent = m_crowd->getAgent(index);
+    if (!agent || !agent->active) {
+        return false;
+    }
+
+    dtPolyRef ref = 0;
+    float nearest[3];
+    const dtQueryFilter* filter = m_crowd->getFilter(agent->params.queryFilterType);
+    dtStatus status = m_crowd->getNavMeshQuery()->findNearestPoly(pos, m_crowd->getQueryHalfExtents(), filter,
+                                                                  &ref, nearest);
+    if (dtStatusFailed(status) || !ref) {
+        return false;
+    }
+
+    return m_crowd->requestMoveTarget(index, ref, nearest);
+}
+
+bool NavMeshCrowd::resetTarget(int index) {
+    const dtCrowdAgent* agent = m_crowd->getAgent(index);
+    return agent && agent->active && m_crowd->resetMoveTarget(index);
+}
+
+int NavMeshCrowd::update(float dt, float* states, int maxStates) {
+    m_crowd->update(dt, 0);
+
+    if (!states) {
+        return 0;
+    }
+
+    const int count = dtMin(maxStates, m_crowd->getAgentCount());
+    for (int i = 0; i < count; ++i) {
+        const dtCrowdAgent* agent = m_crowd->getAgent(i);
+        float* state = &states[i * CROWD_AGENT_STATE_SIZE];
+        if (agent->active) {
+            dtVcopy(&state[0], agent->npos);
+            dtVcopy(&state[3], agent->vel);
+        } else {
+            memset(state, 0, sizeof(float) * CROWD_AGENT_STATE_SIZE);
+        }
+    }
+    return count;
+}
+
+int NavMeshCrowd::getMaxAgents() const {
+    return m_crowd->getAgentCount();
+}
+
+int NavMeshCrowd::getActiveAgentCount() const {
+    return m_activeAgents;
+}
@@ -0,0 +1,280 @@
+#include "NavMeshFile.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+#include <string.h>
+
+#include "DetourAlloc.h"
+#include "DetourCommon.h"
+
+static bool seekTo(FILE* fp, long long offset) {
+#ifdef _WIN32
+    return _fseeki64(fp, offset, SEEK_SET) == 0;
+#else
+    return fseeko(fp, (off_t) offset, SEEK_SET) == 0;
+#endif
+}
+
+static long long fileSize(FILE* fp) {
+#ifdef _WIN32
+    return _fseeki64(fp, 0, SEEK_END) == 0 ? _ftelli64(fp) : -1;
+#else
+    return fseeko(fp, 0, SEEK_END) == 0 ? (long long) ftello(fp) : -1;
+#endif
+}
+
+static long long alignUp(long long offset) {
+    return (offset + NAVMESHFILE_ALIGNMENT - 1) & ~(long long) (NAVMESHFILE_ALIGNMENT - 1);
+}
+
+static bool isNavMeshFileHeader(const Sample::NavMeshSetHeader& header) {
+    return header.magic == Sample::NAVMESHSET_MAGIC && header.version == NAVMESHFILE_VERSION && header.numTiles >= 0;
+}
+
+// Checks that an entry of the table points at a whole, aligned tile after the table.
+static bool isValidTile(const NavMeshFileTile& tile, long long dataStart, long long fileSize) {
+    return tile.tileRef && tile.dataSize >= (int) sizeof(dtMeshHeader) && tile.offset >= dataStart &&
+           (tile.offset % NAVMESHFILE_ALIGNMENT) == 0 && tile.offset + tile.dataSize <= fileSize;
+}
+
+bool readNavMeshFileTable(const unsigned char* data, long long size, Sample::NavMeshSetHeader& header,
+                          std::vector<NavMeshFileTile>& tiles) {
+    if (size < (long long) sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    const long long dataStart = sizeof(header) + (long long) header.numTiles * sizeof(NavMeshFileTile);
+    if (!isNavMeshFileHeader(header) || dataStart > size) {
+        return false;
+    }
+
+    tiles.resize(header.numTiles);
+    if (!tiles.empty()) {
+        memcpy(&tiles[0], data + sizeof(header), tiles.size() * sizeof(NavMeshFileTile));
+    }
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        if (!isValidTile(tiles[i], dataStart, size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+unsigned int navMeshFileChecksum(const unsigned char* data, int size) {
+    struct Table {
+        unsigned int entries[256];
+
+        Table() {
+            for (unsigned int i = 0; i < 256; ++i) {
+                unsigned int crc = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+                }
+                entries[i] = crc;
+            }
+        }
+    };
+    static const Table table;
+
+    unsigned int crc = 0xFFFFFFFFu;
+    for (int i = 0; i < size; ++i) {
+        crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+bool saveNavMeshFile(const dtNavMesh* mesh, const char* path) {
+    if (!mesh) {
+        return false;
+    }
+
+    std::vector<const dtMeshTile*> tiles;
+    for (int i = 0; i < mesh->getMaxTiles(); ++i) {
+        const dtMeshTile* tile = mesh->getTile(i);
+        if (tile && tile->header && tile->dataSize) {
+            tiles.push_back(tile);
+        }
+    }
+
+    Sample::NavMeshSetHeader header;
+    header.magic = Sample::NAVMESHSET_MAGIC;
+    header.version = NAVMESHFILE_VERSION;
+    header.numTiles = (int) tiles.size();
+    memcpy(&header.params, mesh->getParams(), sizeof(dtNavMeshParams));
+
+    std::vector<NavMeshFileTile> table(tiles.size());
+    long long offset = alignUp(sizeof(header) + table.size() * sizeof(NavMeshFileTile));
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        const dtMeshTile* tile = tiles[i];
+        NavMeshFileTile& entry = table[i];
+        entry.offset = offset;
+        entry.tileRef = mesh->getTileRef(tile);
+        entry.dataSize = tile->dataSize;
+        entry.checksum = navMeshFileChecksum(tile->data, tile->dataSize);
+        entry.x = tile->header->x;
+        entry.y = tile->header->y;
+        entry.layer = tile->header->layer;
+        entry.reserved = 0;
+        offset = alignUp(offset + tile->dataSize);
+    }
+
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    if (ok && !table.empty()) {
+        ok = fwrite(&table[0], sizeof(NavMeshFileTile), table.size(), fp) == table.size();
+    }
+
+    static const unsigned char padding[NAVMESHFILE_ALIGNMENT] = {0};
+    long long written = sizeof(header) + table.size() * sizeof(NavMeshFileTile);
+    for (size_t i = 0; i < tiles.size() && ok; ++i) {
+        const size_t gap = (size_t) (table[i].offset - written);
+        ok = (gap == 0 || fwrite(padding, 1, gap, fp) == gap) &&
+             fwrite(tiles[i]->data, tiles[i]->dataSize, 1, fp) == 1;
+        written = table[i].offset + tiles[i]->dataSize;
+    }
+
+    if (fclose(fp) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+dtNavMesh* loadNavMeshFile(const char* path, int threadCount) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return 0;
+    }
+    const unsigned char* bytes = file.getData();
+
+    Sample::NavMeshSetHeader header;
+    std::vector<NavMeshFileTile> table;
+    if (!readNavMeshFileTable(bytes, (long long) file.getSize(), header, table)) {
+        return 0;
+    }
+
+    dtNavMesh* mesh = dtAllocNavMesh();
+    if (!mesh || dtStatusFailed(mesh->init(&header.params))) {
+        dtFreeNavMesh(mesh);
+        return 0;
+    }
+
+    // Copying and checksumming is most of the work and touches every byte, so that is what runs in parallel.
+    std::vector<unsigned char*> data(table.size(), (unsigned char*) 0);
+    ThreadPool pool(dtMax(1, dtMin(ThreadPool::resolveThreadCount(threadCount), (int) table.size())));
+    pool.parallelFor((int) table.size(), [&](int i, int) {
+        const NavMeshFileTile& tile = table[i];
+        const unsigned char* source = bytes + tile.offset;
+        if (navMeshFileChecksum(source, tile.dataSize) != tile.checksum) {
+            return;
+        }
+        data[i] = (unsigned char*) dtAlloc(tile.dataSize, DT_ALLOC_PERM);
+        if (data[i]) {
+            memcpy(data[i], source, tile.dataSize);
+        }
+    });
+
+    bool ok = true;
+    for (size_t i = 0; i < table.size(); ++i) {
+        if (!ok || !data[i]) {
+            dtFree(data[i]);
+            ok = false;
+            continue;
+        }
+        if (dtStatusFailed(mesh->addTile(data[i], table[i].dataSize, DT_TILE_FREE_DATA, table[i].tileRef, 0))) {
+            dtFree(data[i]);
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        dtFreeNavMesh(mesh);
+        return 0;
+    }
+    return mesh;
+}
+
+NavMeshFileReader::NavMeshFileReader() :
+    m_file(0)
+{
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+NavMeshFileReader::~NavMeshFileReader() {
+    close();
+}
+
+void NavMeshFileReader::close() {
+    if (m_file) {
+        fclose(m_file);
+        m_file = 0;
+    }
+    m_tiles.clear();
+}
+
+bool NavMeshFileReader::open(const char* path) {
+    close();
+
+    m_file = fopen(path, "rb");
+    if (!m_file) {
+        return false;
+    }
+    const long long size = fileSize(m_file);
+    if (!seekTo(m_file, 0) || fread(&m_header, sizeof(m_header), 1, m_file) != 1 || !isNavMeshFileHeader(m_header)) {
+        close();
+        return false;
+    }
+
+    const long long dataStart = sizeof(m_header) + (long long) m_header.numTiles * sizeof(NavMeshFileTile);
+    if (dataStart > size) {
+        close();
+        return false;
+    }
+    m_tiles.resize(m_header.numTiles);
+    if (!m_tiles.empty() && fread(&m_tiles[0], sizeof(NavMeshFileTile), m_tiles.size(), m_file) != m_tiles.size()) {
+        close();
+        return false;
+    }
+    for (size_t i = 0; i < m_tiles.size(); ++i) {
+        if (!isValidTile(m_tiles[i], dataStart, size)) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+int NavMeshFileReader::findTile(int x, int y, int layer) const {
+    for (size_t i = 0; i < m_tiles.size(); ++i) {
+        if (m_tiles[i].x == x && m_tiles[i].y == y && m_tiles[i].layer == layer) {
+            return (int) i;
+        }
+    }
+    return -1;
+}
+
+unsigned char* NavMeshFileReader::readTile(int index) {
+    if (!m_file || index < 0 || index >= (int) m_tiles.size()) {
+        return 0;
+    }
+
+    unsigned char* data = (unsigned char*) dtAlloc(m_tiles[index].dataSize, DT_ALLOC_PERM);
+    if (data && !readTile(index, data)) {
+        dtFree(data);
+        return 0;
+    }
+    return data;
+}
+
+bool NavMeshFileReader::readTile(int index, unsigned char* data) {
+    if (!m_file || index < 0 || index >= (int) m_tiles.size()) {
+        return false;
+    }
+
+    const NavMeshFileTile& tile = m_tiles[index];
+    return seekTo(m_file, tile.offset) && fread(data, tile.dataSize, 1, m_file) == 1 &&
+           navMeshFileChecksum(data, tile.dataSize) == tile.checksum;
+}
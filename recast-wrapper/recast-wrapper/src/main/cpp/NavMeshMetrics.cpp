@@ -0,0 +1,219 @@
+#include "NavMeshMetrics.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <atomic>
+
+static const int MAX_BUCKETS = 16;
+
+// Upper bounds of the histogram buckets in nanoseconds. Queries take microseconds to milliseconds,
+// build stages milliseconds to seconds.
+static const long long QUERY_BUCKETS[] = {
+    10000LL, 25000LL, 50000LL, 100000LL, 250000LL, 500000LL, 1000000LL, 2500000LL, 5000000LL,
+    10000000LL, 25000000LL, 100000000LL, 1000000000LL
+};
+static const long long BUILD_BUCKETS[] = {
+    1000000LL, 5000000LL, 10000000LL, 25000000LL, 50000000LL, 100000000LL, 250000000LL, 500000000LL,
+    1000000000LL, 2500000000LL, 5000000000LL, 10000000000LL, 30000000000LL
+};
+static const int QUERY_BUCKET_COUNT = sizeof(QUERY_BUCKETS) / sizeof(QUERY_BUCKETS[0]);
+static const int BUILD_BUCKET_COUNT = sizeof(BUILD_BUCKETS) / sizeof(BUILD_BUCKETS[0]);
+
+static const char* BUILD_STAGE_NAMES[BUILD_STAGE_COUNT] = {
+    "rasterize", "compact", "erode", "distance_field", "regions", "contours", "polymesh", "detail", "detour_data"
+};
+static const rcTimerLabel BUILD_STAGE_TIMERS[BUILD_STAGE_DETOUR_DATA] = {
+    RC_TIMER_RASTERIZE_TRIANGLES, RC_TIMER_BUILD_COMPACTHEIGHTFIELD, RC_TIMER_ERODE_AREA,
+    RC_TIMER_BUILD_DISTANCEFIELD, RC_TIMER_BUILD_REGIONS, RC_TIMER_BUILD_CONTOURS, RC_TIMER_BUILD_POLYMESH,
+    RC_TIMER_BUILD_POLYMESHDETAIL
+};
+static const char* QUERY_TYPE_NAMES[QUERY_TYPE_COUNT] = {
+    "find_nearest_poly", "find_path", "find_random_point", "smooth_path"
+};
+
+// Bucket counts are not cumulative; the last one counts observations above every bound.
+struct Histogram {
+    std::atomic<long long> buckets[MAX_BUCKETS + 1];
+    std::atomic<long long> sumNanos;
+};
+
+struct QueryCounters {
+    Histogram latency;
+    std::atomic<long long> partial;
+    std::atomic<long long> failures;
+    std::atomic<long long> nodesExpanded;
+};
+
+// Zero initialized as statics.
+static Histogram buildStages[BUILD_STAGE_COUNT];
+static std::atomic<long long> buildErrors;
+static QueryCounters queries[QUERY_TYPE_COUNT];
+static std::atomic<long long> tileCount;
+static std::atomic<long long> tileBytes;
+
+static void observe(Histogram& histogram, const long long* bounds, int boundCount, long long nanos) {
+    int bucket = 0;
+    while (bucket < boundCount && nanos > bounds[bucket]) {
+        bucket++;
+    }
+    histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    histogram.sumNanos.fetch_add(nanos, std::memory_order_relaxed);
+}
+
+static long long nanosSince(MetricsClock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(MetricsClock::now() - start).count();
+}
+
+void NavMeshMetrics::snapshotBuildTimers(const rcContext* ctx, BuildTimerSnapshot* since) {
+    for (int stage = 0; stage < BUILD_STAGE_DETOUR_DATA; ++stage) {
+        since->micros[stage] = ctx ? ctx->getAccumulatedTime(BUILD_STAGE_TIMERS[stage]) : -1;
+    }
+}
+
+void NavMeshMetrics::recordBuildTimers(const rcContext* ctx, BuildStage first, BuildStage last,
+                                       const BuildTimerSnapshot& since) {
+    if (!ctx) {
+        return;
+    }
+    for (int stage = first; stage <= last && stage < BUILD_STAGE_DETOUR_DATA; ++stage) {
+        // Contexts without timers report -1, and a reset in between leaves less than the snapshot.
+        const int micros = ctx->getAccumulatedTime(BUILD_STAGE_TIMERS[stage]);
+        if (micros >= 0) {
+            const int start = since.micros[stage] >= 0 && since.micros[stage] <= micros ? since.micros[stage] : 0;
+            observe(buildStages[stage], BUILD_BUCKETS, BUILD_BUCKET_COUNT, (micros - start) * 1000LL);
+        }
+    }
+}
+
+void NavMeshMetrics::recordBuildStage(BuildStage stage, MetricsClock::time_point start) {
+    observe(buildStages[stage], BUILD_BUCKETS, BUILD_BUCKET_COUNT, nanosSince(start));
+}
+
+void NavMeshMetrics::recordBuildError() {
+    buildErrors.fetch_add(1, std::memory_order_relaxed);
+}
+
+void NavMeshMetrics::recordQuery(QueryType type, MetricsClock::time_point start, dtStatus status,
+                                 int nodesExpanded) {
+    QueryCounters& counters = queries[type];
+    observe(counters.latency, QUERY_BUCKETS, QUERY_BUCKET_COUNT, nanosSince(start));
+    if (dtStatusFailed(status)) {
+        counters.failures.fetch_add(1, std::memory_order_relaxed);
+    } else if (dtStatusDetail(status, DT_PARTIAL_RESULT)) {
+        counters.partial.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (nodesExpanded > 0) {
+        counters.nodesExpanded.fetch_add(nodesExpanded, std::memory_order_relaxed);
+    }
+}
+
+void NavMeshMetrics::addNavMeshTiles(const dtNavMesh* navMesh, int sign) {
+    if (!navMesh) {
+        return;
+    }
+    int tiles = 0;
+    long long bytes = 0;
+    for (int i = 0; i < navMesh->getMaxTiles(); ++i) {
+        const dtMeshTile* tile = navMesh->getTile(i);
+        if (tile && tile->header) {
+            tiles++;
+            bytes += tile->dataSize;
+        }
+    }
+    addTileMemory(sign * tiles, sign * bytes);
+}
+
+void NavMeshMetrics::addTileMemory(int tiles, long long bytes) {
+    tileCount.fetch_add(tiles, std::memory_order_relaxed);
+    tileBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+static void appendf(std::string& out, const char* format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    const int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (length > 0) {
+        out.append(line, length < (int) sizeof(line) ? length : (int) sizeof(line) - 1);
+    }
+}
+
+static void writeHistogram(std::string& out, const char* name, const char* label, const char* value,
+                           const Histogram& histogram, const long long* bounds, int boundCount) {
+    long long cumulative = 0;
+    for (int i = 0; i < boundCount; ++i) {
+        cumulative += histogram.buckets[i].load(std::memory_order_relaxed);
+        appendf(out, "%s_bucket{%s=\"%s\",le=\"%g\"} %lld\n", name, label, value, bounds[i] / 1e9, cumulative);
+    }
+    cumulative += histogram.buckets[boundCount].load(std::memory_order_relaxed);
+    // The count is derived from the buckets, so it matches +Inf even while queries are being recorded.
+    appendf(out, "%s_bucket{%s=\"%s\",le=\"+Inf\"} %lld\n", name, label, value, cumulative);
+    appendf(out, "%s_sum{%s=\"%s\"} %.9f\n", name, label, value,
+            histogram.sumNanos.load(std::memory_order_relaxed) / 1e9);
+    appendf(out, "%s_count{%s=\"%s\"} %lld\n", name, label, value, cumulative);
+}
+
+void NavMeshMetrics::writePrometheus(std::string& out) {
+    out += "# HELP recast_build_stage_duration_seconds Duration of each navmesh build stage.\n";
+    out += "# TYPE recast_build_stage_duration_seconds histogram\n";
+    for (int i = 0; i < BUILD_STAGE_COUNT; ++i) {
+        writeHistogram(out, "recast_build_stage_duration_seconds", "stage", BUILD_STAGE_NAMES[i], buildStages[i],
+                       BUILD_BUCKETS, BUILD_BUCKET_COUNT);
+    }
+    out += "# HELP recast_build_errors_total Errors logged by navmesh builds.\n";
+    out += "# TYPE recast_build_errors_total counter\n";
+    appendf(out, "recast_build_errors_total %lld\n", buildErrors.load(std::memory_order_relaxed));
+
+    out += "# HELP recast_query_duration_seconds Latency of navmesh queries made through the C API.\n";
+    out += "# TYPE recast_query_duration_seconds histogram\n";
+    for (int i = 0; i < QUERY_TYPE_COUNT; ++i) {
+        writeHistogram(out, "recast_query_duration_seconds", "query", QUERY_TYPE_NAMES[i], queries[i].latency,
+                       QUERY_BUCKETS, QUERY_BUCKET_COUNT);
+    }
+    out += "# HELP recast_query_partial_total Queries that returned a partial result.\n";
+    out += "# TYPE recast_query_partial_total counter\n";
+    for (int i = 0; i < QUERY_TYPE_COUNT; ++i) {
+        appendf(out, "recast_query_partial_total{query=\"%s\"} %lld\n", QUERY_TYPE_NAMES[i],
+                queries[i].partial.load(std::memory_order_relaxed));
+    }
+    out += "# HELP recast_query_failures_total Queries that failed.\n";
+    out += "# TYPE recast_query_failures_total counter\n";
+    for (int i = 0; i < QUERY_TYPE_COUNT; ++i) {
+        appendf(out, "recast_query_failures_total{query=\"%s\"} %lld\n", QUERY_TYPE_NAMES[i],
+                queries[i].failures.load(std::memory_order_relaxed));
+    }
+    out += "# HELP recast_query_nodes_expanded_total Search nodes touched by queries.\n";
+    out += "# TYPE recast_query_nodes_expanded_total counter\n";
+    for (int i = 0; i < QUERY_TYPE_COUNT; ++i) {
+        appendf(out, "recast_query_nodes_expanded_total{query=\"%s\"} %lld\n", QUERY_TYPE_NAMES[i],
+                queries[i].nodesExpanded.load(std::memory_order_relaxed));
+    }
+
+    out += "# HELP recast_navmesh_tiles Tiles of the live navmeshes.\n";
+    out += "# TYPE recast_navmesh_tiles gauge\n";
+    appendf(out, "recast_navmesh_tiles %lld\n", tileCount.load(std::memory_order_relaxed));
+    out += "# HELP recast_navmesh_tile_bytes Tile data held by the live navmeshes.\n";
+    out += "# TYPE recast_navmesh_tile_bytes gauge\n";
+    appendf(out, "recast_navmesh_tile_bytes %lld\n", tileBytes.load(std::memory_order_relaxed));
+}
+
+static void resetHistogram(Histogram& histogram) {
+    for (int i = 0; i <= MAX_BUCKETS; ++i) {
+        histogram.buckets[i].store(0, std::memory_order_relaxed);
+    }
+    histogram.sumNanos.store(0, std::memory_order_relaxed);
+}
+
+void NavMeshMetrics::reset() {
+    for (int i = 0; i < BUILD_STAGE_COUNT; ++i) {
+        resetHistogram(buildStages[i]);
+    }
+    buildErrors.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < QUERY_TYPE_COUNT; ++i) {
+        resetHistogram(queries[i].latency);
+        queries[i].partial.store(0, std::memory_order_relaxed);
+        queries[i].failures.store(0, std::memory_order_relaxed);
+        queries[i].nodesExpanded.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,102 @@
+#include "NavMeshQueryBatch.h"
+#include "NavMeshMetrics.h"
+#include "NavMeshTesterTool_subset.h"
+#include "DetourNode.h"
+
+#include <string.h>
+
+NavMeshQueryBatch::NavMeshQueryBatch() :
+    m_navmesh(0),
+    m_pool(0)
+{
+}
+
+NavMeshQueryBatch::~NavMeshQueryBatch() {
+    for (size_t i = 0; i < m_queries.size(); ++i) {
+        dtFreeNavMeshQuery(m_queries[i]);
+    }
+    delete m_pool;
+}
+
+bool NavMeshQueryBatch::init(dtNavMesh* navmesh, int maxNodes, int threadCount) {
+    if (!navmesh) {
+        return false;
+    }
+    if (maxNodes <= 0) {
+        maxNodes = 2048;
+    }
+
+    m_navmesh = navmesh;
+    m_pool = new ThreadPool(threadCount);
+
+    for (int i = 0; i < m_pool->getThreadCount(); ++i) {
+        dtNavMeshQuery* navQuery = dtAllocNavMeshQuery();
+        if (!navQuery) {
+            return false;
+        }
+        m_queries.push_back(navQuery);
+        if (dtStatusFailed(navQuery->init(navmesh, maxNodes))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int NavMeshQueryBatch::findSmoothPaths(const float* startPositions, const float* endPositions, int count,
+                                       const float* halfExtents, const dtQueryFilter* filter,
+                                       BatchPathResult* results, float* smoothPaths, int maxSmoothPath) {
+    dtQueryFilter defaultFilter;
+    if (!filter) {
+        filter = &defaultFilter;
+    }
+
+    // The per-thread queries are shared by every caller of this batch.
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_pool->parallelFor(count, [&](int i, int worker) {
+        findSmoothPath(m_queries[worker], &startPositions[i * 3], &endPositions[i * 3], halfExtents, filter,
+                       results[i], &smoothPaths[(size_t) i * maxSmoothPath * 3], maxSmoothPath);
+    });
+
+    int found = 0;
+    for (int i = 0; i < count; ++i) {
+        if (results[i].pathCount > 0) {
+            found++;
+        }
+    }
+    return found;
+}
+
+void NavMeshQueryBatch::findSmoothPath(dtNavMeshQuery* navQuery, const float* startPos, const float* endPos,
+                                       const float* halfExtents, const dtQueryFilter* filter,
+                                       BatchPathResult& result, float* smoothPath, int maxSmoothPath) {
+    memset(&result, 0, sizeof(BatchPathResult));
+
+    float nearestStart[3];
+    float nearestEnd[3];
+    result.status = navQuery->findNearestPoly(startPos, halfExtents, filter, &result.startRef, nearestStart);
+    if (dtStatusFailed(result.status)) {
+        return;
+    }
+    result.status = navQuery->findNearestPoly(endPos, halfExtents, filter, &result.endRef, nearestEnd);
+    if (dtStatusFailed(result.status)) {
+        return;
+    }
+    if (!result.startRef || !result.endRef) {
+        result.status = DT_FAILURE | DT_INVALID_PARAM;
+        return;
+    }
+
+    dtPolyRef path[MAX_PATH_LEN];
+    const MetricsClock::time_point start = MetricsClock::now();
+    result.status = navQuery->findPath(result.startRef, result.endRef, nearestStart, nearestEnd, filter,
+                                       path, &result.pathCount, MAX_PATH_LEN);
+    NavMeshMetrics::recordQuery(QUERY_FIND_PATH, start, result.status, navQuery->getNodePool()->getNodeCount());
+    if (dtStatusFailed(result.status) || result.pathCount == 0) {
+        return;
+    }
+
+    calcSmoothPath(nearestStart, result.startRef, nearestEnd, path, result.pathCount, *filter,
+                   m_navmesh, *navQuery, smoothPath, result.smoothPathCount, maxSmoothPath);
+}
@@ -0,0 +1,137 @@
+#include "NavMeshQueryPool.h"
+
+#include <atomic>
+
+static std::atomic<unsigned long long> nextPoolId(1);
+
+// Generator state of the query that is currently drawing random numbers on this thread. Detour's frand
+// callbacks take no arguments, so the state is handed over through here.
+static thread_local unsigned long long* currentRngState = 0;
+
+// splitmix64, used to spread seeds so that neighbouring seeds give unrelated sequences.
+static unsigned long long mixSeed(unsigned long long x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// xorshift64* over the current thread's state. Returns a float in [0, 1).
+static float threadFrand() {
+    unsigned long long x = *currentRngState;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *currentRngState = x;
+    return (float) ((x * 0x2545f4914f6cdd1dULL) >> 40) * (1.0f / 16777216.0f);
+}
+
+// xorshift must never hold a zero state.
+static unsigned long long makeRngState(unsigned long long seed) {
+    const unsigned long long state = mixSeed(seed);
+    return state ? state : 0x9e3779b97f4a7c15ULL;
+}
+
+NavMeshQueryPool::NavMeshQueryPool() :
+    m_navMesh(0),
+    m_maxNodes(0),
+    m_seed(0),
+    m_id(nextPoolId++)
+{
+}
+
+NavMeshQueryPool::~NavMeshQueryPool() {
+    for (size_t i = 0; i < m_slotList.size(); ++i) {
+        dtFreeNavMeshQuery(m_slotList[i]->query);
+        delete m_slotList[i];
+    }
+}
+
+bool NavMeshQueryPool::init(const dtNavMesh* navMesh, int maxNodes, unsigned int seed) {
+    if (!navMesh) {
+        return false;
+    }
+
+    m_navMesh = navMesh;
+    m_maxNodes = maxNodes > 0 ? maxNodes : 2048;
+    m_seed = seed;
+
+    // Fail early rather than on the first query of every thread.
+    return getQuery() != 0;
+}
+
+NavMeshQueryPool::Slot* NavMeshQueryPool::getSlot() {
+    // Most threads only ever use one pool, so the last pool and slot used are remembered per thread and
+    // the lock is only taken when switching pools.
+    static thread_local unsigned long long cachedPoolId = 0;
+    static thread_local Slot* cachedSlot = 0;
+    if (cachedPoolId == m_id) {
+        return cachedSlot;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const std::thread::id thread = std::this_thread::get_id();
+    std::unordered_map<std::thread::id, Slot*>::const_iterator it = m_slots.find(thread);
+    Slot* slot = 0;
+    if (it != m_slots.end()) {
+        slot = it->second;
+    } else {
+        dtNavMeshQuery* navQuery = dtAllocNavMeshQuery();
+        if (!navQuery) {
+            return 0;
+        }
+        if (dtStatusFailed(navQuery->init(m_navMesh, m_maxNodes))) {
+            dtFreeNavMeshQuery(navQuery);
+            return 0;
+        }
+
+        slot = new Slot();
+        slot->query = navQuery;
+        slot->rngState = makeRngState(((unsigned long long) m_seed << 32) | m_slotList.size());
+        m_slots[thread] = slot;
+        m_slotList.push_back(slot);
+    }
+
+    cachedPoolId = m_id;
+    cachedSlot = slot;
+    return slot;
+}
+
+dtNavMeshQuery* NavMeshQueryPool::getQuery() {
+    Slot* slot = getSlot();
+    return slot ? slot->query : 0;
+}
+
+void NavMeshQueryPool::seedThread(unsigned int seed) {
+    Slot* slot = getSlot();
+    if (slot) {
+        slot->rngState = makeRngState(seed);
+    }
+}
+
+dtStatus NavMeshQueryPool::findRandomPoint(const dtQueryFilter* filter, dtPolyRef* polyRef, float* point) {
+    Slot* slot = getSlot();
+    if (!slot) {
+        return DT_FAILURE | DT_OUT_OF_MEMORY;
+    }
+
+    currentRngState = &slot->rngState;
+    return slot->query->findRandomPoint(filter, threadFrand, polyRef, point);
+}
+
+dtStatus NavMeshQueryPool::findRandomPointAroundCircle(dtPolyRef startRef, const float* centerPos, float radius,
+                                                       const dtQueryFilter* filter, dtPolyRef* polyRef,
+                                                       float* point) {
+    Slot* slot = getSlot();
+    if (!slot) {
+        return DT_FAILURE | DT_OUT_OF_MEMORY;
+    }
+
+    currentRngState = &slot->rngState;
+    return slot->query->findRandomPointAroundCircle(startRef, centerPos, radius, filter, threadFrand, polyRef, point);
+}
+
+int NavMeshQueryPool::getThreadCount() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (int) m_slotList.size();
+}
@@ -0,0 +1,313 @@
+#include "NavMeshRebuilder.h"
+#include "NavMeshMetrics.h"
+#include "wrapper.h"
+
+#include <float.h>
+
+#include "DetourAlloc.h"
+#include "DetourCommon.h"
+
+NavMeshRebuilder::NavMeshRebuilder() :
+    m_navMesh(0),
+    m_geom(0),
+    m_tileWidth(0),
+    m_tileHeight(0),
+    m_pool(0),
+    m_building(0),
+    m_stop(false),
+    m_queued(0),
+    m_builtCount(0),
+    m_applied(0),
+    m_failures(0),
+    m_buildNanos(0)
+{
+}
+
+NavMeshRebuilder::~NavMeshRebuilder() {
+    close();
+}
+
+void NavMeshRebuilder::close() {
+    if (m_worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        m_worker.join();
+    }
+    for (size_t i = 0; i < m_built.size(); ++i) {
+        dtFree(m_built[i].data);
+    }
+    m_built.clear();
+    delete m_pool;
+    m_pool = 0;
+}
+
+bool NavMeshRebuilder::init(rcContext* ctx, dtNavMesh* navMesh, const rcConfig& config, InputGeom* geom,
+                            const TileAgentSettings& agent, int threadCount) {
+    if (!navMesh || !geom || !geom->getMesh()) {
+        ctx->log(RC_LOG_ERROR, "NavMeshRebuilder: No navmesh or geometry.");
+        return false;
+    }
+    if (config.tileSize <= 0) {
+        ctx->log(RC_LOG_ERROR, "NavMeshRebuilder: Invalid tile size %d.", config.tileSize);
+        return false;
+    }
+
+    // Rebuilt tiles have to land exactly where the tiles they replace are.
+    const dtNavMeshParams* params = navMesh->getParams();
+    const float tcs = config.tileSize * config.cs;
+    const float tolerance = tcs * 0.001f;
+    const float* orig = geom->getNavMeshBoundsMin();
+    if (dtAbs(params->tileWidth - tcs) > tolerance || dtAbs(params->tileHeight - tcs) > tolerance ||
+        dtAbs(params->orig[0] - orig[0]) > tolerance || dtAbs(params->orig[2] - orig[2]) > tolerance) {
+        ctx->log(RC_LOG_ERROR, "NavMeshRebuilder: The navmesh was not built from this config and geometry.");
+        return false;
+    }
+
+    m_navMesh = navMesh;
+    m_config = config;
+    m_geom = geom;
+    m_agent = agent;
+    calcTileGridSize(config, geom, &m_tileWidth, &m_tileHeight);
+    m_dirty.assign(m_tileWidth * m_tileHeight, false);
+    m_pool = new ThreadPool(ThreadPool::resolveThreadCount(threadCount));
+    m_worker = std::thread(&NavMeshRebuilder::workerLoop, this);
+    return true;
+}
+
+void NavMeshRebuilder::workerLoop() {
+    // rcContext is not thread safe, so every pool thread logs and times through its own.
+    std::vector<IoRcContext> contexts(m_pool->getThreadCount());
+    std::vector<int> batch;
+    std::vector<BuiltTile> results;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_stop) {
+                return;
+            }
+            // Tiles marked dirty from here on are queued again and rebuilt by the next batch.
+            batch.swap(m_queue);
+            for (size_t i = 0; i < batch.size(); ++i) {
+                m_dirty[batch[i]] = false;
+            }
+            m_building = (int) batch.size();
+        }
+
+        const MetricsClock::time_point start = MetricsClock::now();
+        results.resize(batch.size());
+        {
+            std::lock_guard<std::mutex> geomLock(m_geomMutex);
+            m_pool->parallelFor((int) batch.size(), [&](int i, int worker) {
+                BuiltTile& result = results[i];
+                result.tile = batch[i];
+                result.ok = buildTileNavMeshData(&contexts[worker], m_config, m_geom, batch[i] % m_tileWidth,
+                                                 batch[i] / m_tileWidth, m_agent, &result.data, &result.dataSize);
+            });
+        }
+        const long long nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            MetricsClock::now() - start).count();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (size_t i = 0; i < results.size(); ++i) {
+                BuiltTile& result = results[i];
+                if (!result.ok) {
+                    m_failures++;
+                    continue;
+                }
+                m_builtCount++;
+                bool replaced = false;
+                for (size_t j = 0; j < m_built.size() && !replaced; ++j) {
+                    if (m_built[j].tile == result.tile) {
+                        dtFree(m_built[j].data);
+                        m_built[j] = result;
+                        replaced = true;
+                    }
+                }
+                if (!replaced) {
+                    m_built.push_back(result);
+                }
+            }
+            m_buildNanos += nanos;
+            m_building = 0;
+            batch.clear();
+            if (m_queue.empty()) {
+                m_idle.notify_all();
+            }
+        }
+    }
+}
+
+int NavMeshRebuilder::queueTiles(const float* bmin, const float* bmax) {
+    if (!m_navMesh) {
+        return 0;
+    }
+
+    // A tile's build reads the geometry under its border as well, so edits that close to it count.
+    const float border = m_config.borderSize * m_config.cs;
+    float lo[3], hi[3];
+    dtVcopy(lo, bmin);
+    dtVcopy(hi, bmax);
+    lo[0] -= border;
+    lo[2] -= border;
+    hi[0] += border;
+    hi[2] += border;
+
+    int ax, ay, bx, by;
+    m_navMesh->calcTileLoc(lo, &ax, &ay);
+    m_navMesh->calcTileLoc(hi, &bx, &by);
+    const int x0 = dtMax(dtMin(ax, bx), 0);
+    const int y0 = dtMax(dtMin(ay, by), 0);
+    const int x1 = dtMin(dtMax(ax, bx), m_tileWidth - 1);
+    const int y1 = dtMin(dtMax(ay, by), m_tileHeight - 1);
+
+    int count = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                const int tile = y * m_tileWidth + x;
+                count++;
+                if (!m_dirty[tile]) {
+                    m_dirty[tile] = true;
+                    m_queue.push_back(tile);
+                    m_queued++;
+                }
+            }
+        }
+    }
+    if (count) {
+        m_wake.notify_one();
+    }
+    return count;
+}
+
+int NavMeshRebuilder::markDirty(const float* bmin, const float* bmax) {
+    return queueTiles(bmin, bmax);
+}
+
+int NavMeshRebuilder::addConvexVolume(const float* verts, int nverts, float minh, float maxh,
+                                      unsigned char area) {
+    if (!m_geom || nverts < 3 || nverts > MAX_CONVEXVOL_PTS) {
+        return -1;
+    }
+    {
+        std::lock_guard<std::mutex> geomLock(m_geomMutex);
+        m_geom->addConvexVolume(verts, nverts, minh, maxh, area);
+    }
+
+    float bmin[3], bmax[3];
+    dtVcopy(bmin, verts);
+    dtVcopy(bmax, verts);
+    for (int i = 1; i < nverts; ++i) {
+        dtVmin(bmin, &verts[i * 3]);
+        dtVmax(bmax, &verts[i * 3]);
+    }
+    return queueTiles(bmin, bmax);
+}
+
+int NavMeshRebuilder::addOffMeshConnection(const float* spos, const float* epos, float radius,
+                                           unsigned char bidir, unsigned char area, unsigned short flags) {
+    if (!m_geom) {
+        return -1;
+    }
+    {
+        std::lock_guard<std::mutex> geomLock(m_geomMutex);
+        m_geom->addOffMeshConnection(spos, epos, radius, bidir, area, flags);
+    }
+
+    // The connection is stored in the tile of its start point, but links land in the tile of its end.
+    float bmin[3], bmax[3];
+    dtVcopy(bmin, spos);
+    dtVcopy(bmax, spos);
+    dtVmin(bmin, epos);
+    dtVmax(bmax, epos);
+    bmin[0] -= radius;
+    bmin[2] -= radius;
+    bmax[0] += radius;
+    bmax[2] += radius;
+    return queueTiles(bmin, bmax);
+}
+
+int NavMeshRebuilder::applyBuiltTiles(float* bmin, float* bmax) {
+    std::vector<BuiltTile> built;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        built.swap(m_built);
+    }
+    if (built.empty()) {
+        return 0;
+    }
+
+    const dtNavMeshParams* params = m_navMesh->getParams();
+    float lo[3] = {FLT_MAX, params->orig[1], FLT_MAX};
+    float hi[3] = {-FLT_MAX, params->orig[1], -FLT_MAX};
+    int applied = 0;
+    int failures = 0;
+
+    for (size_t i = 0; i < built.size(); ++i) {
+        const BuiltTile& result = built[i];
+        const int x = result.tile % m_tileWidth;
+        const int y = result.tile / m_tileWidth;
+
+        // The new tile gets a fresh salt rather than the old ref, so refs into the old polys go stale.
+        const dtTileRef oldRef = m_navMesh->getTileRefAt(x, y, 0);
+        if (oldRef) {
+            const int oldSize = m_navMesh->getTileByRef(oldRef)->dataSize;
+            m_navMesh->removeTile(oldRef, 0, 0);
+            NavMeshMetrics::addTileMemory(-1, -oldSize);
+        }
+        if (result.data) {
+            if (dtStatusFailed(m_navMesh->addTile(result.data, result.dataSize, DT_TILE_FREE_DATA, 0, 0))) {
+                dtFree(result.data);
+                failures++;
+                continue;
+            }
+            NavMeshMetrics::addTileMemory(1, result.dataSize);
+        }
+
+        applied++;
+        lo[0] = dtMin(lo[0], params->orig[0] + x * params->tileWidth);
+        lo[2] = dtMin(lo[2], params->orig[2] + y * params->tileHeight);
+        hi[0] = dtMax(hi[0], params->orig[0] + (x + 1) * params->tileWidth);
+        hi[2] = dtMax(hi[2], params->orig[2] + (y + 1) * params->tileHeight);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_applied += applied;
+        m_failures += failures;
+    }
+    if (applied) {
+        lo[1] = m_geom->getNavMeshBoundsMin()[1];
+        hi[1] = m_geom->getNavMeshBoundsMax()[1];
+        if (bmin) {
+            dtVcopy(bmin, lo);
+        }
+        if (bmax) {
+            dtVcopy(bmax, hi);
+        }
+    }
+    return applied;
+}
+
+void NavMeshRebuilder::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_stop || (m_queue.empty() && m_building == 0); });
+}
+
+void NavMeshRebuilder::getStats(TileRebuildStats* stats) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stats->queued = m_queued;
+    stats->built = m_builtCount;
+    stats->applied = m_applied;
+    stats->failures = m_failures;
+    stats->buildNanos = m_buildNanos;
+    stats->pendingTiles = (int) m_queue.size() + m_building;
+    stats->readyTiles = (int) m_built.size();
+}
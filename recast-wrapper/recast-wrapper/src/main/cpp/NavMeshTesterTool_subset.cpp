@@ -24,6 +24,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 
 #include "DetourNavMesh.h"
 #include "Recast.h"
@@ -205,18 +206,20 @@ bool getSteerTarget(dtNavMeshQuery* navQuery, const float* startPos, const float
 }
 
 // copied from NavMeshTesterTool::recalc() "(m_toolMode == TOOLMODE_PATHFIND_FOLLOW)"
-void calcSmoothPath(float *startPos, dtPolyRef startRef, float *endPos,
-                    dtPolyRef *path, int pathCount,
+void calcSmoothPath(const float *startPos, dtPolyRef startRef, const float *endPos,
+                    const dtPolyRef *path, int pathCount,
                     const dtQueryFilter &filter,
                     dtNavMesh *navMesh, dtNavMeshQuery &navQuery,
-                    float *m_smoothPath, int &m_nsmoothPath)
+                    float *m_smoothPath, int &m_nsmoothPath, const int maxSmoothPath)
 {
     m_nsmoothPath = 0;
+    if (pathCount <= 0 || maxSmoothPath <= 0)
+        return;
     
     // Iterate over the path to find smooth path on the detail mesh surface.
     dtPolyRef polys[MAX_PATH_LEN];
-    memcpy(polys, path, sizeof(dtPolyRef)*pathCount);
-    int npolys = pathCount;
+    int npolys = dtMin(pathCount, MAX_PATH_LEN);
+    memcpy(polys, path, sizeof(dtPolyRef)*npolys);
     
     float iterPos[3], targetPos[3];
     navQuery.closestPointOnPoly(startRef, startPos, iterPos, 0);
@@ -230,7 +233,7 @@ void calcSmoothPath(float *startPos, dtPolyRef startRef, float *endPos,
     
     // Move towards target a small advancement at a time until target reached or
     // when ran out of memory to store the path.
-    while (npolys && m_nsmoothPath < MAX_SMOOTH_PATH_LEN)
+    while (npolys && m_nsmoothPath < maxSmoothPath)
     {
         // Find location to steer towards.
         float steerPos[3];
@@ -276,7 +279,7 @@ void calcSmoothPath(float *startPos, dtPolyRef startRef, float *endPos,
         {
             // Reached end of path.
             dtVcopy(iterPos, targetPos);
-            if (m_nsmoothPath < MAX_SMOOTH_PATH_LEN)
+            if (m_nsmoothPath < maxSmoothPath)
             {
                 dtVcopy(&m_smoothPath[m_nsmoothPath*3], iterPos);
                 m_nsmoothPath++;
@@ -305,7 +308,7 @@ void calcSmoothPath(float *startPos, dtPolyRef startRef, float *endPos,
             dtStatus _status = navMesh->getOffMeshConnectionPolyEndPoints(prevRef, polyRef, _startPos, _endPos);
             if (dtStatusSucceed(_status))
             {
-                if (m_nsmoothPath < MAX_SMOOTH_PATH_LEN)
+                if (m_nsmoothPath < maxSmoothPath)
                 {
                     dtVcopy(&m_smoothPath[m_nsmoothPath*3], _startPos);
                     m_nsmoothPath++;
@@ -325,7 +328,7 @@ void calcSmoothPath(float *startPos, dtPolyRef startRef, float *endPos,
         }
         
         // Store results.
-        if (m_nsmoothPath < MAX_SMOOTH_PATH_LEN)
+        if (m_nsmoothPath < maxSmoothPath)
         {
             dtVcopy(&m_smoothPath[m_nsmoothPath*3], iterPos);
             m_nsmoothPath++;
@@ -333,6 +336,93 @@ void calcSmoothPath(float *startPos, dtPolyRef startRef, float *endPos,
     }
 }
 
+// Vertices added by DT_STRAIGHTPATH_ALL_CROSSINGS lie on the line between the corners around them.
+static bool isCorner(const float* prev, const float* cur, const float* next)
+{
+    const float ax = cur[0] - prev[0], az = cur[2] - prev[2];
+    const float bx = next[0] - cur[0], bz = next[2] - cur[2];
+    const float cross = ax*bz - az*bx;
+    return cross*cross > 1e-6f * (ax*ax + az*az) * (bx*bx + bz*bz);
+}
+
+static bool appendSnapped(dtNavMeshQuery& navQuery, const float* pos, dtPolyRef ref, dtPolyRef fallbackRef,
+                          float* smoothPath, int& smoothPathCount, const int maxSmoothPath)
+{
+    if (smoothPathCount >= maxSmoothPath)
+        return false;
+    
+    // Points on a poly edge belong to the polys on both sides; try the other one if the first misses.
+    float* out = &smoothPath[smoothPathCount*3];
+    dtVcopy(out, pos);
+    float h = 0;
+    if ((ref && dtStatusSucceed(navQuery.getPolyHeight(ref, pos, &h))) ||
+        (fallbackRef && dtStatusSucceed(navQuery.getPolyHeight(fallbackRef, pos, &h))))
+        out[1] = h;
+    smoothPathCount++;
+    return true;
+}
+
+void calcStraightSmoothPath(const float* startPos, dtPolyRef startRef, const float* endPos,
+                            const dtPolyRef* path, int pathCount,
+                            dtNavMeshQuery& navQuery, SmoothPathMode mode, float sampleSpacing,
+                            float* smoothPath, int& smoothPathCount, const int maxSmoothPath)
+{
+    smoothPathCount = 0;
+    if (pathCount <= 0 || maxSmoothPath <= 0)
+        return;
+    
+    float iterPos[3], targetPos[3];
+    navQuery.closestPointOnPoly(startRef, startPos, iterPos, 0);
+    navQuery.closestPointOnPoly(path[pathCount-1], endPos, targetPos, 0);
+    
+    // Sampling needs the poly under every stretch of the path, which the crossings provide. Each poly
+    // contributes at most a crossing and a corner.
+    const bool sampled = mode == SMOOTH_PATH_SAMPLED && sampleSpacing > 0.0f;
+    const int maxStraight = (sampled ? 2*pathCount : pathCount) + 2;
+    std::vector<float> straight(maxStraight*3);
+    std::vector<unsigned char> flags(maxStraight);
+    std::vector<dtPolyRef> refs(maxStraight);
+    int nstraight = 0;
+    navQuery.findStraightPath(iterPos, targetPos, path, pathCount,
+                              &straight[0], &flags[0], &refs[0], &nstraight, maxStraight,
+                              sampled ? DT_STRAIGHTPATH_ALL_CROSSINGS : 0);
+    
+    // Distance along the path since the last point written.
+    float travelled = 0;
+    for (int i = 0; i < nstraight; ++i)
+    {
+        const float* v = &straight[i*3];
+        // Straight path refs are the polys entered at each vertex, so vertex i lies between refs[i-1] and refs[i].
+        const dtPolyRef prevRef = i > 0 ? refs[i-1] : startRef;
+        const bool offMeshEnd = i > 0 && (flags[i-1] & DT_STRAIGHTPATH_OFFMESH_CONNECTION);
+        const bool keep = !sampled || i == 0 || i == nstraight-1 || offMeshEnd ||
+                          (flags[i] & DT_STRAIGHTPATH_OFFMESH_CONNECTION) ||
+                          isCorner(&straight[(i-1)*3], v, &straight[(i+1)*3]);
+        if (keep)
+        {
+            if (!appendSnapped(navQuery, v, refs[i], prevRef, smoothPath, smoothPathCount, maxSmoothPath))
+                return;
+            travelled = 0;
+        }
+        
+        // Off-mesh connections are not walked, so nothing is sampled along them.
+        if (!sampled || i == nstraight-1 || (flags[i] & DT_STRAIGHTPATH_OFFMESH_CONNECTION))
+            continue;
+        
+        const float* next = &straight[(i+1)*3];
+        const float len = dtVdist2D(v, next);
+        float t = sampleSpacing - travelled;
+        for (; t + 0.01f < len; t += sampleSpacing)
+        {
+            float pos[3];
+            dtVlerp(pos, v, next, t / len);
+            if (!appendSnapped(navQuery, pos, refs[i], 0, smoothPath, smoothPathCount, maxSmoothPath))
+                return;
+        }
+        travelled = len - (t - sampleSpacing);
+    }
+}
+
 SmoothPathResult* getSmoothPath(float* startPos, dtPolyRef startRef, float* endPos,
                                FindPathResult* path,
                                const dtQueryFilter* filter,
@@ -342,6 +432,6 @@ SmoothPathResult* getSmoothPath(float* startPos, dtPolyRef startRef, float* endP
                    path->path, path->pathCount,
                    *filter,
                    navMesh, *navQuery,
-                   result->path, result->pathCount);
+                   result->path, result->pathCount, MAX_SMOOTH_PATH_LEN);
     return result;
 }
@@ -0,0 +1,469 @@
+#include "NavMeshTileCache.h"
+#include "ChunkyTriMesh.h"
+#include "HeightfieldRasterizer.h"
+#include "NavMeshMetrics.h"
+#include "ThreadPool.h"
+#include "TileCompressor.h"
+#include "wrapper.h"
+
+#include <string.h>
+#include <vector>
+
+#include "DetourCommon.h"
+
+// Most tiles have one layer, bridges and overhangs add more. Only sizes the tile lookups.
+static const int EXPECTED_LAYERS_PER_TILE = 4;
+// rcBuildHeightfieldLayers stops at RC_NOT_CONNECTED (63) layers, so every layer it returns fits.
+static const int MAX_LAYERS_PER_TILE = RC_NOT_CONNECTED;
+
+// Bump allocator for the temporary data of a tile rebuild, which dtTileCache resets before each one.
+// Requests that do not fit go to the heap, and the next reset grows the buffer to cover them, so rebuilds
+// soon run without any heap allocation.
+struct TileCacheAllocator : public dtTileCacheAlloc {
+    TileCacheAllocator() : m_buffer(0), m_capacity(0), m_top(0), m_requested(0) {}
+
+    ~TileCacheAllocator() {
+        freeOverflow();
+        dtFree(m_buffer);
+    }
+
+    void reset() override {
+        freeOverflow();
+        if (m_requested > m_capacity) {
+            dtFree(m_buffer);
+            m_buffer = (unsigned char*) dtAlloc(m_requested, DT_ALLOC_PERM);
+            m_capacity = m_buffer ? m_requested : 0;
+        }
+        m_top = 0;
+        m_requested = 0;
+    }
+
+    void* alloc(const size_t size) override {
+        const size_t aligned = (size + 15) & ~(size_t) 15;
+        m_requested += aligned;
+        if (m_top + aligned <= m_capacity) {
+            void* ptr = m_buffer + m_top;
+            m_top += aligned;
+            return ptr;
+        }
+        void* ptr = dtAlloc(size, DT_ALLOC_TEMP);
+        if (ptr) {
+            m_overflow.push_back(ptr);
+        }
+        return ptr;
+    }
+
+    void free(void*) override {
+        // Everything is released by the next reset.
+    }
+
+private:
+    void freeOverflow() {
+        for (size_t i = 0; i < m_overflow.size(); ++i) {
+            dtFree(m_overflow[i]);
+        }
+        m_overflow.clear();
+    }
+
+    unsigned char* m_buffer;
+    size_t m_capacity;
+    size_t m_top;
+    size_t m_requested;
+    std::vector<void*> m_overflow;
+};
+
+struct TileLayerCompressor : public dtTileCacheCompressor {
+    int maxCompressedSize(const int bufferSize) override {
+        return tileCompressBound(bufferSize);
+    }
+
+    dtStatus compress(const unsigned char* buffer, const int bufferSize, unsigned char* compressed,
+                      const int maxCompressedSize, int* compressedSize) override {
+        const int size = tileCompress(buffer, bufferSize, compressed, maxCompressedSize);
+        if (!size) {
+            return DT_FAILURE | DT_BUFFER_TOO_SMALL;
+        }
+        *compressedSize = size;
+        return DT_SUCCESS;
+    }
+
+    dtStatus decompress(const unsigned char* compressed, const int compressedSize, unsigned char* buffer,
+                        const int maxBufferSize, int* bufferSize) override {
+        const int size = tileDecompress(compressed, compressedSize, buffer, maxBufferSize);
+        if (size < 0) {
+            return DT_FAILURE | DT_INVALID_PARAM;
+        }
+        *bufferSize = size;
+        return DT_SUCCESS;
+    }
+};
+
+// Gives rebuilt tiles the same areas, flags and off-mesh connections as navmesh_data_create does.
+struct TileMeshProcess : public dtTileCacheMeshProcess {
+    explicit TileMeshProcess(InputGeom* geom) : m_geom(geom), m_tiles(0) {}
+
+    void process(dtNavMeshCreateParams* params, unsigned char* polyAreas, unsigned short* polyFlags) override {
+        for (int i = 0; i < params->polyCount; ++i) {
+            if (polyAreas[i] == DT_TILECACHE_WALKABLE_AREA) {
+                polyAreas[i] = SAMPLE_POLYAREA_GROUND;
+            }
+            if (polyAreas[i] == SAMPLE_POLYAREA_GROUND || polyAreas[i] == SAMPLE_POLYAREA_GRASS ||
+                polyAreas[i] == SAMPLE_POLYAREA_ROAD) {
+                polyFlags[i] = SAMPLE_POLYFLAGS_WALK;
+            } else if (polyAreas[i] == SAMPLE_POLYAREA_WATER) {
+                polyFlags[i] = SAMPLE_POLYFLAGS_SWIM;
+            } else if (polyAreas[i] == SAMPLE_POLYAREA_DOOR) {
+                polyFlags[i] = SAMPLE_POLYFLAGS_WALK | SAMPLE_POLYFLAGS_DOOR;
+            }
+        }
+
+        // params stays in use until the tile is created, and update builds one tile at a time.
+        m_geom->gatherOffMeshConnections(params->bmin, params->bmax, m_offMeshCons, *params);
+        m_tiles++;
+    }
+
+    InputGeom* m_geom;
+    OffMeshConnectionSet m_offMeshCons;
+    long long m_tiles;
+};
+
+struct TileLayers {
+    unsigned char* data[MAX_LAYERS_PER_TILE];
+    int dataSize[MAX_LAYERS_PER_TILE];
+    int count;
+    bool ok;
+};
+
+// Same pipeline as compact_heightfield_create up to the marked convex volumes, then heightfield layers
+// instead of regions.
+static bool buildTileLayers(rcContext* ctx, const rcConfig& config, InputGeom* geom, int tx, int ty,
+                            dtTileCacheCompressor* compressor, TileLayers& layers) {
+    layers.count = 0;
+
+    rcConfig tileConfig;
+    calcTileConfig(config, geom, tx, ty, tileConfig);
+
+    float tbmin[2], tbmax[2];
+    tbmin[0] = tileConfig.bmin[0];
+    tbmin[1] = tileConfig.bmin[2];
+    tbmax[0] = tileConfig.bmax[0];
+    tbmax[1] = tileConfig.bmax[2];
+    std::vector<int> cid;
+    const int ncid = rcGetChunksOverlappingRect(geom->getChunkyMesh(), tbmin, tbmax, cid);
+    if (!ncid) {
+        return true;
+    }
+
+    rcHeightfield* solid = 0;
+    rcCompactHeightfield* chf = 0;
+    rcHeightfieldLayerSet* lset = 0;
+    const ConvexVolume* vols = geom->getConvexVolumes();
+    std::vector<int> volumes;
+    bool ok = false;
+
+    BuildTimerSnapshot since;
+    NavMeshMetrics::snapshotBuildTimers(ctx, &since);
+
+    solid = rcAllocHeightfield();
+    if (!solid) {
+        ctx->log(RC_LOG_ERROR, "buildTileLayers: Out of memory 'solid'.");
+        goto cleanup;
+    }
+    if (!rcCreateHeightfield(ctx, *solid, tileConfig.width, tileConfig.height, tileConfig.bmin, tileConfig.bmax,
+                             tileConfig.cs, tileConfig.ch)) {
+        ctx->log(RC_LOG_ERROR, "buildTileLayers: Could not create solid heightfield.");
+        goto cleanup;
+    }
+    if (!rasterizeChunks(ctx, tileConfig, geom, &cid[0], ncid, *solid, 1)) {
+        goto cleanup;
+    }
+
+    chf = rcAllocCompactHeightfield();
+    if (!chf) {
+        ctx->log(RC_LOG_ERROR, "buildTileLayers: Out of memory 'chf'.");
+        goto cleanup;
+    }
+    if (!rcBuildCompactHeightfield(ctx, tileConfig.walkableHeight, tileConfig.walkableClimb, *solid, *chf)) {
+        ctx->log(RC_LOG_ERROR, "buildTileLayers: Could not build compact data.");
+        goto cleanup;
+    }
+    if (!rcErodeWalkableArea(ctx, tileConfig.walkableRadius, *chf)) {
+        ctx->log(RC_LOG_ERROR, "buildTileLayers: Could not erode.");
+        goto cleanup;
+    }
+    geom->queryConvexVolumes(tileConfig.bmin, tileConfig.bmax, volumes);
+    for (size_t i = 0; i < volumes.size(); ++i) {
+        const ConvexVolume& vol = vols[volumes[i]];
+        rcMarkConvexPolyArea(ctx, vol.verts, vol.nverts, vol.hmin, vol.hmax, (unsigned char) vol.area, *chf);
+    }
+    NavMeshMetrics::recordBuildTimers(ctx, BUILD_STAGE_RASTERIZE, BUILD_STAGE_ERODE, since);
+
+    lset = rcAllocHeightfieldLayerSet();
+    if (!lset) {
+        ctx->log(RC_LOG_ERROR, "buildTileLayers: Out of memory 'lset'.");
+        goto cleanup;
+    }
+    if (!rcBuildHeightfieldLayers(ctx, *chf, tileConfig.borderSize, tileConfig.walkableHeight, *lset)) {
+        ctx->log(RC_LOG_ERROR, "buildTileLayers: Could not build heightfield layers.");
+        goto cleanup;
+    }
+
+    if (lset->nlayers > MAX_LAYERS_PER_TILE) {
+        ctx->log(RC_LOG_WARNING, "buildTileLayers: Tile (%d, %d) has %d layers, dropping all above %d.", tx, ty,
+                 lset->nlayers, MAX_LAYERS_PER_TILE);
+    }
+    for (int i = 0; i < rcMin(lset->nlayers, MAX_LAYERS_PER_TILE); ++i) {
+        const rcHeightfieldLayer* layer = &lset->layers[i];
+
+        dtTileCacheLayerHeader header;
+        header.magic = DT_TILECACHE_MAGIC;
+        header.version = DT_TILECACHE_VERSION;
+        header.tx = tx;
+        header.ty = ty;
+        header.tlayer = i;
+        dtVcopy(header.bmin, layer->bmin);
+        dtVcopy(header.bmax, layer->bmax);
+        header.width = (unsigned char) layer->width;
+        header.height = (unsigned char) layer->height;
+        header.minx = (unsigned char) layer->minx;
+        header.maxx = (unsigned char) layer->maxx;
+        header.miny = (unsigned char) layer->miny;
+        header.maxy = (unsigned char) layer->maxy;
+        header.hmin = (unsigned short) layer->hmin;
+        header.hmax = (unsigned short) layer->hmax;
+
+        unsigned char* data = 0;
+        int dataSize = 0;
+        if (dtStatusFailed(dtBuildTileCacheLayer(compressor, &header, layer->heights, layer->areas, layer->cons,
+                                                 &data, &dataSize))) {
+            ctx->log(RC_LOG_ERROR, "buildTileLayers: Could not compress layer %d of tile (%d, %d).", i, tx, ty);
+            goto cleanup;
+        }
+        layers.data[layers.count] = data;
+        layers.dataSize[layers.count] = dataSize;
+        layers.count++;
+    }
+    ok = true;
+
+cleanup:
+    if (!ok) {
+        for (int i = 0; i < layers.count; ++i) {
+            dtFree(layers.data[i]);
+        }
+        layers.count = 0;
+    }
+    rcFreeHeightfieldLayerSet(lset);
+    rcFreeCompactHeightfield(chf);
+    rcFreeHeightField(solid);
+    return ok;
+}
+
+NavMeshTileCache::NavMeshTileCache() :
+    m_alloc(0),
+    m_compressor(0),
+    m_meshProcess(0),
+    m_tileCache(0),
+    m_navMesh(0),
+    m_rebuiltTiles(0),
+    m_upToDate(true)
+{
+}
+
+NavMeshTileCache::~NavMeshTileCache() {
+    close();
+}
+
+void NavMeshTileCache::close() {
+    NavMeshMetrics::addNavMeshTiles(m_navMesh, -1);
+    dtFreeNavMesh(m_navMesh);
+    m_navMesh = 0;
+    dtFreeTileCache(m_tileCache);
+    m_tileCache = 0;
+    delete m_meshProcess;
+    m_meshProcess = 0;
+    delete m_compressor;
+    m_compressor = 0;
+    delete m_alloc;
+    m_alloc = 0;
+}
+
+bool NavMeshTileCache::init(rcContext* ctx, const rcConfig& config, InputGeom* geom, const TileAgentSettings& agent,
+                            int maxObstacles, int threadCount) {
+    if (!geom || !geom->getMesh()) {
+        ctx->log(RC_LOG_ERROR, "buildTileCache: No vertices and triangles.");
+        return false;
+    }
+    if (config.tileSize <= 0 || config.tileSize + config.borderSize * 2 > 255) {
+        ctx->log(RC_LOG_ERROR, "buildTileCache: Invalid tile size %d.", config.tileSize);
+        return false;
+    }
+
+    int tw = 0;
+    int th = 0;
+    calcTileGridSize(config, geom, &tw, &th);
+    const int tileCount = tw * th;
+
+    dtTileCacheParams tcparams;
+    memset(&tcparams, 0, sizeof(tcparams));
+    rcVcopy(tcparams.orig, geom->getNavMeshBoundsMin());
+    tcparams.cs = config.cs;
+    tcparams.ch = config.ch;
+    tcparams.width = config.tileSize;
+    tcparams.height = config.tileSize;
+    tcparams.walkableHeight = agent.agentHeight;
+    tcparams.walkableRadius = agent.agentRadius;
+    tcparams.walkableClimb = agent.agentMaxClimb;
+    tcparams.maxSimplificationError = config.maxSimplificationError;
+    tcparams.maxTiles = tileCount * EXPECTED_LAYERS_PER_TILE;
+    tcparams.maxObstacles = maxObstacles > 0 ? maxObstacles : 128;
+
+    m_alloc = new TileCacheAllocator();
+    m_compressor = new TileLayerCompressor();
+    m_meshProcess = new TileMeshProcess(geom);
+    m_tileCache = dtAllocTileCache();
+    if (!m_tileCache || dtStatusFailed(m_tileCache->init(&tcparams, m_alloc, m_compressor, m_meshProcess))) {
+        ctx->log(RC_LOG_ERROR, "buildTileCache: Could not init tile cache.");
+        close();
+        return false;
+    }
+
+    dtNavMeshParams params;
+    rcVcopy(params.orig, geom->getNavMeshBoundsMin());
+    params.tileWidth = config.tileSize * config.cs;
+    params.tileHeight = config.tileSize * config.cs;
+    params.maxTiles = tcparams.maxTiles;
+    params.maxPolys = 1 << (22 - rcMin((int) dtIlog2(dtNextPow2(tcparams.maxTiles)), 14));
+
+    m_navMesh = dtAllocNavMesh();
+    if (!m_navMesh || dtStatusFailed(m_navMesh->init(&params))) {
+        ctx->log(RC_LOG_ERROR, "buildTileCache: Could not init navmesh.");
+        close();
+        return false;
+    }
+
+    ctx->startTimer(RC_TIMER_TOTAL);
+
+    ThreadPool pool(rcMin(ThreadPool::resolveThreadCount(threadCount), tileCount));
+
+    // rcContext is not thread safe, so every worker logs and times through its own.
+    std::vector<IoRcContext> contexts(pool.getThreadCount());
+    std::vector<TileLayers> results(tileCount);
+
+    pool.parallelFor(tileCount, [&](int i, int worker) {
+        TileLayers& layers = results[i];
+        layers.ok = buildTileLayers(&contexts[worker], config, geom, i % tw, i / tw, m_compressor, layers);
+    });
+
+    // dtTileCache is not thread safe, layers are added in a fixed order once they are all built.
+    int failed = 0;
+    for (int i = 0; i < tileCount; ++i) {
+        TileLayers& layers = results[i];
+        if (!layers.ok) {
+            failed++;
+            continue;
+        }
+        for (int j = 0; j < layers.count; ++j) {
+            if (dtStatusFailed(m_tileCache->addTile(layers.data[j], layers.dataSize[j], DT_COMPRESSEDTILE_FREE_DATA, 0))) {
+                ctx->log(RC_LOG_ERROR, "buildTileCache: Could not add layer %d of tile (%d, %d).", j, i % tw, i / tw);
+                dtFree(layers.data[j]);
+                failed++;
+            }
+        }
+    }
+    for (int y = 0; y < th; ++y) {
+        for (int x = 0; x < tw; ++x) {
+            m_tileCache->buildNavMeshTilesAt(x, y, m_navMesh);
+        }
+    }
+    m_meshProcess->m_tiles = 0;
+
+    ctx->stopTimer(RC_TIMER_TOTAL);
+
+    if (failed) {
+        ctx->log(RC_LOG_WARNING, "buildTileCache: %d of %d tiles failed to build.", failed, tileCount);
+    }
+
+    NavMeshMetrics::addNavMeshTiles(m_navMesh, 1);
+    return true;
+}
+
+dtObstacleRef NavMeshTileCache::addCylinderObstacle(const float* pos, float radius, float height) {
+    dtObstacleRef ref = 0;
+    if (dtStatusFailed(m_tileCache->addObstacle(pos, radius, height, &ref))) {
+        return 0;
+    }
+    m_upToDate = false;
+    return ref;
+}
+
+dtObstacleRef NavMeshTileCache::addBoxObstacle(const float* bmin, const float* bmax) {
+    dtObstacleRef ref = 0;
+    if (dtStatusFailed(m_tileCache->addBoxObstacle(bmin, bmax, &ref))) {
+        return 0;
+    }
+    m_upToDate = false;
+    return ref;
+}
+
+dtObstacleRef NavMeshTileCache::addOrientedBoxObstacle(const float* center, const float* halfExtents,
+                                                       float yRadians) {
+    dtObstacleRef ref = 0;
+    if (dtStatusFailed(m_tileCache->addBoxObstacle(center, halfExtents, yRadians, &ref))) {
+        return 0;
+    }
+    m_upToDate = false;
+    return ref;
+}
+
+bool NavMeshTileCache::removeObstacle(dtObstacleRef ref) {
+    if (!ref || dtStatusFailed(m_tileCache->removeObstacle(ref))) {
+        return false;
+    }
+    m_upToDate = false;
+    return true;
+}
+
+bool NavMeshTileCache::update(int budgetMicros) {
+    if (m_upToDate) {
+        return true;
+    }
+
+    // Rebuilt tiles change size, so the tile memory gauges are recounted around the rebuilds.
+    NavMeshMetrics::addNavMeshTiles(m_navMesh, -1);
+    const long long tilesBefore = m_meshProcess->m_tiles;
+    const MetricsClock::time_point start = MetricsClock::now();
+    const MetricsClock::time_point deadline = start + std::chrono::microseconds(budgetMicros);
+
+    // Each update call applies the queued requests and rebuilds at most one tile.
+    bool upToDate = false;
+    do {
+        if (dtStatusFailed(m_tileCache->update(0, m_navMesh, &upToDate))) {
+            break;
+        }
+    } while (!upToDate && MetricsClock::now() < deadline);
+
+    m_rebuiltTiles += m_meshProcess->m_tiles - tilesBefore;
+    NavMeshMetrics::addNavMeshTiles(m_navMesh, 1);
+    m_upToDate = upToDate;
+    return upToDate;
+}
+
+void NavMeshTileCache::getStats(TileCacheStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (int i = 0; i < m_tileCache->getTileCount(); ++i) {
+        const dtCompressedTile* tile = m_tileCache->getTile(i);
+        if (tile && tile->header) {
+            stats->compressedBytes += tile->compressedSize;
+            stats->rawBytes += tile->header->width * tile->header->height * 3;
+            stats->layers++;
+        }
+    }
+    for (int i = 0; i < m_tileCache->getObstacleCount(); ++i) {
+        const dtTileCacheObstacle* obstacle = m_tileCache->getObstacle(i);
+        if (obstacle && obstacle->state != DT_OBSTACLE_EMPTY) {
+            stats->obstacles++;
+        }
+    }
+    stats->maxObstacles = m_tileCache->getParams()->maxObstacles;
+    stats->rebuiltTiles = m_rebuiltTiles;
+}
@@ -0,0 +1,220 @@
+#include "PathCache.h"
+#include "DetourCommon.h"
+
+#include <string.h>
+
+bool PathCache::Key::operator==(const Key& other) const {
+    return startRef == other.startRef && endRef == other.endRef &&
+           includeFlags == other.includeFlags && excludeFlags == other.excludeFlags &&
+           memcmp(areaCost, other.areaCost, sizeof(areaCost)) == 0;
+}
+
+size_t PathCache::KeyHash::operator()(const Key& key) const {
+    // FNV-1a over the key. Costs are hashed by their bit patterns, consistent with operator==.
+    unsigned long long hash = 14695981039346656037ULL;
+    const unsigned char* bytes[3] = {
+        (const unsigned char*) &key.startRef,
+        (const unsigned char*) &key.endRef,
+        (const unsigned char*) key.areaCost
+    };
+    const size_t sizes[3] = { sizeof(key.startRef), sizeof(key.endRef), sizeof(key.areaCost) };
+    for (int i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < sizes[i]; ++j) {
+            hash = (hash ^ bytes[i][j]) * 1099511628211ULL;
+        }
+    }
+    hash = (hash ^ key.includeFlags) * 1099511628211ULL;
+    hash = (hash ^ key.excludeFlags) * 1099511628211ULL;
+    return (size_t) (hash ^ (hash >> 32));
+}
+
+PathCache::PathCache(const dtNavMesh* navMesh, int maxEntries) :
+    m_navMesh(navMesh),
+    m_maxEntriesPerShard(dtMax(1, (maxEntries + SHARD_COUNT - 1) / SHARD_COUNT))
+{
+    for (int i = 0; i < SHARD_COUNT; ++i) {
+        Shard& shard = m_shards[i];
+        shard.hits = shard.misses = shard.insertions = shard.evictions = shard.invalidations = 0;
+    }
+}
+
+PathCache::Shard& PathCache::shardFor(const Key& key) {
+    // The low bits pick the unordered_map bucket, so take the shard from the high ones.
+    const size_t hash = KeyHash()(key);
+    return m_shards[(hash >> 24) % SHARD_COUNT];
+}
+
+bool PathCache::isValid(const Entry& entry) const {
+    for (size_t i = 0; i < entry.path.size(); ++i) {
+        if (!m_navMesh->isValidPolyRef(entry.path[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PathCache::erase(Shard& shard, EntryList::iterator entry) {
+    shard.index.erase(entry->key);
+    shard.lru.erase(entry);
+}
+
+int PathCache::findPath(dtNavMeshQuery* navQuery, dtPolyRef startRef, dtPolyRef endRef, const float* startPos,
+                        const float* endPos, const dtQueryFilter* filter, dtPolyRef* path, int maxPath,
+                        dtStatus* status) {
+    dtQueryFilter defaultFilter;
+    if (!filter) {
+        filter = &defaultFilter;
+    }
+
+    Key key;
+    key.startRef = startRef;
+    key.endRef = endRef;
+    key.includeFlags = filter->getIncludeFlags();
+    key.excludeFlags = filter->getExcludeFlags();
+    for (int i = 0; i < DT_MAX_AREAS; ++i) {
+        key.areaCost[i] = filter->getAreaCost(i);
+    }
+
+    Shard& shard = shardFor(key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::unordered_map<Key, EntryList::iterator, KeyHash>::iterator found = shard.index.find(key);
+        if (found != shard.index.end()) {
+            EntryList::iterator entry = found->second;
+            if (!isValid(*entry)) {
+                erase(shard, entry);
+                shard.invalidations++;
+            } else if ((int) entry->path.size() <= maxPath) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+                shard.hits++;
+                memcpy(path, &entry->path[0], entry->path.size() * sizeof(dtPolyRef));
+                if (status) {
+                    *status = DT_SUCCESS;
+                }
+                return (int) entry->path.size();
+            }
+            // A corridor longer than the caller's buffer falls through to the search, which reports it
+            // as truncated the same way an uncached query would.
+        }
+        shard.misses++;
+    }
+
+    // Search without holding the shard, so other threads are not held up by it.
+    int pathCount = 0;
+    const dtStatus result = navQuery->findPath(startRef, endRef, startPos, endPos, filter, path, &pathCount, maxPath);
+    if (status) {
+        *status = result;
+    }
+    if (dtStatusFailed(result)) {
+        return 0;
+    }
+
+    if (!dtStatusDetail(result, DT_PARTIAL_RESULT) && !dtStatusDetail(result, DT_BUFFER_TOO_SMALL) && pathCount > 0) {
+        insert(key, path, pathCount);
+    }
+    return pathCount;
+}
+
+void PathCache::insert(const Key& key, const dtPolyRef* path, int pathCount) {
+    Entry entry;
+    entry.key = key;
+    entry.path.assign(path, path + pathCount);
+
+    // Remember which tiles the corridor crosses for invalidateRegion. Consecutive polys mostly share a
+    // tile, and a corridor only crosses a handful, so a linear check is enough to keep them unique.
+    for (int i = 0; i < pathCount; ++i) {
+        const dtMeshTile* tile = 0;
+        const dtPoly* poly = 0;
+        m_navMesh->getTileAndPolyByRefUnsafe(path[i], &tile, &poly);
+        bool seen = false;
+        for (size_t j = 0; j < entry.tiles.size() && !seen; j += 2) {
+            seen = entry.tiles[j] == tile->header->x && entry.tiles[j + 1] == tile->header->y;
+        }
+        if (!seen) {
+            entry.tiles.push_back(tile->header->x);
+            entry.tiles.push_back(tile->header->y);
+        }
+    }
+
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // Another thread may have stored the same key while this one was searching.
+    std::unordered_map<Key, EntryList::iterator, KeyHash>::iterator found = shard.index.find(key);
+    if (found != shard.index.end()) {
+        erase(shard, found->second);
+    }
+
+    shard.lru.push_front(entry);
+    shard.index[key] = shard.lru.begin();
+    shard.insertions++;
+
+    while ((int) shard.index.size() > m_maxEntriesPerShard) {
+        erase(shard, --shard.lru.end());
+        shard.evictions++;
+    }
+}
+
+int PathCache::invalidateRegion(const float* bmin, const float* bmax) {
+    int ax, ay, bx, by;
+    m_navMesh->calcTileLoc(bmin, &ax, &ay);
+    m_navMesh->calcTileLoc(bmax, &bx, &by);
+    const int x0 = dtMin(ax, bx), x1 = dtMax(ax, bx);
+    const int y0 = dtMin(ay, by), y1 = dtMax(ay, by);
+
+    int dropped = 0;
+    for (int i = 0; i < SHARD_COUNT; ++i) {
+        Shard& shard = m_shards[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        EntryList::iterator entry = shard.lru.begin();
+        while (entry != shard.lru.end()) {
+            bool crosses = false;
+            for (size_t j = 0; j < entry->tiles.size() && !crosses; j += 2) {
+                crosses = entry->tiles[j] >= x0 && entry->tiles[j] <= x1 &&
+                          entry->tiles[j + 1] >= y0 && entry->tiles[j + 1] <= y1;
+            }
+            EntryList::iterator next = entry;
+            ++next;
+            if (crosses) {
+                erase(shard, entry);
+                shard.invalidations++;
+                dropped++;
+            }
+            entry = next;
+        }
+    }
+    return dropped;
+}
+
+void PathCache::clear() {
+    for (int i = 0; i < SHARD_COUNT; ++i) {
+        Shard& shard = m_shards[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.invalidations += shard.index.size();
+        shard.index.clear();
+        shard.lru.clear();
+    }
+}
+
+void PathCache::getStats(PathCacheStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (int i = 0; i < SHARD_COUNT; ++i) {
+        Shard& shard = m_shards[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats->hits += shard.hits;
+        stats->misses += shard.misses;
+        stats->insertions += shard.insertions;
+        stats->evictions += shard.evictions;
+        stats->invalidations += shard.invalidations;
+        stats->entries += (int) shard.index.size();
+    }
+    stats->maxEntries = m_maxEntriesPerShard * SHARD_COUNT;
+}
+
+void PathCache::resetCounters() {
+    for (int i = 0; i < SHARD_COUNT; ++i) {
+        Shard& shard = m_shards[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.hits = shard.misses = shard.insertions = shard.evictions = shard.invalidations = 0;
+    }
+}
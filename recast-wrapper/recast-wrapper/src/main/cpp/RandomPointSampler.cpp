@@ -0,0 +1,175 @@
+#include "RandomPointSampler.h"
+#include "DetourCommon.h"
+
+// splitmix64 finalizer.
+static unsigned long long mix64(unsigned long long x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// 24 random bits as a float in [0, 1).
+static float toUnitFloat(unsigned long long bits) {
+    return (float) (bits & 0xffffff) * (1.0f / 16777216.0f);
+}
+
+// Twice the 2D area of a convex poly, which is what findRandomPoint weighs polys by.
+static float calcPolyArea(const dtMeshTile* tile, const dtPoly* poly) {
+    float area = 0;
+    const float* va = &tile->verts[poly->verts[0] * 3];
+    for (int i = 2; i < poly->vertCount; ++i) {
+        const float* vb = &tile->verts[poly->verts[i - 1] * 3];
+        const float* vc = &tile->verts[poly->verts[i] * 3];
+        area += dtTriArea2D(va, vb, vc);
+    }
+    return area;
+}
+
+RandomPointSampler::RandomPointSampler() :
+    m_navMesh(0),
+    m_query(0),
+    m_totalArea(0),
+    m_tileSignature(0)
+{
+}
+
+RandomPointSampler::~RandomPointSampler() {
+    dtFreeNavMeshQuery(m_query);
+}
+
+bool RandomPointSampler::init(const dtNavMesh* navMesh, const dtQueryFilter* filter) {
+    if (!navMesh) {
+        return false;
+    }
+
+    m_query = dtAllocNavMeshQuery();
+    if (!m_query || dtStatusFailed(m_query->init(navMesh, 64))) {
+        return false;
+    }
+
+    m_navMesh = navMesh;
+    m_filter = filter ? *filter : dtQueryFilter();
+    build();
+    return true;
+}
+
+bool RandomPointSampler::refresh() {
+    if (calcTileSignature() == m_tileSignature) {
+        return false;
+    }
+    build();
+    return true;
+}
+
+// Tiles get a new salt whenever they are removed, so the salts and data pointers of all tile slots
+// change whenever the set of tiles does.
+unsigned long long RandomPointSampler::calcTileSignature() const {
+    unsigned long long signature = 0;
+    for (int i = 0; i < m_navMesh->getMaxTiles(); ++i) {
+        const dtMeshTile* tile = m_navMesh->getTile(i);
+        const unsigned long long data = tile->header ? (unsigned long long) (size_t) tile->data : 0;
+        signature = mix64(signature ^ mix64(((unsigned long long) tile->salt << 32) ^ (unsigned long long) i) ^ data);
+    }
+    return signature;
+}
+
+void RandomPointSampler::build() {
+    m_refs.clear();
+    m_totalArea = 0;
+    m_tileSignature = calcTileSignature();
+
+    std::vector<float> areas;
+    for (int i = 0; i < m_navMesh->getMaxTiles(); ++i) {
+        const dtMeshTile* tile = m_navMesh->getTile(i);
+        if (!tile->header) {
+            continue;
+        }
+
+        const dtPolyRef base = m_navMesh->getPolyRefBase(tile);
+        for (int j = 0; j < tile->header->polyCount; ++j) {
+            const dtPoly* poly = &tile->polys[j];
+            const dtPolyRef ref = base | (dtPolyRef) j;
+            if (poly->getType() != DT_POLYTYPE_GROUND || !m_filter.passFilter(ref, tile, poly)) {
+                continue;
+            }
+            const float area = calcPolyArea(tile, poly);
+            if (area <= 0) {
+                continue;
+            }
+            m_refs.push_back(ref);
+            areas.push_back(area);
+            m_totalArea += area * 0.5f;
+        }
+    }
+
+    // Vose's alias method: every column holds at most two polys, so a sample is one column pick and one
+    // biased coin flip. Scaled areas are kept in double so that the leftovers do not drift.
+    const int n = (int) m_refs.size();
+    m_probabilities.assign(n, 1.0f);
+    m_aliases.resize(n);
+    std::vector<double> scaled(n);
+    std::vector<int> small;
+    std::vector<int> large;
+    double totalArea = 0;
+    for (int i = 0; i < n; ++i) {
+        totalArea += areas[i];
+    }
+    for (int i = 0; i < n; ++i) {
+        m_aliases[i] = i;
+        scaled[i] = areas[i] * n / totalArea;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        const int less = small.back();
+        const int more = large.back();
+        small.pop_back();
+        m_probabilities[less] = (float) scaled[less];
+        m_aliases[less] = more;
+        scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+        if (scaled[more] < 1.0) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+}
+
+int RandomPointSampler::sample(unsigned long long seed, unsigned long long counter, int count, dtPolyRef* refs,
+                               float* points) const {
+    const int n = (int) m_refs.size();
+    if (n == 0 || count <= 0) {
+        return 0;
+    }
+
+    const unsigned long long key = mix64(seed);
+    float verts[DT_VERTS_PER_POLYGON * 3];
+    float areas[DT_VERTS_PER_POLYGON];
+    for (int i = 0; i < count; ++i) {
+        const unsigned long long first = mix64(key ^ mix64(counter + (unsigned long long) i));
+        const unsigned long long second = mix64(first);
+
+        // The high half of the first word picks the column and its low bits flip the coin.
+        int column = (int) (((first >> 32) * (unsigned long long) n) >> 32);
+        if (toUnitFloat(first) >= m_probabilities[column]) {
+            column = m_aliases[column];
+        }
+
+        const dtPolyRef ref = m_refs[column];
+        const dtMeshTile* tile = 0;
+        const dtPoly* poly = 0;
+        m_navMesh->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+        for (int j = 0; j < poly->vertCount; ++j) {
+            dtVcopy(&verts[j * 3], &tile->verts[poly->verts[j] * 3]);
+        }
+
+        float* point = &points[i * 3];
+        dtRandomPointInConvexPoly(verts, poly->vertCount, areas, toUnitFloat(second), toUnitFloat(second >> 24),
+                                  point);
+        float h = 0;
+        if (dtStatusSucceed(m_query->getPolyHeight(ref, point, &h))) {
+            point[1] = h;
+        }
+        refs[i] = ref;
+    }
+    return count;
+}
@@ -21,24 +21,42 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <map>
+#include <mutex>
+#include <vector>
 
 #include "Sample_subset.h"
+#include "MappedFile.h"
+#include "NavMeshFile.h"
+#include "TileCompressor.h"
 
 namespace Sample {
-    static const int NAVMESHSET_MAGIC = 'M' << 24 | 'S' << 16 | 'E' << 8 | 'T'; //'MSET';
-    static const int NAVMESHSET_VERSION = 1;
+    // Reads and adds the next tile of a compressed file. Returns 1 when a tile was read, 0 at the end
+    // marker and -1 on a read or decompression error.
+    static int readCompressedTile(FILE *fp, dtNavMesh *mesh) {
+        NavMeshCompressedTileHeader tileHeader;
+        if (fread(&tileHeader, sizeof(tileHeader), 1, fp) != 1) {
+            return -1;
+        }
+        if (!tileHeader.tileRef || tileHeader.dataSize <= 0 || tileHeader.compressedSize <= 0) {
+            return 0;
+        }
 
-    struct NavMeshSetHeader {
-        int magic;
-        int version;
-        int numTiles;
-        dtNavMeshParams params;
-    };
+        unsigned char *compressed = (unsigned char *) dtAlloc(tileHeader.compressedSize, DT_ALLOC_TEMP);
+        unsigned char *data = (unsigned char *) dtAlloc(tileHeader.dataSize, DT_ALLOC_PERM);
+        if (!compressed || !data || fread(compressed, tileHeader.compressedSize, 1, fp) != 1 ||
+            tileDecompress(compressed, tileHeader.compressedSize, data, tileHeader.dataSize) != tileHeader.dataSize) {
+            dtFree(compressed);
+            dtFree(data);
+            return -1;
+        }
+        dtFree(compressed);
 
-    struct NavMeshTileHeader {
-        dtTileRef tileRef;
-        int dataSize;
-    };
+        if (dtStatusFailed(mesh->addTile(data, tileHeader.dataSize, DT_TILE_FREE_DATA, tileHeader.tileRef, 0))) {
+            dtFree(data);
+        }
+        return 1;
+    }
 
     dtNavMesh *loadAll(const char *path) {
         FILE *fp = fopen(path, "rb");
@@ -51,11 +69,16 @@ namespace Sample {
             fclose(fp);
             return 0;
         }
-        if (header.magic != NAVMESHSET_MAGIC) {
+        if (header.magic == NAVMESHSET_MAGIC && header.version == NAVMESHFILE_VERSION) {
+            fclose(fp);
+            return loadNavMeshFile(path, 0);
+        }
+        const bool compressed = header.magic == NAVMESHSET_COMPRESSED_MAGIC;
+        if (header.magic != NAVMESHSET_MAGIC && !compressed) {
             fclose(fp);
             return 0;
         }
-        if (header.version != NAVMESHSET_VERSION) {
+        if (header.version != (compressed ? NAVMESHSET_COMPRESSED_VERSION : NAVMESHSET_VERSION)) {
             fclose(fp);
             return 0;
         }
@@ -73,6 +96,18 @@ namespace Sample {
 
         // Read tiles.
         for (int i = 0; i < header.numTiles; ++i) {
+            if (compressed) {
+                const int read = readCompressedTile(fp, mesh);
+                if (read < 0) {
+                    dtFreeNavMesh(mesh);
+                    fclose(fp);
+                    return 0;
+                }
+                if (read == 0)
+                    break;
+                continue;
+            }
+
             NavMeshTileHeader tileHeader;
             readLen = fread(&tileHeader, sizeof(tileHeader), 1, fp);
             if (readLen != 1) {
@@ -100,4 +135,154 @@ namespace Sample {
 
         return mesh;
     }
-}
\ No newline at end of file
+
+    bool saveCompressed(const dtNavMesh *mesh, const char *path) {
+        if (!mesh) return false;
+
+        FILE *fp = fopen(path, "wb");
+        if (!fp) return false;
+
+        NavMeshSetHeader header;
+        header.magic = NAVMESHSET_COMPRESSED_MAGIC;
+        header.version = NAVMESHSET_COMPRESSED_VERSION;
+        header.numTiles = 0;
+        for (int i = 0; i < mesh->getMaxTiles(); ++i) {
+            const dtMeshTile *tile = mesh->getTile(i);
+            if (tile && tile->header && tile->dataSize) header.numTiles++;
+        }
+        memcpy(&header.params, mesh->getParams(), sizeof(dtNavMeshParams));
+        bool ok = fwrite(&header, sizeof(NavMeshSetHeader), 1, fp) == 1;
+
+        std::vector<unsigned char> buffer;
+        for (int i = 0; i < mesh->getMaxTiles() && ok; ++i) {
+            const dtMeshTile *tile = mesh->getTile(i);
+            if (!tile || !tile->header || !tile->dataSize) continue;
+
+            buffer.resize(tileCompressBound(tile->dataSize));
+            NavMeshCompressedTileHeader tileHeader;
+            tileHeader.tileRef = mesh->getTileRef(tile);
+            tileHeader.dataSize = tile->dataSize;
+            tileHeader.compressedSize = tileCompress(tile->data, tile->dataSize, &buffer[0], (int) buffer.size());
+            tileHeader.x = tile->header->x;
+            tileHeader.y = tile->header->y;
+            ok = tileHeader.compressedSize > 0 && fwrite(&tileHeader, sizeof(tileHeader), 1, fp) == 1 &&
+                 fwrite(&buffer[0], tileHeader.compressedSize, 1, fp) == 1;
+        }
+
+        if (fclose(fp) != 0) ok = false;
+        return ok;
+    }
+
+    // Meshes created by loadAllMapped reference the mapping directly, so it must outlive them.
+    static std::mutex s_mappedMutex;
+    static std::map<const dtNavMesh *, MappedFile *> s_mapped;
+
+    // The version 2 table points at aligned tiles, which are checked against their checksums before Detour
+    // writes its links into them.
+    static bool addMappedTiles(dtNavMesh *mesh, unsigned char *data, size_t size) {
+        NavMeshSetHeader header;
+        std::vector<NavMeshFileTile> tiles;
+        if (!readNavMeshFileTable(data, (long long) size, header, tiles)) {
+            return false;
+        }
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            const NavMeshFileTile &tile = tiles[i];
+            if (navMeshFileChecksum(data + tile.offset, tile.dataSize) != tile.checksum ||
+                dtStatusFailed(mesh->addTile(data + tile.offset, tile.dataSize, 0, tile.tileRef, 0))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    dtNavMesh *loadAllMapped(const char *path) {
+        MappedFile *file = new MappedFile();
+        if (!file->open(path) || file->getSize() < sizeof(NavMeshSetHeader)) {
+            delete file;
+            return 0;
+        }
+
+        const unsigned char *data = file->getData();
+        const size_t size = file->getSize();
+
+        NavMeshSetHeader header;
+        memcpy(&header, data, sizeof(NavMeshSetHeader));
+        if (header.magic != NAVMESHSET_MAGIC ||
+            (header.version != NAVMESHSET_VERSION && header.version != NAVMESHFILE_VERSION)) {
+            delete file;
+            return 0;
+        }
+
+        dtNavMesh *mesh = dtAllocNavMesh();
+        if (!mesh) {
+            delete file;
+            return 0;
+        }
+        dtStatus status = mesh->init(&header.params);
+        if (dtStatusFailed(status)) {
+            dtFreeNavMesh(mesh);
+            delete file;
+            return 0;
+        }
+
+        // Register the tiles in place. They are added without DT_TILE_FREE_DATA so Detour never frees
+        // them; it does write the poly link lists into the tile data, which the copy-on-write mapping
+        // absorbs by privately copying just those pages.
+        if (header.version == NAVMESHFILE_VERSION) {
+            if (!addMappedTiles(mesh, file->getData(), size)) {
+                dtFreeNavMesh(mesh);
+                delete file;
+                return 0;
+            }
+            std::lock_guard<std::mutex> lock(s_mappedMutex);
+            s_mapped[mesh] = file;
+            return mesh;
+        }
+
+        size_t offset = sizeof(NavMeshSetHeader);
+        for (int i = 0; i < header.numTiles; ++i) {
+            NavMeshTileHeader tileHeader;
+            if (size - offset < sizeof(tileHeader)) {
+                dtFreeNavMesh(mesh);
+                delete file;
+                return 0;
+            }
+            memcpy(&tileHeader, data + offset, sizeof(tileHeader));
+            offset += sizeof(tileHeader);
+
+            if (!tileHeader.tileRef || tileHeader.dataSize <= 0)
+                break;
+
+            // Tile data must lie inside the file and keep the 4 byte alignment Detour lays it out with.
+            if (size - offset < (size_t) tileHeader.dataSize || (offset & 3) != 0) {
+                dtFreeNavMesh(mesh);
+                delete file;
+                return 0;
+            }
+
+            mesh->addTile(file->getData() + offset, tileHeader.dataSize, 0, tileHeader.tileRef, 0);
+            offset += tileHeader.dataSize;
+        }
+
+        std::lock_guard<std::mutex> lock(s_mappedMutex);
+        s_mapped[mesh] = file;
+        return mesh;
+    }
+
+    void freeNavMesh(dtNavMesh *mesh) {
+        MappedFile *file = 0;
+        {
+            // Unregister before freeing, so the address cannot be reused by another mesh while it is
+            // still in the registry.
+            std::lock_guard<std::mutex> lock(s_mappedMutex);
+            std::map<const dtNavMesh *, MappedFile *>::iterator it = s_mapped.find(mesh);
+            if (it != s_mapped.end()) {
+                file = it->second;
+                s_mapped.erase(it);
+            }
+        }
+
+        dtFreeNavMesh(mesh);
+        delete file;
+    }
+}
@@ -0,0 +1,423 @@
+#include "StreamingNavMesh.h"
+#include "NavMeshMetrics.h"
+#include "NavMeshFile.h"
+#include "Sample_subset.h"
+#include "TileCompressor.h"
+#include "DetourAlloc.h"
+#include "DetourCommon.h"
+
+static bool seekTo(FILE* fp, long long offset) {
+#ifdef _WIN32
+    return _fseeki64(fp, offset, SEEK_SET) == 0;
+#else
+    return fseeko(fp, (off_t) offset, SEEK_SET) == 0;
+#endif
+}
+
+StreamingNavMesh::StreamingNavMesh() :
+    m_file(0),
+    m_navMesh(0),
+    m_minX(0),
+    m_minY(0),
+    m_gridWidth(0),
+    m_gridHeight(0),
+    m_lruHead(-1),
+    m_lruTail(-1),
+    m_touch(0),
+    m_budgetBytes(0),
+    m_residentBytes(0),
+    m_compressedBytes(0),
+    m_residentTiles(0),
+    m_pinnedTiles(0),
+    m_hits(0),
+    m_misses(0),
+    m_evictions(0),
+    m_loadFailures(0)
+{
+}
+
+StreamingNavMesh::~StreamingNavMesh() {
+    close();
+}
+
+void StreamingNavMesh::close() {
+    // Resident tiles were added with DT_TILE_FREE_DATA and are released together with the mesh.
+    NavMeshMetrics::addTileMemory(-m_residentTiles, -m_residentBytes);
+    dtFreeNavMesh(m_navMesh);
+    m_navMesh = 0;
+    if (m_file) {
+        fclose(m_file);
+        m_file = 0;
+    }
+    m_reader.close();
+    for (size_t i = 0; i < m_tiles.size(); ++i) {
+        dtFree(m_tiles[i].compressed);
+    }
+    m_tiles.clear();
+    m_cells.clear();
+    m_lruHead = m_lruTail = -1;
+    m_residentBytes = 0;
+    m_compressedBytes = 0;
+    m_residentTiles = 0;
+    m_pinnedTiles = 0;
+}
+
+bool StreamingNavMesh::init(const char* path, long long budgetBytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    close();
+
+    m_budgetBytes = budgetBytes > 0 ? budgetBytes : 0;
+
+    m_file = fopen(path, "rb");
+    if (!m_file) {
+        return false;
+    }
+
+    Sample::NavMeshSetHeader header;
+    if (fread(&header, sizeof(header), 1, m_file) != 1) {
+        close();
+        return false;
+    }
+    const bool compressed = header.magic == Sample::NAVMESHSET_COMPRESSED_MAGIC &&
+                            header.version == Sample::NAVMESHSET_COMPRESSED_VERSION;
+    const bool indexed = header.magic == Sample::NAVMESHSET_MAGIC && header.version == NAVMESHFILE_VERSION;
+    if (header.numTiles < 0 || (!compressed && !indexed &&
+        (header.magic != Sample::NAVMESHSET_MAGIC || header.version != Sample::NAVMESHSET_VERSION))) {
+        close();
+        return false;
+    }
+
+    m_navMesh = dtAllocNavMesh();
+    if (!m_navMesh || dtStatusFailed(m_navMesh->init(&header.params))) {
+        close();
+        return false;
+    }
+
+    m_tiles.reserve(header.numTiles);
+    if (compressed) {
+        if (!readCompressedTiles(header.numTiles)) {
+            close();
+            return false;
+        }
+        // Every tile is in memory now, the file is not needed anymore.
+        fclose(m_file);
+        m_file = 0;
+        buildCellIndex();
+        return true;
+    }
+    if (indexed) {
+        // The reader keeps its own handle and validates the table against the file size.
+        fclose(m_file);
+        m_file = 0;
+        if (!m_reader.open(path) || !readTileTable()) {
+            close();
+            return false;
+        }
+        buildCellIndex();
+        return true;
+    }
+
+    // Index the tiles by reading only their headers.
+    long long offset = sizeof(Sample::NavMeshSetHeader);
+    for (int i = 0; i < header.numTiles; ++i) {
+        Sample::NavMeshTileHeader tileHeader;
+        if (!seekTo(m_file, offset) || fread(&tileHeader, sizeof(tileHeader), 1, m_file) != 1) {
+            close();
+            return false;
+        }
+        offset += sizeof(tileHeader);
+
+        if (!tileHeader.tileRef || !tileHeader.dataSize)
+            break;
+
+        dtMeshHeader meshHeader;
+        if (tileHeader.dataSize < (int) sizeof(meshHeader) ||
+            fread(&meshHeader, sizeof(meshHeader), 1, m_file) != 1 ||
+            meshHeader.magic != DT_NAVMESH_MAGIC || meshHeader.version != DT_NAVMESH_VERSION) {
+            close();
+            return false;
+        }
+
+        TileEntry entry;
+        entry.tileRef = tileHeader.tileRef;
+        entry.offset = offset;
+        entry.compressed = 0;
+        entry.compressedSize = 0;
+        entry.dataSize = tileHeader.dataSize;
+        entry.fileIndex = -1;
+        entry.x = meshHeader.x;
+        entry.y = meshHeader.y;
+        entry.nextInCell = -1;
+        entry.prev = entry.next = -1;
+        entry.pinCount = 0;
+        entry.lastTouch = 0;
+        entry.resident = false;
+        m_tiles.push_back(entry);
+
+        offset += tileHeader.dataSize;
+    }
+
+    buildCellIndex();
+    return true;
+}
+
+bool StreamingNavMesh::readCompressedTiles(int numTiles) {
+    for (int i = 0; i < numTiles; ++i) {
+        Sample::NavMeshCompressedTileHeader tileHeader;
+        if (fread(&tileHeader, sizeof(tileHeader), 1, m_file) != 1) {
+            return false;
+        }
+        if (!tileHeader.tileRef || tileHeader.dataSize <= 0 || tileHeader.compressedSize <= 0)
+            break;
+
+        TileEntry entry;
+        entry.tileRef = tileHeader.tileRef;
+        entry.offset = 0;
+        entry.compressed = (unsigned char*) dtAlloc(tileHeader.compressedSize, DT_ALLOC_PERM);
+        entry.compressedSize = tileHeader.compressedSize;
+        entry.dataSize = tileHeader.dataSize;
+        entry.fileIndex = -1;
+        entry.x = tileHeader.x;
+        entry.y = tileHeader.y;
+        entry.nextInCell = -1;
+        entry.prev = entry.next = -1;
+        entry.pinCount = 0;
+        entry.lastTouch = 0;
+        entry.resident = false;
+        if (!entry.compressed) {
+            return false;
+        }
+        // Pushed before reading, so close frees the buffer if the read fails.
+        m_tiles.push_back(entry);
+        if (fread(entry.compressed, entry.compressedSize, 1, m_file) != 1) {
+            return false;
+        }
+        m_compressedBytes += entry.compressedSize;
+    }
+    return true;
+}
+
+bool StreamingNavMesh::readTileTable() {
+    for (int i = 0; i < m_reader.getTileCount(); ++i) {
+        const NavMeshFileTile& tile = m_reader.getTile(i);
+
+        TileEntry entry;
+        entry.tileRef = tile.tileRef;
+        entry.offset = tile.offset;
+        entry.compressed = 0;
+        entry.compressedSize = 0;
+        entry.dataSize = tile.dataSize;
+        entry.fileIndex = i;
+        entry.x = tile.x;
+        entry.y = tile.y;
+        entry.nextInCell = -1;
+        entry.prev = entry.next = -1;
+        entry.pinCount = 0;
+        entry.lastTouch = 0;
+        entry.resident = false;
+        m_tiles.push_back(entry);
+    }
+    return true;
+}
+
+void StreamingNavMesh::buildCellIndex() {
+    if (m_tiles.empty()) {
+        return;
+    }
+
+    int maxX = m_tiles[0].x, maxY = m_tiles[0].y;
+    m_minX = m_tiles[0].x;
+    m_minY = m_tiles[0].y;
+    for (size_t i = 1; i < m_tiles.size(); ++i) {
+        m_minX = dtMin(m_minX, m_tiles[i].x);
+        m_minY = dtMin(m_minY, m_tiles[i].y);
+        maxX = dtMax(maxX, m_tiles[i].x);
+        maxY = dtMax(maxY, m_tiles[i].y);
+    }
+    m_gridWidth = maxX - m_minX + 1;
+    m_gridHeight = maxY - m_minY + 1;
+    m_cells.assign((size_t) m_gridWidth * m_gridHeight, -1);
+    for (int i = (int) m_tiles.size() - 1; i >= 0; --i) {
+        int& cell = m_cells[(m_tiles[i].y - m_minY) * m_gridWidth + (m_tiles[i].x - m_minX)];
+        m_tiles[i].nextInCell = cell;
+        cell = i;
+    }
+}
+
+int StreamingNavMesh::touch(const float* bmin, const float* bmax) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return forEachTileIn(bmin, bmax, 0);
+}
+
+int StreamingNavMesh::pin(const float* bmin, const float* bmax) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return forEachTileIn(bmin, bmax, 1);
+}
+
+int StreamingNavMesh::unpin(const float* bmin, const float* bmax) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return forEachTileIn(bmin, bmax, -1);
+}
+
+void StreamingNavMesh::setBudget(long long budgetBytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budgetBytes = budgetBytes > 0 ? budgetBytes : 0;
+    enforceBudget();
+}
+
+void StreamingNavMesh::getStats(TileStreamStats* stats) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stats->hits = m_hits;
+    stats->misses = m_misses;
+    stats->evictions = m_evictions;
+    stats->loadFailures = m_loadFailures;
+    stats->residentBytes = m_residentBytes;
+    stats->budgetBytes = m_budgetBytes;
+    stats->compressedBytes = m_compressedBytes;
+    stats->residentTiles = m_residentTiles;
+    stats->pinnedTiles = m_pinnedTiles;
+    stats->totalTiles = (int) m_tiles.size();
+}
+
+void StreamingNavMesh::resetCounters() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hits = m_misses = m_evictions = m_loadFailures = 0;
+}
+
+int StreamingNavMesh::forEachTileIn(const float* bmin, const float* bmax, int pinDelta) {
+    if (!m_navMesh || m_cells.empty()) {
+        return 0;
+    }
+
+    int ax, ay, bx, by;
+    m_navMesh->calcTileLoc(bmin, &ax, &ay);
+    m_navMesh->calcTileLoc(bmax, &bx, &by);
+    const int x0 = dtMax(dtMin(ax, bx), m_minX);
+    const int y0 = dtMax(dtMin(ay, by), m_minY);
+    const int x1 = dtMin(dtMax(ax, bx), m_minX + m_gridWidth - 1);
+    const int y1 = dtMin(dtMax(ay, by), m_minY + m_gridHeight - 1);
+
+    // Tiles stamped with the current touch are protected from the eviction pass below.
+    const unsigned int stamp = ++m_touch;
+    int resident = 0;
+
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            for (int i = m_cells[(y - m_minY) * m_gridWidth + (x - m_minX)]; i != -1; i = m_tiles[i].nextInCell) {
+                TileEntry& tile = m_tiles[i];
+
+                if (pinDelta > 0) {
+                    if (tile.pinCount++ == 0) m_pinnedTiles++;
+                } else if (pinDelta < 0 && tile.pinCount > 0) {
+                    if (--tile.pinCount == 0) m_pinnedTiles--;
+                }
+
+                if (pinDelta >= 0) {
+                    if (tile.resident) {
+                        m_hits++;
+                        unlink(i);
+                        linkFront(i);
+                    } else {
+                        m_misses++;
+                        loadTile(i);
+                    }
+                    tile.lastTouch = stamp;
+                }
+
+                if (tile.resident) resident++;
+            }
+        }
+    }
+
+    enforceBudget();
+    return resident;
+}
+
+bool StreamingNavMesh::loadTile(int index) {
+    TileEntry& tile = m_tiles[index];
+
+    unsigned char* data = 0;
+    if (tile.fileIndex >= 0) {
+        data = m_reader.readTile(tile.fileIndex);
+    } else {
+        data = (unsigned char*) dtAlloc(tile.dataSize, DT_ALLOC_PERM);
+        const bool read = data && (tile.compressed ?
+            tileDecompress(tile.compressed, tile.compressedSize, data, tile.dataSize) == tile.dataSize :
+            seekTo(m_file, tile.offset) && fread(data, tile.dataSize, 1, m_file) == 1);
+        if (!read) {
+            dtFree(data);
+            data = 0;
+        }
+    }
+    if (!data) {
+        m_loadFailures++;
+        return false;
+    }
+
+    // Reusing the tile ref the file was saved with keeps poly refs identical across reloads.
+    if (dtStatusFailed(m_navMesh->addTile(data, tile.dataSize, DT_TILE_FREE_DATA, tile.tileRef, 0))) {
+        dtFree(data);
+        m_loadFailures++;
+        return false;
+    }
+
+    tile.resident = true;
+    linkFront(index);
+    m_residentBytes += tile.dataSize;
+    m_residentTiles++;
+    NavMeshMetrics::addTileMemory(1, tile.dataSize);
+    return true;
+}
+
+void StreamingNavMesh::evictTile(int index) {
+    TileEntry& tile = m_tiles[index];
+    m_navMesh->removeTile(tile.tileRef, 0, 0);
+    unlink(index);
+    tile.resident = false;
+    m_residentBytes -= tile.dataSize;
+    m_residentTiles--;
+    m_evictions++;
+    NavMeshMetrics::addTileMemory(-1, -tile.dataSize);
+}
+
+void StreamingNavMesh::enforceBudget() {
+    if (m_budgetBytes <= 0) {
+        return;
+    }
+
+    int i = m_lruTail;
+    while (i != -1 && m_residentBytes > m_budgetBytes) {
+        const int prev = m_tiles[i].prev;
+        if (m_tiles[i].pinCount == 0 && m_tiles[i].lastTouch != m_touch) {
+            evictTile(i);
+        }
+        i = prev;
+    }
+}
+
+void StreamingNavMesh::linkFront(int index) {
+    TileEntry& tile = m_tiles[index];
+    tile.prev = -1;
+    tile.next = m_lruHead;
+    if (m_lruHead != -1) {
+        m_tiles[m_lruHead].prev = index;
+    } else {
+        m_lruTail = index;
+    }
+    m_lruHead = index;
+}
+
+void StreamingNavMesh::unlink(int index) {
+    TileEntry& tile = m_tiles[index];
+    if (tile.prev != -1) {
+        m_tiles[tile.prev].next = tile.next;
+    } else {
+        m_lruHead = tile.next;
+    }
+    if (tile.next != -1) {
+        m_tiles[tile.next].prev = tile.prev;
+    } else {
+        m_lruTail = tile.prev;
+    }
+    tile.prev = tile.next = -1;
+}
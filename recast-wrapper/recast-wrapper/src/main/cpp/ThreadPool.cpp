@@ -0,0 +1,92 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadCount) :
+    m_fn(0),
+    m_count(0),
+    m_next(0),
+    m_busy(0),
+    m_generation(0),
+    m_stop(false)
+{
+    for (int i = 1; i < resolveThreadCount(threadCount); ++i) {
+        m_threads.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (size_t i = 0; i < m_threads.size(); ++i) {
+        m_threads[i].join();
+    }
+}
+
+int ThreadPool::defaultThreadCount() {
+    const unsigned int count = std::thread::hardware_concurrency();
+    return count ? (int) count : 1;
+}
+
+int ThreadPool::resolveThreadCount(int threadCount) {
+    return threadCount > 0 ? threadCount : defaultThreadCount();
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int, int)>& fn) {
+    if (count <= 0) {
+        return;
+    }
+
+    if (m_threads.empty() || count == 1) {
+        for (int i = 0; i < count; ++i) {
+            fn(i, 0);
+        }
+        return;
+    }
+
+    // Only one job runs at a time; concurrent callers queue up here.
+    std::lock_guard<std::mutex> callLock(m_callMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fn = &fn;
+        m_count = count;
+        m_next = 0;
+        m_busy = (int) m_threads.size();
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    runJob(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_busy == 0; });
+    m_fn = 0;
+}
+
+void ThreadPool::workerLoop(int worker) {
+    unsigned int seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this, seenGeneration] { return m_stop || m_generation != seenGeneration; });
+            if (m_stop) {
+                return;
+            }
+            seenGeneration = m_generation;
+        }
+
+        runJob(worker);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busy == 0) {
+            m_done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runJob(int worker) {
+    for (int i = m_next++; i < m_count; i = m_next++) {
+        (*m_fn)(i, worker);
+    }
+}
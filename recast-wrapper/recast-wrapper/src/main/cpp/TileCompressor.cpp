@@ -0,0 +1,168 @@
+#include "TileCompressor.h"
+
+#include <string.h>
+
+static const int MIN_MATCH = 4;
+static const int MAX_OFFSET = 65535;
+static const int HASH_BITS = 12;
+// Lengths of 15 and above spill into extra bytes.
+static const int RUN_MASK = 15;
+
+static unsigned int read32(const unsigned char* p) {
+    unsigned int value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static unsigned int hash4(unsigned int value) {
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static unsigned char* writeLength(unsigned char* op, int length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (unsigned char) length;
+    return op;
+}
+
+static unsigned char* writeLiterals(unsigned char* op, const unsigned char* literals, int literalLength,
+                                    int matchToken) {
+    *op++ = (unsigned char) (((literalLength < RUN_MASK ? literalLength : RUN_MASK) << 4) | matchToken);
+    if (literalLength >= RUN_MASK) {
+        op = writeLength(op, literalLength - RUN_MASK);
+    }
+    if (literalLength > 0) {
+        memcpy(op, literals, literalLength);
+    }
+    return op + literalLength;
+}
+
+int tileCompressBound(int srcSize) {
+    return srcSize + srcSize / 255 + 16;
+}
+
+int tileCompress(const unsigned char* src, int srcSize, unsigned char* dst, int dstCapacity) {
+    if (srcSize < 0 || dstCapacity < tileCompressBound(srcSize)) {
+        return 0;
+    }
+
+    // Positions + 1, so that 0 means empty.
+    int table[1 << HASH_BITS];
+    memset(table, 0, sizeof(table));
+
+    const unsigned char* ip = src;
+    const unsigned char* anchor = src;
+    const unsigned char* const end = src + srcSize;
+    unsigned char* op = dst;
+
+    while (end - ip >= MIN_MATCH) {
+        const unsigned int sequence = read32(ip);
+        int& slot = table[hash4(sequence)];
+        const int candidate = slot - 1;
+        slot = (int) (ip - src) + 1;
+
+        if (candidate < 0 || (ip - src) - candidate > MAX_OFFSET || read32(src + candidate) != sequence) {
+            // Skip faster through data that does not compress.
+            ip += 1 + ((ip - anchor) >> 6);
+            continue;
+        }
+
+        const unsigned char* match = src + candidate;
+        const unsigned char* matchEnd = ip + MIN_MATCH;
+        const unsigned char* reference = match + MIN_MATCH;
+        while (matchEnd < end && *matchEnd == *reference) {
+            matchEnd++;
+            reference++;
+        }
+
+        const int matchLength = (int) (matchEnd - ip) - MIN_MATCH;
+        op = writeLiterals(op, anchor, (int) (ip - anchor), matchLength < RUN_MASK ? matchLength : RUN_MASK);
+        const int offset = (int) (ip - match);
+        *op++ = (unsigned char) (offset & 0xff);
+        *op++ = (unsigned char) (offset >> 8);
+        if (matchLength >= RUN_MASK) {
+            op = writeLength(op, matchLength - RUN_MASK);
+        }
+
+        ip = matchEnd;
+        anchor = ip;
+    }
+
+    // The last sequence is literals only; the end of the input marks it.
+    op = writeLiterals(op, anchor, (int) (end - anchor), 0);
+    return (int) (op - dst);
+}
+
+static bool readLength(const unsigned char*& ip, const unsigned char* end, int limit, int& length) {
+    unsigned char byte;
+    do {
+        if (ip >= end) {
+            return false;
+        }
+        byte = *ip++;
+        length += byte;
+        if (length > limit) {
+            return false;
+        }
+    } while (byte == 255);
+    return true;
+}
+
+int tileDecompress(const unsigned char* src, int srcSize, unsigned char* dst, int dstCapacity) {
+    const unsigned char* ip = src;
+    const unsigned char* const end = src + srcSize;
+    unsigned char* op = dst;
+    unsigned char* const outEnd = dst + dstCapacity;
+
+    while (ip < end) {
+        const unsigned char token = *ip++;
+
+        int literalLength = token >> 4;
+        if (literalLength == RUN_MASK && !readLength(ip, end, srcSize, literalLength)) {
+            return -1;
+        }
+        if (literalLength > end - ip || literalLength > outEnd - op) {
+            return -1;
+        }
+        memcpy(op, ip, literalLength);
+        op += literalLength;
+        ip += literalLength;
+
+        if (ip == end) {
+            break;
+        }
+
+        if (end - ip < 2) {
+            return -1;
+        }
+        const int offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op - dst) {
+            return -1;
+        }
+
+        int matchLength = token & RUN_MASK;
+        if (matchLength == RUN_MASK && !readLength(ip, end, dstCapacity, matchLength)) {
+            return -1;
+        }
+        matchLength += MIN_MATCH;
+        if (matchLength > outEnd - op) {
+            return -1;
+        }
+
+        const unsigned char* match = op - offset;
+        if (offset >= matchLength) {
+            memcpy(op, match, matchLength);
+        } else {
+            // Overlapping references repeat the last offset bytes.
+            for (int i = 0; i < matchLength; ++i) {
+                op[i] = match[i];
+            }
+        }
+        op += matchLength;
+    }
+
+    return (int) (op - dst);
+}
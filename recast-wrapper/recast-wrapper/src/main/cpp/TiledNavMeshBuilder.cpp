@@ -0,0 +1,211 @@
+#include "TiledNavMeshBuilder.h"
+#include "ThreadPool.h"
+#include "wrapper.h"
+
+#include <vector>
+
+#include "DetourCommon.h"
+
+void calcTileGridSize(const rcConfig& config, const InputGeom* geom, int* tileWidth, int* tileHeight) {
+    int gridWidth = 0;
+    int gridHeight = 0;
+    rcCalcGridSize(geom->getNavMeshBoundsMin(), geom->getNavMeshBoundsMax(), config.cs, &gridWidth, &gridHeight);
+    *tileWidth = (gridWidth + config.tileSize - 1) / config.tileSize;
+    *tileHeight = (gridHeight + config.tileSize - 1) / config.tileSize;
+}
+
+void calcTileConfig(const rcConfig& config, const InputGeom* geom, int tx, int ty, rcConfig& tileConfig) {
+    const float* bmin = geom->getNavMeshBoundsMin();
+    const float* bmax = geom->getNavMeshBoundsMax();
+    const float tcs = config.tileSize * config.cs;
+
+    tileConfig = config;
+    tileConfig.width = config.tileSize + config.borderSize * 2;
+    tileConfig.height = config.tileSize + config.borderSize * 2;
+
+    tileConfig.bmin[0] = bmin[0] + tx * tcs;
+    tileConfig.bmin[1] = bmin[1];
+    tileConfig.bmin[2] = bmin[2] + ty * tcs;
+    tileConfig.bmax[0] = bmin[0] + (tx + 1) * tcs;
+    tileConfig.bmax[1] = bmax[1];
+    tileConfig.bmax[2] = bmin[2] + (ty + 1) * tcs;
+
+    // Expand the heightfield bounding box by border size to find the extents of geometry we need to build this tile.
+    tileConfig.bmin[0] -= config.borderSize * config.cs;
+    tileConfig.bmin[2] -= config.borderSize * config.cs;
+    tileConfig.bmax[0] += config.borderSize * config.cs;
+    tileConfig.bmax[2] += config.borderSize * config.cs;
+}
+
+static bool tileHasGeometry(const rcConfig& tileConfig, const InputGeom* geom) {
+    float tbmin[2], tbmax[2];
+    tbmin[0] = tileConfig.bmin[0];
+    tbmin[1] = tileConfig.bmin[2];
+    tbmax[0] = tileConfig.bmax[0];
+    tbmax[1] = tileConfig.bmax[2];
+    int cid;
+    return rcGetChunksOverlappingRect(geom->getChunkyMesh(), tbmin, tbmax, &cid, 1) > 0;
+}
+
+bool buildTileNavMeshData(rcContext* ctx, const rcConfig& config, InputGeom* geom, int tx, int ty,
+                          const TileAgentSettings& agent, unsigned char** navData, int* navDataSize) {
+    *navData = 0;
+    *navDataSize = 0;
+
+    rcConfig tileConfig;
+    calcTileConfig(config, geom, tx, ty, tileConfig);
+
+    if (!tileHasGeometry(tileConfig, geom)) {
+        return true;
+    }
+
+    rcCompactHeightfield* chf = 0;
+    rcContourSet* cset = 0;
+    rcPolyMesh* pmesh = 0;
+    rcPolyMeshDetail* dmesh = 0;
+    NavMeshDataResult* data = 0;
+    bool ok = false;
+    BuildTimerSnapshot since;
+    NavMeshMetrics::snapshotBuildTimers(ctx, &since);
+
+    // Tiles are already built in parallel, and each is far too small to be worth splitting further.
+    chf = compact_heightfield_create_threaded(ctx, &tileConfig, geom, 1);
+    if (!chf) {
+        goto cleanup;
+    }
+
+    cset = rcAllocContourSet();
+    if (!cset) {
+        ctx->log(RC_LOG_ERROR, "buildTile: Out of memory 'cset'.");
+        goto cleanup;
+    }
+    if (!rcBuildContours(ctx, *chf, tileConfig.maxSimplificationError, tileConfig.maxEdgeLen, *cset)) {
+        ctx->log(RC_LOG_ERROR, "buildTile: Could not create contours.");
+        goto cleanup;
+    }
+    if (cset->nconts == 0) {
+        // Nothing walkable in this tile.
+        ok = true;
+        goto cleanup;
+    }
+
+    pmesh = rcAllocPolyMesh();
+    if (!pmesh) {
+        ctx->log(RC_LOG_ERROR, "buildTile: Out of memory 'pmesh'.");
+        goto cleanup;
+    }
+    if (!rcBuildPolyMesh(ctx, *cset, tileConfig.maxVertsPerPoly, *pmesh)) {
+        ctx->log(RC_LOG_ERROR, "buildTile: Could not triangulate contours.");
+        goto cleanup;
+    }
+    NavMeshMetrics::recordBuildTimers(ctx, BUILD_STAGE_CONTOURS, BUILD_STAGE_POLYMESH, since);
+    if (pmesh->npolys == 0) {
+        ok = true;
+        goto cleanup;
+    }
+
+    dmesh = polymesh_detail_create(ctx, &tileConfig, pmesh, chf);
+    if (!dmesh) {
+        goto cleanup;
+    }
+
+    data = navmesh_data_create(ctx, &tileConfig, dmesh, pmesh, geom, tx, ty,
+                               agent.agentHeight, agent.agentRadius, agent.agentMaxClimb);
+    if (!data || !data->data) {
+        ctx->log(RC_LOG_ERROR, "buildTile: Could not create Detour data for tile (%d, %d).", tx, ty);
+        goto cleanup;
+    }
+
+    *navData = data->data;
+    *navDataSize = data->size;
+    ok = true;
+
+cleanup:
+    delete data;
+    rcFreePolyMeshDetail(dmesh);
+    rcFreePolyMesh(pmesh);
+    rcFreeContourSet(cset);
+    rcFreeCompactHeightfield(chf);
+    return ok;
+}
+
+struct TileBuildResult {
+    unsigned char* data;
+    int size;
+    bool ok;
+};
+
+dtNavMesh* buildTiledNavMesh(rcContext* ctx, const rcConfig& config, InputGeom* geom,
+                             const TileAgentSettings& agent, int threadCount) {
+    if (!geom || !geom->getMesh()) {
+        ctx->log(RC_LOG_ERROR, "buildTiledNavigation: No vertices and triangles.");
+        return 0;
+    }
+    if (config.tileSize <= 0) {
+        ctx->log(RC_LOG_ERROR, "buildTiledNavigation: Invalid tile size %d.", config.tileSize);
+        return 0;
+    }
+
+    int tw = 0;
+    int th = 0;
+    calcTileGridSize(config, geom, &tw, &th);
+    const int tileCount = tw * th;
+
+    dtNavMeshParams params;
+    rcVcopy(params.orig, geom->getNavMeshBoundsMin());
+    params.tileWidth = config.tileSize * config.cs;
+    params.tileHeight = config.tileSize * config.cs;
+    params.maxTiles = tileCount;
+    params.maxPolys = 1 << (22 - rcMin((int) dtIlog2(dtNextPow2(tileCount)), 14));
+
+    dtNavMesh* navmesh = dtAllocNavMesh();
+    if (!navmesh) {
+        ctx->log(RC_LOG_ERROR, "buildTiledNavigation: Could not allocate navmesh.");
+        return 0;
+    }
+    if (dtStatusFailed(navmesh->init(&params))) {
+        ctx->log(RC_LOG_ERROR, "buildTiledNavigation: Could not init navmesh.");
+        dtFreeNavMesh(navmesh);
+        return 0;
+    }
+
+    ctx->startTimer(RC_TIMER_TOTAL);
+
+    ThreadPool pool(rcMin(ThreadPool::resolveThreadCount(threadCount), tileCount));
+
+    // rcContext is not thread safe, so every worker logs and times through its own.
+    std::vector<IoRcContext> contexts(pool.getThreadCount());
+    std::vector<TileBuildResult> results(tileCount);
+
+    pool.parallelFor(tileCount, [&](int i, int worker) {
+        TileBuildResult& result = results[i];
+        result.ok = buildTileNavMeshData(&contexts[worker], config, geom, i % tw, i / tw, agent,
+                                         &result.data, &result.size);
+    });
+
+    // dtNavMesh itself is not thread safe, tiles are added in a fixed order once they are all built.
+    int failed = 0;
+    for (int i = 0; i < tileCount; ++i) {
+        TileBuildResult& result = results[i];
+        if (!result.ok) {
+            failed++;
+            continue;
+        }
+        if (!result.data) {
+            continue;
+        }
+        if (dtStatusFailed(navmesh->addTile(result.data, result.size, DT_TILE_FREE_DATA, 0, 0))) {
+            ctx->log(RC_LOG_ERROR, "buildTiledNavigation: Could not add tile (%d, %d).", i % tw, i / tw);
+            dtFree(result.data);
+            failed++;
+        }
+    }
+
+    ctx->stopTimer(RC_TIMER_TOTAL);
+
+    if (failed) {
+        ctx->log(RC_LOG_WARNING, "buildTiledNavigation: %d of %d tiles failed to build.", failed, tileCount);
+    }
+
+    return navmesh;
+}
@@ -1,5 +1,7 @@
 #include "wrapper.h"
 #include "ChunkyTriMesh.h"
+#include "DetourNode.h"
+#include "HeightfieldRasterizer.h"
 #include <cstring>
 
 rcContext* rcContext_create() {
@@ -34,26 +36,30 @@ void rcConfig_calc_grid_size(rcConfig* config, InputGeom* geom) {
 }
 
 rcCompactHeightfield* compact_heightfield_create(rcContext* context, rcConfig* config, InputGeom* geom) {
+	return compact_heightfield_create_threaded(context, config, geom, 0);
+}
+
+rcCompactHeightfield* compact_heightfield_create_threaded(rcContext* context, rcConfig* config, InputGeom* geom, int threads) {
     rcHeightfield* heightfield = 0;
-	unsigned char* triareas = 0;
 	rcCompactHeightfield* m_chf = 0;
-	const float* verts = 0;
-	int nverts;
-	int ntris;
 	const rcChunkyTriMesh* chunkyMesh = 0;
 	float tbmin[2], tbmax[2];
-	int cid[512];// TODO: Make grow when returning too many items.
+	std::vector<int> cid;
 	int ncid;
 
-	int m_tileTriCount = 0;
 	const bool m_filterLowHangingObstacles = false;
 	const bool m_filterLedgeSpans = false;
 	const bool m_filterWalkableLowHeightSpans = false;
 
 	const ConvexVolume* vols;
+	std::vector<int> volumes;
 
     int partitionType = SAMPLE_PARTITION_WATERSHED;
 
+	// Callers such as buildTileNavMeshData keep reading the context's timers, so they are not reset here.
+	BuildTimerSnapshot since;
+	NavMeshMetrics::snapshotBuildTimers(context, &since);
+
 	if (!geom) {
 		context->log(RC_LOG_ERROR, "buildNavigation: InputGeometry is null.");
 		goto handle_error;
@@ -72,51 +78,22 @@ rcCompactHeightfield* compact_heightfield_create(rcContext* context, rcConfig* c
 		goto handle_error;
 	}
 
-    verts = geom->getMesh()->getVerts();
-	nverts = geom->getMesh()->getVertCount();
-	ntris = geom->getMesh()->getTriCount();
 	chunkyMesh = geom->getChunkyMesh();
 
-    // Allocate array that can hold triangle flags.
-	// If you have multiple meshes you need to process, allocate
-	// and array which can hold the max number of triangles you need to process.
-	triareas = new unsigned char[chunkyMesh->maxTrisPerChunk];
-	if (!triareas)
-	{
-		context->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'm_triareas' (%d).", chunkyMesh->maxTrisPerChunk);
-		goto handle_error;
-	}
-	
 	tbmin[0] = config->bmin[0];
 	tbmin[1] = config->bmin[2];
 	tbmax[0] = config->bmax[0];
 	tbmax[1] = config->bmax[2];
-	ncid = rcGetChunksOverlappingRect(chunkyMesh, tbmin, tbmax, cid, 512);
+	ncid = rcGetChunksOverlappingRect(chunkyMesh, tbmin, tbmax, cid);
 	if (!ncid) {
 		context->log(RC_LOG_ERROR, "No chunks.", chunkyMesh->maxTrisPerChunk);
 		goto handle_error;
     }
 	
-	for (int i = 0; i < ncid; ++i)
-	{
-		const rcChunkyTriMeshNode& node = chunkyMesh->nodes[cid[i]];
-		const int* ctris = &chunkyMesh->tris[node.i*3];
-		const int nctris = node.n;
-		
-		m_tileTriCount += nctris;
-		
-		memset(triareas, 0, nctris*sizeof(unsigned char));
-		rcMarkWalkableTriangles(context, config->walkableSlopeAngle,
-								verts, nverts, ctris, nctris, triareas);
-		
-		if (!rcRasterizeTriangles(context, verts, nverts, ctris, triareas, nctris, *heightfield, config->walkableClimb)) {
-			goto handle_error;
-		}
+	if (!rasterizeChunks(context, *config, geom, &cid[0], ncid, *heightfield, threads)) {
+		goto handle_error;
 	}
 
-    delete [] triareas;
-    triareas = 0;
-
     if (m_filterLowHangingObstacles) {
 		rcFilterLowHangingWalkableObstacles(context, config->walkableClimb, *heightfield);
 	}
@@ -151,8 +128,12 @@ rcCompactHeightfield* compact_heightfield_create(rcContext* context, rcConfig* c
 
 	// (Optional) Mark areas.
 	vols = geom->getConvexVolumes();
-	for (int i  = 0; i < geom->getConvexVolumeCount(); ++i)
-		rcMarkConvexPolyArea(context, vols[i].verts, vols[i].nverts, vols[i].hmin, vols[i].hmax, (unsigned char)vols[i].area, *m_chf);
+	geom->queryConvexVolumes(config->bmin, config->bmax, volumes);
+	for (size_t i = 0; i < volumes.size(); ++i)
+	{
+		const ConvexVolume& vol = vols[volumes[i]];
+		rcMarkConvexPolyArea(context, vol.verts, vol.nverts, vol.hmin, vol.hmax, (unsigned char)vol.area, *m_chf);
+	}
 	
 	if (partitionType == SAMPLE_PARTITION_WATERSHED)
 	{
@@ -190,6 +171,7 @@ rcCompactHeightfield* compact_heightfield_create(rcContext* context, rcConfig* c
 		}
 	}
 
+	NavMeshMetrics::recordBuildTimers(context, BUILD_STAGE_RASTERIZE, BUILD_STAGE_REGIONS, since);
 	return m_chf;
 
 handle_error:
@@ -198,11 +180,6 @@ handle_error:
 		heightfield = 0;
 	}
 
-	if (triareas) {
-		delete triareas;
-		triareas = 0;
-	}
-
 	if (m_chf) {
 		rcFreeCompactHeightfield(m_chf);
 		m_chf = 0;
@@ -219,6 +196,9 @@ void compact_heightfield_delete(rcCompactHeightfield* chf) {
 rcPolyMesh* polymesh_create(rcContext* m_ctx, rcConfig* m_cfg, rcCompactHeightfield* m_chf) {
 	rcContourSet* m_cset = 0;
 	rcPolyMesh* m_pmesh = 0;
+	BuildTimerSnapshot since;
+
+	NavMeshMetrics::snapshotBuildTimers(m_ctx, &since);
 
     // Create contours.
 	m_cset = rcAllocContourSet();
@@ -253,6 +233,7 @@ rcPolyMesh* polymesh_create(rcContext* m_ctx, rcConfig* m_cfg, rcCompactHeightfi
 		goto handle_error;
 	}
 
+	NavMeshMetrics::recordBuildTimers(m_ctx, BUILD_STAGE_CONTOURS, BUILD_STAGE_POLYMESH, since);
 	return m_pmesh;
 
 handle_error:
@@ -274,6 +255,9 @@ void polymesh_delete(rcPolyMesh* polyMesh) {
 }
 
 rcPolyMeshDetail* polymesh_detail_create(rcContext* m_ctx, rcConfig* m_cfg, rcPolyMesh* m_pmesh, rcCompactHeightfield* m_chf) {
+	BuildTimerSnapshot since;
+	NavMeshMetrics::snapshotBuildTimers(m_ctx, &since);
+
 	// Build detail mesh.
 	rcPolyMeshDetail* m_dmesh = rcAllocPolyMeshDetail();
 
@@ -297,6 +281,7 @@ rcPolyMeshDetail* polymesh_detail_create(rcContext* m_ctx, rcConfig* m_cfg, rcPo
 		goto handle_error;
 	}
 
+	NavMeshMetrics::recordBuildTimers(m_ctx, BUILD_STAGE_DETAIL, BUILD_STAGE_DETAIL, since);
     return m_dmesh;
 
 handle_error:
@@ -360,13 +345,8 @@ NavMeshDataResult* navmesh_data_create(rcContext* context, rcConfig* m_cfg, rcPo
 		params.detailVertsCount = m_dmesh->nverts;
 		params.detailTris = m_dmesh->tris;
 		params.detailTriCount = m_dmesh->ntris;
-		params.offMeshConVerts = m_geom->getOffMeshConnectionVerts();
-		params.offMeshConRad = m_geom->getOffMeshConnectionRads();
-		params.offMeshConDir = m_geom->getOffMeshConnectionDirs();
-		params.offMeshConAreas = m_geom->getOffMeshConnectionAreas();
-		params.offMeshConFlags = m_geom->getOffMeshConnectionFlags();
-		params.offMeshConUserID = m_geom->getOffMeshConnectionId();
-		params.offMeshConCount = m_geom->getOffMeshConnectionCount();
+		OffMeshConnectionSet offMeshCons;
+		m_geom->gatherOffMeshConnections(m_pmesh->bmin, m_pmesh->bmax, offMeshCons, params);
 		params.walkableHeight = agentHeight;
 		params.walkableRadius = agentRadius;
 		params.walkableClimb = agentMaxClimb;
@@ -379,11 +359,13 @@ NavMeshDataResult* navmesh_data_create(rcContext* context, rcConfig* m_cfg, rcPo
 		params.ch = m_cfg->ch;
 		params.buildBvTree = true;
 		
+		const MetricsClock::time_point start = MetricsClock::now();
 		if (!dtCreateNavMeshData(&params, &navData, &navDataSize))
 		{
 			context->log(RC_LOG_ERROR, "Could not build Detour navmesh.");
 			return 0;
-		}		
+		}
+		NavMeshMetrics::recordBuildStage(BUILD_STAGE_DETOUR_DATA, start);
 	}
 
     NavMeshDataResult* result = new NavMeshDataResult();
@@ -412,15 +394,92 @@ dtNavMesh* navmesh_create(rcContext* context, NavMeshDataResult* navmesh_data) {
 		return 0;
 	}
 
+	NavMeshMetrics::addNavMeshTiles(navmesh, 1);
+	return navmesh;
+}
+
+dtNavMesh* navmesh_create_tiled(rcContext* context, rcConfig* config, InputGeom* geom, float agentHeight, float agentRadius, float agentMaxClimb, int threads) {
+	TileAgentSettings agent;
+	agent.agentHeight = agentHeight;
+	agent.agentRadius = agentRadius;
+	agent.agentMaxClimb = agentMaxClimb;
+	dtNavMesh* navmesh = buildTiledNavMesh(context, *config, geom, agent, threads);
+	NavMeshMetrics::addNavMeshTiles(navmesh, 1);
 	return navmesh;
 }
 
 dtNavMesh* navmesh_load_tiled_bin(const char* path) {
-	return Sample::loadAll(path);
+	dtNavMesh* navmesh = Sample::loadAll(path);
+	NavMeshMetrics::addNavMeshTiles(navmesh, 1);
+	return navmesh;
+}
+
+dtNavMesh* navmesh_load_tiled_bin_mapped(const char* path) {
+	dtNavMesh* navmesh = Sample::loadAllMapped(path);
+	NavMeshMetrics::addNavMeshTiles(navmesh, 1);
+	return navmesh;
+}
+
+bool navmesh_save_compressed(dtNavMesh* navmesh, const char* path) {
+	return Sample::saveCompressed(navmesh, path);
+}
+
+bool navmesh_save(dtNavMesh* navmesh, const char* path) {
+	return saveNavMeshFile(navmesh, path);
+}
+
+dtNavMesh* navmesh_load(const char* path, int threads) {
+	dtNavMesh* navmesh = loadNavMeshFile(path, threads);
+	NavMeshMetrics::addNavMeshTiles(navmesh, 1);
+	return navmesh;
+}
+
+NavMeshFileReader* navmesh_file_open(const char* path) {
+	NavMeshFileReader* reader = new NavMeshFileReader();
+	if (!reader->open(path)) {
+		delete reader;
+		reader = 0;
+	}
+	return reader;
+}
+
+void navmesh_file_close(NavMeshFileReader* reader) {
+	delete reader;
+}
+
+int navmesh_file_get_tile_count(NavMeshFileReader* reader) {
+	return reader->getTileCount();
+}
+
+bool navmesh_file_get_tile_location(NavMeshFileReader* reader, int index, int* location) {
+	if (index < 0 || index >= reader->getTileCount()) {
+		return false;
+	}
+	const NavMeshFileTile& tile = reader->getTile(index);
+	location[0] = tile.x;
+	location[1] = tile.y;
+	location[2] = tile.layer;
+	return true;
+}
+
+int navmesh_file_find_tile(NavMeshFileReader* reader, int x, int y, int layer) {
+	return reader->findTile(x, y, layer);
+}
+
+int navmesh_file_read_tile(NavMeshFileReader* reader, int index, unsigned char* buffer, int maxSize) {
+	if (index < 0 || index >= reader->getTileCount()) {
+		return -1;
+	}
+	const int size = reader->getTile(index).dataSize;
+	if (buffer && maxSize >= size && !reader->readTile(index, buffer)) {
+		return -1;
+	}
+	return size;
 }
 
 void navmesh_delete(dtNavMesh* navmesh) {
-	dtFreeNavMesh(navmesh);
+	NavMeshMetrics::addNavMeshTiles(navmesh, -1);
+	Sample::freeNavMesh(navmesh);
 }
 
 dtNavMeshQuery* navmesh_query_create(dtNavMesh* navmesh) {
@@ -445,23 +504,47 @@ void navmesh_query_delete(dtNavMeshQuery* navQuery) {
 }
 
 PolyPointResult* navmesh_query_find_nearest_poly(dtNavMeshQuery* navQuery, float* point, float* half_extents) {
-	dtQueryFilter filter;
 	PolyPointResult *result = new PolyPointResult();
-	memcpy(result->point, IMPOSSIBLE_POINT, sizeof(IMPOSSIBLE_POINT));
-	result->status = navQuery->findNearestPoly(point, half_extents, &filter, &result->polyRef, result->point);
-	if (0 == memcmp(result->point, IMPOSSIBLE_POINT, sizeof(IMPOSSIBLE_POINT))) {
-		memset(result, 0, sizeof(PolyPointResult));  // reset everything back to 0 to avoid the caller seeing an IMPOSSIBLE POINT
-		result->status = DT_FAILURE | DT_INVALID_PARAM;
-	}
+	result->status = navmesh_query_find_nearest_poly_into(navQuery, point, half_extents, &result->polyRef, result->point);
 	return result;
 }
 
+dtStatus navmesh_query_find_nearest_poly_into(dtNavMeshQuery* navQuery, const float* point, const float* half_extents, dtPolyRef* polyRef, float* nearestPoint) {
+	dtQueryFilter filter;
+	const MetricsClock::time_point start = MetricsClock::now();
+	memcpy(nearestPoint, IMPOSSIBLE_POINT, sizeof(IMPOSSIBLE_POINT));
+	*polyRef = 0;
+	dtStatus status = navQuery->findNearestPoly(point, half_extents, &filter, polyRef, nearestPoint);
+	if (0 == memcmp(nearestPoint, IMPOSSIBLE_POINT, sizeof(IMPOSSIBLE_POINT))) {
+		// reset everything back to 0 to avoid the caller seeing an IMPOSSIBLE POINT
+		memset(nearestPoint, 0, sizeof(IMPOSSIBLE_POINT));
+		*polyRef = 0;
+		status = DT_FAILURE | DT_INVALID_PARAM;
+	}
+	NavMeshMetrics::recordQuery(QUERY_FIND_NEAREST_POLY, start, status, 0);
+	return status;
+}
+
 FindPathResult* navmesh_query_find_path(dtNavMeshQuery* navQuery, dtPolyRef startRef, dtPolyRef endRef, float* startPos, float* endPos, const dtQueryFilter* filter) {
    	FindPathResult* result = new FindPathResult();
+	const MetricsClock::time_point start = MetricsClock::now();
 	result->status = navQuery->findPath(startRef, endRef, startPos, endPos, filter, result->path, &result->pathCount, MAX_PATH_LEN);
+	NavMeshMetrics::recordQuery(QUERY_FIND_PATH, start, result->status, navQuery->getNodePool()->getNodeCount());
 	return result;
 }
 
+int navmesh_query_find_path_into(dtNavMeshQuery* navQuery, dtPolyRef startRef, dtPolyRef endRef, const float* startPos, const float* endPos, const dtQueryFilter* filter, dtPolyRef* path, int maxPath, dtStatus* status) {
+	dtQueryFilter defaultFilter;
+	int pathCount = 0;
+	const MetricsClock::time_point start = MetricsClock::now();
+	dtStatus result = navQuery->findPath(startRef, endRef, startPos, endPos, filter ? filter : &defaultFilter, path, &pathCount, maxPath);
+	NavMeshMetrics::recordQuery(QUERY_FIND_PATH, start, result, navQuery->getNodePool()->getNodeCount());
+	if (status) {
+		*status = result;
+	}
+	return dtStatusFailed(result) ? 0 : pathCount;
+}
+
 void find_path_result_delete(FindPathResult* findPathResult) {
 	delete findPathResult;
 }
@@ -476,17 +559,22 @@ static float frand()
 }
 
 PolyPointResult* navmesh_query_find_random_point(dtNavMeshQuery* navQuery) {
-    dtQueryFilter filter;
     PolyPointResult *result = new PolyPointResult();
+	result->status = navmesh_query_find_random_point_into(navQuery, &result->polyRef, result->point);
+    return result;
+}
+
+dtStatus navmesh_query_find_random_point_into(dtNavMeshQuery* navQuery, dtPolyRef* polyRef, float* point) {
+	dtQueryFilter filter;
 
 	if (!navQuery) {
-		result->status = DT_FAILURE;
-	}
-	else {
-		result->status = navQuery->findRandomPoint(&filter, frand, &result->polyRef, result->point);
+		return DT_FAILURE;
 	}
 
-    return result;
+	const MetricsClock::time_point start = MetricsClock::now();
+	dtStatus status = navQuery->findRandomPoint(&filter, frand, polyRef, point);
+	NavMeshMetrics::recordQuery(QUERY_FIND_RANDOM_POINT, start, status, 0);
+	return status;
 }
 
 dtQueryFilter* dtQueryFilter_create() {
@@ -505,6 +593,442 @@ void smooth_path_result_delete(SmoothPathResult* smoothPathResult) {
 	delete smoothPathResult;
 }
 
+int navmesh_query_get_smooth_path_into(const float* startPos, dtPolyRef startRef, const float* endPos, const dtPolyRef* path, int pathCount, const dtQueryFilter* filter, dtNavMesh* navMesh, dtNavMeshQuery* navQuery, float* smoothPath, int maxSmoothPath) {
+	dtQueryFilter defaultFilter;
+	int smoothPathCount = 0;
+	const MetricsClock::time_point start = MetricsClock::now();
+	calcSmoothPath(startPos, startRef, endPos, path, pathCount, filter ? *filter : defaultFilter,
+				   navMesh, *navQuery, smoothPath, smoothPathCount, maxSmoothPath);
+	NavMeshMetrics::recordQuery(QUERY_SMOOTH_PATH, start, smoothPathCount > 0 ? DT_SUCCESS : DT_FAILURE, 0);
+	return smoothPathCount;
+}
+
+int navmesh_query_get_smooth_path_mode_into(const float* startPos, dtPolyRef startRef, const float* endPos, const dtPolyRef* path, int pathCount, const dtQueryFilter* filter, dtNavMesh* navMesh, dtNavMeshQuery* navQuery, int mode, float sampleSpacing, float* smoothPath, int maxSmoothPath) {
+	if (mode != SMOOTH_PATH_SAMPLED && mode != SMOOTH_PATH_CORNERS) {
+		return navmesh_query_get_smooth_path_into(startPos, startRef, endPos, path, pathCount, filter, navMesh, navQuery, smoothPath, maxSmoothPath);
+	}
+
+	// The straight path is computed over the given corridor, so the filter is not needed.
+	int smoothPathCount = 0;
+	const MetricsClock::time_point start = MetricsClock::now();
+	calcStraightSmoothPath(startPos, startRef, endPos, path, pathCount, *navQuery, (SmoothPathMode) mode, sampleSpacing,
+						   smoothPath, smoothPathCount, maxSmoothPath);
+	NavMeshMetrics::recordQuery(QUERY_SMOOTH_PATH, start, smoothPathCount > 0 ? DT_SUCCESS : DT_FAILURE, 0);
+	return smoothPathCount;
+}
+
+// Sliced searches hold on to their filter between calls, so the default one has to outlive any single call.
+static const dtQueryFilter* defaultSlicedFilter() {
+	static const dtQueryFilter filter;
+	return &filter;
+}
+
+dtStatus navmesh_query_init_sliced_find_path(dtNavMeshQuery* navQuery, dtPolyRef startRef, dtPolyRef endRef, const float* startPos, const float* endPos, const dtQueryFilter* filter, unsigned int options) {
+	return navQuery->initSlicedFindPath(startRef, endRef, startPos, endPos, filter ? filter : defaultSlicedFilter(), options);
+}
+
+dtStatus navmesh_query_update_sliced_find_path(dtNavMeshQuery* navQuery, int maxIter, int* doneIters) {
+	return navQuery->updateSlicedFindPath(maxIter, doneIters);
+}
+
+int navmesh_query_finalize_sliced_find_path(dtNavMeshQuery* navQuery, dtPolyRef* path, int maxPath, dtStatus* status) {
+	int pathCount = 0;
+	dtStatus result = navQuery->finalizeSlicedFindPath(path, &pathCount, maxPath);
+	if (status) {
+		*status = result;
+	}
+	return dtStatusFailed(result) ? 0 : pathCount;
+}
+
+int navmesh_query_finalize_sliced_find_path_partial(dtNavMeshQuery* navQuery, const dtPolyRef* existing, int existingSize, dtPolyRef* path, int maxPath, dtStatus* status) {
+	int pathCount = 0;
+	dtStatus result = navQuery->finalizeSlicedFindPathPartial(existing, existingSize, path, &pathCount, maxPath);
+	if (status) {
+		*status = result;
+	}
+	return dtStatusFailed(result) ? 0 : pathCount;
+}
+
+NavMeshQueryBatch* navmesh_query_batch_create(dtNavMesh* navmesh, int maxNodes, int threads) {
+	NavMeshQueryBatch* batch = new NavMeshQueryBatch();
+
+	if (!batch->init(navmesh, maxNodes, threads)) {
+		delete batch;
+		return 0;
+	}
+
+	return batch;
+}
+
+void navmesh_query_batch_delete(NavMeshQueryBatch* batch) {
+	delete batch;
+}
+
+int navmesh_query_batch_find_smooth_paths(NavMeshQueryBatch* batch, const float* startPositions, const float* endPositions, int count, const float* halfExtents, const dtQueryFilter* filter, BatchPathResult* results, float* smoothPaths, int maxSmoothPathLen) {
+	return batch->findSmoothPaths(startPositions, endPositions, count, halfExtents, filter, results, smoothPaths, maxSmoothPathLen);
+}
+
+NavMeshQueryPool* navmesh_query_pool_create(dtNavMesh* navmesh, int maxNodes, unsigned int seed) {
+	NavMeshQueryPool* pool = new NavMeshQueryPool();
+
+	if (!pool->init(navmesh, maxNodes, seed)) {
+		delete pool;
+		pool = 0;
+	}
+
+	return pool;
+}
+
+void navmesh_query_pool_delete(NavMeshQueryPool* pool) {
+	delete pool;
+}
+
+dtNavMeshQuery* navmesh_query_pool_get_query(NavMeshQueryPool* pool) {
+	return pool->getQuery();
+}
+
+void navmesh_query_pool_seed_thread(NavMeshQueryPool* pool, unsigned int seed) {
+	pool->seedThread(seed);
+}
+
+dtStatus navmesh_query_pool_find_random_point_into(NavMeshQueryPool* pool, const dtQueryFilter* filter, dtPolyRef* polyRef, float* point) {
+	dtQueryFilter defaultFilter;
+	return pool->findRandomPoint(filter ? filter : &defaultFilter, polyRef, point);
+}
+
+dtStatus navmesh_query_pool_find_random_point_around_circle_into(NavMeshQueryPool* pool, dtPolyRef startRef, const float* centerPos, float radius, const dtQueryFilter* filter, dtPolyRef* polyRef, float* point) {
+	dtQueryFilter defaultFilter;
+	return pool->findRandomPointAroundCircle(startRef, centerPos, radius, filter ? filter : &defaultFilter, polyRef, point);
+}
+
+int navmesh_query_pool_find_path_into(NavMeshQueryPool* pool, dtPolyRef startRef, dtPolyRef endRef, const float* startPos, const float* endPos, const dtQueryFilter* filter, dtPolyRef* path, int maxPath, dtStatus* status) {
+	dtNavMeshQuery* navQuery = pool->getQuery();
+	if (!navQuery) {
+		if (status) {
+			*status = DT_FAILURE | DT_OUT_OF_MEMORY;
+		}
+		return 0;
+	}
+	return navmesh_query_find_path_into(navQuery, startRef, endRef, startPos, endPos, filter, path, maxPath, status);
+}
+
+int navmesh_query_pool_get_thread_count(NavMeshQueryPool* pool) {
+	return pool->getThreadCount();
+}
+
+RandomPointSampler* navmesh_random_sampler_create(dtNavMesh* navmesh, int includeFlags, int excludeFlags) {
+	dtQueryFilter filter;
+	filter.setIncludeFlags((unsigned short) includeFlags);
+	filter.setExcludeFlags((unsigned short) excludeFlags);
+
+	RandomPointSampler* sampler = new RandomPointSampler();
+
+	if (!sampler->init(navmesh, &filter)) {
+		delete sampler;
+		sampler = 0;
+	}
+
+	return sampler;
+}
+
+void navmesh_random_sampler_delete(RandomPointSampler* sampler) {
+	delete sampler;
+}
+
+bool navmesh_random_sampler_refresh(RandomPointSampler* sampler) {
+	return sampler->refresh();
+}
+
+int navmesh_random_sampler_sample_into(RandomPointSampler* sampler, unsigned long long seed, unsigned long long counter, int count, dtPolyRef* refs, float* points) {
+	return sampler->sample(seed, counter, count, refs, points);
+}
+
+int navmesh_random_sampler_get_poly_count(RandomPointSampler* sampler) {
+	return sampler->getPolyCount();
+}
+
+float navmesh_random_sampler_get_total_area(RandomPointSampler* sampler) {
+	return sampler->getTotalArea();
+}
+
+StreamingNavMesh* navmesh_stream_open(const char* path, long long budgetBytes) {
+	StreamingNavMesh* stream = new StreamingNavMesh();
+
+	if (!stream->init(path, budgetBytes)) {
+		delete stream;
+		stream = 0;
+	}
+
+	return stream;
+}
+
+void navmesh_stream_delete(StreamingNavMesh* stream) {
+	delete stream;
+}
+
+dtNavMesh* navmesh_stream_get_navmesh(StreamingNavMesh* stream) {
+	return stream->getNavMesh();
+}
+
+int navmesh_stream_touch(StreamingNavMesh* stream, const float* bmin, const float* bmax) {
+	return stream->touch(bmin, bmax);
+}
+
+int navmesh_stream_pin(StreamingNavMesh* stream, const float* bmin, const float* bmax) {
+	return stream->pin(bmin, bmax);
+}
+
+int navmesh_stream_unpin(StreamingNavMesh* stream, const float* bmin, const float* bmax) {
+	return stream->unpin(bmin, bmax);
+}
+
+void navmesh_stream_set_budget(StreamingNavMesh* stream, long long budgetBytes) {
+	stream->setBudget(budgetBytes);
+}
+
+void navmesh_stream_get_stats(StreamingNavMesh* stream, TileStreamStats* stats) {
+	stream->getStats(stats);
+}
+
+void navmesh_stream_reset_stats(StreamingNavMesh* stream) {
+	stream->resetCounters();
+}
+
+int navmesh_stream_find_path_into(StreamingNavMesh* stream, dtNavMeshQuery* navQuery, const float* startPos, const float* endPos, const float* halfExtents, const dtQueryFilter* filter, dtPolyRef* path, int maxPath, dtStatus* status) {
+	// Stream in everything between the two end points before searching. Corridors that leave this box
+	// end at the edge of the resident tiles and come back as DT_PARTIAL_RESULT.
+	float bmin[3], bmax[3];
+	dtVcopy(bmin, startPos);
+	dtVcopy(bmax, startPos);
+	dtVmin(bmin, endPos);
+	dtVmax(bmax, endPos);
+	dtVsub(bmin, bmin, halfExtents);
+	dtVadd(bmax, bmax, halfExtents);
+	stream->touch(bmin, bmax);
+
+	dtPolyRef startRef = 0, endRef = 0;
+	float nearest[3];
+	dtStatus result = navmesh_query_find_nearest_poly_into(navQuery, startPos, halfExtents, &startRef, nearest);
+	if (dtStatusSucceed(result)) {
+		result = navmesh_query_find_nearest_poly_into(navQuery, endPos, halfExtents, &endRef, nearest);
+	}
+	if (dtStatusFailed(result) || !startRef || !endRef) {
+		if (status) {
+			*status = DT_FAILURE | DT_INVALID_PARAM;
+		}
+		return 0;
+	}
+
+	return navmesh_query_find_path_into(navQuery, startRef, endRef, startPos, endPos, filter, path, maxPath, status);
+}
+
+PathCache* navmesh_path_cache_create(dtNavMesh* navmesh, int maxEntries) {
+	return new PathCache(navmesh, maxEntries);
+}
+
+void navmesh_path_cache_delete(PathCache* cache) {
+	delete cache;
+}
+
+int navmesh_path_cache_find_path_into(PathCache* cache, dtNavMeshQuery* navQuery, dtPolyRef startRef, dtPolyRef endRef, const float* startPos, const float* endPos, const dtQueryFilter* filter, dtPolyRef* path, int maxPath, dtStatus* status) {
+	return cache->findPath(navQuery, startRef, endRef, startPos, endPos, filter, path, maxPath, status);
+}
+
+int navmesh_path_cache_invalidate_region(PathCache* cache, const float* bmin, const float* bmax) {
+	return cache->invalidateRegion(bmin, bmax);
+}
+
+void navmesh_path_cache_clear(PathCache* cache) {
+	cache->clear();
+}
+
+void navmesh_path_cache_get_stats(PathCache* cache, PathCacheStats* stats) {
+	cache->getStats(stats);
+}
+
+void navmesh_path_cache_reset_stats(PathCache* cache) {
+	cache->resetCounters();
+}
+
+HierarchicalPathfinder* navmesh_hierarchy_create(dtNavMesh* navmesh, const dtQueryFilter* filter, int threads) {
+	HierarchicalPathfinder* hierarchy = new HierarchicalPathfinder();
+
+	if (!hierarchy->init(navmesh, filter, threads)) {
+		delete hierarchy;
+		hierarchy = 0;
+	}
+
+	return hierarchy;
+}
+
+void navmesh_hierarchy_delete(HierarchicalPathfinder* hierarchy) {
+	delete hierarchy;
+}
+
+int navmesh_hierarchy_find_path_into(HierarchicalPathfinder* hierarchy, dtNavMeshQuery* navQuery, dtPolyRef startRef, dtPolyRef endRef, const float* startPos, const float* endPos, dtPolyRef* path, int maxPath, dtStatus* status) {
+	return hierarchy->findPath(navQuery, startRef, endRef, startPos, endPos, path, maxPath, status);
+}
+
+int navmesh_hierarchy_find_waypoints_into(HierarchicalPathfinder* hierarchy, dtPolyRef startRef, dtPolyRef endRef, const float* startPos, const float* endPos, dtPolyRef* waypointRefs, float* waypointPositions, int maxWaypoints, dtStatus* status) {
+	return hierarchy->findWaypoints(startRef, endRef, startPos, endPos, waypointRefs, waypointPositions, maxWaypoints, status);
+}
+
+void navmesh_hierarchy_get_stats(HierarchicalPathfinder* hierarchy, HierarchicalGraphStats* stats) {
+	hierarchy->getStats(stats);
+}
+
+NavMeshRebuilder* navmesh_rebuilder_create(rcContext* context, dtNavMesh* navmesh, rcConfig* config, InputGeom* geom, float agentHeight, float agentRadius, float agentMaxClimb, int threads) {
+	TileAgentSettings agent;
+	agent.agentHeight = agentHeight;
+	agent.agentRadius = agentRadius;
+	agent.agentMaxClimb = agentMaxClimb;
+	NavMeshRebuilder* rebuilder = new NavMeshRebuilder();
+
+	if (!rebuilder->init(context, navmesh, *config, geom, agent, threads)) {
+		delete rebuilder;
+		rebuilder = 0;
+	}
+
+	return rebuilder;
+}
+
+void navmesh_rebuilder_delete(NavMeshRebuilder* rebuilder) {
+	delete rebuilder;
+}
+
+int navmesh_rebuilder_mark_dirty(NavMeshRebuilder* rebuilder, const float* bmin, const float* bmax) {
+	return rebuilder->markDirty(bmin, bmax);
+}
+
+int navmesh_rebuilder_add_convex_volume(NavMeshRebuilder* rebuilder, const float* verts, int nverts, float minh, float maxh, int area) {
+	return rebuilder->addConvexVolume(verts, nverts, minh, maxh, (unsigned char) area);
+}
+
+int navmesh_rebuilder_add_off_mesh_connection(NavMeshRebuilder* rebuilder, const float* spos, const float* epos, float radius, bool bidirectional, int area, int flags) {
+	return rebuilder->addOffMeshConnection(spos, epos, radius, bidirectional ? 1 : 0, (unsigned char) area, (unsigned short) flags);
+}
+
+int navmesh_rebuilder_apply(NavMeshRebuilder* rebuilder, float* bmin, float* bmax) {
+	return rebuilder->applyBuiltTiles(bmin, bmax);
+}
+
+void navmesh_rebuilder_wait(NavMeshRebuilder* rebuilder) {
+	rebuilder->wait();
+}
+
+void navmesh_rebuilder_get_stats(NavMeshRebuilder* rebuilder, TileRebuildStats* stats) {
+	rebuilder->getStats(stats);
+}
+
+NavMeshTileCache* navmesh_tile_cache_create(rcContext* context, rcConfig* config, InputGeom* geom, float agentHeight, float agentRadius, float agentMaxClimb, int maxObstacles, int threads) {
+	TileAgentSettings agent;
+	agent.agentHeight = agentHeight;
+	agent.agentRadius = agentRadius;
+	agent.agentMaxClimb = agentMaxClimb;
+	NavMeshTileCache* cache = new NavMeshTileCache();
+
+	if (!cache->init(context, *config, geom, agent, maxObstacles, threads)) {
+		delete cache;
+		cache = 0;
+	}
+
+	return cache;
+}
+
+void navmesh_tile_cache_delete(NavMeshTileCache* cache) {
+	delete cache;
+}
+
+dtNavMesh* navmesh_tile_cache_get_navmesh(NavMeshTileCache* cache) {
+	return cache->getNavMesh();
+}
+
+unsigned int navmesh_tile_cache_add_cylinder_obstacle(NavMeshTileCache* cache, const float* pos, float radius, float height) {
+	return cache->addCylinderObstacle(pos, radius, height);
+}
+
+unsigned int navmesh_tile_cache_add_box_obstacle(NavMeshTileCache* cache, const float* bmin, const float* bmax) {
+	return cache->addBoxObstacle(bmin, bmax);
+}
+
+unsigned int navmesh_tile_cache_add_oriented_box_obstacle(NavMeshTileCache* cache, const float* center, const float* halfExtents, float yRadians) {
+	return cache->addOrientedBoxObstacle(center, halfExtents, yRadians);
+}
+
+bool navmesh_tile_cache_remove_obstacle(NavMeshTileCache* cache, unsigned int ref) {
+	return cache->removeObstacle(ref);
+}
+
+bool navmesh_tile_cache_update(NavMeshTileCache* cache, int budgetMicros) {
+	return cache->update(budgetMicros);
+}
+
+void navmesh_tile_cache_get_stats(NavMeshTileCache* cache, TileCacheStats* stats) {
+	cache->getStats(stats);
+}
+
+NavMeshCrowd* crowd_create(dtNavMesh* navmesh, int maxAgents, float maxAgentRadius) {
+	NavMeshCrowd* crowd = new NavMeshCrowd();
+
+	if (!crowd->init(navmesh, maxAgents, maxAgentRadius)) {
+		delete crowd;
+		crowd = 0;
+	}
+
+	return crowd;
+}
+
+void crowd_delete(NavMeshCrowd* crowd) {
+	delete crowd;
+}
+
+void crowd_get_default_agent_config(CrowdAgentConfig* config) {
+	NavMeshCrowd::getDefaultAgentConfig(config);
+}
+
+int crowd_add_agent(NavMeshCrowd* crowd, const float* pos, const CrowdAgentConfig* config) {
+	return crowd->addAgent(pos, config);
+}
+
+void crowd_remove_agent(NavMeshCrowd* crowd, int index) {
+	crowd->removeAgent(index);
+}
+
+bool crowd_set_target(NavMeshCrowd* crowd, int index, const float* pos) {
+	return crowd->setTarget(index, pos);
+}
+
+bool crowd_reset_target(NavMeshCrowd* crowd, int index) {
+	return crowd->resetTarget(index);
+}
+
+int crowd_update(NavMeshCrowd* crowd, float dt, float* states, int maxStates) {
+	return crowd->update(dt, states, maxStates);
+}
+
+int crowd_get_active_agent_count(NavMeshCrowd* crowd) {
+	return crowd->getActiveAgentCount();
+}
+
+int navmesh_metrics_write_prometheus(char* buffer, int maxLength) {
+	std::string text;
+	NavMeshMetrics::writePrometheus(text);
+	if (buffer && maxLength > 0) {
+		const int length = dtMin((int) text.size(), maxLength - 1);
+		memcpy(buffer, text.data(), length);
+		buffer[length] = 0;
+	}
+	return (int) text.size();
+}
+
+void navmesh_metrics_reset() {
+	NavMeshMetrics::reset();
+}
+
+bool build_allocator_install() {
+	return installBuildAllocator();
+}
+
 bool dtStatus_failed(dtStatus status) {
 	return dtStatusFailed(status);
 }
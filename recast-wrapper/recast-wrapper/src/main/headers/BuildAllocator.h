@@ -0,0 +1,27 @@
+//
+//  BuildAllocator.h
+//
+
+#ifndef BuildAllocator_h
+#define BuildAllocator_h
+
+// Allocators for rcAlloc and dtAlloc that suit navmesh builds running on several threads.
+//
+// Temporary allocations (RC_ALLOC_TEMP, DT_ALLOC_TEMP) are bumped out of an arena owned by the calling
+// thread. Freeing them costs a counter decrement, and the arena rewinds to its start whenever none of its
+// allocations are live, which Recast guarantees at least once per tile since it frees its temporaries
+// before each build step returns. An arena that overflowed grows to the size it needed on its next rewind,
+// so after the first few tiles a thread builds without touching the heap for temporaries. Arenas of threads
+// that exit are kept for the next thread pool.
+//
+// Permanent allocations come from size classes of up to 64 KiB, cached per thread and shared through a
+// bounded pool, so the tile data built on a worker and freed on the query thread goes back to a pool rather
+// than to a contended malloc. Larger blocks go straight to malloc.
+//
+// The allocators replace the defaults for the whole process and cannot free blocks of the default allocator,
+// or the other way round. Returns false without installing anything if they were installed before or if
+// anything was already allocated through the defaults. Nothing may allocate through rcAlloc or dtAlloc while
+// the call runs, and no other allocators may be installed afterwards.
+bool installBuildAllocator();
+
+#endif /* BuildAllocator_h */
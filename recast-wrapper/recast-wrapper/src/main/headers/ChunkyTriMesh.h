@@ -19,6 +19,8 @@
 #ifndef CHUNKYTRIMESH_H
 #define CHUNKYTRIMESH_H
 
+#include <vector>
+
 struct rcChunkyTriMeshNode
 {
 	float bmin[2];
@@ -27,16 +29,35 @@ struct rcChunkyTriMeshNode
 	int n;
 };
 
+/// Four children of a node of the wide tree, with their bounds as structure of arrays so that all four
+/// are tested together. A child >= 0 is another wide node, a negative child c is the leaf ~c of
+/// rcChunkyTriMesh::nodes. Only the first count slots are used.
+struct rcChunkyTriMeshWideNode
+{
+	float minX[4];
+	float minY[4];
+	float maxX[4];
+	float maxY[4];
+	int child[4];
+	int count;
+};
+
 struct rcChunkyTriMesh
 {
-	inline rcChunkyTriMesh() : nodes(0), nnodes(0), tris(0), ntris(0), maxTrisPerChunk(0) {};
-	inline ~rcChunkyTriMesh() { delete [] nodes; delete [] tris; }
+	inline rcChunkyTriMesh() : nodes(0), nnodes(0), tris(0), ntris(0), maxTrisPerChunk(0), ownsData(true),
+		wideNodes(0), nwideNodes(0) {};
+	inline ~rcChunkyTriMesh() { if (ownsData) { delete [] nodes; delete [] tris; } delete [] wideNodes; }
 
 	rcChunkyTriMeshNode* nodes;
 	int nnodes;
 	int* tris;
 	int ntris;
 	int maxTrisPerChunk;
+	/// False when nodes and tris point into memory owned elsewhere, such as a mapped geometry cache.
+	bool ownsData;
+	/// The same tree with four children per node, which is what the overlap queries walk. Always owned.
+	rcChunkyTriMeshWideNode* wideNodes;
+	int nwideNodes;
 
 private:
 	// Explicitly disabled copy constructor and copy assignment operator.
@@ -46,14 +67,25 @@ private:
 
 /// Creates partitioned triangle mesh (AABB tree),
 /// where each node contains at max trisPerChunk triangles.
+/// Subtrees are built on threadCount threads; values <= 0 use every core.
 bool rcCreateChunkyTriMesh(const float* verts, const int* tris, int ntris,
-						   int trisPerChunk, rcChunkyTriMesh* cm);
+						   int trisPerChunk, rcChunkyTriMesh* cm, int threadCount = 0);
 
-/// Returns the chunk indices which overlap the input rectable.
+/// Builds cm->wideNodes from cm->nodes. rcCreateChunkyTriMesh does this itself; it is only needed when
+/// the nodes are filled in some other way.
+bool rcBuildChunkyTriMeshWideNodes(rcChunkyTriMesh* cm);
+
+/// Returns the chunk indices which overlap the input rectable, at most maxIds of them.
 int rcGetChunksOverlappingRect(const rcChunkyTriMesh* cm, float bmin[2], float bmax[2], int* ids, const int maxIds);
 
-/// Returns the chunk indices which overlap the input segment.
+/// Returns the chunk indices which overlap the input segment, at most maxIds of them.
 int rcGetChunksOverlappingSegment(const rcChunkyTriMesh* cm, float p[2], float q[2], int* ids, const int maxIds);
 
+/// Replaces the contents of ids with all chunk indices which overlap the input rectangle.
+int rcGetChunksOverlappingRect(const rcChunkyTriMesh* cm, float bmin[2], float bmax[2], std::vector<int>& ids);
+
+/// Replaces the contents of ids with all chunk indices which overlap the input segment.
+int rcGetChunksOverlappingSegment(const rcChunkyTriMesh* cm, float p[2], float q[2], std::vector<int>& ids);
+
 
 #endif // CHUNKYTRIMESH_H
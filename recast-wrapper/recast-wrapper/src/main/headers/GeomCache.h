@@ -0,0 +1,71 @@
+//
+//  GeomCache.h
+//
+
+#ifndef GeomCache_h
+#define GeomCache_h
+
+#include <stddef.h>
+#include <string>
+
+#include "ChunkyTriMesh.h"
+
+class MappedFile;
+
+// Binary cache of everything InputGeom derives from an OBJ file: vertices, triangles, normals, bounds
+// and the chunky triangle tree. It lives next to the OBJ as "<obj>.geomcache" and is only used when it
+// was written from OBJ content with the same hash and with the same load options.
+static const int GEOMCACHE_MAGIC = 'G' << 24 | 'E' << 16 | 'O' << 8 | 'C';
+static const int GEOMCACHE_VERSION = 2;
+
+struct GeomCacheHeader {
+    int magic;
+    int version;
+    unsigned long long sourceHash;
+    unsigned long long sourceSize;
+    int invertYZ;
+    int trisPerChunk;
+    int vertCount;
+    int triCount;
+    int nodeCount;
+    int chunkTriCount;
+    int maxTrisPerChunk;
+    int reserved;
+    float bmin[3];
+    float bmax[3];
+    // Byte offsets of the sections from the start of the file, each 16 byte aligned.
+    unsigned long long vertsOffset;
+    unsigned long long trisOffset;
+    unsigned long long normalsOffset;
+    unsigned long long nodesOffset;
+    unsigned long long chunkTrisOffset;
+};
+
+// Views into a mapped cache file. Valid for as long as the mapping is.
+struct GeomCacheData {
+    const GeomCacheHeader* header;
+    float* verts;
+    int* tris;
+    float* normals;
+    rcChunkyTriMeshNode* nodes;
+    int* chunkTris;
+};
+
+// Hashes file content in fixed 1MB blocks across threadCount threads (<= 0 means every core). The
+// result does not depend on the number of threads.
+unsigned long long hashGeomSource(const unsigned char* data, size_t size, int threadCount);
+
+std::string getGeomCachePath(const std::string& objPath);
+
+// Maps the cache at path and checks it against the expected source hash and load options, and that every
+// index it holds stays within the sections it points into. On success the views in data point into file.
+bool readGeomCache(const std::string& path, unsigned long long sourceHash, unsigned long long sourceSize,
+                   bool invertYZ, int trisPerChunk, MappedFile& file, GeomCacheData& data);
+
+// Writes a cache through a temporary file that is renamed into place, so concurrent readers never see a
+// partially written cache.
+bool writeGeomCache(const std::string& path, const GeomCacheHeader& header, const float* verts,
+                    const int* tris, const float* normals, const rcChunkyTriMeshNode* nodes,
+                    const int* chunkTris);
+
+#endif /* GeomCache_h */
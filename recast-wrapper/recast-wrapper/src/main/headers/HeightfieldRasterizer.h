@@ -0,0 +1,27 @@
+//
+//  HeightfieldRasterizer.h
+//
+
+#ifndef HeightfieldRasterizer_h
+#define HeightfieldRasterizer_h
+
+#include "Recast.h"
+#include "InputGeom.h"
+
+// Marks the walkable triangles of the given chunks of geom's chunky mesh and rasterizes them into
+// heightfield, chunk by chunk in the order given, like the loop of the Recast demo.
+//
+// With more than one thread the heightfield is split into strips of rows. Every strip is rasterized
+// into a private heightfield by its own worker, which processes every chunk that may touch the strip in
+// the same order as the serial loop, and the strip's columns are then moved into heightfield. Each
+// column therefore receives exactly the same spans in the same order as in a serial build, and the
+// result is bit-identical to it. Triangles near strip borders are rasterized by both neighbours.
+// Heightfields too small to split, or too large for the strips' memory budget, use fewer strips or
+// none.
+//
+// threadCount <= 0 uses every core. ctx is only used from the calling thread, which times the whole
+// rasterization with RC_TIMER_RASTERIZE_TRIANGLES.
+bool rasterizeChunks(rcContext* ctx, const rcConfig& config, const InputGeom* geom, const int* chunkIds,
+                     int chunkCount, rcHeightfield& heightfield, int threadCount);
+
+#endif /* HeightfieldRasterizer_h */
@@ -0,0 +1,94 @@
+//
+//  HierarchicalPathfinder.h
+//
+
+#ifndef HierarchicalPathfinder_h
+#define HierarchicalPathfinder_h
+
+#include <vector>
+
+#include "DetourNavMesh.h"
+#include "DetourNavMeshQuery.h"
+
+extern "C"
+struct HierarchicalGraphStats {
+    int clusters;           // Tiles with at least one portal.
+    int portals;            // Nodes of the abstract graph.
+    int intraEdges;         // Cached portal to portal costs inside a tile.
+    int interEdges;         // Links between portals of neighbouring tiles.
+    long long memoryBytes;
+};
+
+// HPA*-style abstract graph over a tiled navmesh, for routes that are too long for one findPath call.
+//
+// Every tile is a cluster. Polys with a link into a neighbouring tile are the portals, and the cost
+// between every pair of portals of a tile is precomputed with a search restricted to that tile. Long
+// queries run A* over the portals first, which visits a handful of nodes per tile crossed, and then
+// refine the route one tile at a time with dtNavMeshQuery::findPath, so each refinement stays well
+// inside the query's node pool.
+//
+// Costs are precomputed for the filter the graph was built with, and the graph is a snapshot of the
+// navmesh it was built from: rebuild it after tiles are added, removed or replaced. Once built it is
+// read only and can be shared by any number of threads, each with its own dtNavMeshQuery.
+class HierarchicalPathfinder {
+public:
+    HierarchicalPathfinder();
+
+    // A null filter builds the graph for the default dtQueryFilter. threadCount <= 0 uses every core.
+    bool init(const dtNavMesh* navMesh, const dtQueryFilter* filter, int threadCount);
+
+    // Plans the route over the abstract graph and writes the polys at which it enters each tile, ending
+    // with endRef, to waypointRefs and their positions to waypointPositions. Callers can refine the route
+    // incrementally with findPath towards the next waypoint. When endRef cannot be reached the waypoints
+    // lead to the portal closest to endPos and the status has DT_PARTIAL_RESULT.
+    int findWaypoints(dtPolyRef startRef, dtPolyRef endRef, const float* startPos, const float* endPos,
+                      dtPolyRef* waypointRefs, float* waypointPositions, int maxWaypoints,
+                      dtStatus* status) const;
+
+    // Same contract as navmesh_query_find_path_into, with the filter fixed to the one the graph was built
+    // with. Routes that do not fit in maxPath come back truncated with DT_BUFFER_TOO_SMALL, so the first
+    // maxPath polys of a cross-map route are available without searching the rest of it.
+    int findPath(dtNavMeshQuery* navQuery, dtPolyRef startRef, dtPolyRef endRef, const float* startPos,
+                 const float* endPos, dtPolyRef* path, int maxPath, dtStatus* status) const;
+
+    void getStats(HierarchicalGraphStats* stats) const;
+
+private:
+    // Explicitly disabled copy constructor and copy assignment operator.
+    HierarchicalPathfinder(const HierarchicalPathfinder&);
+    HierarchicalPathfinder& operator=(const HierarchicalPathfinder&);
+
+    struct Portal {
+        dtPolyRef ref;
+        int cluster;
+        float pos[3];
+    };
+
+    struct Edge {
+        int to;
+        float cost;
+    };
+
+    struct Waypoint {
+        dtPolyRef ref;
+        float pos[3];
+    };
+
+    void findClusterCosts(const dtMeshTile* tile, int sourcePoly, const float* sourcePos,
+                          const std::vector<float>& centers, std::vector<float>& costs) const;
+    void findPortalCosts(dtPolyRef ref, const float* pos, std::vector<float>& portalCosts) const;
+    int findPortal(int cluster, dtPolyRef ref) const;
+    dtStatus planRoute(dtPolyRef startRef, dtPolyRef endRef, const float* startPos, const float* endPos,
+                       std::vector<Waypoint>& waypoints) const;
+
+    const dtNavMesh* m_navMesh;
+    dtQueryFilter m_filter;
+    std::vector<Portal> m_portals;          // Sorted by cluster, then ref.
+    std::vector<int> m_clusterPortals;      // Portals of cluster i are [m_clusterPortals[i], m_clusterPortals[i + 1]).
+    std::vector<int> m_portalEdges;         // Edges of portal i are [m_portalEdges[i], m_portalEdges[i + 1]).
+    std::vector<Edge> m_edges;
+    int m_clusterCount;
+    int m_intraEdgeCount;
+};
+
+#endif /* HierarchicalPathfinder_h */
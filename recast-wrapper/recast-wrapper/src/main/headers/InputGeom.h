@@ -19,8 +19,10 @@
 #ifndef INPUTGEOM_H
 #define INPUTGEOM_H
 
+#include <vector>
 #include "ChunkyTriMesh.h"
 #include "MeshLoaderObj.h"
+#include "MarkupGrid.h"
 
 static const int MAX_CONVEXVOL_PTS = 12;
 struct ConvexVolume
@@ -31,6 +33,18 @@ struct ConvexVolume
 	int area;
 };
 
+/// Off-mesh connections selected for one tile, laid out as dtNavMeshCreateParams expects them.
+struct OffMeshConnectionSet
+{
+	std::vector<float> verts;
+	std::vector<float> rads;
+	std::vector<unsigned char> dirs;
+	std::vector<unsigned char> areas;
+	std::vector<unsigned short> flags;
+	std::vector<unsigned int> ids;
+	std::vector<int> indices;
+};
+
 struct BuildSettings
 {
 	// Cell size in world units
@@ -73,30 +87,36 @@ class InputGeom
 {
 	rcChunkyTriMesh* m_chunkyMesh;
 	rcMeshLoaderObj* m_mesh;
+	class MappedFile* m_geomCache;
 	float m_meshBMin[3], m_meshBMax[3];
 	BuildSettings m_buildSettings;
 	bool m_hasBuildSettings;
 	
 	/// @name Off-Mesh connections.
+	/// Indexed on a grid by their start point, which decides the tile Detour stores them in.
 	///@{
-	static const int MAX_OFFMESH_CONNECTIONS = 256;
-	float m_offMeshConVerts[MAX_OFFMESH_CONNECTIONS*3*2];
-	float m_offMeshConRads[MAX_OFFMESH_CONNECTIONS];
-	unsigned char m_offMeshConDirs[MAX_OFFMESH_CONNECTIONS];
-	unsigned char m_offMeshConAreas[MAX_OFFMESH_CONNECTIONS];
-	unsigned short m_offMeshConFlags[MAX_OFFMESH_CONNECTIONS];
-	unsigned int m_offMeshConId[MAX_OFFMESH_CONNECTIONS];
-	int m_offMeshConCount;
+	std::vector<float> m_offMeshConVerts;
+	std::vector<float> m_offMeshConRads;
+	std::vector<unsigned char> m_offMeshConDirs;
+	std::vector<unsigned char> m_offMeshConAreas;
+	std::vector<unsigned short> m_offMeshConFlags;
+	std::vector<unsigned int> m_offMeshConId;
+	/// Deleting moves the last connection into the gap, so ids come from a counter rather than the count.
+	unsigned int m_offMeshConNextId;
+	MarkupGrid m_offMeshConGrid;
 	///@}
 
 	/// @name Convex Volumes.
+	/// Indexed on a grid by their bounds, kept in m_volumeBounds as bmin and bmax per volume.
 	///@{
-	static const int MAX_VOLUMES = 256;
-	ConvexVolume m_volumes[MAX_VOLUMES];
-	int m_volumeCount;
+	std::vector<ConvexVolume> m_volumes;
+	std::vector<float> m_volumeBounds;
+	MarkupGrid m_volumeGrid;
 	///@}
 	
 	bool loadMesh(class rcContext* ctx, const std::string& filepath, bool invertYZ);
+	bool loadCachedMesh(const std::string& filepath, unsigned long long sourceHash,
+						unsigned long long sourceSize, bool invertYZ);
 public:
 	InputGeom();
 	~InputGeom();
@@ -114,25 +134,32 @@ public:
 
 	/// @name Off-Mesh connections.
 	///@{
-	int getOffMeshConnectionCount() const { return m_offMeshConCount; }
-	const float* getOffMeshConnectionVerts() const { return m_offMeshConVerts; }
-	const float* getOffMeshConnectionRads() const { return m_offMeshConRads; }
-	const unsigned char* getOffMeshConnectionDirs() const { return m_offMeshConDirs; }
-	const unsigned char* getOffMeshConnectionAreas() const { return m_offMeshConAreas; }
-	const unsigned short* getOffMeshConnectionFlags() const { return m_offMeshConFlags; }
-	const unsigned int* getOffMeshConnectionId() const { return m_offMeshConId; }
+	int getOffMeshConnectionCount() const { return (int)m_offMeshConRads.size(); }
+	const float* getOffMeshConnectionVerts() const { return m_offMeshConVerts.empty() ? 0 : &m_offMeshConVerts[0]; }
+	const float* getOffMeshConnectionRads() const { return m_offMeshConRads.empty() ? 0 : &m_offMeshConRads[0]; }
+	const unsigned char* getOffMeshConnectionDirs() const { return m_offMeshConDirs.empty() ? 0 : &m_offMeshConDirs[0]; }
+	const unsigned char* getOffMeshConnectionAreas() const { return m_offMeshConAreas.empty() ? 0 : &m_offMeshConAreas[0]; }
+	const unsigned short* getOffMeshConnectionFlags() const { return m_offMeshConFlags.empty() ? 0 : &m_offMeshConFlags[0]; }
+	const unsigned int* getOffMeshConnectionId() const { return m_offMeshConId.empty() ? 0 : &m_offMeshConId[0]; }
 	void addOffMeshConnection(const float* spos, const float* epos, const float rad,
 							  unsigned char bidir, unsigned char area, unsigned short flags);
 	void deleteOffMeshConnection(int i);
+	/// Copies the connections that start inside the xz extent of [bmin, bmax] into storage and points
+	/// the off-mesh fields of params at it.
+	void gatherOffMeshConnections(const float* bmin, const float* bmax, OffMeshConnectionSet& storage,
+								  struct dtNavMeshCreateParams& params) const;
 	///@}
 
 	/// @name Box Volumes.
 	///@{
-	int getConvexVolumeCount() const { return m_volumeCount; }
-	const ConvexVolume* getConvexVolumes() const { return m_volumes; }
+	int getConvexVolumeCount() const { return (int)m_volumes.size(); }
+	const ConvexVolume* getConvexVolumes() const { return m_volumes.empty() ? 0 : &m_volumes[0]; }
 	void addConvexVolume(const float* verts, const int nverts,
 						 const float minh, const float maxh, unsigned char area);
 	void deleteConvexVolume(int i);
+	/// Fills volumes with the indices of the volumes whose xz bounds overlap [bmin, bmax], in
+	/// ascending order. Safe to call from several threads while no volume is added or deleted.
+	void queryConvexVolumes(const float* bmin, const float* bmax, std::vector<int>& volumes) const;
 	///@}
 	
 private:
@@ -0,0 +1,35 @@
+//
+//  MappedFile.h
+//
+
+#ifndef MappedFile_h
+#define MappedFile_h
+
+#include <stddef.h>
+
+// Copy-on-write memory mapping of a whole file. Pages are backed by the OS page cache, so processes
+// mapping the same file share them until one of them writes to a page, at which point only that page
+// is copied into the writing process.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // Maps path into memory, replacing any previous mapping. Returns false if the file cannot be
+    // opened or mapped, or is empty.
+    bool open(const char* path);
+    void close();
+
+    unsigned char* getData() const { return m_data; }
+    size_t getSize() const { return m_size; }
+
+private:
+    // Explicitly disabled copy constructor and copy assignment operator.
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    unsigned char* m_data;
+    size_t m_size;
+};
+
+#endif /* MappedFile_h */
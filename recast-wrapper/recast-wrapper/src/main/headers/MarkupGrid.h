@@ -0,0 +1,41 @@
+//
+//  MarkupGrid.h
+//
+
+#ifndef MarkupGrid_h
+#define MarkupGrid_h
+
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid over the xz plane that finds the items whose bounds overlap a box. InputGeom uses it to
+// pick the convex volumes and off-mesh connections of one tile out of all of them. An item is listed in
+// every cell its bounds touch, so a lookup costs the number of items near the box, not the number in the
+// world. Items too large for the cells sit in an overflow list that every lookup returns, and lookups too
+// large for them return every item, so nothing is ever left out.
+class MarkupGrid {
+public:
+    explicit MarkupGrid(float cellSize);
+
+    void insert(int item, const float* bmin, const float* bmax);
+    void remove(int item, const float* bmin, const float* bmax);
+    // Renumbers an item, for stores that fill a removed slot with their last item.
+    void renumber(int from, int to, const float* bmin, const float* bmax);
+    void clear();
+
+    // Fills items with the items listed in the cells the box touches, sorted and without duplicates. Items
+    // only near the box may be included, so callers test exact bounds. Safe to call from several threads
+    // as long as nothing is inserted or removed meanwhile.
+    void query(const float* bmin, const float* bmax, std::vector<int>& items) const;
+
+private:
+    // Returns false for bounds that span too many cells, lie too far out or are inverted or NaN.
+    bool cellRange(const float* bmin, const float* bmax, int* x0, int* z0, int* x1, int* z1) const;
+    static long long cellKey(int x, int z) { return ((long long) x << 32) | (unsigned int) z; }
+
+    float m_invCellSize;
+    std::unordered_map<long long, std::vector<int> > m_cells;
+    std::vector<int> m_overflow;
+};
+
+#endif /* MarkupGrid_h */
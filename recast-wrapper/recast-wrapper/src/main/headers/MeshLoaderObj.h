@@ -19,6 +19,7 @@
 #ifndef MESHLOADER_OBJ
 #define MESHLOADER_OBJ
 
+#include <stddef.h>
 #include <string>
 
 class rcMeshLoaderObj
@@ -27,7 +28,16 @@ public:
 	rcMeshLoaderObj();
 	~rcMeshLoaderObj();
 	
-	bool load(const std::string& fileName, bool invertYZ);
+	// Parses the file on threadCount threads; values <= 0 use every core.
+	bool load(const std::string& fileName, bool invertYZ, int threadCount = 0);
+	// Same, cutting the file into slices of at least minSliceBytes rather than 1MB. Any slice size gives
+	// the same result; small ones let tests reach the slice seams with small files.
+	bool load(const std::string& fileName, bool invertYZ, int threadCount, size_t minSliceBytes);
+
+	// Uses arrays owned elsewhere (e.g. a mapped geometry cache) instead of loading a file.
+	// The arrays must outlive this object.
+	void setExternalData(const std::string& fileName, float* verts, int vertCount,
+						 int* tris, float* normals, int triCount);
 
 	const float* getVerts() const { return m_verts; }
 	const float* getNormals() const { return m_normals; }
@@ -41,9 +51,6 @@ private:
 	rcMeshLoaderObj(const rcMeshLoaderObj&);
 	rcMeshLoaderObj& operator=(const rcMeshLoaderObj&);
 	
-	void addVertex(float x, float y, float z, int& cap);
-	void addTriangle(int a, int b, int c, int& cap);
-	
 	std::string m_filename;
 	float m_scale;	
 	float* m_verts;
@@ -51,6 +58,7 @@ private:
 	float* m_normals;
 	int m_vertCount;
 	int m_triCount;
+	bool m_ownsData;
 };
 
 #endif // MESHLOADER_OBJ
@@ -0,0 +1,64 @@
+//
+//  NavMeshCrowd.h
+//
+
+#ifndef NavMeshCrowd_h
+#define NavMeshCrowd_h
+
+#include "DetourCrowd.h"
+#include "DetourNavMesh.h"
+
+// Number of floats NavMeshCrowd::update writes per agent: position xyz followed by velocity xyz.
+const int CROWD_AGENT_STATE_SIZE = 6;
+
+extern "C"
+struct CrowdAgentConfig {
+    float radius;
+    float height;
+    float maxAcceleration;
+    float maxSpeed;
+    float separationWeight;
+    int updateFlags;            // Combination of DetourCrowd's UpdateFlags.
+    int obstacleAvoidance;      // Avoidance quality from 0 (lowest) to 3 (highest).
+};
+
+// Steers many agents over one navmesh with DetourCrowd: path following, local avoidance between agents
+// and separation. Agents are identified by the slot index returned from addAgent.
+//
+// A crowd is not thread-safe and must not be used while its navmesh is being modified.
+class NavMeshCrowd {
+public:
+    NavMeshCrowd();
+    ~NavMeshCrowd();
+
+    bool init(dtNavMesh* navMesh, int maxAgents, float maxAgentRadius);
+
+    // Adds an agent at the navmesh point nearest to pos. A null config uses the defaults of
+    // getDefaultAgentConfig. Returns the agent's index, or -1 when the crowd is full or pos is off the mesh.
+    int addAgent(const float* pos, const CrowdAgentConfig* config);
+    void removeAgent(int index);
+
+    // Sends the agent to the navmesh point nearest to pos. Returns false when there is none.
+    bool setTarget(int index, const float* pos);
+    bool resetTarget(int index);
+
+    // Advances every agent by dt seconds. When states is not null, the state of agent slot i is written to
+    // states[i * CROWD_AGENT_STATE_SIZE] for every slot below maxStates, with zeros for unused slots.
+    // Returns the number of slots written.
+    int update(float dt, float* states, int maxStates);
+
+    int getMaxAgents() const;
+    int getActiveAgentCount() const;
+
+    static void getDefaultAgentConfig(CrowdAgentConfig* config);
+
+private:
+    // Explicitly disabled copy constructor and copy assignment operator.
+    NavMeshCrowd(const NavMeshCrowd&);
+    NavMeshCrowd& operator=(const NavMeshCrowd&);
+
+    dtCrowd* m_crowd;
+    int m_activeAgents;
+};
+
+#endif /* NavMeshCrowd_h */
@@ -0,0 +1,82 @@
+//
+//  NavMeshFile.h
+//
+
+#ifndef NavMeshFile_h
+#define NavMeshFile_h
+
+#include <stdio.h>
+#include <vector>
+
+#include "DetourNavMesh.h"
+#include "Sample_subset.h"
+
+// Version 2 of the .tiled.bin64 layout. It starts with the same Sample::NavMeshSetHeader as version 1,
+// followed by a table of numTiles NavMeshFileTile entries and then the tile data. Every tile starts at
+// a multiple of NAVMESHFILE_ALIGNMENT from the start of the file, so a mapping of the file can be handed
+// to Detour in place, and the table gives its offset, size, grid location and CRC-32. A reader can seek
+// straight to one tile, and tiles can be read and verified in any order or in parallel.
+static const int NAVMESHFILE_VERSION = 2;
+static const int NAVMESHFILE_ALIGNMENT = 16;
+
+struct NavMeshFileTile {
+    long long offset;
+    dtTileRef tileRef;
+    int dataSize;
+    unsigned int checksum;  // CRC-32 of the tile data as it was saved.
+    int x;
+    int y;
+    int layer;
+    int reserved;
+};
+
+// CRC-32 (IEEE 802.3) of size bytes.
+unsigned int navMeshFileChecksum(const unsigned char* data, int size);
+
+// Reads the header and tile table of a version 2 file held in memory, such as a mapping of it. Returns false
+// if data is not a version 2 file or any entry of the table points outside it or at a misaligned offset.
+bool readNavMeshFileTable(const unsigned char* data, long long size, Sample::NavMeshSetHeader& header,
+                          std::vector<NavMeshFileTile>& tiles);
+
+// Writes every tile of mesh to path in the version 2 layout.
+bool saveNavMeshFile(const dtNavMesh* mesh, const char* path);
+
+// Loads a version 2 file. Tiles are copied out of a mapping of the file and checked against their
+// checksums on threadCount threads (<= 0 means one per core), then added to the navmesh in table order,
+// since dtNavMesh::addTile is not thread safe. Returns 0 if the file or any tile fails validation.
+dtNavMesh* loadNavMeshFile(const char* path, int threadCount);
+
+// Reads single tiles of a version 2 file without loading the rest.
+class NavMeshFileReader {
+public:
+    NavMeshFileReader();
+    ~NavMeshFileReader();
+
+    // Reads the header and the tile table. Returns false if path is not a version 2 file.
+    bool open(const char* path);
+    void close();
+
+    const dtNavMeshParams& getParams() const { return m_header.params; }
+    int getTileCount() const { return (int) m_tiles.size(); }
+    const NavMeshFileTile& getTile(int index) const { return m_tiles[index]; }
+
+    // Index of the tile at (x, y, layer), or -1.
+    int findTile(int x, int y, int layer) const;
+
+    // Reads the tile into a dtAlloc'd buffer and verifies it. Returns 0 on a read error or a checksum
+    // mismatch.
+    unsigned char* readTile(int index);
+    // Same, into data, which must hold getTile(index).dataSize bytes.
+    bool readTile(int index, unsigned char* data);
+
+private:
+    // Explicitly disabled copy constructor and copy assignment operator.
+    NavMeshFileReader(const NavMeshFileReader&);
+    NavMeshFileReader& operator=(const NavMeshFileReader&);
+
+    FILE* m_file;
+    Sample::NavMeshSetHeader m_header;
+    std::vector<NavMeshFileTile> m_tiles;
+};
+
+#endif /* NavMeshFile_h */
@@ -0,0 +1,75 @@
+//
+//  NavMeshMetrics.h
+//
+
+#ifndef NavMeshMetrics_h
+#define NavMeshMetrics_h
+
+#include <chrono>
+#include <string>
+
+#include "Recast.h"
+#include "DetourNavMesh.h"
+#include "DetourStatus.h"
+
+enum BuildStage {
+    BUILD_STAGE_RASTERIZE = 0,
+    BUILD_STAGE_COMPACT,
+    BUILD_STAGE_ERODE,
+    BUILD_STAGE_DISTANCE_FIELD,
+    BUILD_STAGE_REGIONS,
+    BUILD_STAGE_CONTOURS,
+    BUILD_STAGE_POLYMESH,
+    BUILD_STAGE_DETAIL,
+    BUILD_STAGE_DETOUR_DATA,
+    BUILD_STAGE_COUNT
+};
+
+enum QueryType {
+    QUERY_FIND_NEAREST_POLY = 0,
+    QUERY_FIND_PATH,
+    QUERY_FIND_RANDOM_POINT,
+    QUERY_SMOOTH_PATH,
+    QUERY_TYPE_COUNT
+};
+
+typedef std::chrono::steady_clock MetricsClock;
+
+// Accumulated Recast timers of a context at the start of a build step, so the step can record its own
+// stages without resetting timers its caller is still reading.
+struct BuildTimerSnapshot {
+    int micros[BUILD_STAGE_DETOUR_DATA];
+};
+
+// Process wide build and query metrics, exported in the Prometheus text format.
+//
+// Build stage durations are read from the timers of the rcContext a build runs with, so they are only
+// recorded for contexts that implement them, such as IoRcContext. Queries made through the C API record
+// their latency, outcome and the number of search nodes they touched. Tile memory covers every navmesh
+// created, loaded or streamed through the C API that has not been deleted yet.
+//
+// Every counter is a relaxed atomic: recording is safe from any thread and costs two clock reads and a
+// few uncontended increments per query.
+class NavMeshMetrics {
+public:
+    // Records the timers of stages first to last accumulated by ctx since snapshotBuildTimers filled since.
+    static void snapshotBuildTimers(const rcContext* ctx, BuildTimerSnapshot* since);
+    static void recordBuildTimers(const rcContext* ctx, BuildStage first, BuildStage last,
+                                  const BuildTimerSnapshot& since);
+    static void recordBuildStage(BuildStage stage, MetricsClock::time_point start);
+    static void recordBuildError();
+
+    static void recordQuery(QueryType type, MetricsClock::time_point start, dtStatus status, int nodesExpanded);
+
+    // Adds (sign 1) or removes (sign -1) the tiles of navMesh to the tile memory gauges.
+    static void addNavMeshTiles(const dtNavMesh* navMesh, int sign);
+    static void addTileMemory(int tiles, long long bytes);
+
+    // Appends every metric to out in the Prometheus text exposition format, version 0.0.4.
+    static void writePrometheus(std::string& out);
+
+    // Zeroes the counters and histograms. The tile memory gauges describe live navmeshes and are kept.
+    static void reset();
+};
+
+#endif /* NavMeshMetrics_h */
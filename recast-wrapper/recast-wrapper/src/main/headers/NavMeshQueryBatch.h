@@ -0,0 +1,57 @@
+//
+//  NavMeshQueryBatch.h
+//
+
+#ifndef NavMeshQueryBatch_h
+#define NavMeshQueryBatch_h
+
+#include <mutex>
+#include <vector>
+
+#include "DetourNavMesh.h"
+#include "DetourNavMeshQuery.h"
+#include "ThreadPool.h"
+
+extern "C"
+struct BatchPathResult {
+    dtStatus status;
+    dtPolyRef startRef;
+    dtPolyRef endRef;
+    int pathCount;
+    int smoothPathCount;
+};
+
+// Runs many nearest-poly + findPath + smoothing requests against one navmesh on a thread pool,
+// with one dtNavMeshQuery per pool thread.
+class NavMeshQueryBatch {
+public:
+    NavMeshQueryBatch();
+    ~NavMeshQueryBatch();
+
+    // maxNodes <= 0 uses the same node pool size as navmesh_query_create, threadCount <= 0 one thread per core.
+    bool init(dtNavMesh* navmesh, int maxNodes, int threadCount);
+
+    // Resolves the nearest polys of startPositions[i] and endPositions[i] and finds the smooth path
+    // between them for every i in [0, count). Request i writes up to maxSmoothPath points to
+    // smoothPaths[i * maxSmoothPath * 3] and its summary to results[i]. Returns the number of
+    // requests that found a path.
+    int findSmoothPaths(const float* startPositions, const float* endPositions, int count,
+                        const float* halfExtents, const dtQueryFilter* filter,
+                        BatchPathResult* results, float* smoothPaths, int maxSmoothPath);
+
+private:
+    // Explicitly disabled copy constructor and copy assignment operator.
+    NavMeshQueryBatch(const NavMeshQueryBatch&);
+    NavMeshQueryBatch& operator=(const NavMeshQueryBatch&);
+
+    void findSmoothPath(dtNavMeshQuery* navQuery, const float* startPos, const float* endPos,
+                        const float* halfExtents, const dtQueryFilter* filter,
+                        BatchPathResult& result, float* smoothPath, int maxSmoothPath);
+
+    dtNavMesh* m_navmesh;
+    ThreadPool* m_pool;
+    std::vector<dtNavMeshQuery*> m_queries;
+    std::mutex m_mutex;
+};
+
+#endif /* NavMeshQueryBatch_h */
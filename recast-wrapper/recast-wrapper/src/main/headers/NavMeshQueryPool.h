@@ -0,0 +1,66 @@
+//
+//  NavMeshQueryPool.h
+//
+
+#ifndef NavMeshQueryPool_h
+#define NavMeshQueryPool_h
+
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "DetourNavMesh.h"
+#include "DetourNavMeshQuery.h"
+
+// Hands out one dtNavMeshQuery per OS thread, each with its own node pool and random number generator,
+// so path and random point queries can run on every core without sharing a query.
+//
+// A thread gets its query on first use and keeps it until the pool is deleted. Its generator starts
+// from the pool seed mixed with the order in which threads first used the pool; threads that need a
+// reproducible sequence regardless of scheduling call seedThread. The pool must not outlive its navmesh,
+// and must not be deleted while any thread is still using one of its queries.
+class NavMeshQueryPool {
+public:
+    NavMeshQueryPool();
+    ~NavMeshQueryPool();
+
+    // maxNodes <= 0 uses the same node pool size as navmesh_query_create.
+    bool init(const dtNavMesh* navMesh, int maxNodes, unsigned int seed);
+
+    // The calling thread's query, or null when it could not be allocated.
+    dtNavMeshQuery* getQuery();
+
+    // Restarts the calling thread's generator from seed.
+    void seedThread(unsigned int seed);
+
+    // findRandomPoint on the calling thread's query, drawing from its generator.
+    dtStatus findRandomPoint(const dtQueryFilter* filter, dtPolyRef* polyRef, float* point);
+    dtStatus findRandomPointAroundCircle(dtPolyRef startRef, const float* centerPos, float radius,
+                                         const dtQueryFilter* filter, dtPolyRef* polyRef, float* point);
+
+    // Number of threads that have a query.
+    int getThreadCount();
+
+private:
+    // Explicitly disabled copy constructor and copy assignment operator.
+    NavMeshQueryPool(const NavMeshQueryPool&);
+    NavMeshQueryPool& operator=(const NavMeshQueryPool&);
+
+    struct Slot {
+        dtNavMeshQuery* query;
+        unsigned long long rngState;
+    };
+
+    Slot* getSlot();
+
+    const dtNavMesh* m_navMesh;
+    int m_maxNodes;
+    unsigned int m_seed;
+    unsigned long long m_id;                // Unique per pool, so addresses reused after delete never match.
+    std::mutex m_mutex;
+    std::unordered_map<std::thread::id, Slot*> m_slots;
+    std::vector<Slot*> m_slotList;
+};
+
+#endif /* NavMeshQueryPool_h */
@@ -0,0 +1,110 @@
+//
+//  NavMeshRebuilder.h
+//
+
+#ifndef NavMeshRebuilder_h
+#define NavMeshRebuilder_h
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Recast.h"
+#include "DetourNavMesh.h"
+#include "InputGeom.h"
+#include "ThreadPool.h"
+#include "TiledNavMeshBuilder.h"
+
+extern "C"
+struct TileRebuildStats {
+    long long queued;       // Tiles marked dirty, counting a tile again only once its previous rebuild started.
+    long long built;        // Tiles rebuilt, including tiles that turned out to have nothing walkable.
+    long long applied;      // Rebuilt tiles swapped into the navmesh.
+    long long failures;     // Tiles that could not be built or added.
+    long long buildNanos;   // Time spent rebuilding, summed over batches rather than threads.
+    int pendingTiles;       // Dirty tiles waiting for or in a rebuild.
+    int readyTiles;         // Rebuilt tiles waiting to be applied.
+};
+
+// Keeps a tiled navmesh built by buildTiledNavMesh up to date with edits to its InputGeom by rebuilding
+// only the tiles an edit touches.
+//
+// Dirty tiles are rebuilt on a background thread, in batches spread over the rebuilder's own thread
+// pool. Builds only read the geometry and never touch the navmesh, so queries keep running while they
+// do. Finished tiles wait until applyBuiltTiles swaps them in with removeTile and addTile, which takes
+// microseconds per tile but relinks the neighbouring tiles as well, so it must not overlap with queries
+// on the navmesh: the owner applies between query batches, as with StreamingNavMesh::touch. Swapped
+// tiles get new tile refs, so PathCache entries crossing them are dropped on their next hit and
+// RandomPointSampler::refresh picks the change up.
+//
+// Geometry edits made through the rebuilder wait for a batch in progress to finish and mark the edit's
+// bounds dirty. Edits made directly on the InputGeom must happen while the rebuilder is idle (see wait),
+// followed by markDirty.
+class NavMeshRebuilder {
+public:
+    NavMeshRebuilder();
+    ~NavMeshRebuilder();
+
+    // navMesh, geom and ctx must outlive the rebuilder. ctx is only used to log why init failed.
+    // threadCount <= 0 uses every core.
+    bool init(rcContext* ctx, dtNavMesh* navMesh, const rcConfig& config, InputGeom* geom,
+              const TileAgentSettings& agent, int threadCount);
+
+    // Queues every tile whose build reads from the xz extent of [bmin, bmax], including the tiles that
+    // only reach it with their border, and returns how many there are.
+    int markDirty(const float* bmin, const float* bmax);
+
+    // Adds the volume or connection to the geometry and marks its bounds dirty. Return the number of
+    // tiles queued, or -1 when there is no geometry or the volume has fewer than 3 or more than
+    // MAX_CONVEXVOL_PTS vertices.
+    int addConvexVolume(const float* verts, int nverts, float minh, float maxh, unsigned char area);
+    int addOffMeshConnection(const float* spos, const float* epos, float radius, unsigned char bidir,
+                             unsigned char area, unsigned short flags);
+
+    // Swaps every rebuilt tile into the navmesh and returns how many were swapped. When any were, bmin
+    // and bmax (if not null) receive the bounds of the swapped tiles.
+    int applyBuiltTiles(float* bmin, float* bmax);
+
+    // Blocks until no tile is waiting for or in a rebuild.
+    void wait();
+
+    void getStats(TileRebuildStats* stats);
+
+private:
+    // Explicitly disabled copy constructor and copy assignment operator.
+    NavMeshRebuilder(const NavMeshRebuilder&);
+    NavMeshRebuilder& operator=(const NavMeshRebuilder&);
+
+    struct BuiltTile {
+        int tile;           // Index into the tile grid.
+        unsigned char* data;
+        int dataSize;
+        bool ok;
+    };
+
+    void workerLoop();
+    int queueTiles(const float* bmin, const float* bmax);
+    void close();
+
+    dtNavMesh* m_navMesh;
+    rcConfig m_config;
+    InputGeom* m_geom;
+    TileAgentSettings m_agent;
+    int m_tileWidth, m_tileHeight;
+    ThreadPool* m_pool;
+    std::thread m_worker;
+
+    std::mutex m_mutex;                 // Guards everything below.
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::vector<bool> m_dirty;          // Per tile, queued but not yet taken by a batch.
+    std::vector<int> m_queue;
+    std::vector<BuiltTile> m_built;     // At most one per tile; a newer build replaces an unapplied one.
+    int m_building;
+    bool m_stop;
+    std::mutex m_geomMutex;             // Held by batches while they read the geometry.
+    long long m_queued, m_builtCount, m_applied, m_failures, m_buildNanos;
+};
+
+#endif /* NavMeshRebuilder_h */
@@ -9,9 +9,34 @@
 #include "DetourNavMeshQuery.h"
 #include "Common.h"
 
+// How navmesh_query_get_smooth_path_mode_into turns a corridor into points.
+enum SmoothPathMode
+{
+    SMOOTH_PATH_FOLLOW = 0,     // calcSmoothPath: small steps along the surface, as before.
+    SMOOTH_PATH_SAMPLED = 1,    // Straight path, plus a point every sampleSpacing along it.
+    SMOOTH_PATH_CORNERS = 2,    // Straight path corners only.
+};
+
 #endif /* NavMeshTesterTool_subset_h */
 
 SmoothPathResult* getSmoothPath(float* startPos, dtPolyRef startRef, float* endPos,
                                FindPathResult* path,
                                const dtQueryFilter* filter,
                                dtNavMesh* navMesh, dtNavMeshQuery* navQuery);
+
+// Follows the corridor in path along the detail mesh surface, writing at most maxSmoothPath points
+// to smoothPath. Corridors longer than MAX_PATH_LEN are truncated.
+void calcSmoothPath(const float* startPos, dtPolyRef startRef, const float* endPos,
+                    const dtPolyRef* path, int pathCount,
+                    const dtQueryFilter& filter,
+                    dtNavMesh* navMesh, dtNavMeshQuery& navQuery,
+                    float* smoothPath, int& smoothPathCount, const int maxSmoothPath);
+
+// Computes the straight path through the corridor once with the funnel algorithm and snaps its points to
+// the detail mesh height. SMOOTH_PATH_SAMPLED adds points every sampleSpacing along the way, so terrain
+// between corners is followed. Cost grows with the number of polys in the corridor rather than with path
+// length over step size.
+void calcStraightSmoothPath(const float* startPos, dtPolyRef startRef, const float* endPos,
+                            const dtPolyRef* path, int pathCount,
+                            dtNavMeshQuery& navQuery, SmoothPathMode mode, float sampleSpacing,
+                            float* smoothPath, int& smoothPathCount, const int maxSmoothPath);
@@ -0,0 +1,78 @@
+//
+//  NavMeshTileCache.h
+//
+
+#ifndef NavMeshTileCache_h
+#define NavMeshTileCache_h
+
+#include "Recast.h"
+#include "DetourNavMesh.h"
+#include "DetourTileCache.h"
+#include "DetourTileCacheBuilder.h"
+#include "InputGeom.h"
+#include "TiledNavMeshBuilder.h"
+
+extern "C"
+struct TileCacheStats {
+    long long compressedBytes;  // Layer data held by the cache, compressed.
+    long long rawBytes;         // The same layers uncompressed.
+    long long rebuiltTiles;     // Navmesh tiles rebuilt by update since the cache was created.
+    int layers;
+    int obstacles;              // Obstacles added and not yet removed, including ones still being processed.
+    int maxObstacles;
+};
+
+// Navmesh with temporary obstacles, built through DetourTileCache.
+//
+// init rasterizes every tile of geom once, like buildTiledNavMesh, but stops at the heightfield layers:
+// the walkable surface of a tile, split into non-overlapping layers and compressed with tileCompress.
+// Each layer becomes a navmesh tile. Cylinder and box obstacles are carved into the layers they touch when
+// those layers are turned back into navmesh tiles, which takes a fraction of a full tile build since
+// rasterization is skipped.
+//
+// Adding and removing obstacles only queues the change. update() applies the queue and rebuilds the
+// touched tiles one at a time until none are left or its time budget runs out, so the cost per tick is
+// bounded and a large change is spread over several ticks. update modifies the navmesh and must not
+// overlap with queries on it; everything else is as thread safe as dtTileCache, i.e. not at all.
+class NavMeshTileCache {
+public:
+    NavMeshTileCache();
+    ~NavMeshTileCache();
+
+    // geom must outlive the cache; its convex volumes are baked into the layers and its off-mesh
+    // connections are added to every rebuilt tile. threadCount <= 0 bakes on every core.
+    bool init(rcContext* ctx, const rcConfig& config, InputGeom* geom, const TileAgentSettings& agent,
+              int maxObstacles, int threadCount);
+
+    dtNavMesh* getNavMesh() const { return m_navMesh; }
+
+    // Return the obstacle's ref, or 0 when the obstacle pool or the queue of pending changes is full;
+    // an update makes room in the queue.
+    dtObstacleRef addCylinderObstacle(const float* pos, float radius, float height);
+    dtObstacleRef addBoxObstacle(const float* bmin, const float* bmax);
+    dtObstacleRef addOrientedBoxObstacle(const float* center, const float* halfExtents, float yRadians);
+    bool removeObstacle(dtObstacleRef ref);
+
+    // Applies queued obstacle changes and rebuilds touched tiles for up to budgetMicros microseconds, but
+    // at least one tile. Returns true when every change has been applied.
+    bool update(int budgetMicros);
+
+    void getStats(TileCacheStats* stats);
+
+private:
+    // Explicitly disabled copy constructor and copy assignment operator.
+    NavMeshTileCache(const NavMeshTileCache&);
+    NavMeshTileCache& operator=(const NavMeshTileCache&);
+
+    void close();
+
+    struct TileCacheAllocator* m_alloc;
+    struct TileLayerCompressor* m_compressor;
+    struct TileMeshProcess* m_meshProcess;
+    dtTileCache* m_tileCache;
+    dtNavMesh* m_navMesh;
+    long long m_rebuiltTiles;
+    bool m_upToDate;
+};
+
+#endif /* NavMeshTileCache_h */
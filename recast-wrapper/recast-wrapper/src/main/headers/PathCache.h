@@ -0,0 +1,103 @@
+//
+//  PathCache.h
+//
+
+#ifndef PathCache_h
+#define PathCache_h
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "DetourNavMesh.h"
+#include "DetourNavMeshQuery.h"
+
+extern "C"
+struct PathCacheStats {
+    long long hits;
+    long long misses;
+    long long insertions;
+    long long evictions;      // Entries dropped to stay within maxEntries.
+    long long invalidations;  // Entries dropped because a tile they cross was removed, replaced or invalidated.
+    int entries;
+    int maxEntries;
+};
+
+// Bounded LRU cache of findPath corridors, keyed by start poly, end poly and the filter's include flags,
+// exclude flags and area costs. Only complete corridors are stored. The positions are not part of the key:
+// findPath measures costs from startPos and endPos, so positions elsewhere in the same pair of polys can
+// make a different corridor the cheapest, yet get the cached one. The corridor still connects the two
+// polys, and straightening it with the new positions gives a valid path, if not always the shortest.
+//
+// Every poly ref carries the salt of its tile, which changes when the tile is removed or replaced, so
+// entries crossing such a tile fail validation on their next hit and are dropped. Changes that keep the
+// tile, such as new poly flags or areas, need invalidateRegion or clear.
+//
+// The cache is split into independently locked shards and can be shared by any number of threads, each
+// with its own dtNavMeshQuery. Like the queries themselves, it must not be used while the navmesh is
+// being modified.
+class PathCache {
+public:
+    PathCache(const dtNavMesh* navMesh, int maxEntries);
+
+    // Same contract as navmesh_query_find_path_into. Hits copy the cached corridor into path, misses run
+    // the search and store its result.
+    int findPath(dtNavMeshQuery* navQuery, dtPolyRef startRef, dtPolyRef endRef, const float* startPos,
+                 const float* endPos, const dtQueryFilter* filter, dtPolyRef* path, int maxPath, dtStatus* status);
+
+    // Drops the entries whose corridor crosses a tile overlapping the xz extent of [bmin, bmax], and
+    // returns how many were dropped.
+    int invalidateRegion(const float* bmin, const float* bmax);
+    void clear();
+
+    void getStats(PathCacheStats* stats);
+    void resetCounters();
+
+private:
+    // Explicitly disabled copy constructor and copy assignment operator.
+    PathCache(const PathCache&);
+    PathCache& operator=(const PathCache&);
+
+    static const int SHARD_COUNT = 16;
+
+    struct Key {
+        dtPolyRef startRef;
+        dtPolyRef endRef;
+        unsigned short includeFlags;
+        unsigned short excludeFlags;
+        float areaCost[DT_MAX_AREAS];
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        Key key;
+        std::vector<dtPolyRef> path;
+        std::vector<int> tiles;     // x, y pairs of the tiles the corridor crosses.
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    struct Shard {
+        std::mutex mutex;
+        EntryList lru;              // Most recently used first.
+        std::unordered_map<Key, EntryList::iterator, KeyHash> index;
+        long long hits, misses, insertions, evictions, invalidations;
+    };
+
+    Shard& shardFor(const Key& key);
+    bool isValid(const Entry& entry) const;
+    void erase(Shard& shard, EntryList::iterator entry);
+    void insert(const Key& key, const dtPolyRef* path, int pathCount);
+
+    const dtNavMesh* m_navMesh;
+    int m_maxEntriesPerShard;
+    Shard m_shards[SHARD_COUNT];
+};
+
+#endif /* PathCache_h */
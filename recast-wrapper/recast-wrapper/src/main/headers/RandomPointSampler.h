@@ -0,0 +1,61 @@
+//
+//  RandomPointSampler.h
+//
+
+#ifndef RandomPointSampler_h
+#define RandomPointSampler_h
+
+#include <vector>
+
+#include "DetourNavMesh.h"
+#include "DetourNavMeshQuery.h"
+
+// Draws uniformly distributed points on a navmesh in constant time per point.
+//
+// dtNavMeshQuery::findRandomPoint walks every tile and poly on each call. This sampler instead builds
+// an alias table over the areas of the polys that pass its filter once, so a point costs one table
+// lookup plus the point-in-poly and height computation. Points are a pure function of (seed, counter):
+// sample i of a call uses counter + i, so batches can be split across calls or threads and still give
+// the same points.
+//
+// The table is a snapshot of the navmesh's tiles. refresh() rebuilds it when tiles have been added,
+// removed or replaced, and must not overlap with sampling. Sampling itself is read only and can run on
+// any number of threads at once.
+class RandomPointSampler {
+public:
+    RandomPointSampler();
+    ~RandomPointSampler();
+
+    // A null filter samples every ground poly, as the default dtQueryFilter does.
+    bool init(const dtNavMesh* navMesh, const dtQueryFilter* filter);
+
+    // Rebuilds the table if the navmesh's tiles changed since it was built. Returns true when it did.
+    bool refresh();
+
+    // Writes count points to points (xyz) and their polys to refs. Returns the number written, which is
+    // 0 when no poly passes the filter.
+    int sample(unsigned long long seed, unsigned long long counter, int count, dtPolyRef* refs,
+               float* points) const;
+
+    int getPolyCount() const { return (int) m_refs.size(); }
+    float getTotalArea() const { return m_totalArea; }
+
+private:
+    // Explicitly disabled copy constructor and copy assignment operator.
+    RandomPointSampler(const RandomPointSampler&);
+    RandomPointSampler& operator=(const RandomPointSampler&);
+
+    void build();
+    unsigned long long calcTileSignature() const;
+
+    const dtNavMesh* m_navMesh;
+    dtNavMeshQuery* m_query;                    // Only used for getPolyHeight, which does not touch the node pool.
+    dtQueryFilter m_filter;
+    std::vector<dtPolyRef> m_refs;
+    std::vector<float> m_probabilities;         // Chance of keeping column i rather than taking its alias.
+    std::vector<int> m_aliases;
+    float m_totalArea;
+    unsigned long long m_tileSignature;
+};
+
+#endif /* RandomPointSampler_h */
@@ -7,8 +7,51 @@
 
 #include "DetourNavMesh.h"
 
-#endif //RECASTNAVIGATION_SAMPLE_SUBSET_H
-
 namespace Sample {
+    // Layout of the .tiled.bin64 files written by RecastDemo: a NavMeshSetHeader followed by numTiles
+    // (NavMeshTileHeader, tile data) pairs.
+    static const int NAVMESHSET_MAGIC = 'M' << 24 | 'S' << 16 | 'E' << 8 | 'T'; //'MSET';
+    static const int NAVMESHSET_VERSION = 1;
+
+    struct NavMeshSetHeader {
+        int magic;
+        int version;
+        int numTiles;
+        dtNavMeshParams params;
+    };
+
+    struct NavMeshTileHeader {
+        dtTileRef tileRef;
+        int dataSize;
+    };
+
+    // Compressed variant written by saveCompressed: the same NavMeshSetHeader under its own magic, then
+    // numTiles (NavMeshCompressedTileHeader, tileCompress output) pairs. Tiles are compressed one by one,
+    // and the header carries the tile's grid location, so a reader can index and unpack single tiles.
+    static const int NAVMESHSET_COMPRESSED_MAGIC = 'M' << 24 | 'S' << 16 | 'E' << 8 | 'Z'; //'MSEZ';
+    static const int NAVMESHSET_COMPRESSED_VERSION = 1;
+
+    struct NavMeshCompressedTileHeader {
+        dtTileRef tileRef;
+        int dataSize;
+        int compressedSize;
+        int x;
+        int y;
+    };
+
+    // Loads a .tiled.bin64 file in the plain, compressed or version 2 (NavMeshFile.h) layout.
     dtNavMesh *loadAll(const char *path);
+
+    // Writes every tile of mesh to path in the compressed layout.
+    bool saveCompressed(const dtNavMesh *mesh, const char *path);
+
+    // Loads the plain or version 2 layout of loadAll, but maps the file into memory and adds the tiles in place
+    // instead of copying them, so processes loading the same file share its pages. The mapping stays
+    // alive until the mesh is released with freeNavMesh.
+    dtNavMesh *loadAllMapped(const char *path);
+
+    // Frees a mesh returned by any of the loaders, including the file mapping behind loadAllMapped.
+    void freeNavMesh(dtNavMesh *mesh);
 }
+
+#endif //RECASTNAVIGATION_SAMPLE_SUBSET_H
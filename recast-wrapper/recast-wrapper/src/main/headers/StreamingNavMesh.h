@@ -0,0 +1,117 @@
+//
+//  StreamingNavMesh.h
+//
+
+#ifndef StreamingNavMesh_h
+#define StreamingNavMesh_h
+
+#include <stdio.h>
+#include <mutex>
+#include <vector>
+
+#include "DetourNavMesh.h"
+#include "NavMeshFile.h"
+
+extern "C"
+struct TileStreamStats {
+    long long hits;          // Tiles requested by a touch that were already resident.
+    long long misses;        // Tiles requested by a touch that had to be loaded.
+    long long evictions;     // Tiles removed to get back under the budget.
+    long long loadFailures;  // Tiles that could not be read or added.
+    long long residentBytes;
+    long long budgetBytes;
+    long long compressedBytes;  // Compressed tiles held in memory, resident or not. 0 for plain files.
+    int residentTiles;
+    int pinnedTiles;
+    int totalTiles;
+};
+
+// Navmesh backed by a .tiled.bin64 file whose tiles are only loaded when a region that overlaps them is
+// touched. Once the resident tiles exceed the byte budget, the least recently touched tiles that are
+// neither pinned nor part of the current touch are evicted. Evicted tiles are re-added with their
+// original tile ref, so poly refs stay valid across an evict/reload cycle.
+//
+// Version 2 files (NavMeshFile.h) are indexed from their tile table alone, and every tile is checked
+// against its checksum when it is loaded.
+//
+// Files written by Sample::saveCompressed are read whole by init, and their tiles stay compressed in memory:
+// loading a tile decompresses it instead of reading the file, and an evicted tile goes back to costing its
+// compressed size. The budget counts decompressed tiles only.
+//
+// Touching, pinning and evicting modify the dtNavMesh, so they must not run concurrently with queries
+// against getNavMesh(). The owner is expected to touch the region a query needs before running it.
+class StreamingNavMesh {
+public:
+    StreamingNavMesh();
+    ~StreamingNavMesh();
+
+    // Indexes the tiles in path without loading them. A budget of 0 means no limit, so every tile stays
+    // resident once touched.
+    bool init(const char* path, long long budgetBytes);
+
+    dtNavMesh* getNavMesh() const { return m_navMesh; }
+
+    // Loads every tile overlapping the xz extent of [bmin, bmax] and marks them as most recently used.
+    // Returns the number of tiles in the region that are resident afterwards.
+    int touch(const float* bmin, const float* bmax);
+
+    // Pinned tiles are loaded immediately and are never evicted until unpinned as many times as they
+    // were pinned. Both return the same count as touch.
+    int pin(const float* bmin, const float* bmax);
+    int unpin(const float* bmin, const float* bmax);
+
+    // Changing the budget evicts straight away if the resident tiles no longer fit.
+    void setBudget(long long budgetBytes);
+
+    void getStats(TileStreamStats* stats);
+    void resetCounters();
+
+private:
+    // Explicitly disabled copy constructor and copy assignment operator.
+    StreamingNavMesh(const StreamingNavMesh&);
+    StreamingNavMesh& operator=(const StreamingNavMesh&);
+
+    struct TileEntry {
+        dtTileRef tileRef;
+        long long offset;
+        unsigned char* compressed;  // Only for compressed files, otherwise the tile is read from offset.
+        int compressedSize;
+        int dataSize;
+        int fileIndex;              // Table index in m_reader for version 2 files, which it verifies, or -1.
+        int x, y;
+        int nextInCell;
+        int prev, next;     // LRU list links, -1 terminated. Only valid while resident.
+        int pinCount;
+        unsigned int lastTouch;
+        bool resident;
+    };
+
+    void close();
+    bool readCompressedTiles(int numTiles);
+    bool readTileTable();
+    void buildCellIndex();
+    int forEachTileIn(const float* bmin, const float* bmax, int pinDelta);
+    bool loadTile(int index);
+    void evictTile(int index);
+    void enforceBudget();
+    void linkFront(int index);
+    void unlink(int index);
+
+    FILE* m_file;
+    NavMeshFileReader m_reader;
+    dtNavMesh* m_navMesh;
+    std::vector<TileEntry> m_tiles;
+    std::vector<int> m_cells;   // First tile index per grid cell, chained through nextInCell.
+    int m_minX, m_minY, m_gridWidth, m_gridHeight;
+    int m_lruHead, m_lruTail;
+    unsigned int m_touch;
+    long long m_budgetBytes;
+    long long m_residentBytes;
+    long long m_compressedBytes;
+    int m_residentTiles;
+    int m_pinnedTiles;
+    long long m_hits, m_misses, m_evictions, m_loadFailures;
+    std::mutex m_mutex;
+};
+
+#endif /* StreamingNavMesh_h */
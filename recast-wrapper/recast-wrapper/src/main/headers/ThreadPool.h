@@ -0,0 +1,57 @@
+//
+//  ThreadPool.h
+//
+
+#ifndef ThreadPool_h
+#define ThreadPool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads used to spread native work (tile builds, batched queries, ...)
+// across cores. The thread calling parallelFor takes part in the work as worker 0, so a pool created
+// with a single thread runs everything inline.
+class ThreadPool {
+public:
+    explicit ThreadPool(int threadCount);
+    ~ThreadPool();
+
+    int getThreadCount() const { return (int) m_threads.size() + 1; }
+
+    // Calls fn(index, worker) for every index in [0, count) and blocks until all calls have returned.
+    // worker is in [0, getThreadCount()) and identifies the thread, which makes it suitable for
+    // indexing per-thread state. Must not be called from inside fn.
+    void parallelFor(int count, const std::function<void(int, int)>& fn);
+
+    // Number of hardware threads, or 1 when it cannot be determined.
+    static int defaultThreadCount();
+
+    // Resolves a caller supplied thread count, where values <= 0 mean "use every core".
+    static int resolveThreadCount(int threadCount);
+
+private:
+    // Explicitly disabled copy constructor and copy assignment operator.
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    void workerLoop(int worker);
+    void runJob(int worker);
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_callMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const std::function<void(int, int)>* m_fn;
+    int m_count;
+    std::atomic<int> m_next;
+    int m_busy;
+    unsigned int m_generation;
+    bool m_stop;
+};
+
+#endif /* ThreadPool_h */
@@ -0,0 +1,27 @@
+//
+//  TileCompressor.h
+//
+
+#ifndef TileCompressor_h
+#define TileCompressor_h
+
+// Byte oriented LZ77 compressor for tile data, in the spirit of LZ4: a hash of the next four bytes finds
+// an earlier occurrence within 64KB, and the output is a sequence of literal runs and back references.
+// Heightfield layers and Detour tiles are full of repeated heights, areas and vertex patterns, which this
+// shrinks severalfold while decompressing at memory speed.
+//
+// The format is internal to the wrapper and carries no header; callers store the uncompressed size
+// alongside the compressed bytes.
+
+// Largest compressed size of srcSize bytes.
+int tileCompressBound(int srcSize);
+
+// Compresses src into dst and returns the compressed size, or 0 if dstCapacity is below
+// tileCompressBound(srcSize).
+int tileCompress(const unsigned char* src, int srcSize, unsigned char* dst, int dstCapacity);
+
+// Decompresses src into dst and returns the decompressed size, or -1 if src is corrupt or does not fit
+// into dstCapacity bytes. Never reads or writes outside the given buffers.
+int tileDecompress(const unsigned char* src, int srcSize, unsigned char* dst, int dstCapacity);
+
+#endif /* TileCompressor_h */
@@ -0,0 +1,35 @@
+//
+//  TiledNavMeshBuilder.h
+//
+
+#ifndef TiledNavMeshBuilder_h
+#define TiledNavMeshBuilder_h
+
+#include "Recast.h"
+#include "DetourNavMesh.h"
+#include "InputGeom.h"
+
+struct TileAgentSettings {
+    float agentHeight;
+    float agentRadius;
+    float agentMaxClimb;
+};
+
+// Number of tiles needed to cover the navmesh bounds of geom with tiles of config.tileSize cells.
+void calcTileGridSize(const rcConfig& config, const InputGeom* geom, int* tileWidth, int* tileHeight);
+
+// Fills tileConfig with the per-tile configuration for tile (tx, ty): the grid is tileSize cells
+// plus borderSize cells on every side, and the bounds are expanded by the border accordingly.
+void calcTileConfig(const rcConfig& config, const InputGeom* geom, int tx, int ty, rcConfig& tileConfig);
+
+// Runs the whole Recast pipeline for a single tile and returns the Detour tile data in navData.
+// Tiles without any walkable surface are not an error: true is returned with navData set to 0.
+bool buildTileNavMeshData(rcContext* ctx, const rcConfig& config, InputGeom* geom, int tx, int ty,
+                          const TileAgentSettings& agent, unsigned char** navData, int* navDataSize);
+
+// Builds every tile covering geom on threadCount threads (<= 0 means one per core) and adds them to a
+// single multi-tile navmesh. Each thread logs through its own context; ctx only sees the summary.
+dtNavMesh* buildTiledNavMesh(rcContext* ctx, const rcConfig& config, InputGeom* geom,
+                             const TileAgentSettings& agent, int threadCount);
+
+#endif /* TiledNavMeshBuilder_h */
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <chrono>
 
 #include <Recast.h>
 #include <DetourNavMesh.h>
@@ -11,15 +12,54 @@
 #include "InputGeom.h"
 #include "NavMeshTesterTool_subset.h"
 #include "Sample_subset.h"
+#include "TiledNavMeshBuilder.h"
+#include "NavMeshQueryBatch.h"
+#include "NavMeshQueryPool.h"
+#include "RandomPointSampler.h"
+#include "StreamingNavMesh.h"
+#include "PathCache.h"
+#include "HierarchicalPathfinder.h"
+#include "NavMeshCrowd.h"
+#include "NavMeshRebuilder.h"
+#include "NavMeshTileCache.h"
+#include "NavMeshFile.h"
+#include "NavMeshMetrics.h"
+#include "BuildAllocator.h"
 
 const float IMPOSSIBLE_POINT[3] = {-1000000.0f, -1000000.0f, -1000000.0f};
 
+// Logs to stdout and keeps Recast's build timers, which NavMeshMetrics reads after each build stage.
 class IoRcContext : public rcContext {
     public:
-    IoRcContext(): rcContext(true) {}
+    IoRcContext(): rcContext(true) {
+        resetTimers();
+    }
     void doLog(const rcLogCategory category, const char* msg, const int len) override {
+        if (category == RC_LOG_ERROR) {
+            NavMeshMetrics::recordBuildError();
+        }
         printf("LOG: %s\n", msg);
     }
+    void doResetTimers() override {
+        for (int i = 0; i < RC_MAX_TIMERS; ++i) {
+            m_accumulatedNanos[i] = 0;
+        }
+    }
+    void doStartTimer(const rcTimerLabel label) override {
+        m_startTime[label] = std::chrono::steady_clock::now();
+    }
+    void doStopTimer(const rcTimerLabel label) override {
+        m_accumulatedNanos[label] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_startTime[label]).count();
+    }
+    // In microseconds, as in the Recast demo.
+    int doGetAccumulatedTime(const rcTimerLabel label) const override {
+        return (int) (m_accumulatedNanos[label] / 1000);
+    }
+
+    private:
+    std::chrono::steady_clock::time_point m_startTime[RC_MAX_TIMERS];
+    long long m_accumulatedNanos[RC_MAX_TIMERS];
 };
 
 enum SamplePartitionType
@@ -69,6 +109,9 @@ extern "C" void rcContext_delete(rcContext* ctx);
 extern "C" InputGeom* InputGeom_load(rcContext* context, const char* path, bool invertYZ);
 extern "C" void InputGeom_delete(InputGeom* geom);
 extern "C" rcCompactHeightfield* compact_heightfield_create(rcContext* context, rcConfig* config, InputGeom* geom);
+// Same as compact_heightfield_create, which rasterizes on every core, with the rasterization threads given; threads <= 0
+// means every core. The result is bit-identical for any number of threads.
+extern "C" rcCompactHeightfield* compact_heightfield_create_threaded(rcContext* context, rcConfig* config, InputGeom* geom, int threads);
 extern "C" void compact_heightfield_delete(rcCompactHeightfield* chf);
 extern "C" rcPolyMesh* polymesh_create(rcContext* m_ctx, rcConfig* m_cfg, rcCompactHeightfield* m_chf);
 extern "C" void polymesh_delete(rcPolyMesh* polyMesh);
@@ -77,7 +120,26 @@ extern "C" void polymesh_detail_delete(rcPolyMeshDetail* polyMeshDetail);
 extern "C" NavMeshDataResult* navmesh_data_create(rcContext* context, rcConfig* m_cfg, rcPolyMeshDetail* m_dmesh, rcPolyMesh* m_pmesh, InputGeom* m_geom, int tx, int ty, float agentHeight, float agentRadius, float agentMaxClimb);
 extern "C" void rcConfig_calc_grid_size(rcConfig* config, InputGeom* geom);
 extern "C" dtNavMesh* navmesh_create(rcContext* context, NavMeshDataResult* navmesh_data);
+extern "C" dtNavMesh* navmesh_create_tiled(rcContext* context, rcConfig* config, InputGeom* geom, float agentHeight, float agentRadius, float agentMaxClimb, int threads);
 extern "C" dtNavMesh* navmesh_load_tiled_bin(const char* path);
+extern "C" dtNavMesh* navmesh_load_tiled_bin_mapped(const char* path);
+// Writes the navmesh's tiles to path with every tile compressed on its own. navmesh_load_tiled_bin and navmesh_stream_open
+// read the result; a stream keeps its tiles compressed in memory and decompresses each one when a touch first needs it.
+extern "C" bool navmesh_save_compressed(dtNavMesh* navmesh, const char* path);
+// Version 2 files: a tile table with offsets and checksums in front of 16 byte aligned tiles. navmesh_load verifies and copies
+// the tiles on threads threads (<= 0 means one per core) and fails if any tile is damaged. The other loaders and navmesh_stream_open
+// read version 2 files as well.
+extern "C" bool navmesh_save(dtNavMesh* navmesh, const char* path);
+extern "C" dtNavMesh* navmesh_load(const char* path, int threads);
+// Reads single tiles of a version 2 file. navmesh_file_get_tile_location writes the x, y and layer of a table entry into
+// location, navmesh_file_find_tile returns the entry at (x, y, layer) or -1. navmesh_file_read_tile returns the tile's size,
+// and only when buffer holds that many bytes also reads and verifies the tile into it; -1 means the read or the checksum failed.
+extern "C" NavMeshFileReader* navmesh_file_open(const char* path);
+extern "C" void navmesh_file_close(NavMeshFileReader* reader);
+extern "C" int navmesh_file_get_tile_count(NavMeshFileReader* reader);
+extern "C" bool navmesh_file_get_tile_location(NavMeshFileReader* reader, int index, int* location);
+extern "C" int navmesh_file_find_tile(NavMeshFileReader* reader, int x, int y, int layer);
+extern "C" int navmesh_file_read_tile(NavMeshFileReader* reader, int index, unsigned char* buffer, int maxSize);
 extern "C" void navmesh_delete(dtNavMesh* navmesh);
 extern "C" dtNavMeshQuery* navmesh_query_create(dtNavMesh* navmesh);
 extern "C" void navmesh_query_delete(dtNavMeshQuery* navQuery);
@@ -90,6 +152,121 @@ extern "C" dtQueryFilter* dtQueryFilter_create();
 extern "C" void dtQueryFilter_delete(dtQueryFilter* filter);
 extern "C" SmoothPathResult* navmesh_query_get_smooth_path(float* startPos, dtPolyRef startRef, float* endPos, FindPathResult* path, const dtQueryFilter* filter, dtNavMesh* navMesh, dtNavMeshQuery* navQuery);
 extern "C" void smooth_path_result_delete(SmoothPathResult* smoothPathResult);
+
+// Allocation-free variants of the query functions above. Results are written into buffers owned by the caller,
+// so the same (pinned) buffers can be reused across calls. A null filter selects the default dtQueryFilter.
+extern "C" dtStatus navmesh_query_find_nearest_poly_into(dtNavMeshQuery* navQuery, const float* point, const float* half_extents, dtPolyRef* polyRef, float* nearestPoint);
+extern "C" dtStatus navmesh_query_find_random_point_into(dtNavMeshQuery* navQuery, dtPolyRef* polyRef, float* point);
+extern "C" int navmesh_query_find_path_into(dtNavMeshQuery* navQuery, dtPolyRef startRef, dtPolyRef endRef, const float* startPos, const float* endPos, const dtQueryFilter* filter, dtPolyRef* path, int maxPath, dtStatus* status);
+extern "C" int navmesh_query_get_smooth_path_into(const float* startPos, dtPolyRef startRef, const float* endPos, const dtPolyRef* path, int pathCount, const dtQueryFilter* filter, dtNavMesh* navMesh, dtNavMeshQuery* navQuery, float* smoothPath, int maxSmoothPath);
+// Same as navmesh_query_get_smooth_path_into with the SmoothPathMode of NavMeshTesterTool_subset.h selectable
+// per call. SMOOTH_PATH_SAMPLED writes a point every sampleSpacing world units between corners.
+extern "C" int navmesh_query_get_smooth_path_mode_into(const float* startPos, dtPolyRef startRef, const float* endPos, const dtPolyRef* path, int pathCount, const dtQueryFilter* filter, dtNavMesh* navMesh, dtNavMeshQuery* navQuery, int mode, float sampleSpacing, float* smoothPath, int maxSmoothPath);
+// Time-sliced findPath on a query: init, then update with at most maxIter node expansions per call until the status is no
+// longer DT_IN_PROGRESS, then finalize. The query keeps the filter until the search is finalized, so a caller supplied
+// filter must outlive it. One query runs one sliced search at a time; use a query per concurrent search.
+extern "C" dtStatus navmesh_query_init_sliced_find_path(dtNavMeshQuery* navQuery, dtPolyRef startRef, dtPolyRef endRef, const float* startPos, const float* endPos, const dtQueryFilter* filter, unsigned int options);
+extern "C" dtStatus navmesh_query_update_sliced_find_path(dtNavMeshQuery* navQuery, int maxIter, int* doneIters);
+extern "C" int navmesh_query_finalize_sliced_find_path(dtNavMeshQuery* navQuery, dtPolyRef* path, int maxPath, dtStatus* status);
+extern "C" int navmesh_query_finalize_sliced_find_path_partial(dtNavMeshQuery* navQuery, const dtPolyRef* existing, int existingSize, dtPolyRef* path, int maxPath, dtStatus* status);
+extern "C" NavMeshQueryBatch* navmesh_query_batch_create(dtNavMesh* navmesh, int maxNodes, int threads);
+extern "C" void navmesh_query_batch_delete(NavMeshQueryBatch* batch);
+extern "C" int navmesh_query_batch_find_smooth_paths(NavMeshQueryBatch* batch, const float* startPositions, const float* endPositions, int count, const float* halfExtents, const dtQueryFilter* filter, BatchPathResult* results, float* smoothPaths, int maxSmoothPathLen);
+// Query pools: every OS thread calling into a pool gets its own query and random number generator, so pools can be used
+// from any number of threads at once. The query returned by navmesh_query_pool_get_query belongs to the calling thread
+// and the pool; it can be passed to the other navmesh_query_* functions on that thread but must not be deleted.
+extern "C" NavMeshQueryPool* navmesh_query_pool_create(dtNavMesh* navmesh, int maxNodes, unsigned int seed);
+extern "C" void navmesh_query_pool_delete(NavMeshQueryPool* pool);
+extern "C" dtNavMeshQuery* navmesh_query_pool_get_query(NavMeshQueryPool* pool);
+extern "C" void navmesh_query_pool_seed_thread(NavMeshQueryPool* pool, unsigned int seed);
+extern "C" dtStatus navmesh_query_pool_find_random_point_into(NavMeshQueryPool* pool, const dtQueryFilter* filter, dtPolyRef* polyRef, float* point);
+extern "C" dtStatus navmesh_query_pool_find_random_point_around_circle_into(NavMeshQueryPool* pool, dtPolyRef startRef, const float* centerPos, float radius, const dtQueryFilter* filter, dtPolyRef* polyRef, float* point);
+extern "C" int navmesh_query_pool_find_path_into(NavMeshQueryPool* pool, dtPolyRef startRef, dtPolyRef endRef, const float* startPos, const float* endPos, const dtQueryFilter* filter, dtPolyRef* path, int maxPath, dtStatus* status);
+extern "C" int navmesh_query_pool_get_thread_count(NavMeshQueryPool* pool);
+// Random point sampling: an alias table over the areas of the polys whose flags pass includeFlags and excludeFlags, built
+// once so that each point costs O(1). Sample i of a call is determined by seed and counter + i alone. Call
+// navmesh_random_sampler_refresh after changing the navmesh's tiles; it rebuilds the table only if they changed.
+extern "C" RandomPointSampler* navmesh_random_sampler_create(dtNavMesh* navmesh, int includeFlags, int excludeFlags);
+extern "C" void navmesh_random_sampler_delete(RandomPointSampler* sampler);
+extern "C" bool navmesh_random_sampler_refresh(RandomPointSampler* sampler);
+extern "C" int navmesh_random_sampler_sample_into(RandomPointSampler* sampler, unsigned long long seed, unsigned long long counter, int count, dtPolyRef* refs, float* points);
+extern "C" int navmesh_random_sampler_get_poly_count(RandomPointSampler* sampler);
+extern "C" float navmesh_random_sampler_get_total_area(RandomPointSampler* sampler);
+// Tile streaming: the navmesh returned by navmesh_stream_get_navmesh is owned by the stream and must not be
+// passed to navmesh_delete. Touching, pinning and changing the budget must not overlap with queries on it.
+extern "C" StreamingNavMesh* navmesh_stream_open(const char* path, long long budgetBytes);
+extern "C" void navmesh_stream_delete(StreamingNavMesh* stream);
+extern "C" dtNavMesh* navmesh_stream_get_navmesh(StreamingNavMesh* stream);
+extern "C" int navmesh_stream_touch(StreamingNavMesh* stream, const float* bmin, const float* bmax);
+extern "C" int navmesh_stream_pin(StreamingNavMesh* stream, const float* bmin, const float* bmax);
+extern "C" int navmesh_stream_unpin(StreamingNavMesh* stream, const float* bmin, const float* bmax);
+extern "C" void navmesh_stream_set_budget(StreamingNavMesh* stream, long long budgetBytes);
+extern "C" void navmesh_stream_get_stats(StreamingNavMesh* stream, TileStreamStats* stats);
+extern "C" void navmesh_stream_reset_stats(StreamingNavMesh* stream);
+extern "C" int navmesh_stream_find_path_into(StreamingNavMesh* stream, dtNavMeshQuery* navQuery, const float* startPos, const float* endPos, const float* halfExtents, const dtQueryFilter* filter, dtPolyRef* path, int maxPath, dtStatus* status);
+// Path cache: navmesh_path_cache_find_path_into has the contract of navmesh_query_find_path_into, but repeated
+// queries for the same poly pair and filter are answered from the cache. One cache can be shared by many threads.
+extern "C" PathCache* navmesh_path_cache_create(dtNavMesh* navmesh, int maxEntries);
+extern "C" void navmesh_path_cache_delete(PathCache* cache);
+extern "C" int navmesh_path_cache_find_path_into(PathCache* cache, dtNavMeshQuery* navQuery, dtPolyRef startRef, dtPolyRef endRef, const float* startPos, const float* endPos, const dtQueryFilter* filter, dtPolyRef* path, int maxPath, dtStatus* status);
+extern "C" int navmesh_path_cache_invalidate_region(PathCache* cache, const float* bmin, const float* bmax);
+extern "C" void navmesh_path_cache_clear(PathCache* cache);
+extern "C" void navmesh_path_cache_get_stats(PathCache* cache, PathCacheStats* stats);
+extern "C" void navmesh_path_cache_reset_stats(PathCache* cache);
+// Hierarchical pathfinding: an abstract graph of tile border portals with precomputed costs for one filter. Long routes
+// are planned on the graph and refined tile by tile, so they are not limited by the query's node pool. Rebuild the
+// graph after changing the navmesh's tiles.
+extern "C" HierarchicalPathfinder* navmesh_hierarchy_create(dtNavMesh* navmesh, const dtQueryFilter* filter, int threads);
+extern "C" void navmesh_hierarchy_delete(HierarchicalPathfinder* hierarchy);
+extern "C" int navmesh_hierarchy_find_path_into(HierarchicalPathfinder* hierarchy, dtNavMeshQuery* navQuery, dtPolyRef startRef, dtPolyRef endRef, const float* startPos, const float* endPos, dtPolyRef* path, int maxPath, dtStatus* status);
+extern "C" int navmesh_hierarchy_find_waypoints_into(HierarchicalPathfinder* hierarchy, dtPolyRef startRef, dtPolyRef endRef, const float* startPos, const float* endPos, dtPolyRef* waypointRefs, float* waypointPositions, int maxWaypoints, dtStatus* status);
+extern "C" void navmesh_hierarchy_get_stats(HierarchicalPathfinder* hierarchy, HierarchicalGraphStats* stats);
+// Incremental rebuilds: tiles of a navmesh_create_tiled navmesh touched by an edit are rebuilt in the background while
+// queries continue, and navmesh_rebuilder_apply swaps the finished ones in. Applying must not overlap with queries on the
+// navmesh; it returns the number of tiles swapped and their bounds, for invalidating path caches and refreshing samplers.
+// The rebuilder must be deleted before its navmesh and geometry.
+extern "C" NavMeshRebuilder* navmesh_rebuilder_create(rcContext* context, dtNavMesh* navmesh, rcConfig* config, InputGeom* geom, float agentHeight, float agentRadius, float agentMaxClimb, int threads);
+extern "C" void navmesh_rebuilder_delete(NavMeshRebuilder* rebuilder);
+extern "C" int navmesh_rebuilder_mark_dirty(NavMeshRebuilder* rebuilder, const float* bmin, const float* bmax);
+extern "C" int navmesh_rebuilder_add_convex_volume(NavMeshRebuilder* rebuilder, const float* verts, int nverts, float minh, float maxh, int area);
+extern "C" int navmesh_rebuilder_add_off_mesh_connection(NavMeshRebuilder* rebuilder, const float* spos, const float* epos, float radius, bool bidirectional, int area, int flags);
+extern "C" int navmesh_rebuilder_apply(NavMeshRebuilder* rebuilder, float* bmin, float* bmax);
+extern "C" void navmesh_rebuilder_wait(NavMeshRebuilder* rebuilder);
+extern "C" void navmesh_rebuilder_get_stats(NavMeshRebuilder* rebuilder, TileRebuildStats* stats);
+// Temporary obstacles: a tiled navmesh whose compressed heightfield layers are kept, so cylinder and box obstacles can be
+// carved in and out without rasterizing again. Obstacle changes are queued and navmesh_tile_cache_update applies them
+// within a time budget; it returns true once nothing is left. The navmesh is owned by the cache, and updating must not
+// overlap with queries on it. Obstacle refs are 0 when the obstacle pool or the change queue is full.
+extern "C" NavMeshTileCache* navmesh_tile_cache_create(rcContext* context, rcConfig* config, InputGeom* geom, float agentHeight, float agentRadius, float agentMaxClimb, int maxObstacles, int threads);
+extern "C" void navmesh_tile_cache_delete(NavMeshTileCache* cache);
+extern "C" dtNavMesh* navmesh_tile_cache_get_navmesh(NavMeshTileCache* cache);
+extern "C" unsigned int navmesh_tile_cache_add_cylinder_obstacle(NavMeshTileCache* cache, const float* pos, float radius, float height);
+extern "C" unsigned int navmesh_tile_cache_add_box_obstacle(NavMeshTileCache* cache, const float* bmin, const float* bmax);
+extern "C" unsigned int navmesh_tile_cache_add_oriented_box_obstacle(NavMeshTileCache* cache, const float* center, const float* halfExtents, float yRadians);
+extern "C" bool navmesh_tile_cache_remove_obstacle(NavMeshTileCache* cache, unsigned int ref);
+extern "C" bool navmesh_tile_cache_update(NavMeshTileCache* cache, int budgetMicros);
+extern "C" void navmesh_tile_cache_get_stats(NavMeshTileCache* cache, TileCacheStats* stats);
+// Crowd simulation: crowd_update advances every agent and writes CROWD_AGENT_STATE_SIZE floats per agent slot
+// (position xyz, velocity xyz) into states, so a whole crowd is stepped and read back in one call. A null config adds
+// the agent with crowd_get_default_agent_config. The crowd must not outlive its navmesh.
+extern "C" NavMeshCrowd* crowd_create(dtNavMesh* navmesh, int maxAgents, float maxAgentRadius);
+extern "C" void crowd_delete(NavMeshCrowd* crowd);
+extern "C" void crowd_get_default_agent_config(CrowdAgentConfig* config);
+extern "C" int crowd_add_agent(NavMeshCrowd* crowd, const float* pos, const CrowdAgentConfig* config);
+extern "C" void crowd_remove_agent(NavMeshCrowd* crowd, int index);
+extern "C" bool crowd_set_target(NavMeshCrowd* crowd, int index, const float* pos);
+extern "C" bool crowd_reset_target(NavMeshCrowd* crowd, int index);
+extern "C" int crowd_update(NavMeshCrowd* crowd, float dt, float* states, int maxStates);
+extern "C" int crowd_get_active_agent_count(NavMeshCrowd* crowd);
+// Metrics: build stage durations, query latencies and outcomes, and tile memory in the Prometheus text format, ready to be
+// served from a metrics endpoint. Writes at most maxLength bytes including the terminating zero and returns the length of
+// the whole text, so a return value >= maxLength means the buffer was too small.
+extern "C" int navmesh_metrics_write_prometheus(char* buffer, int maxLength);
+extern "C" void navmesh_metrics_reset();
+// Allocators: routes rcAlloc and dtAlloc through a per-thread arena for build temporaries and pooled size classes for
+// everything else, see BuildAllocator.h. Process wide and permanent; call it before creating any Recast or Detour object.
+// Returns false and changes nothing on a second call or once anything was allocated through the default allocators.
+extern "C" bool build_allocator_install();
 extern "C" bool dtStatus_failed(dtStatus status);
 extern "C" bool dtPolyRef_is_64bit();
 extern "C" void random_set_seed(int seed);